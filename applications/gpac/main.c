@@ -1146,6 +1146,10 @@ static BOOL WINAPI gpac_sig_handler(DWORD sig)
 #include <signal.h>
 static void gpac_sig_handler(int sig)
 {
+	if (sig == SIGUSR1) {
+		if (session) gf_fs_request_trace_dump(session);
+		return;
+	}
 	if (sig == SIGINT) {
 #endif
 		nb_loops = 0;
@@ -2108,6 +2112,10 @@ restart:
 		signal(SIGINT, gpac_sig_handler);
 #endif
 	}
+#ifndef WIN32
+	if (gf_opts_get_key("core", "trace"))
+		signal(SIGUSR1, gpac_sig_handler);
+#endif
 
 	if (enable_reports) {
 		gpac_print_report(session, GF_TRUE, GF_FALSE);
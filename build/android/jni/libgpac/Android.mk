@@ -150,6 +150,11 @@ LOCAL_SRC_FILES := \
 	../../../../src/filter_core/filter_register.c \
 	../../../../src/filter_core/filter_session.c \
 	../../../../src/filter_core/filter_session_js.c \
+	../../../../src/filter_core/filter_metrics.c \
+	../../../../src/filter_core/filter_trace.c \
+	../../../../src/filter_core/filter_group.c \
+	../../../../src/filter_core/filter_graph_cache.c \
+	../../../../src/filter_core/filter_spill.c \
 	../../../../src/filters/bsrw.c \
 	../../../../src/filters/compose.c \
 	../../../../src/filters/dasher.c \
@@ -194,6 +199,7 @@ LOCAL_SRC_FILES := \
 	../../../../src/filters/ff_mx.c \
 	../../../../src/filters/ff_rescale.c \
 	../../../../src/filters/filelist.c \
+	../../../../src/filters/hevc_rewrite.c \
 	../../../../src/filters/hevcmerge.c \
 	../../../../src/filters/hevcsplit.c \
 	../../../../src/filters/in_atsc.c \
@@ -231,6 +237,7 @@ LOCAL_SRC_FILES := \
 	../../../../src/filters/reframe_flac.c \
 	../../../../src/filters/reframe_h263.c \
 	../../../../src/filters/reframe_img.c \
+	../../../../src/filters/reframe_index.c \
 	../../../../src/filters/reframe_latm.c \
 	../../../../src/filters/reframe_mp3.c \
 	../../../../src/filters/reframe_mpgvid.c \
@@ -250,6 +257,7 @@ LOCAL_SRC_FILES := \
 	../../../../src/filters/tssplit.c \
 	../../../../src/filters/unit_test_filter.c \
 	../../../../src/filters/vcrop.c \
+	../../../../src/filters/vladder.c \
 	../../../../src/filters/vflip.c \
 	../../../../src/filters/write_generic.c \
 	../../../../src/filters/write_nhml.c \
@@ -292,6 +300,7 @@ LOCAL_SRC_FILES := \
 	../../../../src/isomedia/meta.c \
 	../../../../src/isomedia/movie_fragments.c \
 	../../../../src/isomedia/sample_descs.c \
+	../../../../src/isomedia/stbl_delta.c \
 	../../../../src/isomedia/stbl_read.c \
 	../../../../src/isomedia/stbl_write.c \
 	../../../../src/isomedia/track.c \
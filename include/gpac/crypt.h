@@ -24,7 +24,7 @@
 */
 
 /*
-The GPAC crypto lib uses either openSSL 1.x or tiny-AES (https://github.com/kokke/tiny-AES-c) when not available
+The GPAC crypto lib uses either openSSL (through the EVP interface, hence hardware accelerated when available) or tiny-AES (https://github.com/kokke/tiny-AES-c) when not available
 The crypto lib only supports AES 128 bits in CBC and CTR modes
 */
 
@@ -141,6 +141,74 @@ GF_Err gf_crypt_encrypt(GF_Crypt *gfc, void *plaintext, u32 size);
 */
 GF_Err gf_crypt_decrypt(GF_Crypt *gfc, void *ciphertext, u32 size);
 
+/*! encrypts a payload using pattern encryption (cens and cbcs schemes). The encryption is done inplace.
+ The payload is processed as a sequence of patterns of crypt_block 16-byte blocks encrypted followed by skip_block 16-byte blocks left in the clear, the last pattern being possibly partial.
+ All encrypted blocks of the payload are processed in a single call, the chaining state (CBC IV or CTR counter) being carried over from one encrypted stripe to the next.
+ If crypt_block or skip_block is 0, the entire payload is encrypted.
+
+\param gfc the target crytpo context
+\param plaintext the clear buffer
+\param size the size of the clear buffer
+\param crypt_block number of encrypted 16-byte blocks in the pattern
+\param skip_block number of clear 16-byte blocks in the pattern
+\return error if any
+*/
+GF_Err gf_crypt_encrypt_pattern(GF_Crypt *gfc, void *plaintext, u32 size, u32 crypt_block, u32 skip_block);
+
+/*! decrypts a payload using pattern encryption (cens and cbcs schemes). The decryption is done inplace.
+ See \ref gf_crypt_encrypt_pattern for the pattern layout.
+
+\param gfc the target crytpo context
+\param ciphertext the encrypted buffer
+\param size the size of the encrypted buffer
+\param crypt_block number of encrypted 16-byte blocks in the pattern
+\param skip_block number of clear 16-byte blocks in the pattern
+\return error if any
+*/
+GF_Err gf_crypt_decrypt_pattern(GF_Crypt *gfc, void *ciphertext, u32 size, u32 crypt_block, u32 skip_block);
+
+/*! subsample description for \ref gf_crypt_encrypt_subsamples and \ref gf_crypt_decrypt_subsamples*/
+typedef struct
+{
+	/*! number of bytes in the clear at the start of the subsample*/
+	u32 clear_bytes;
+	/*! number of bytes following the clear bytes to which the pattern applies*/
+	u32 crypt_bytes;
+} GF_CryptSubsample;
+
+/*! encrypts the subsamples of a payload using pattern encryption. The encryption is done inplace.
+ The result is the same as calling \ref gf_crypt_encrypt_pattern on each subsample in turn, resetting the IV before each subsample if IV is set, but the encrypted stripes of all subsamples sharing the same chaining state are gathered and processed in a single call.
+ In CBC mode, trailing bytes of a stripe not forming a full 16-byte block are processed after the gathered blocks, as with \ref gf_crypt_encrypt_pattern.
+
+\param gfc the target crytpo context
+\param plaintext the clear buffer
+\param size the size of the clear buffer
+\param subs the list of subsamples, describing at most size bytes
+\param nb_subs the number of subsamples
+\param crypt_block number of encrypted 16-byte blocks in the pattern
+\param skip_block number of clear 16-byte blocks in the pattern
+\param IV constant IV set before each subsample, or NULL to carry the chaining state over subsamples
+\param IV_size size of the constant IV
+\return error if any
+*/
+GF_Err gf_crypt_encrypt_subsamples(GF_Crypt *gfc, void *plaintext, u32 size, const GF_CryptSubsample *subs, u32 nb_subs, u32 crypt_block, u32 skip_block, const u8 *IV, u32 IV_size);
+
+/*! decrypts the subsamples of a payload using pattern encryption. The decryption is done inplace.
+ See \ref gf_crypt_encrypt_subsamples for the subsample processing.
+
+\param gfc the target crytpo context
+\param ciphertext the encrypted buffer
+\param size the size of the encrypted buffer
+\param subs the list of subsamples, describing at most size bytes
+\param nb_subs the number of subsamples
+\param crypt_block number of encrypted 16-byte blocks in the pattern
+\param skip_block number of clear 16-byte blocks in the pattern
+\param IV constant IV set before each subsample, or NULL to carry the chaining state over subsamples
+\param IV_size size of the constant IV
+\return error if any
+*/
+GF_Err gf_crypt_decrypt_subsamples(GF_Crypt *gfc, void *ciphertext, u32 size, const GF_CryptSubsample *subs, u32 nb_subs, u32 crypt_block, u32 skip_block, const u8 *IV, u32 IV_size);
+
 
 /*! @} */
 
@@ -481,6 +481,29 @@ GF_Err gf_dash_group_get_next_segment_location(GF_DashClient *dash, u32 group_id
         s32 *switching_index, const char **switching_url, u64 *switching_start_range, u64 *switching_end_range,
         const char **original_url, Bool *has_next_segment, const char **key_url, bin128 *key_IV);
 
+/*! gets the URL and byte range of a media segment ahead of the download position of this group, in the currently active representation. This is used to prefetch upcoming segments while the current one is being processed. Only static presentations on remote servers are supported.
+\param dash the target dash client
+\param group_idx the 0-based index of the target group
+\param seg_offset offset of the segment after the next segment to be scheduled by the client, 0 being that next segment
+\param url set to the URL of the segment - shall be freed by caller
+\param start_range set to the start byte offset in the segment (optional, may be NULL)
+\param end_range set to the end byte offset in the segment (optional, may be NULL)
+\return GF_EOS if the segment is past the end of the representation, GF_NOT_SUPPORTED if the segment cannot be prefetched or error if any
+*/
+GF_Err gf_dash_group_get_prefetch_segment_location(GF_DashClient *dash, u32 group_idx, u32 seg_offset, char **url, u64 *start_range, u64 *end_range);
+
+/*! gets the URL and byte range of the next tile segment to fetch for a group with dependent tile groups, by decreasing tile priority (see \ref gf_dash_group_set_visible_rect). This only applies to the next segment of the base group: each returned tile segment is marked as requested and is no longer subject to late quality upgrade.
+\param dash the target dash client
+\param group_idx the 0-based index of the base group
+\param dependent_representation_index set to the index of the tile segment, as used by \ref gf_dash_group_get_next_segment_location
+\param url set to the URL of the segment
+\param start_range set to the start byte offset in the segment (optional, may be NULL)
+\param end_range set to the end byte offset in the segment (optional, may be NULL)
+\param priority set to the priority of the tile: 0 for visible, 1 for predicted visible, 2 for hidden (optional, may be NULL)
+\return GF_BUFFER_TOO_SMALL if next segment is not known yet, GF_EOS if all tile segments of the next segment are requested or error if any
+*/
+GF_Err gf_dash_group_get_next_tile_segment_location(GF_DashClient *dash, u32 group_idx, u32 *dependent_representation_index, const char **url, u64 *start_range, u64 *end_range, u32 *priority);
+
 /*! same as gf_dash_group_get_next_segment_location but query the current downloaded segment
 \param dash the target dash client
 \param group_idx the 0-based index of the target group
@@ -914,6 +937,13 @@ GF_Err gf_dash_group_set_quality_degradation_hint(GF_DashClient *dash, u32 group
 */
 GF_Err gf_dash_group_set_visible_rect(GF_DashClient *dash, u32 group_idx, u32 min_x, u32 max_x, u32 min_y, u32 max_y, Bool is_gaze);
 
+/*! sets viewport prediction parameters for tiled groups. The visible rectangle (or gaze position) given by \ref gf_dash_group_set_visible_rect is tracked over time to estimate its motion; tiles not visible but covered by the viewport within the prediction horizon are given an intermediate quality and fetched before hidden tiles. Tile segments already resolved but not yet requested are upgraded when their tile becomes visible; in threaded mode, a tile becoming visible is upgraded before its next segment is downloaded.
+\param dash the target dash client
+\param horizon_ms prediction horizon in milliseconds - if 0, the segment duration of the group is used
+\param margin margin added around the predicted viewport, in percent of the viewport size (or of the SRD reference size for gaze)
+*/
+void gf_dash_set_viewport_prediction(GF_DashClient *dash, u32 horizon_ms, u32 margin);
+
 /*! Ignores xlink on periods if some adaptation sets are specified in the period with xlink
 \param dash the target dash client
 \param ignore_xlink if GF_TRUE? xlinks will be ignored on periods containing both xlinks and adaptation sets
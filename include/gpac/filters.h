@@ -304,6 +304,25 @@ GF_Err gf_fs_set_max_resolution_chain_length(GF_FilterSession *session, u32 max_
 */
 GF_Err gf_fs_set_max_sleep_time(GF_FilterSession *session, u32 max_sleep);
 
+/*! Sets the memory budgets for packets queued in the session. When a budget is exceeded, the payload of packets allocated by the filter core is stored in temporary files upon dispatch, and reloaded when the packet is about to be consumed.
+\param session filter session
+\param pid_budget memory budget in bytes for packets queued on each output PID, 0 for no budget. This can be changed per PID using \ref gf_filter_pid_set_memory_budget
+\param session_cap memory cap in bytes for all packets queued in the session, 0 for no cap
+\return error if any
+*/
+GF_Err gf_fs_set_memory_budget(GF_FilterSession *session, u64 pid_budget, u64 session_cap);
+
+/*! Sets CPU affinity of the session threads, and binds filters to groups of threads.
+Session threads (excluding the main thread) are assigned to the thread groups in round-robin and pinned to the CPUs of their group. Tasks of a filter bound to a group are only executed by threads of that group.
+Since packet memory is allocated and reused by the filter producing the packets, binding filters to a group of CPUs on the same NUMA node keeps their packet memory local to that node.
+This must be called before loading filters and running the session.
+\param session filter session
+\param cpu_groups list of thread groups separated by ':'. Each group is a list of CPU indexes or ranges (e.g. 0-3,8), or \code nodeN \endcode for the CPUs of NUMA node N. The value \code numa \endcode creates one group per NUMA node
+\param filter_bindings list of bindings separated by ',', formatted as \code NAME@GROUP \endcode, where NAME is a filter register name, filter name or ID and GROUP is the 1-based thread group index - may be NULL
+\return error if any
+*/
+GF_Err gf_fs_set_thread_groups(GF_FilterSession *session, const char *cpu_groups, const char *filter_bindings);
+
 /*! gets the maximum filter chain lengtG
 \param session filter session
 \return maximum chain length when resolving filter links.
@@ -322,6 +341,94 @@ void gf_fs_run_step(GF_FilterSession *session);
 */
 GF_Err gf_fs_stop(GF_FilterSession *session);
 
+/*! Filter session group object, hosting several independent filter sessions in a single process*/
+typedef struct __gf_filter_session_group GF_FilterSessionGroup;
+
+/*! Statistics of a session in a filter session group*/
+typedef struct
+{
+	/*! session status: GF_OK while not started or running, GF_EOS or error code once done*/
+	GF_Err status;
+	/*! set to GF_TRUE if the session is started and not yet done*/
+	Bool running;
+	/*! number of times the session was scheduled by the group*/
+	u32 nb_steps;
+	/*! number of tasks executed*/
+	u64 nb_tasks;
+	/*! time in microseconds spent executing tasks of the session*/
+	u64 active_time;
+	/*! time in microseconds since session start, or duration of the session once done*/
+	u64 run_time;
+} GF_FSGroupSessionStats;
+
+/*! Creates a new filter session group.
+
+Sessions of a group are run by a pool of threads shared by all sessions of the group: a thread picks the next session having tasks ready for execution in round-robin, runs all pending tasks of one filter in this session, and moves on to the next session. A session is never run by two threads at the same time, so that a slow or blocked filter only delays its own session.
+
+Sessions of a group share the download manager (and its cache) of the group. Each session uses its own font manager.
+\param nb_threads number of threads in the pool. If -1, uses the number of cores; at least one thread is always created
+
+eturn the new filter session group, or NULL if error
+*/
+GF_FilterSessionGroup *gf_fs_group_new(s32 nb_threads);
+
+/*! Destroys a filter session group, stopping its threads and destroying all its remaining sessions
+\param group filter session group to destroy
+*/
+void gf_fs_group_del(GF_FilterSessionGroup *group);
+
+/*! Creates a new session in a filter session group. The session has no thread of its own and is run by the group once started.
+The session shall not be run using 
+ef gf_fs_run or 
+ef gf_fs_run_step; destroying the session with 
+ef gf_fs_del removes it from the group.
+\param group filter session group
+\param flags set of flags for the session, as used by 
+ef gf_fs_new. The flags 
+ef GF_FS_FLAG_NO_MAIN_THREAD and 
+ef GF_FS_FLAG_NO_REGULATION are always set, the group regulates the sessions
+\param blacklist string containing comma-separated names of filters to disable, as used by 
+ef gf_fs_new
+
+eturn the new filter session, or NULL if error
+*/
+GF_FilterSession *gf_fs_group_new_session(GF_FilterSessionGroup *group, u32 flags, const char *blacklist);
+
+/*! Starts a session of a filter session group, typically once its filters are loaded
+\param session filter session created by 
+ef gf_fs_group_new_session
+
+eturn error if any
+*/
+GF_Err gf_fs_group_start_session(GF_FilterSession *session);
+
+/*! Cancels a session of a filter session group. The cancellation is performed by the group thread running the session, other sessions are not affected.
+\param session filter session created by 
+ef gf_fs_group_new_session
+\param do_flush if GF_TRUE, sources are forced into end of stream and all emitted packets are processed, as done by 
+ef gf_fs_abort. Otherwise pending data is discarded
+
+eturn error if any
+*/
+GF_Err gf_fs_group_cancel_session(GF_FilterSession *session, Bool do_flush);
+
+/*! Waits for a session of a filter session group to be done
+\param group filter session group
+\param session filter session to wait for. If NULL, waits for all started sessions of the group
+
+eturn the last error of the session (or of the first session in error), GF_EOS if done without error
+*/
+GF_Err gf_fs_group_wait(GF_FilterSessionGroup *group, GF_FilterSession *session);
+
+/*! Gets statistics of a session in a filter session group
+\param session filter session created by 
+ef gf_fs_group_new_session
+\param stats filled with the session statistics
+
+eturn error if any
+*/
+GF_Err gf_fs_group_get_session_stats(GF_FilterSession *session, GF_FSGroupSessionStats *stats);
+
 /*! Gets the number of available filter registries (not blacklisted)
 \param session filter session
 \return number of filter registries
@@ -426,6 +533,45 @@ void gf_fs_set_ui_callback(GF_FilterSession *session, Bool (*ui_event_proc)(void
 */
 void gf_fs_print_stats(GF_FilterSession *session);
 
+/*! Enables live metrics collection for the session: packet residence time in PID queues, PID buffer occupancy and blocking time, task time per filter and per thread.
+This must be called before running the session.
+\note If the session has no extra threads, the server is polled by the session thread in between two tasks, so requests are only answered while the session runs tasks. Responses are then sent without blocking, over several polls if needed
+\param session filter session
+\param server_address if not NULL, metrics are served over HTTP in OpenMetrics text format on the given address, formatted as \code [IP:]port \endcode. If no IP is given, the server listens on the loopback interface only
+\return error if any
+*/
+GF_Err gf_fs_enable_metrics(GF_FilterSession *session, const char *server_address);
+
+/*! Gets a snapshot of the session metrics in OpenMetrics text format
+\note If the session has no extra threads, this must be called from the session thread
+\param session filter session
+\param out_text set to the allocated metrics text, to be freed by the caller using gf_free
+\return error if any, GF_NOT_SUPPORTED if metrics are not enabled
+*/
+GF_Err gf_fs_get_metrics(GF_FilterSession *session, char **out_text);
+
+/*! Enables timeline tracing of the session: every task execution (filter, task name, thread, start time, duration and time spent waiting in queue) and packet send/drop events are recorded.
+The trace is written when the session is destroyed, as Chrome trace event JSON or as Perfetto protobuf if the destination extension is .pftrace, .perfetto-trace or .pb.
+This must be called before running the session.
+\param session filter session
+\param dst destination file of the trace
+\param ring_dur_ms if not 0, only the last ring_dur_ms milliseconds of the session are kept
+\return error if any
+*/
+GF_Err gf_fs_enable_trace(GF_FilterSession *session, const char *dst, u32 ring_dur_ms);
+
+/*! Writes the current session trace. This can be called while the session is running, in which case events being recorded during the dump may be missing.
+\param session filter session
+\param dst destination file of the trace, or NULL to use the destination set when enabling the trace
+\return error if any, GF_NOT_SUPPORTED if tracing is not enabled
+*/
+GF_Err gf_fs_dump_trace(GF_FilterSession *session, const char *dst);
+
+/*! Requests the session to dump its trace as soon as possible, to the trace destination with an index appended to the file name (e.g. trace_1.json). This function only sets a flag and can be called from a signal handler.
+\param session filter session
+*/
+void gf_fs_request_trace_dump(GF_FilterSession *session);
+
 /*! Prints connections between loaded filters in the session to logs using \code LOG_APP@LOG_INFO \endcode
 \param session filter session
 */
@@ -1684,6 +1830,20 @@ typedef enum
 	GF_FPROBE_EXT_MATCH,
 } GF_FilterProbeScore;
 
+/*! Data signature identifying a format, see \ref GF_FilterRegister probe_magics*/
+typedef struct
+{
+	/*! byte offset of the signature in the probed data*/
+	u32 offset;
+	/*! size in bytes of the signature, 0 marks the end of a signature list*/
+	u32 size;
+	/*! signature bytes*/
+	const char *data;
+} GF_FilterProbeMagic;
+
+/*! Quick macro for declaring a data signature from a string literal*/
+#define PROBE_MAGIC(_offset, _sig) { _offset, sizeof(_sig)-1, _sig }
+
 /*! Quick macro for assigning the capability arrays to the register structure*/
 #define SETCAPS( __struct ) .caps = __struct, .nb_caps=sizeof(__struct)/sizeof(GF_FilterCapability)
 
@@ -1854,6 +2014,11 @@ struct __gf_filter_register
 	*/
 	const char * (*probe_data)(const u8 *data, u32 size, GF_FilterProbeScore *score);
 
+	/*! optional list of data signatures of the formats handled by \ref probe_data, terminated by an empty signature.
+	When probed data matches the signatures of a single filter, only the probe_data function of this filter is called, unless it does not detect the format.
+	Signatures shall only be declared for formats not handled by other filters.*/
+	const GF_FilterProbeMagic *probe_magics;
+
 	/*! for filters having the same match of input capabilities for a PID, the filter with priority at the lowest value will be used
 	scalable decoders should use high values, so that they are only selected when enhancement layers are present*/
 	u8 priority;
@@ -2768,6 +2933,12 @@ void gf_filter_pid_set_max_buffer(GF_FilterPid *PID, u32 total_duration_us);
 */
 u32 gf_filter_pid_get_max_buffer(GF_FilterPid *PID);
 
+/*! Sets the memory budget of an output PID. Once packets queued on the PID use more memory than the budget, the payload of new packets is stored in temporary files until consumed, see \ref gf_fs_set_memory_budget. Typically used by filters buffering long durations of media
+\param PID the target filter PID
+\param max_bytes memory budget in bytes, 0 to use the session default
+*/
+void gf_filter_pid_set_memory_budget(GF_FilterPid *PID, u64 max_bytes);
+
 /*! Checks if a given filter is in the PID parent chain. This is used to identify sources (rather than checking URL/...)
 \param PID the target filter PID
 \param filter the source filter to check
@@ -2880,6 +3051,10 @@ typedef struct
 	u64 buffer_time;
 	/*! number of units in input buffer of the filter - only set when querying decoder stats*/
 	u32 nb_buffer_units;
+	/*! memory used by packets queued on the PID in bytes, excluding packets spilled to disk*/
+	u64 buffer_mem;
+	/*! size in bytes of packets queued on the PID and spilled to disk*/
+	u64 spill_size;
 } GF_FilterPidStatistics;
 
 /*! Direction for stats querying*/
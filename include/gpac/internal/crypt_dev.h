@@ -50,6 +50,10 @@ struct _gf_crypt_context
 	GF_Err(*_decrypt) (GF_Crypt*, u8 *buffer, u32 size);
 	GF_Err(*_set_state) (GF_Crypt*, const u8 *IV, u32 IV_size);
 	GF_Err(*_get_state) (GF_Crypt*, u8 *IV, u32 *IV_size);
+
+	//buffer gathering the encrypted stripes of subsamples
+	u8 *scratch;
+	u32 scratch_size;
 };
 
 #ifdef GPAC_HAS_SSL
@@ -1719,6 +1719,9 @@ typedef struct
 } GF_SampleDescriptionBox;
 
 
+/*append-only table of delta-coded values, used for sample sizes and chunk offsets of tracks written with packed sample tables*/
+typedef struct __delta_table GF_DeltaTable;
+
 typedef struct
 {
 	GF_ISOM_FULL_BOX
@@ -1727,6 +1730,8 @@ typedef struct
 	u32 sampleCount;
 	u32 alloc_size;
 	u32 *sizes;
+	/*packed sizes in write mode, sizes is NULL when set*/
+	GF_DeltaTable *dtab;
 	//stats for read
 	u32 max_size;
 	u64 total_size;
@@ -1739,6 +1744,8 @@ typedef struct
 	u32 nb_entries;
 	u32 alloc_size;
 	u32 *offsets;
+	/*packed offsets in write mode, offsets is NULL when set*/
+	GF_DeltaTable *dtab;
 } GF_ChunkOffsetBox;
 
 typedef struct
@@ -1747,6 +1754,8 @@ typedef struct
 	u32 nb_entries;
 	u32 alloc_size;
 	u64 *offsets;
+	/*packed offsets in write mode, offsets is NULL when set*/
+	GF_DeltaTable *dtab;
 } GF_ChunkLargeOffsetBox;
 
 typedef struct
@@ -3669,6 +3678,8 @@ typedef struct
 
 GF_Err gf_isom_datamap_new(const char *location, const char *parentPath, u8 mode, GF_DataMap **outDataMap);
 void gf_isom_datamap_del(GF_DataMap *ptr);
+/*updates a gmem:// data map in place with the current blob data, returns GF_NOT_SUPPORTED if map is not a gmem map for this location*/
+GF_Err gf_isom_datamap_refresh_blob(GF_DataMap *map, const char *location);
 GF_Err gf_isom_datamap_open(GF_MediaBox *minf, u32 dataRefIndex, u8 Edit);
 void gf_isom_datamap_close(GF_MediaInformationBox *minf);
 u32 gf_isom_datamap_get_data(GF_DataMap *map, u8 *buffer, u32 bufferLength, u64 Offset);
@@ -3749,6 +3760,8 @@ struct __tag_isom {
 	u8 convert_streaming_text;
 	u8 is_jp2;
 	u8 force_co64;
+	/*sample table mode for new tracks, see GF_ISOSampleTableMode*/
+	u8 stbl_mode;
 	u64 next_flush_chunk_time;
 	Bool keep_utc;
 	/*main boxes for fast access*/
@@ -3916,6 +3929,8 @@ GF_Err stbl_GetSampleDepType(GF_SampleDependencyTypeBox *stbl, u32 SampleNumber,
 
 /*unpack sample2chunk and chunk offset so that we have 1 sample per chunk (edition mode only)*/
 GF_Err stbl_UnpackOffsets(GF_SampleTableBox *stbl);
+/*converts packed sample sizes and chunk offsets to regular tables*/
+GF_Err stbl_UnpackDeltaTables(GF_SampleTableBox *stbl);
 GF_Err stbl_unpackCTS(GF_SampleTableBox *stbl);
 GF_Err SetTrackDuration(GF_TrackBox *trak);
 GF_Err Media_SetDuration(GF_TrackBox *trak);
@@ -3927,6 +3942,17 @@ GF_Err gf_isom_rewrite_text_sample(GF_ISOSample *samp, u32 sampleDescriptionInde
 
 GF_UserDataMap *udta_getEntry(GF_UserDataBox *ptr, u32 box_type, bin128 *uuid);
 
+/*delta tables. Values are appended in blocks coded as varint deltas, only the last value can be modified*/
+GF_DeltaTable *stbl_dtab_new(Bool use_temp_file);
+void stbl_dtab_del(GF_DeltaTable *dtab);
+void stbl_dtab_reset(GF_DeltaTable *dtab);
+u32 stbl_dtab_count(GF_DeltaTable *dtab);
+GF_Err stbl_dtab_add(GF_DeltaTable *dtab, u64 val);
+GF_Err stbl_dtab_get(GF_DeltaTable *dtab, u32 idx, u64 *val);
+void stbl_dtab_set_last(GF_DeltaTable *dtab, u64 val);
+/*checks if all values are the same*/
+Bool stbl_dtab_is_constant(GF_DeltaTable *dtab, u64 *val);
+
 #ifndef GPAC_DISABLE_ISOM_WRITE
 
 GF_Err FlushCaptureMode(GF_ISOFile *movie);
@@ -1893,6 +1893,24 @@ GF_Err gf_isom_set_interleave_time(GF_ISOFile *isom_file, u32 InterleaveTime);
 */
 GF_Err gf_isom_force_64bit_chunk_offset(GF_ISOFile *isom_file, Bool set_on);
 
+/*! sample table memory mode of tracks being written*/
+typedef enum
+{
+	/*! sample tables are regular arrays, with one chunk per sample until the file is stored*/
+	GF_ISOM_STBL_FLAT = 0,
+	/*! sample sizes and chunk offsets are delta-coded in memory and consecutive chunks share their sample to chunk entry. Tables are converted to regular ones upon the first sample update, insertion or removal*/
+	GF_ISOM_STBL_PACKED,
+	/*! same as GF_ISOM_STBL_PACKED, coded tables are stored in temporary files*/
+	GF_ISOM_STBL_PACKED_TMP,
+} GF_ISOSampleTableMode;
+
+/*! sets the memory mode of sample tables for tracks where no sample has been added yet. Packed modes bound the memory used by long recordings
+\param isom_file the target ISO file
+\param stbl_mode the sample table mode to use
+\return error if any
+*/
+GF_Err gf_isom_set_sample_table_mode(GF_ISOFile *isom_file, GF_ISOSampleTableMode stbl_mode);
+
 /*! compression mode of top-level boxes*/
 typedef enum
 {
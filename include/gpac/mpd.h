@@ -152,6 +152,12 @@ typedef struct
 {
 	/*! list of entries*/
 	GF_List *entries;
+	/*! GPAC internal: number of leading segments not loaded by \ref gf_mpd_parse_dom_update*/
+	u32 nb_skipped;
+	/*! GPAC internal: start time of the first segment not loaded*/
+	u64 skipped_start;
+	/*! GPAC internal: end time of the last segment not loaded, start time of the first loaded entry*/
+	u64 skipped_end;
 } GF_MPD_SegmentTimeline;
 
 /*! Byte range info*/
@@ -819,6 +825,26 @@ GF_Err gf_mpd_init_from_dom(GF_XMLNode *root, GF_MPD *mpd, const char *base_url)
 \return error if any
 */
 GF_Err gf_mpd_complete_from_dom(GF_XMLNode *root, GF_MPD *mpd, const char *base_url);
+/*! parses an MPD document and initializes the MPD from it. Segment timeline entries are loaded while parsing the XML document, without creating DOM nodes for them.
+Documents with several root elements, as used for remote periods, are loaded in order: the first root element initializes the MPD as in \ref gf_mpd_init_from_dom and the following ones complete it as in \ref gf_mpd_complete_from_dom
+\param parser the DOM parser to use, the parsed DOM is kept in the parser
+\param file the MPD file to parse
+\param mpd the MPD structure to fill
+\param base_url base URL of the MPD document
+\return error if any
+*/
+GF_Err gf_mpd_parse_dom(GF_DOMParser *parser, const char *file, GF_MPD *mpd, const char *base_url);
+/*! parses an updated MPD document as \ref gf_mpd_parse_dom, skipping already known segments.
+In the period starting at period_start, SegmentTemplate timeline entries ending before skip_end are not loaded; the skipped range is signaled by the nb_skipped, skipped_start and skipped_end fields of the timeline, and the first loaded entry always has an explicit start time
+\param parser the DOM parser to use, the parsed DOM is kept in the parser
+\param file the MPD file to parse
+\param mpd the MPD structure to fill
+\param base_url base URL of the MPD document
+\param period_start start time in milliseconds of the period to update
+\param skip_end time in seconds, relative to the period start, before which segments are not loaded. If 0, all segments are loaded
+\return error if any
+*/
+GF_Err gf_mpd_parse_dom_update(GF_DOMParser *parser, const char *file, GF_MPD *mpd, const char *base_url, u64 period_start, Double skip_end);
 /*! MPD constructor
 \return a new MPD*/
 GF_MPD *gf_mpd_new();
@@ -528,6 +528,12 @@ typedef struct __m2ts_demux_table
 	GF_List *sections;
 	/*! total table size*/
 	u32 table_size;
+	/*! copy of the last section with valid CRC for each section number, used to skip CRC checks of repeated sections*/
+	u8 **section_copies;
+	/*! size of each section copy including CRC, 0 if not received*/
+	u16 *section_sizes;
+	/*! allocated size of each section copy*/
+	u16 *section_allocs;
 } GF_M2TS_Table;
 
 
@@ -536,8 +542,12 @@ typedef struct GF_M2TS_SectionFilter
 {
 	/*! section reassembler*/
 	s16 cc;
-	/*! section buffer (max 4096)*/
+	/*! section buffer (max 4096), NULL if no section is being gathered*/
 	u8 *section;
+	/*! pooled section buffer reused across sections*/
+	u8 *section_buffer;
+	/*! allocated size of the pooled section buffer*/
+	u32 section_alloc;
 	/*! current section length as indicated in section header*/
 	u16 length;
 	/*! number of bytes received from current section*/
@@ -1098,6 +1108,10 @@ struct tag_m2ts_demux
 	if set, on_event shall be non-null
 	*/
 	Bool split_mode;
+
+	/*! optional packet routing callback - if set, each TS packet found by \ref gf_m2ts_process_data is passed to this callback instead of being processed,
+	and the user is responsible for calling \ref gf_m2ts_process_packet on it. The packet data is only valid during the callback*/
+	void (*on_packet)(struct tag_m2ts_demux *ts, u8 *data, u32 pck_number);
 };
 
 //! @endcond
@@ -1134,6 +1148,16 @@ GF_Err gf_m2ts_set_pes_framing(GF_M2TS_PES *pes, GF_M2TSPesFraming mode);
 */
 GF_Err gf_m2ts_process_data(GF_M2TS_Demuxer *demux, u8 *data, u32 data_size);
 
+/*! processes a single TS packet, usually forwarded by the packet routing callback
+Packets of a given PID shall be processed in order. Packets of PES PIDs belonging to different programs may be processed concurrently,
+as long as no other packet is processed at the same time and events are handled in a thread-safe way.
+\param demux the target MPEG-2 TS demultiplexer
+\param data the TS packet to process, starting with the sync byte
+\param pck_number the packet number in the TS
+\return error if any
+*/
+GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *demux, u8 *data, u32 pck_number);
+
 /*! initializes DSM-CC object carousel reception
 \param demux the target MPEG-2 TS demultiplexer
 */
@@ -423,6 +423,17 @@ Sends a buffer on the socket. The socket must be in a bound or connected mode
  */
 GF_Err gf_sk_send(GF_Socket *sock, const u8 *buffer, u32 length);
 /*!
+\brief data emission with partial write report
+
+Sends a buffer on the socket and reports the number of bytes sent, which may be less than the requested length if the socket is in non-blocking mode and would block. The socket must be in a bound or connected mode
+\param sock the socket object
+\param buffer the data buffer to send
+\param length the data length to send
+\param written set to the number of bytes sent, may be NULL
+\return error if any
+ */
+GF_Err gf_sk_send_ex(GF_Socket *sock, const u8 *buffer, u32 length, u32 *written);
+/*!
 \brief data reception
 
 Fetches data on a socket. The socket must be in a bound or connected state
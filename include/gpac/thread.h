@@ -42,7 +42,7 @@ extern "C" {
 This section documents the threading of the GPAC framework. These provide an easy way to implement
 safe multithreaded tools.
 
-Available tools are thread, mutex and semaphore
+Available tools are thread, mutex, semaphore and worker pool
 
 \defgroup thread_grp Thread
 \ingroup thr_grp
@@ -50,6 +50,8 @@ Available tools are thread, mutex and semaphore
 \ingroup thr_grp
 \defgroup sema_grp Semaphore
 \ingroup thr_grp
+\defgroup wpool_grp Worker Pool
+\ingroup thr_grp
 */
 
 /*!
@@ -80,6 +82,8 @@ The thread object allows executing some code independently of the main process o
 #define safe_int64_add(__v, inc_val) InterlockedAdd64((LONG64 *) (__v), inc_val)
 /*! atomic large integer substraction */
 #define safe_int64_sub(__v, dec_val) InterlockedAdd64((LONG64 *) (__v), -dec_val)
+/*! atomic large integer compare and swap, evaluates to non-zero if the value was old_val and is now new_val */
+#define safe_int64_cas(__v, old_val, new_val) (InterlockedCompareExchange64((LONG64 *) (__v), new_val, old_val) == (LONG64) (old_val))
 
 #else
 
@@ -97,6 +101,8 @@ The thread object allows executing some code independently of the main process o
 #define safe_int64_add(__v, inc_val) __atomic_add_fetch((int64_t *) (__v), inc_val, __ATOMIC_SEQ_CST)
 /*! atomic large integer substraction */
 #define safe_int64_sub(__v, dec_val) __atomic_sub_fetch((int64_t *) (__v), dec_val, __ATOMIC_SEQ_CST)
+/*! atomic large integer compare and swap, evaluates to non-zero if the value was old_val and is now new_val */
+#define safe_int64_cas(__v, old_val, new_val) ({ int64_t __old = (old_val); __atomic_compare_exchange_n((int64_t *) (__v), &__old, new_val, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); })
 
 #else
 
@@ -112,6 +118,8 @@ The thread object allows executing some code independently of the main process o
 #define safe_int64_add(__v, inc_val) __sync_add_and_fetch((int64_t *) (__v), inc_val)
 /*! atomic large integer substraction */
 #define safe_int64_sub(__v, dec_val) __sync_sub_and_fetch((int64_t *) (__v), dec_val)
+/*! atomic large integer compare and swap, evaluates to non-zero if the value was old_val and is now new_val */
+#define safe_int64_cas(__v, old_val, new_val) __sync_bool_compare_and_swap((int64_t *) (__v), old_val, new_val)
 
 #endif //GPAC_NEED_LIBATOMIC
 
@@ -222,6 +230,17 @@ Sets the thread execution priority level.
 \note this should be used with caution, especially use of real-time priorities.
  */
 void gf_th_set_priority(GF_Thread *th, s32 priority);
+
+/*!
+\brief thread CPU affinity
+
+Restricts the CPUs a thread may run on. This is currently only supported on Windows (first 64 CPUs) and Linux.
+\param th the thread object, or NULL for the calling thread
+\param cpus list of CPU indexes, starting from 0
+\param nb_cpus number of CPUs in the list
+\return error if any, GF_NOT_SUPPORTED if not supported on the platform
+ */
+GF_Err gf_th_set_cpu_affinity(GF_Thread *th, const u32 *cpus, u32 nb_cpus);
 /*!
 \brief current thread ID
 
@@ -368,6 +387,69 @@ Waits for a certain for the semaphore to be accessible, and returns when semapho
 Bool gf_sema_wait_for(GF_Semaphore *sm, u32 time_out);
 
 
+/*! @} */
+
+/*!
+\addtogroup wpool_grp
+\brief Worker Pool
+
+The worker pool object runs a set of independent tasks on the calling thread and a fixed number of extra threads, typically to split a frame or a batch of packets processed by a filter.
+Tasks are picked by the threads in order until none is left, so that faster threads process more tasks.
+
+@{
+*/
+
+/*!
+\brief abstracted worker pool object
+*/
+typedef struct __tag_worker_pool GF_WorkerPool;
+
+/*! help text for filter options setting the number of extra threads of a worker pool, to append to the option description*/
+#define GF_WORKER_POOL_NBTH_HELP	"-1 uses the session extra thread count if set (see -threads), or the number of cores minus one otherwise"
+
+/*!
+\brief worker pool task callback
+
+\param udta user data passed to \ref gf_worker_pool_run
+\param worker_idx index of the thread running the task, 0 being the calling thread and 1 to N the extra threads of the pool
+\param task_idx index of the task to run
+*/
+typedef void (*gf_worker_task)(void *udta, u32 worker_idx, u32 task_idx);
+
+/*!
+\brief worker pool constructor
+
+Constructs a new worker pool
+\param nb_threads number of extra threads. If negative, the session thread count (-threads option) is used, or the number of cores minus one if not set
+\param name log name of the pool threads
+\return new worker pool object, or NULL if error. A pool with no extra threads is valid and runs all tasks on the calling thread
+ */
+GF_WorkerPool *gf_worker_pool_new(s32 nb_threads, const char *name);
+/*!
+\brief worker pool destructor
+
+Stops the threads of the pool and destroys the object
+\param pool the worker pool object
+ */
+void gf_worker_pool_del(GF_WorkerPool *pool);
+/*!
+\brief worker pool thread count
+
+\param pool the worker pool object
+\return the number of extra threads of the pool
+ */
+u32 gf_worker_pool_get_thread_count(GF_WorkerPool *pool);
+/*!
+\brief worker pool run
+
+Runs a set of tasks on the calling thread and the pool threads, and returns once all tasks are done. Each task is run once by a single thread.
+\param pool the worker pool object
+\param nb_tasks number of tasks to run
+\param task the task callback function
+\param udta user data passed to the task callback
+ */
+void gf_worker_pool_run(GF_WorkerPool *pool, u32 nb_tasks, gf_worker_task task, void *udta);
+
 /*! @} */
 
 #ifdef __cplusplus
@@ -82,6 +82,13 @@ Macro formating a 4-character code (or 4CC) "abcd" as 0xAABBCCDD
 */
 const char *gf_4cc_to_str(u32 type);
 
+/*! converts four character code to string in the given buffer, safe to use from several threads
+\param type a four character code
+\param szType buffer receiving the printable form of the code
+\return szType
+*/
+const char *gf_4cc_to_str_safe(u32 type, char szType[GF_4CC_MSIZE]);
+
 /*! @} */
 
 /*!
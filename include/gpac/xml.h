@@ -272,6 +272,24 @@ GF_Err gf_xml_dom_parse(GF_DOMParser *parser, const char *file, gf_xml_sax_progr
 \return error code if any
 */
 GF_Err gf_xml_dom_parse_string(GF_DOMParser *parser, char *string);
+
+/*! DOM element filter callback, called before creating a DOM element
+\param cbk opaque user data
+\param parent the parent element in the DOM being built, NULL for a root element
+\param name the element name
+\param ns the element namespace prefix, or NULL
+\param attributes the element attributes, only valid during the callback
+\param nb_attributes the number of attributes
+\return GF_TRUE if the element is handled by the caller, in which case neither the element nor its children are added to the DOM
+*/
+typedef Bool (*gf_xml_dom_node_filter)(void *cbk, GF_XMLNode *parent, const char *name, const char *ns, const GF_XMLAttribute *attributes, u32 nb_attributes);
+
+/*! Sets the element filter of a DOM parser. This allows loading large repetitive elements directly from the parsed data without building DOM nodes. Blank text between filtered elements is not added to the DOM.
+\param parser the DOM parser to use
+\param on_filter the filter callback, NULL to disable filtering
+\param cbk opaque user data passed to the callback
+*/
+void gf_xml_dom_set_node_filter(GF_DOMParser *parser, gf_xml_dom_node_filter on_filter, void *cbk);
 /*! Gets the last error that happened during the parsing. The parser aborts at the first error found within a SAX callback
 \param parser the DOM parser to use
 \return last error code if any
@@ -52,6 +52,7 @@ void gf_crypt_close(GF_Crypt *td)
 {
 	if (!td) return;
 	td->_deinit_crypt(td);
+	if (td->scratch) gf_free(td->scratch);
 	gf_free(td->context);
 	gf_free(td);
 }
@@ -103,3 +104,139 @@ GF_Err gf_crypt_decrypt(GF_Crypt *td, void *ciphertext, u32 len)
 	if (!len) return GF_OK;
 	return td->_decrypt(td, ciphertext, len);
 }
+
+static GF_Err gf_crypt_process_pattern(GF_Crypt *td, u8 *data, u32 len, u32 crypt_block, u32 skip_block, Bool is_decrypt)
+{
+	u32 crypt_size, pattern_size;
+	GF_Err(*process) (GF_Crypt *ctx, u8 *buffer, u32 size);
+
+	if (!td) return GF_BAD_PARAM;
+	if (!len) return GF_OK;
+	process = is_decrypt ? td->_decrypt : td->_crypt;
+	if (!crypt_block || !skip_block)
+		return process(td, data, len);
+
+	crypt_size = 16 * crypt_block;
+	pattern_size = 16 * (crypt_block + skip_block);
+	while (len) {
+		GF_Err e = process(td, data, (len >= crypt_size) ? crypt_size : len);
+		if (e) return e;
+		if (len < pattern_size) break;
+		data += pattern_size;
+		len -= pattern_size;
+	}
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_Err gf_crypt_encrypt_pattern(GF_Crypt *td, void *plaintext, u32 len, u32 crypt_block, u32 skip_block)
+{
+	return gf_crypt_process_pattern(td, (u8 *) plaintext, len, crypt_block, skip_block, GF_FALSE);
+}
+
+GF_EXPORT
+GF_Err gf_crypt_decrypt_pattern(GF_Crypt *td, void *ciphertext, u32 len, u32 crypt_block, u32 skip_block)
+{
+	return gf_crypt_process_pattern(td, (u8 *) ciphertext, len, crypt_block, skip_block, GF_TRUE);
+}
+
+//copies the encrypted stripes of a subsample to the scratch buffer, or back to the subsample if scatter is set
+//returns the number of bytes copied; in CBC mode, the trailing bytes of the last stripe that do not form a full block are not copied and their size is returned in tail
+static u32 gf_crypt_copy_stripes(u8 *data, u32 len, u8 *scratch, u32 crypt_block, u32 skip_block, Bool is_cbc, Bool scatter, u32 *tail)
+{
+	u32 done = 0;
+	u32 crypt_size = len;
+	u32 pattern_size = len;
+	*tail = 0;
+	if (crypt_block && skip_block) {
+		crypt_size = 16 * crypt_block;
+		pattern_size = 16 * (crypt_block + skip_block);
+	}
+	while (len) {
+		u32 size = (len >= crypt_size) ? crypt_size : len;
+		if (is_cbc) {
+			*tail = size % 16;
+			size -= *tail;
+		}
+		if (scatter) memcpy(data, scratch + done, size);
+		else memcpy(scratch + done, data, size);
+		done += size;
+		if (len < pattern_size) break;
+		data += pattern_size;
+		len -= pattern_size;
+	}
+	return done;
+}
+
+static GF_Err gf_crypt_process_subsamples(GF_Crypt *td, u8 *data, u32 len, const GF_CryptSubsample *subs, u32 nb_subs, u32 crypt_block, u32 skip_block, const u8 *IV, u32 IV_size, Bool is_decrypt)
+{
+	u32 i, pos;
+	Bool is_cbc;
+	GF_Err(*process) (GF_Crypt *ctx, u8 *buffer, u32 size);
+
+	if (!td || (nb_subs && !subs)) return GF_BAD_PARAM;
+	pos = 0;
+	for (i=0; i<nb_subs; i++) {
+		if ((u64) pos + subs[i].clear_bytes + subs[i].crypt_bytes > len) return GF_BAD_PARAM;
+		pos += subs[i].clear_bytes + subs[i].crypt_bytes;
+	}
+	if (td->scratch_size < pos) {
+		u8 *scratch = gf_realloc(td->scratch, pos);
+		if (!scratch) return GF_OUT_OF_MEM;
+		td->scratch = scratch;
+		td->scratch_size = pos;
+	}
+	process = is_decrypt ? td->_decrypt : td->_crypt;
+	is_cbc = (td->mode==GF_CBC) ? GF_TRUE : GF_FALSE;
+
+	i = 0;
+	pos = 0;
+	while (i<nb_subs) {
+		GF_Err e;
+		u32 first = i, run_pos = pos, run_size = 0, tail = 0;
+
+		if (IV) {
+			e = td->_set_state(td, IV, IV_size);
+			if (e) return e;
+		}
+		//gather all stripes sharing the same chaining state: the run ends with the subsample when the IV is reset,
+		//or when a partial CBC block has to be processed after the gathered blocks
+		while (i<nb_subs) {
+			pos += subs[i].clear_bytes;
+			run_size += gf_crypt_copy_stripes(data + pos, subs[i].crypt_bytes, td->scratch + run_size, crypt_block, skip_block, is_cbc, GF_FALSE, &tail);
+			pos += subs[i].crypt_bytes;
+			i++;
+			if (IV || tail) break;
+		}
+		if (!run_size && !tail) continue;
+
+		if (run_size) {
+			e = process(td, td->scratch, run_size);
+			if (e) return e;
+			run_size = 0;
+			pos = run_pos;
+			for (; first<i; first++) {
+				pos += subs[first].clear_bytes;
+				run_size += gf_crypt_copy_stripes(data + pos, subs[first].crypt_bytes, td->scratch + run_size, crypt_block, skip_block, is_cbc, GF_TRUE, &tail);
+				pos += subs[first].crypt_bytes;
+			}
+		}
+		if (tail) {
+			e = process(td, data + pos - tail, tail);
+			if (e) return e;
+		}
+	}
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_Err gf_crypt_encrypt_subsamples(GF_Crypt *td, void *plaintext, u32 len, const GF_CryptSubsample *subs, u32 nb_subs, u32 crypt_block, u32 skip_block, const u8 *IV, u32 IV_size)
+{
+	return gf_crypt_process_subsamples(td, (u8 *) plaintext, len, subs, nb_subs, crypt_block, skip_block, IV, IV_size, GF_FALSE);
+}
+
+GF_EXPORT
+GF_Err gf_crypt_decrypt_subsamples(GF_Crypt *td, void *ciphertext, u32 len, const GF_CryptSubsample *subs, u32 nb_subs, u32 crypt_block, u32 skip_block, const u8 *IV, u32 IV_size)
+{
+	return gf_crypt_process_subsamples(td, (u8 *) ciphertext, len, subs, nb_subs, crypt_block, skip_block, IV, IV_size, GF_TRUE);
+}
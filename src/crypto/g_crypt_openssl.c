@@ -27,12 +27,18 @@
 
 #ifdef GPAC_HAS_SSL
 #include <openssl/aes.h>
-#include <openssl/modes.h>
+#include <openssl/evp.h>
 
 #include <math.h>
 
+/*all ciphering goes through the EVP interface, which uses AES-NI / ARMv8 crypto extensions when available
+(the legacy AES_KEY block API is never hardware accelerated)*/
+
+/*number of counter blocks ciphered at once in CTR mode*/
+#define OPENSSL_CTR_BATCH_BLOCKS	64
+
 typedef struct {
-	AES_KEY enc_key, dec_key;
+	EVP_CIPHER_CTX *enc_ctx, *dec_ctx;
 
 	u8 block[AES_BLOCK_SIZE];
 	u8 padded_input[AES_BLOCK_SIZE]; // use only when the input length is inferior to the algo block size
@@ -49,7 +55,10 @@ GF_Err gf_crypt_init_openssl_cbc(GF_Crypt* td, void *key, const void *iv)
 		if (ctx == NULL) return GF_OUT_OF_MEM;
 		td->context = ctx;
 	}
-	
+	if (!ctx->enc_ctx) ctx->enc_ctx = EVP_CIPHER_CTX_new();
+	if (!ctx->dec_ctx) ctx->dec_ctx = EVP_CIPHER_CTX_new();
+	if (!ctx->enc_ctx || !ctx->dec_ctx) return GF_OUT_OF_MEM;
+
 	if (iv != NULL) {
 		memcpy(ctx->previous_ciphertext, iv, AES_BLOCK_SIZE);
 	}
@@ -58,19 +67,32 @@ GF_Err gf_crypt_init_openssl_cbc(GF_Crypt* td, void *key, const void *iv)
 
 void gf_crypt_deinit_openssl_cbc(GF_Crypt* td)
 {
+	Openssl_ctx_cbc* ctx = (Openssl_ctx_cbc*)td->context;
+	if (!ctx) return;
+	if (ctx->enc_ctx) EVP_CIPHER_CTX_free(ctx->enc_ctx);
+	if (ctx->dec_ctx) EVP_CIPHER_CTX_free(ctx->dec_ctx);
+	ctx->enc_ctx = ctx->dec_ctx = NULL;
 }
 
 void gf_set_key_openssl_cbc(GF_Crypt* td, void *key)
 {
 	Openssl_ctx_cbc* ctx = (Openssl_ctx_cbc*)td->context;
-	AES_set_encrypt_key(key, 128, &(ctx->enc_key));
-	AES_set_decrypt_key(key, 128, &(ctx->dec_key));
+	//key change does not touch the current IV
+	EVP_EncryptInit_ex(ctx->enc_ctx, EVP_aes_128_cbc(), NULL, key, ctx->previous_ciphertext);
+	EVP_CIPHER_CTX_set_padding(ctx->enc_ctx, 0);
+	EVP_DecryptInit_ex(ctx->dec_ctx, EVP_aes_128_cbc(), NULL, key, ctx->previous_ciphertext);
+	EVP_CIPHER_CTX_set_padding(ctx->dec_ctx, 0);
 }
 
 GF_Err gf_crypt_set_IV_openssl_cbc(GF_Crypt* td, const u8 *iv, u32 iv_size)
 {
 	Openssl_ctx_cbc* ctx = (Openssl_ctx_cbc*)td->context;
+	if (iv_size>AES_BLOCK_SIZE) return GF_BAD_PARAM;
 	memcpy(ctx->previous_ciphertext, iv, iv_size);
+	if (!EVP_CipherInit_ex(ctx->enc_ctx, NULL, NULL, NULL, ctx->previous_ciphertext, 1))
+		return GF_IO_ERR;
+	if (!EVP_CipherInit_ex(ctx->dec_ctx, NULL, NULL, NULL, ctx->previous_ciphertext, 0))
+		return GF_IO_ERR;
 	return GF_OK;
 }
 
@@ -82,42 +104,54 @@ GF_Err gf_crypt_get_IV_openssl_cbc(GF_Crypt* td, u8 *iv, u32 *iv_size)
 	return GF_OK;
 }
 
-GF_Err gf_crypt_crypt_openssl_cbc(GF_Crypt* td, u8 *plaintext, u32 len, u32 aes_crypt_type) {
+GF_Err gf_crypt_crypt_openssl_cbc(GF_Crypt* td, u8 *plaintext, u32 len, Bool is_encrypt)
+{
 	Openssl_ctx_cbc* ctx = (Openssl_ctx_cbc*)td->context;
-	u32 iteration;
-	AES_KEY *key = aes_crypt_type ? &ctx->enc_key : &ctx->dec_key;
-	u32 numberOfIterations = len / AES_BLOCK_SIZE;
-	if (numberOfIterations * AES_BLOCK_SIZE < len) numberOfIterations++;
-
-	for (iteration = 0; iteration < numberOfIterations; ++iteration) {
-		if (len - iteration*AES_BLOCK_SIZE < AES_BLOCK_SIZE) {
-			memset(ctx->padded_input, 0, AES_BLOCK_SIZE);
-			memcpy(ctx->padded_input, plaintext, len - iteration*AES_BLOCK_SIZE);
-			AES_cbc_encrypt(plaintext + iteration*AES_BLOCK_SIZE, ctx->block, AES_BLOCK_SIZE, key, ctx->previous_ciphertext, aes_crypt_type);
-			memcpy(plaintext + iteration*AES_BLOCK_SIZE, ctx->block, len - iteration*AES_BLOCK_SIZE);
-		} else {
-			AES_cbc_encrypt(plaintext + iteration*AES_BLOCK_SIZE, plaintext + iteration*AES_BLOCK_SIZE, AES_BLOCK_SIZE, key, ctx->previous_ciphertext, aes_crypt_type);
-		}
+	EVP_CIPHER_CTX *evp = is_encrypt ? ctx->enc_ctx : ctx->dec_ctx;
+	u32 remain = len % AES_BLOCK_SIZE;
+	u32 full_len = len - remain;
+	int out_len;
+
+	//process all full blocks in a single call, the EVP context carries the chaining state
+	if (full_len) {
+		//inplace decryption, backup last ciphertext block before it is overwritten
+		if (!is_encrypt)
+			memcpy(ctx->previous_ciphertext, plaintext + full_len - AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+		if (!EVP_CipherUpdate(evp, plaintext, &out_len, plaintext, full_len))
+			return GF_IO_ERR;
+		if (is_encrypt)
+			memcpy(ctx->previous_ciphertext, plaintext + full_len - AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+	}
+	if (remain) {
+		memset(ctx->padded_input, 0, AES_BLOCK_SIZE);
+		memcpy(ctx->padded_input, plaintext + full_len, remain);
+		if (!EVP_CipherUpdate(evp, ctx->block, &out_len, ctx->padded_input, AES_BLOCK_SIZE))
+			return GF_IO_ERR;
+		memcpy(ctx->previous_ciphertext, is_encrypt ? ctx->block : ctx->padded_input, AES_BLOCK_SIZE);
+		memcpy(plaintext + full_len, ctx->block, remain);
 	}
 	return GF_OK;
 }
 
 GF_Err gf_crypt_encrypt_openssl_cbc(GF_Crypt* td, u8 *plaintext, u32 len)
 {
-	return gf_crypt_crypt_openssl_cbc(td, plaintext, len, AES_ENCRYPT);
+	return gf_crypt_crypt_openssl_cbc(td, plaintext, len, GF_TRUE);
 }
 
 GF_Err gf_crypt_decrypt_openssl_cbc(GF_Crypt* td, u8 *ciphertext, u32 len)
 {
-	return gf_crypt_crypt_openssl_cbc(td, ciphertext, len, AES_DECRYPT);
+	return gf_crypt_crypt_openssl_cbc(td, ciphertext, len, GF_FALSE);
 }
 
 typedef struct {
-	AES_KEY key;
+	//ECB context used to cipher counter blocks
+	EVP_CIPHER_CTX *ecb_ctx;
 
 	u8 cyphered_iv[16];
 	u8 iv[16];
 	unsigned int c_counter_pos;
+
+	u8 keystream[OPENSSL_CTR_BATCH_BLOCKS*AES_BLOCK_SIZE];
 } Openssl_ctx_ctr;
 
 
@@ -126,7 +160,8 @@ typedef struct {
 void gf_set_key_openssl_ctr(GF_Crypt* td, void *key)
 {
 	Openssl_ctx_ctr* ctx = (Openssl_ctx_ctr*)td->context;
-	AES_set_encrypt_key(key, 128, &(ctx->key));
+	EVP_EncryptInit_ex(ctx->ecb_ctx, EVP_aes_128_ecb(), NULL, key, NULL);
+	EVP_CIPHER_CTX_set_padding(ctx->ecb_ctx, 0);
 }
 
 GF_Err gf_crypt_set_IV_openssl_ctr(GF_Crypt* td, const u8 *iv, u32 iv_size)
@@ -159,6 +194,9 @@ GF_Err gf_crypt_init_openssl_ctr(GF_Crypt* td, void *key, const void *iv)
 
 		td->context = ctx;
 	}
+	if (!ctx->ecb_ctx) ctx->ecb_ctx = EVP_CIPHER_CTX_new();
+	if (!ctx->ecb_ctx) return GF_OUT_OF_MEM;
+
 	ctx->c_counter_pos = 0;
 	if (iv != NULL) {
 		memcpy(ctx->iv, &((u8*)iv)[0], AES_BLOCK_SIZE);
@@ -169,14 +207,64 @@ GF_Err gf_crypt_init_openssl_ctr(GF_Crypt* td, void *key, const void *iv)
 
 void gf_crypt_deinit_openssl_ctr(GF_Crypt* td)
 {
+	Openssl_ctx_ctr* ctx = (Openssl_ctx_ctr*)td->context;
+	if (!ctx) return;
+	if (ctx->ecb_ctx) EVP_CIPHER_CTX_free(ctx->ecb_ctx);
+	ctx->ecb_ctx = NULL;
+}
+
+//128-bit big endian counter increment, as done by openSSL CRYPTO_ctr128_encrypt
+static GFINLINE void ctr128_inc(u8 *counter)
+{
+	u32 n = 16;
+	do {
+		--n;
+		counter[n]++;
+		if (counter[n]) return;
+	} while (n);
 }
 
 GF_Err gf_crypt_crypt_openssl_ctr(GF_Crypt* td, u8 *plaintext, u32 len)
 {
 	Openssl_ctx_ctr* ctx = (Openssl_ctx_ctr*)td->context;
 
-	CRYPTO_ctr128_encrypt(plaintext, plaintext, len, &ctx->key, ctx->iv, ctx->cyphered_iv, &ctx->c_counter_pos, (block128_f)AES_encrypt);
+	//consume remaining bytes of the current key stream block
+	while (ctx->c_counter_pos && len) {
+		*plaintext ^= ctx->cyphered_iv[ctx->c_counter_pos];
+		plaintext++;
+		len--;
+		ctx->c_counter_pos = (ctx->c_counter_pos + 1) % AES_BLOCK_SIZE;
+	}
+
+	//cipher counter blocks by batches so that the EVP implementation can pipeline them
+	while (len) {
+		u32 i, nb_blocks, done;
+		int out_len;
+		u8 *ks = ctx->keystream;
 
+		nb_blocks = (len + AES_BLOCK_SIZE - 1) / AES_BLOCK_SIZE;
+		if (nb_blocks > OPENSSL_CTR_BATCH_BLOCKS) nb_blocks = OPENSSL_CTR_BATCH_BLOCKS;
+
+		for (i=0; i<nb_blocks; i++) {
+			memcpy(ks + i*AES_BLOCK_SIZE, ctx->iv, AES_BLOCK_SIZE);
+			ctr128_inc(ctx->iv);
+		}
+		if (!EVP_EncryptUpdate(ctx->ecb_ctx, ks, &out_len, ks, nb_blocks*AES_BLOCK_SIZE))
+			return GF_IO_ERR;
+
+		done = nb_blocks*AES_BLOCK_SIZE;
+		if (done > len) done = len;
+		for (i=0; i<done; i++)
+			plaintext[i] ^= ks[i];
+
+		//last block partially used, keep it for next call
+		if (done % AES_BLOCK_SIZE) {
+			memcpy(ctx->cyphered_iv, ks + (nb_blocks-1)*AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+			ctx->c_counter_pos = done % AES_BLOCK_SIZE;
+		}
+		plaintext += done;
+		len -= done;
+	}
 	return GF_OK;
 }
 
@@ -190,7 +278,6 @@ GF_Err gf_crypt_decrypt_openssl_ctr(GF_Crypt* td, u8 *ciphertext, u32 len)
 	return gf_crypt_crypt_openssl_ctr(td, ciphertext, len);
 }
 
-
 GF_Err gf_crypt_open_open_openssl(GF_Crypt* td, GF_CRYPTO_MODE mode)
 {
 	td->mode = mode;
@@ -86,6 +86,7 @@
 
 #pragma comment (linker, EXPORT_SYMBOL(gf_get_default_cache_directory) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_4cc_to_str) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_4cc_to_str_safe) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_error_to_string) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_rand_init) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_rand) )
@@ -260,6 +261,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_th_stop) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_th_status) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_th_set_priority) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_th_set_cpu_affinity) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_th_id) )
 
 /* Lock */
@@ -964,6 +966,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_storage_mode) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_enable_compression) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_force_64bit_chunk_offset) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_sample_table_mode) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_interleave_time) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_copyright) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_media_type) )
@@ -2011,6 +2014,8 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_mpd_resolve_segment_duration) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_mpd_init_smooth_from_dom) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_mpd_complete_from_dom) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mpd_parse_dom) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mpd_parse_dom_update) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_mpd_get_segment_start_time_with_timescale) )
 
 
@@ -2282,6 +2287,11 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_fs_load_filter) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_fs_run) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_fs_print_stats) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_fs_enable_metrics) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_fs_get_metrics) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_fs_enable_trace) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_fs_dump_trace) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_fs_request_trace_dump) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_fs_print_connections) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_fs_set_separators) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_props_get_type_name) )
@@ -2301,6 +2311,13 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_fs_post_user_task ) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_fs_abort ) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_fs_is_last_task ) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_fs_group_new ) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_fs_group_del ) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_fs_group_new_session ) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_fs_group_start_session ) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_fs_group_cancel_session ) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_fs_group_wait ) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_fs_group_get_session_stats ) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_filter_set_source ) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_fs_print_all_connections ) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_fs_check_filter_register_cap ) )
@@ -2311,6 +2328,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_filter_is_alias ) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_filter_in_parent_chain ) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_fs_set_max_resolution_chain_length ) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_fs_set_thread_groups) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_fs_get_max_resolution_chain_length ) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_fs_get_last_connect_error ) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_fs_get_last_process_error ) )
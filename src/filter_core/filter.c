@@ -320,6 +320,9 @@ GF_Err gf_filter_new_finalize(GF_Filter *filter, const char *args, GF_FilterArgT
 		}
 	}
 
+	if (filter->session->th_bind)
+		gf_fs_filter_bind_thread_group(filter);
+
 #ifdef GPAC_HAS_QJS
 	jsfs_on_filter_created(filter);
 #endif
@@ -1106,6 +1109,7 @@ static void filter_parse_dyn_args(GF_Filter *filter, const char *args, GF_Filter
 						|| !strncmp(args+4, "gmem://", 7)
 						|| !strncmp(args+4, "gpac://", 7)
 						|| !strncmp(args+4, "pipe://", 7)
+						|| !strncmp(args+4, "shm://", 6)
 						|| !strncmp(args+4, "tcp://", 6)
 						|| !strncmp(args+4, "udp://", 6)
 						|| !strncmp(args+4, "tcpu://", 7)
@@ -3158,6 +3162,27 @@ Bool gf_filter_block_enabled(GF_Filter *filter)
 	return (filter->session->blocking_mode==GF_FS_NOBLOCK) ? GF_FALSE : GF_TRUE;
 }
 
+static Bool gf_filter_reg_has_input_ext(const GF_FilterRegister *freg, const char *ext, u32 ext_len)
+{
+	u32 k;
+	for (k=0; k<freg->nb_caps; k++) {
+		const char *value;
+		const GF_FilterCapability *cap = &freg->caps[k];
+		if (!(cap->flags & GF_CAPFLAG_IN_BUNDLE)) continue;
+		if (!(cap->flags & GF_CAPFLAG_INPUT)) continue;
+		if (cap->code != GF_PROP_PID_FILE_EXT) continue;
+		value = cap->val.value.string;
+		while (value) {
+			const char *match = strstr(value, ext);
+			if (!match) break;
+			if (!match[ext_len] || (match[ext_len]=='|'))
+				return GF_TRUE;
+			value = match+ext_len;
+		}
+	}
+	return GF_FALSE;
+}
+
 GF_EXPORT
 GF_Err gf_filter_pid_raw_new(GF_Filter *filter, const char *url, const char *local_file, const char *mime_type, const char *fext, u8 *probe_data, u32 probe_size, Bool trust_mime, GF_FilterPid **out_pid)
 {
@@ -3226,8 +3251,32 @@ GF_Err gf_filter_pid_raw_new(GF_Filter *filter, const char *url, const char *loc
 		u32 i, count;
 		GF_FilterProbeScore score, max_score = GF_FPROBE_NOT_SUPPORTED;
 		const char *probe_mime = NULL;
+		const GF_FilterRegister *magic_freg;
 		gf_mx_p(filter->session->filters_mx);
 		count = gf_list_count(filter->session->registry);
+
+		//data signature claimed by a single filter also claiming the extension if any, only probe with this filter
+		magic_freg = gf_fs_probe_magic_match(filter->session, probe_data, probe_size);
+		if (magic_freg && (!ext_len || gf_filter_reg_has_input_ext(magic_freg, tmp_ext, ext_len))) {
+			const char *a_mime;
+			score = GF_FPROBE_NOT_SUPPORTED;
+			a_mime = magic_freg->probe_data(probe_data, probe_size, &score);
+			if (a_mime && ((score==GF_FPROBE_SUPPORTED) || (score==GF_FPROBE_FORCE))) {
+				GF_LOG(GF_LOG_INFO, GF_LOG_FILTER, ("Data Prober (filter %s) detected format is mime %s\n", magic_freg->name, a_mime));
+				probe_mime = a_mime;
+				//other filters are assumed not to support the data
+				for (i=0; i<count && ext_len; i++) {
+					const GF_FilterRegister *freg = gf_list_get(filter->session->registry, i);
+					if (!freg || !freg->probe_data || (freg==magic_freg)) continue;
+					if (gf_filter_reg_has_input_ext(freg, tmp_ext, ext_len)) {
+						ext_not_trusted = GF_TRUE;
+						break;
+					}
+				}
+				count = 0;
+			}
+		}
+
 		for (i=0; i<count; i++) {
 			const char *a_mime;
 			const GF_FilterRegister *freg = gf_list_get(filter->session->registry, i);
@@ -3235,24 +3284,8 @@ GF_Err gf_filter_pid_raw_new(GF_Filter *filter, const char *url, const char *loc
 			score = GF_FPROBE_NOT_SUPPORTED;
 			a_mime = freg->probe_data(probe_data, probe_size, &score);
 			if (score==GF_FPROBE_NOT_SUPPORTED) {
-				u32 k;
-				for (k=0;k<freg->nb_caps && !ext_not_trusted && ext_len; k++) {
-					const char *value;
-					const GF_FilterCapability *cap = &freg->caps[k];
-					if (!(cap->flags & GF_CAPFLAG_IN_BUNDLE)) continue;
-					if (!(cap->flags & GF_CAPFLAG_INPUT)) continue;
-					if (cap->code != GF_PROP_PID_FILE_EXT) continue;
-					value = cap->val.value.string;
-					while (value && ext_len) {
-						const char *match = strstr(value, tmp_ext);
-						if (!match) break;
-						if (!match[ext_len] || (match[ext_len]=='|')) {
-							ext_not_trusted = GF_TRUE;
-							break;
-						}
-						value = match+ext_len;
-					}
-				}
+				if (!ext_not_trusted && ext_len && gf_filter_reg_has_input_ext(freg, tmp_ext, ext_len))
+					ext_not_trusted = GF_TRUE;
 			} else if (score==GF_FPROBE_EXT_MATCH) {
 				if (a_mime && ext_len && strstr(a_mime, tmp_ext)) {
 					ext_not_trusted = GF_FALSE;
@@ -0,0 +1,570 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2020
+ *					All rights reserved
+ *
+ *  This file is part of GPAC / filters sub-project
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include "filter_session.h"
+#include <gpac/bitstream.h>
+#include <gpac/version.h>
+
+/*
+Persistent cache of the filter graph.
+
+The cache file stores the edges of the filter registry graph (cf gf_filter_sess_build_graph) and the filter chains
+resolved by gf_filter_pid_resolve_link_dijkstra, so that a new session can skip graph construction and link resolution.
+
+The file is tagged with a CRC of the registry (filter names, flags and capabilities, GPAC version), and is ignored
+when the registry of the session does not match. Filters are referred to by their index in the registry.
+
+A resolved chain only depends on:
+- the source filter register and the PID properties checked by the registry capabilities,
+- the destination filter register and its state (instance caps, bundle used at resolution, encoder type, explicit destination),
+- the preferred registers, blacklists, reconfigurable flag and maximum chain length.
+The chain key is built from these values.
+
+If the registry is modified after session setup (custom filter registers), the cache is disabled for the session.
+*/
+
+#define GF_FS_GCACHE_MAGIC	GF_4CC('G','F','G','C')
+#define GF_FS_GCACHE_VERSION	1
+
+typedef struct
+{
+	const GF_FilterRegister *freg;
+	u32 cap_idx;
+} GF_FSCachedChainEntry;
+
+typedef struct
+{
+	u32 crc;
+	char *key;
+	u32 nb_entries;
+	GF_FSCachedChainEntry *entries;
+} GF_FSCachedChain;
+
+struct __gf_fs_graph_cache
+{
+	char *path;
+	//CRC of the registry at session setup
+	u32 reg_crc;
+	GF_List *chains;
+	//distinct property codes and names used by registry caps
+	u32 *codes;
+	u32 nb_codes;
+	GF_List *names;
+	//graph built by this session or new chains resolved, file needs update
+	Bool graph_dirty, chains_dirty;
+	//registry modified after setup, cache no longer used
+	Bool inactive;
+	u32 nb_hits, nb_miss;
+};
+
+static u32 gcache_registry_crc(GF_FilterSession *fsess)
+{
+	u8 *data;
+	u32 i, j, size, crc, count;
+	char szDump[GF_PROP_DUMP_ARG_SIZE];
+	GF_BitStream *bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+
+	gf_bs_write_data(bs, gf_gpac_version(), (u32) strlen(gf_gpac_version()));
+	count = gf_list_count(fsess->registry);
+	for (i=0; i<count; i++) {
+		const GF_FilterRegister *freg = gf_list_get(fsess->registry, i);
+		gf_bs_write_data(bs, freg->name, (u32) strlen(freg->name)+1);
+		gf_bs_write_u32(bs, freg->flags);
+		gf_bs_write_u8(bs, freg->priority);
+		gf_bs_write_u8(bs, freg->configure_pid ? 1 : 0);
+		gf_bs_write_u8(bs, freg->reconfigure_output ? 1 : 0);
+		gf_bs_write_u32(bs, freg->nb_caps);
+		for (j=0; j<freg->nb_caps; j++) {
+			const char *val;
+			const GF_FilterCapability *cap = &freg->caps[j];
+			gf_bs_write_u32(bs, cap->code);
+			gf_bs_write_u32(bs, cap->flags);
+			gf_bs_write_u8(bs, cap->priority);
+			if (cap->name) gf_bs_write_data(bs, cap->name, (u32) strlen(cap->name));
+			gf_bs_write_u32(bs, cap->val.type);
+			if (cap->val.type==GF_PROP_FORBIDEN) continue;
+			val = gf_props_dump_val(&cap->val, szDump, GF_FALSE, NULL);
+			if (val) gf_bs_write_data(bs, val, (u32) strlen(val)+1);
+		}
+	}
+	gf_bs_get_content(bs, &data, &size);
+	gf_bs_del(bs);
+	crc = gf_crc_32(data, size);
+	gf_free(data);
+	return crc;
+}
+
+static void gcache_setup_codes(GF_FilterSession *fsess, GF_FSGraphCache *gc)
+{
+	u32 i, j, k, count = gf_list_count(fsess->registry);
+	gc->names = gf_list_new();
+	for (i=0; i<count; i++) {
+		const GF_FilterRegister *freg = gf_list_get(fsess->registry, i);
+		for (j=0; j<freg->nb_caps; j++) {
+			const GF_FilterCapability *cap = &freg->caps[j];
+			if (!(cap->flags & GF_CAPFLAG_INPUT)) continue;
+			if (!cap->code) {
+				if (cap->name && (gf_list_find(gc->names, (void *) cap->name)<0))
+					gf_list_add(gc->names, (void *) cap->name);
+				continue;
+			}
+			for (k=0; k<gc->nb_codes; k++) {
+				if (gc->codes[k]==cap->code) break;
+			}
+			if (k<gc->nb_codes) continue;
+			gc->codes = gf_realloc(gc->codes, sizeof(u32) * (gc->nb_codes+1));
+			gc->codes[gc->nb_codes] = cap->code;
+			gc->nb_codes++;
+		}
+	}
+	//file ext and mime are checked as fallback of one another
+	for (i=0; i<2; i++) {
+		u32 code = i ? GF_PROP_PID_MIME : GF_PROP_PID_FILE_EXT;
+		for (k=0; k<gc->nb_codes; k++) {
+			if (gc->codes[k]==code) break;
+		}
+		if (k<gc->nb_codes) continue;
+		gc->codes = gf_realloc(gc->codes, sizeof(u32) * (gc->nb_codes+1));
+		gc->codes[gc->nb_codes] = code;
+		gc->nb_codes++;
+	}
+}
+
+static void gcache_reset_chains(GF_FSGraphCache *gc)
+{
+	while (gf_list_count(gc->chains)) {
+		GF_FSCachedChain *chain = gf_list_pop_back(gc->chains);
+		gf_free(chain->key);
+		if (chain->entries) gf_free(chain->entries);
+		gf_free(chain);
+	}
+}
+
+static char *gcache_read_string(GF_BitStream *bs)
+{
+	char *str;
+	u32 len = gf_bs_read_u16(bs);
+	if (!len || (gf_bs_available(bs) < len)) return NULL;
+	str = gf_malloc(len+1);
+	if (!str) return NULL;
+	gf_bs_read_data(bs, str, len);
+	str[len] = 0;
+	return str;
+}
+
+static GF_Err gcache_load(GF_FilterSession *fsess, GF_FSGraphCache *gc)
+{
+	u8 *data;
+	u32 i, j, size, nb_links, nb_chains, nb_regs;
+	GF_FilterRegDesc **descs = NULL;
+	GF_BitStream *bs;
+	GF_Err e;
+
+	if (!gf_file_exists(gc->path)) return GF_URL_ERROR;
+	e = gf_file_load_data(gc->path, &data, &size);
+	if (e) return e;
+
+	nb_regs = gf_list_count(fsess->registry);
+	e = GF_NON_COMPLIANT_BITSTREAM;
+	//payload is followed by its CRC
+	if ((size<20) || (gf_crc_32(data, size-4) != GF_4CC(data[size-4], data[size-3], data[size-2], data[size-1]))) {
+		gf_free(data);
+		return e;
+	}
+	bs = gf_bs_new(data, size-4, GF_BITSTREAM_READ);
+	if (gf_bs_read_u32(bs) != GF_FS_GCACHE_MAGIC) goto exit;
+	if (gf_bs_read_u32(bs) != GF_FS_GCACHE_VERSION) goto exit;
+	if (gf_bs_read_u32(bs) != gc->reg_crc) {
+		e = GF_NOT_FOUND;
+		goto exit;
+	}
+	nb_links = gf_bs_read_u32(bs);
+	if (nb_links > nb_regs) goto exit;
+
+	descs = gf_malloc(sizeof(GF_FilterRegDesc *) * nb_links);
+	if (!descs) {
+		e = GF_OUT_OF_MEM;
+		goto exit;
+	}
+	memset(descs, 0, sizeof(GF_FilterRegDesc *) * nb_links);
+	for (i=0; i<nb_links; i++) {
+		u32 reg_idx = gf_bs_read_u32(bs);
+		if (reg_idx>=nb_regs) goto exit;
+		GF_SAFEALLOC(descs[i], GF_FilterRegDesc);
+		if (!descs[i]) {
+			e = GF_OUT_OF_MEM;
+			goto exit;
+		}
+		descs[i]->freg = gf_list_get(fsess->registry, reg_idx);
+	}
+	for (i=0; i<nb_links; i++) {
+		GF_FilterRegDesc *rdesc = descs[i];
+		rdesc->nb_edges = gf_bs_read_u32(bs);
+		if (gf_bs_available(bs) < rdesc->nb_edges * 15) goto exit;
+		rdesc->nb_alloc_edges = rdesc->nb_edges;
+		if (!rdesc->nb_edges) continue;
+		rdesc->edges = gf_malloc(sizeof(GF_FilterRegEdge) * rdesc->nb_edges);
+		if (!rdesc->edges) {
+			rdesc->nb_edges = 0;
+			e = GF_OUT_OF_MEM;
+			goto exit;
+		}
+		memset(rdesc->edges, 0, sizeof(GF_FilterRegEdge) * rdesc->nb_edges);
+		for (j=0; j<rdesc->nb_edges; j++) {
+			GF_FilterRegEdge *edge = &rdesc->edges[j];
+			u32 src_idx = gf_bs_read_u32(bs);
+			if (src_idx>=nb_links) goto exit;
+			edge->src_reg = descs[src_idx];
+			edge->src_cap_idx = gf_bs_read_u16(bs);
+			edge->dst_cap_idx = gf_bs_read_u16(bs);
+			edge->weight = gf_bs_read_u8(bs);
+			edge->priority = gf_bs_read_u8(bs);
+			edge->loaded_filter_only = gf_bs_read_u8(bs);
+			edge->src_stream_type = (s32) gf_bs_read_u32(bs);
+			if (edge->src_cap_idx >= edge->src_reg->freg->nb_caps) goto exit;
+			if (edge->dst_cap_idx >= rdesc->freg->nb_caps) goto exit;
+		}
+	}
+
+	nb_chains = gf_bs_read_u32(bs);
+	for (i=0; i<nb_chains; i++) {
+		GF_FSCachedChain *chain;
+		char *key = gcache_read_string(bs);
+		if (!key) goto exit;
+		GF_SAFEALLOC(chain, GF_FSCachedChain);
+		if (!chain) {
+			gf_free(key);
+			e = GF_OUT_OF_MEM;
+			goto exit;
+		}
+		chain->key = key;
+		chain->crc = gf_crc_32(key, (u32) strlen(key));
+		gf_list_add(gc->chains, chain);
+		chain->nb_entries = gf_bs_read_u32(bs);
+		if (gf_bs_available(bs) < chain->nb_entries * 8) goto exit;
+		if (!chain->nb_entries) continue;
+		chain->entries = gf_malloc(sizeof(GF_FSCachedChainEntry) * chain->nb_entries);
+		if (!chain->entries) {
+			chain->nb_entries = 0;
+			e = GF_OUT_OF_MEM;
+			goto exit;
+		}
+		for (j=0; j<chain->nb_entries; j++) {
+			u32 reg_idx = gf_bs_read_u32(bs);
+			u32 cap_idx = gf_bs_read_u32(bs);
+			if (reg_idx>=nb_regs) goto exit;
+			chain->entries[j].freg = gf_list_get(fsess->registry, reg_idx);
+			if (cap_idx >= chain->entries[j].freg->nb_caps) goto exit;
+			chain->entries[j].cap_idx = cap_idx;
+		}
+	}
+	if (gf_bs_available(bs)) goto exit;
+
+	for (i=0; i<nb_links; i++) {
+		gf_list_add(fsess->links, descs[i]);
+	}
+	nb_links = 0;
+	e = GF_OK;
+
+exit:
+	if (descs) {
+		for (i=0; i<nb_links; i++) {
+			if (!descs[i]) continue;
+			if (descs[i]->edges) gf_free(descs[i]->edges);
+			gf_free(descs[i]);
+		}
+		gf_free(descs);
+	}
+	if (e) gcache_reset_chains(gc);
+	gf_bs_del(bs);
+	gf_free(data);
+	return e;
+}
+
+static void gcache_save(GF_FilterSession *fsess, GF_FSGraphCache *gc)
+{
+	u8 *data;
+	u32 i, j, size, nb_links, crc;
+	char *tmp_name;
+	char szSuffix[100];
+	FILE *out;
+	GF_BitStream *bs;
+
+	//links have been reset or were never built
+	nb_links = gf_list_count(fsess->links);
+	if (!nb_links) return;
+	//registry modified during the session (eg unregistered filter), do not store this state
+	if (gcache_registry_crc(fsess) != gc->reg_crc) return;
+	//edges of filters not used in this session were not computed
+	gf_filter_sess_load_graph_edges(fsess);
+
+	bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+	gf_bs_write_u32(bs, GF_FS_GCACHE_MAGIC);
+	gf_bs_write_u32(bs, GF_FS_GCACHE_VERSION);
+	gf_bs_write_u32(bs, gc->reg_crc);
+	gf_bs_write_u32(bs, nb_links);
+	for (i=0; i<nb_links; i++) {
+		GF_FilterRegDesc *rdesc = gf_list_get(fsess->links, i);
+		gf_bs_write_u32(bs, gf_list_find(fsess->registry, (void *) rdesc->freg));
+	}
+	for (i=0; i<nb_links; i++) {
+		GF_FilterRegDesc *rdesc = gf_list_get(fsess->links, i);
+		gf_bs_write_u32(bs, rdesc->nb_edges);
+		for (j=0; j<rdesc->nb_edges; j++) {
+			GF_FilterRegEdge *edge = &rdesc->edges[j];
+			gf_bs_write_u32(bs, gf_list_find(fsess->links, edge->src_reg));
+			gf_bs_write_u16(bs, edge->src_cap_idx);
+			gf_bs_write_u16(bs, edge->dst_cap_idx);
+			gf_bs_write_u8(bs, edge->weight);
+			gf_bs_write_u8(bs, edge->priority);
+			gf_bs_write_u8(bs, edge->loaded_filter_only);
+			gf_bs_write_u32(bs, (u32) edge->src_stream_type);
+		}
+	}
+	gf_bs_write_u32(bs, gf_list_count(gc->chains));
+	for (i=0; i<gf_list_count(gc->chains); i++) {
+		GF_FSCachedChain *chain = gf_list_get(gc->chains, i);
+		u32 len = (u32) strlen(chain->key);
+		gf_bs_write_u16(bs, len);
+		gf_bs_write_data(bs, chain->key, len);
+		gf_bs_write_u32(bs, chain->nb_entries);
+		for (j=0; j<chain->nb_entries; j++) {
+			gf_bs_write_u32(bs, gf_list_find(fsess->registry, (void *) chain->entries[j].freg));
+			gf_bs_write_u32(bs, chain->entries[j].cap_idx);
+		}
+	}
+	gf_bs_get_content(bs, &data, &size);
+	gf_bs_del(bs);
+	data = gf_realloc(data, size+4);
+	if (!data) return;
+	crc = gf_crc_32(data, size);
+	data[size] = (crc>>24) & 0xFF;
+	data[size+1] = (crc>>16) & 0xFF;
+	data[size+2] = (crc>>8) & 0xFF;
+	data[size+3] = crc & 0xFF;
+	size += 4;
+
+	//write to a temp file and rename it, so that concurrent sessions never load a partial file
+	sprintf(szSuffix, ".%u_%p.tmp", gf_sys_get_process_id(), fsess);
+	tmp_name = gf_strdup(gc->path);
+	gf_dynstrcat(&tmp_name, szSuffix, NULL);
+	out = gf_fopen(tmp_name, "wb");
+	if (!out) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_FILTER, ("[Filters] Failed to open graph cache file %s for write\n", tmp_name));
+	} else {
+		u32 written = (u32) gf_fwrite(data, size, out);
+		gf_fclose(out);
+		if (written != size) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_FILTER, ("[Filters] Failed to write graph cache file %s\n", tmp_name));
+			gf_file_delete(tmp_name);
+		} else if (rename(tmp_name, gc->path)) {
+			gf_file_delete(gc->path);
+			if (gf_file_move(tmp_name, gc->path))
+				gf_file_delete(tmp_name);
+		}
+	}
+	gf_free(tmp_name);
+	gf_free(data);
+}
+
+void gf_fs_graph_cache_new(GF_FilterSession *fsess, const char *path)
+{
+	GF_Err e;
+	u64 start_time = gf_sys_clock_high_res();
+	GF_FSGraphCache *gc;
+	GF_SAFEALLOC(gc, GF_FSGraphCache);
+	if (!gc) return;
+	gc->path = gf_strdup(path);
+	gc->chains = gf_list_new();
+	gc->reg_crc = gcache_registry_crc(fsess);
+	gcache_setup_codes(fsess, gc);
+	fsess->graph_cache = gc;
+
+	e = gcache_load(fsess, gc);
+	if (e==GF_OK) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_FILTER, ("Loaded filter graph and %d chains from cache %s in "LLU" us\n", gf_list_count(gc->chains), path, gf_sys_clock_high_res() - start_time));
+		return;
+	}
+	if (e==GF_NOT_FOUND) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_FILTER, ("Filter graph cache %s does not match filter registry, rebuilding\n", path));
+	} else if (e!=GF_URL_ERROR) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_FILTER, ("Failed to load filter graph cache %s: %s, rebuilding\n", path, gf_error_to_string(e)));
+	}
+	gf_filter_sess_build_graph(fsess, NULL);
+	gc->graph_dirty = GF_TRUE;
+}
+
+void gf_fs_graph_cache_del(GF_FilterSession *fsess)
+{
+	GF_FSGraphCache *gc = fsess->graph_cache;
+	if (!gc) return;
+	fsess->graph_cache = NULL;
+
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_FILTER, ("Filter graph cache: %d chain hits %d misses\n", gc->nb_hits, gc->nb_miss));
+	if (!gc->inactive && (gc->graph_dirty || gc->chains_dirty))
+		gcache_save(fsess, gc);
+
+	gcache_reset_chains(gc);
+	gf_list_del(gc->chains);
+	gf_list_del(gc->names);
+	if (gc->codes) gf_free(gc->codes);
+	gf_free(gc->path);
+	gf_free(gc);
+}
+
+void gf_fs_graph_cache_registry_changed(GF_FilterSession *fsess)
+{
+	GF_FSGraphCache *gc = fsess->graph_cache;
+	if (!gc || gc->inactive) return;
+	GF_LOG(GF_LOG_INFO, GF_LOG_FILTER, ("Filter registry modified, disabling filter graph cache\n"));
+	gcache_reset_chains(gc);
+	gc->inactive = GF_TRUE;
+}
+
+static void gcache_append_regs(char **key, const char *prefix, GF_List *regs)
+{
+	u32 i, count = gf_list_count(regs);
+	if (!count) return;
+	gf_dynstrcat(key, prefix, "|");
+	for (i=0; i<count; i++) {
+		const GF_FilterRegister *freg = gf_list_get(regs, i);
+		gf_dynstrcat(key, freg->name, ",");
+	}
+}
+
+Bool gf_fs_graph_cache_get_chain(GF_FilterPid *pid, GF_Filter *dst, const char *prefRegister, Bool reconfigurable_only, GF_List *out_reg_chain, char **out_key)
+{
+	u32 i, crc;
+	char *key = NULL;
+	char szVal[100];
+	char sz4cc[GF_4CC_MSIZE];
+	char szDump[GF_PROP_DUMP_ARG_SIZE];
+	GF_FSGraphCache *gc = pid->filter->session->graph_cache;
+
+	*out_key = NULL;
+	if (!gc || gc->inactive) return GF_FALSE;
+
+	gf_dynstrcat(&key, pid->filter->freg->name, NULL);
+	gf_dynstrcat(&key, dst->freg->name, ">");
+	sprintf(szVal, "%d,%d,%d,%d,%d,%d", dst->bundle_idx_at_resolution, reconfigurable_only, pid->filter->session->max_resolve_chain_len,
+		pid->ext_not_trusted, dst->encoder_stream_type, (pid->filter->dst_filter==dst) ? 1 : (pid->filter->dst_filter ? 2 : 0));
+	gf_dynstrcat(&key, szVal, "|");
+	if (prefRegister[0])
+		gf_dynstrcat(&key, prefRegister, "|");
+	//caps of destination instance (output file extension, scripts), used instead of the register caps
+	for (i=0; i<dst->nb_forced_caps; i++) {
+		const char *val;
+		const GF_FilterCapability *cap = &dst->forced_caps[i];
+		sprintf(szVal, "fc%s,%08X,%d=", cap->code ? gf_4cc_to_str_safe(cap->code, sz4cc) : "", cap->flags, cap->priority);
+		gf_dynstrcat(&key, szVal, "|");
+		if (cap->name) gf_dynstrcat(&key, cap->name, NULL);
+		if (cap->val.type==GF_PROP_FORBIDEN) continue;
+		val = gf_props_dump_val(&cap->val, szDump, GF_FALSE, NULL);
+		if (val) gf_dynstrcat(&key, val, NULL);
+	}
+	gcache_append_regs(&key, "bl", pid->filter->blacklisted);
+	gcache_append_regs(&key, "ab", pid->adapters_blacklist);
+
+	for (i=0; i<gc->nb_codes; i++) {
+		const char *val;
+		const GF_PropertyValue *p = gf_filter_pid_get_property_first(pid, gc->codes[i]);
+		if (!p) continue;
+		sprintf(szVal, "%s=", gf_4cc_to_str_safe(gc->codes[i], sz4cc));
+		gf_dynstrcat(&key, szVal, "|");
+		val = gf_props_dump_val(p, szDump, GF_FALSE, NULL);
+		if (val) gf_dynstrcat(&key, val, NULL);
+	}
+	for (i=0; i<gf_list_count(gc->names); i++) {
+		const char *val;
+		const char *name = gf_list_get(gc->names, i);
+		const GF_PropertyValue *p = gf_filter_pid_get_property_str_first(pid, name);
+		if (!p) continue;
+		gf_dynstrcat(&key, name, "|");
+		gf_dynstrcat(&key, "=", NULL);
+		val = gf_props_dump_val(p, szDump, GF_FALSE, NULL);
+		if (val) gf_dynstrcat(&key, val, NULL);
+	}
+	if (!key) return GF_FALSE;
+	//keys are stored with a 16-bit length
+	if (strlen(key) > 0xFFFF) {
+		gf_free(key);
+		return GF_FALSE;
+	}
+
+	crc = gf_crc_32(key, (u32) strlen(key));
+	for (i=0; i<gf_list_count(gc->chains); i++) {
+		u32 j;
+		GF_FSCachedChain *chain = gf_list_get(gc->chains, i);
+		if ((chain->crc != crc) || strcmp(chain->key, key)) continue;
+
+		for (j=0; j<chain->nb_entries; j++) {
+			gf_list_add(out_reg_chain, (void *) chain->entries[j].freg);
+			gf_list_add(out_reg_chain, (void *) &chain->entries[j].freg->caps[chain->entries[j].cap_idx]);
+		}
+		gc->nb_hits++;
+		gf_free(key);
+		GF_LOG(GF_LOG_INFO, GF_LOG_FILTER, ("[Filters] Graph cache: using cached chain of %d filters from %s to %s\n", chain->nb_entries, pid->filter->freg->name, dst->freg->name));
+		return GF_TRUE;
+	}
+	gc->nb_miss++;
+	*out_key = key;
+	return GF_FALSE;
+}
+
+void gf_fs_graph_cache_add_chain(GF_FilterSession *fsess, char *key, GF_List *reg_chain)
+{
+	u32 i;
+	GF_FSCachedChain *chain;
+	GF_FSGraphCache *gc = fsess->graph_cache;
+
+	if (!gc || gc->inactive) {
+		gf_free(key);
+		return;
+	}
+	GF_SAFEALLOC(chain, GF_FSCachedChain);
+	if (!chain) {
+		gf_free(key);
+		return;
+	}
+	chain->key = key;
+	chain->crc = gf_crc_32(key, (u32) strlen(key));
+	chain->nb_entries = gf_list_count(reg_chain) / 2;
+	if (chain->nb_entries) {
+		chain->entries = gf_malloc(sizeof(GF_FSCachedChainEntry) * chain->nb_entries);
+		if (!chain->entries) {
+			gf_free(key);
+			gf_free(chain);
+			return;
+		}
+	}
+	for (i=0; i<chain->nb_entries; i++) {
+		const GF_FilterRegister *freg = gf_list_get(reg_chain, 2*i);
+		const GF_FilterCapability *cap = gf_list_get(reg_chain, 2*i+1);
+		chain->entries[i].freg = freg;
+		chain->entries[i].cap_idx = (u32) (cap - freg->caps);
+	}
+	gf_list_add(gc->chains, chain);
+	gc->chains_dirty = GF_TRUE;
+}
@@ -0,0 +1,443 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2020
+ *					All rights reserved
+ *
+ *  This file is part of GPAC / filters sub-project
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include "filter_session.h"
+
+/*
+Filter session groups.
+
+Sessions of a group are created without threads and without main thread, and are run step by step (see gf_fs_run_step)
+by the threads of the group. A thread picks the next session having tasks ready in round-robin, and a session is run by
+at most one thread at any time. When the tasks of a session are not yet due, the session returns from its step and
+reports the time of its next task to the group, so that the group threads never sleep on behalf of a single session.
+
+The download manager is owned by the group and shared by all its sessions. Download tasks are posted to a hidden service
+session, run by the group threads as any other session of the group. The font manager is not thread-safe and sessions of
+a group run concurrently, each session therefore uses its own font manager.
+*/
+
+enum
+{
+	//session created but not started
+	GF_FSG_IDLE=0,
+	GF_FSG_STARTED,
+	GF_FSG_DONE,
+};
+
+//max time a group thread waits for a new task
+#define GF_FSG_MAX_WAIT_MS	50
+
+struct __gf_filter_session_group
+{
+	//sessions of the group, including the service session
+	GF_List *sessions;
+	GF_List *threads;
+	//protects the session list and session group state
+	GF_Mutex *mx;
+	GF_Semaphore *sema;
+	//signaled when a session is done, for threads waiting in gf_fs_group_wait
+	GF_Semaphore *done_sema;
+	//number of threads waiting on done_sema, only modified under the group mutex
+	u32 nb_done_waiters;
+	//index of next session to check
+	u32 rr_idx;
+	volatile Bool exit;
+
+	//service session, hosting tasks of the shared download manager
+	GF_FilterSession *services;
+	GF_DownloadManager *download_manager;
+};
+
+//number of tasks pending in the session, main thread tasks included
+static u32 fsg_session_tasks(GF_FilterSession *fsess)
+{
+	u32 nb_tasks = gf_fq_count(fsess->tasks);
+	if (fsess->main_thread_tasks != fsess->tasks)
+		nb_tasks += gf_fq_count(fsess->main_thread_tasks);
+	return nb_tasks;
+}
+
+//wakes up threads waiting for sessions to be done, must be called with the group mutex held
+static void fsg_notify_done(GF_FilterSessionGroup *group)
+{
+	if (!group->nb_done_waiters) return;
+	gf_sema_notify(group->done_sema, group->nb_done_waiters);
+	group->nb_done_waiters = 0;
+}
+
+//picks the next session to run, returns NULL if none is ready and sets next_due to the earliest due time of postponed sessions
+static GF_FilterSession *fsg_pick_session(GF_FilterSessionGroup *group, u64 *next_due)
+{
+	u32 i, count;
+	u64 now = gf_sys_clock_high_res();
+
+	*next_due = 0;
+	gf_mx_p(group->mx);
+	count = gf_list_count(group->sessions);
+	for (i=0; i<count; i++) {
+		u32 idx = (group->rr_idx + i) % count;
+		GF_FilterSession *fsess = gf_list_get(group->sessions, idx);
+		if ((fsess->group_state != GF_FSG_STARTED) || fsess->group_running) continue;
+
+		if (!fsess->group_cancel) {
+			if (!fsg_session_tasks(fsess)) continue;
+			if (fsess->group_next_due > now) {
+				if (!*next_due || (fsess->group_next_due < *next_due))
+					*next_due = fsess->group_next_due;
+				continue;
+			}
+		}
+		fsess->group_running = GF_TRUE;
+		group->rr_idx = idx+1;
+		gf_mx_v(group->mx);
+		return fsess;
+	}
+	gf_mx_v(group->mx);
+	return NULL;
+}
+
+static void fsg_run_session(GF_FilterSessionGroup *group, GF_FilterSession *fsess)
+{
+	Bool has_tasks;
+
+	if (fsess->group_cancel) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_FILTER, ("[SessionGroup] Canceling session %p\n", fsess));
+		gf_fs_abort(fsess, (fsess->group_cancel==2) ? GF_TRUE : GF_FALSE);
+		fsess->group_cancel = 0;
+	}
+	fsess->group_next_due = 0;
+	gf_fs_run_step(fsess);
+
+	gf_mx_p(group->mx);
+	fsess->group_running = GF_FALSE;
+	fsess->group_nb_steps++;
+	has_tasks = fsg_session_tasks(fsess) ? GF_TRUE : GF_FALSE;
+	//no more tasks, session is done
+	if (!has_tasks && !fsess->pid_connect_tasks_pending && (fsess != group->services)) {
+		fsess->group_state = GF_FSG_DONE;
+		fsess->group_end_time = gf_sys_clock_high_res();
+		if (fsess->run_status == GF_OK)
+			fsess->run_status = GF_EOS;
+		fsess->main_th.has_seen_eot = GF_TRUE;
+		fsess->nb_threads_stopped = 1;
+		GF_LOG(GF_LOG_INFO, GF_LOG_FILTER, ("[SessionGroup] Session %p done in "LLU" us - %d steps "LLU" tasks\n", fsess, fsess->group_end_time - fsess->group_start_time, fsess->group_nb_steps, fsess->main_th.nb_tasks));
+		fsg_notify_done(group);
+	}
+	gf_mx_v(group->mx);
+
+	//session still has tasks ready and we move on to the next session, wake up another thread
+	if (has_tasks && !fsess->group_next_due)
+		gf_sema_notify(group->sema, 1);
+}
+
+static u32 fsg_thread_proc(void *par)
+{
+	GF_FilterSessionGroup *group = (GF_FilterSessionGroup *)par;
+
+	while (!group->exit) {
+		u64 next_due;
+		GF_FilterSession *fsess = fsg_pick_session(group, &next_due);
+		if (!fsess) {
+			u32 wait_ms = GF_FSG_MAX_WAIT_MS;
+			if (next_due) {
+				u64 now = gf_sys_clock_high_res();
+				wait_ms = (next_due > now) ? (u32) ((next_due - now + 999) / 1000) : 0;
+				if (wait_ms > GF_FSG_MAX_WAIT_MS) wait_ms = GF_FSG_MAX_WAIT_MS;
+			}
+			if (wait_ms)
+				gf_sema_wait_for(group->sema, wait_ms);
+			continue;
+		}
+		fsg_run_session(group, fsess);
+	}
+	return 0;
+}
+
+void gf_fs_group_notify(GF_FilterSession *fsess)
+{
+	fsess->group_next_due = 0;
+	//session is being run, the running thread checks for tasks once done
+	if (fsess->group_running) return;
+	if (fsess->group_state != GF_FSG_STARTED) return;
+	gf_sema_notify(fsess->group->sema, 1);
+}
+
+static GF_FilterSession *fsg_create_session(GF_FilterSessionGroup *group, u32 flags, const char *blacklist)
+{
+	GF_FilterSession *fsess;
+	GF_FilterSchedulerType sched_type = GF_FS_SCHEDULER_LOCK_FREE;
+	const char *opt = gf_opts_get_key("core", "sched");
+	//sessions have no thread of their own, but tasks may be posted from any thread of the group
+	if (opt && !strcmp(opt, "lock")) sched_type = GF_FS_SCHEDULER_LOCK;
+	else if (opt && !strcmp(opt, "flock")) sched_type = GF_FS_SCHEDULER_LOCK_FORCE;
+
+	fsess = gf_fs_new(0, sched_type, flags | GF_FS_FLAG_NO_MAIN_THREAD | GF_FS_FLAG_NO_REGULATION, blacklist);
+	if (!fsess) return NULL;
+	fsess->group = group;
+	fsess->group_state = GF_FSG_IDLE;
+	return fsess;
+}
+
+GF_EXPORT
+GF_FilterSessionGroup *gf_fs_group_new(s32 nb_threads)
+{
+	u32 i;
+	GF_FilterSessionGroup *group;
+
+	if (nb_threads < 0) {
+		GF_SystemRTInfo rti;
+		memset(&rti, 0, sizeof(GF_SystemRTInfo));
+		nb_threads = 1;
+		if (gf_sys_get_rti(0, &rti, 0) && rti.nb_cores)
+			nb_threads = rti.nb_cores;
+	}
+	if (!nb_threads) nb_threads = 1;
+
+	GF_SAFEALLOC(group, GF_FilterSessionGroup);
+	if (!group) return NULL;
+	group->sessions = gf_list_new();
+	group->threads = gf_list_new();
+	group->mx = gf_mx_new("FilterSessionGroup");
+	group->sema = gf_sema_new(GF_INT_MAX, 0);
+	group->done_sema = gf_sema_new(GF_INT_MAX, 0);
+	if (!group->sessions || !group->threads || !group->mx || !group->sema || !group->done_sema) {
+		gf_fs_group_del(group);
+		return NULL;
+	}
+	//service session: no filters are loaded in this session, don't build the link graph
+	group->services = fsg_create_session(group, GF_FS_FLAG_NO_GRAPH_CACHE, NULL);
+	if (!group->services) {
+		gf_fs_group_del(group);
+		return NULL;
+	}
+	gf_list_add(group->sessions, group->services);
+	gf_fs_group_start_session(group->services);
+
+	for (i=0; i<(u32) nb_threads; i++) {
+		GF_Thread *th = gf_th_new("FilterSessionGroupThread");
+		if (!th) break;
+		gf_list_add(group->threads, th);
+		gf_th_run(th, fsg_thread_proc, group);
+	}
+	if (!gf_list_count(group->threads)) {
+		gf_fs_group_del(group);
+		return NULL;
+	}
+	GF_LOG(GF_LOG_INFO, GF_LOG_FILTER, ("[SessionGroup] Created session group with %d threads\n", gf_list_count(group->threads) ));
+	return group;
+}
+
+GF_EXPORT
+void gf_fs_group_del(GF_FilterSessionGroup *group)
+{
+	if (!group) return;
+
+	//stop threads
+	if (group->threads) {
+		u32 i, count = gf_list_count(group->threads);
+		group->exit = GF_TRUE;
+		if (group->sema) gf_sema_notify(group->sema, count);
+		//gf_th_del waits for the thread to exit
+		for (i=0; i<count; i++) {
+			GF_Thread *th = gf_list_get(group->threads, i);
+			gf_th_del(th);
+		}
+		gf_list_del(group->threads);
+		group->threads = NULL;
+	}
+	//destroy remaining sessions
+	if (group->sessions) {
+		while (1) {
+			GF_FilterSession *fsess = NULL;
+			u32 i, count = gf_list_count(group->sessions);
+			for (i=0; i<count; i++) {
+				fsess = gf_list_get(group->sessions, i);
+				if (fsess != group->services) break;
+				fsess = NULL;
+			}
+			if (!fsess) break;
+			gf_fs_del(fsess);
+		}
+	}
+	//flush pending service tasks, download sessions are now destroyed
+	if (group->services) {
+		u32 nb_loops = 0;
+		while (gf_fq_count(group->services->tasks) && (nb_loops<1000)) {
+			gf_fs_run_step(group->services);
+			nb_loops++;
+		}
+	}
+	if (group->download_manager) gf_dm_del(group->download_manager);
+	if (group->services) gf_fs_del(group->services);
+	if (group->sessions) gf_list_del(group->sessions);
+	if (group->sema) gf_sema_del(group->sema);
+	if (group->done_sema) gf_sema_del(group->done_sema);
+	if (group->mx) gf_mx_del(group->mx);
+	gf_free(group);
+}
+
+GF_EXPORT
+GF_FilterSession *gf_fs_group_new_session(GF_FilterSessionGroup *group, u32 flags, const char *blacklist)
+{
+	GF_FilterSession *fsess;
+	if (!group) return NULL;
+	fsess = fsg_create_session(group, flags, blacklist);
+	if (!fsess) return NULL;
+
+	gf_mx_p(group->mx);
+	gf_list_add(group->sessions, fsess);
+	gf_mx_v(group->mx);
+	return fsess;
+}
+
+GF_EXPORT
+GF_Err gf_fs_group_start_session(GF_FilterSession *fsess)
+{
+	GF_FilterSessionGroup *group;
+	if (!fsess || !fsess->group) return GF_BAD_PARAM;
+	group = fsess->group;
+	if (fsess->group_state != GF_FSG_IDLE) return GF_BAD_PARAM;
+
+	//reset session state, no thread is started since the session has none
+	gf_fs_run(fsess);
+
+	gf_mx_p(group->mx);
+	fsess->group_start_time = gf_sys_clock_high_res();
+	fsess->group_next_due = 0;
+	fsess->group_state = GF_FSG_STARTED;
+	gf_mx_v(group->mx);
+	gf_sema_notify(group->sema, 1);
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_Err gf_fs_group_cancel_session(GF_FilterSession *fsess, Bool do_flush)
+{
+	GF_FilterSessionGroup *group;
+	if (!fsess || !fsess->group) return GF_BAD_PARAM;
+	group = fsess->group;
+
+	gf_mx_p(group->mx);
+	if (fsess->group_state == GF_FSG_STARTED) {
+		fsess->group_cancel = do_flush ? 2 : 1;
+	} else if (fsess->group_state == GF_FSG_IDLE) {
+		fsess->group_state = GF_FSG_DONE;
+		fsess->run_status = GF_EOS;
+		fsg_notify_done(group);
+	}
+	gf_mx_v(group->mx);
+	gf_sema_notify(group->sema, 1);
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_Err gf_fs_group_wait(GF_FilterSessionGroup *group, GF_FilterSession *session)
+{
+	GF_Err e = GF_EOS;
+	if (!group) return GF_BAD_PARAM;
+	if (session && (session->group != group)) return GF_BAD_PARAM;
+
+	while (1) {
+		u32 i, count;
+		Bool done = GF_TRUE;
+		gf_mx_p(group->mx);
+		count = gf_list_count(group->sessions);
+		for (i=0; i<count; i++) {
+			GF_FilterSession *fsess = gf_list_get(group->sessions, i);
+			if (fsess == group->services) continue;
+			if (session && (fsess != session)) continue;
+			if (fsess->group_state == GF_FSG_STARTED) {
+				done = GF_FALSE;
+				break;
+			}
+			if ((fsess->group_state == GF_FSG_DONE) && (fsess->run_status != GF_EOS) && (e == GF_EOS))
+				e = fsess->run_status;
+		}
+		if (done) {
+			gf_mx_v(group->mx);
+			break;
+		}
+		//wait for the next session to be done, under the group mutex so that no notification is missed
+		group->nb_done_waiters++;
+		gf_mx_v(group->mx);
+		gf_sema_wait(group->done_sema);
+		e = GF_EOS;
+	}
+	return e;
+}
+
+GF_EXPORT
+GF_Err gf_fs_group_get_session_stats(GF_FilterSession *fsess, GF_FSGroupSessionStats *stats)
+{
+	if (!fsess || !fsess->group || !stats) return GF_BAD_PARAM;
+	memset(stats, 0, sizeof(GF_FSGroupSessionStats));
+
+	gf_mx_p(fsess->group->mx);
+	stats->status = (fsess->group_state == GF_FSG_DONE) ? fsess->run_status : GF_OK;
+	stats->running = (fsess->group_state == GF_FSG_STARTED) ? GF_TRUE : GF_FALSE;
+	stats->nb_steps = fsess->group_nb_steps;
+	stats->nb_tasks = fsess->main_th.nb_tasks;
+	stats->active_time = fsess->main_th.active_time;
+	if (fsess->group_state == GF_FSG_DONE)
+		stats->run_time = fsess->group_end_time - fsess->group_start_time;
+	else if (fsess->group_state == GF_FSG_STARTED)
+		stats->run_time = gf_sys_clock_high_res() - fsess->group_start_time;
+	gf_mx_v(fsess->group->mx);
+	return GF_OK;
+}
+
+void gf_fs_group_detach(GF_FilterSession *fsess)
+{
+	GF_FilterSessionGroup *group = fsess->group;
+	if (!group) return;
+
+	//wait for the thread running the session, if any
+	while (1) {
+		gf_mx_p(group->mx);
+		if (!fsess->group_running) break;
+		gf_mx_v(group->mx);
+		gf_sleep(0);
+	}
+	gf_list_del_item(group->sessions, fsess);
+	fsg_notify_done(group);
+	gf_mx_v(group->mx);
+	fsess->group = NULL;
+
+	//session still running, discard pending data
+	if (fsess->group_state == GF_FSG_STARTED) {
+		fsess->group_state = GF_FSG_DONE;
+		if (fsess != group->services)
+			gf_fs_abort(fsess, GF_FALSE);
+	}
+}
+
+GF_DownloadManager *gf_fs_group_get_download_manager(GF_FilterSessionGroup *group)
+{
+	gf_mx_p(group->mx);
+	if (!group->download_manager)
+		group->download_manager = gf_dm_new(group->services);
+	gf_mx_v(group->mx);
+	return group->download_manager;
+}
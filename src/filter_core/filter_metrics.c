@@ -0,0 +1,685 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2020
+ *					All rights reserved
+ *
+ *  This file is part of GPAC / filters sub-project
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include "filter_session.h"
+#include <gpac/network.h>
+
+/*
+Live metrics of a filter session.
+
+Counters are updated without locks by the thread currently running the filter (filters are never run concurrently), or by the thread
+owning the counter (session threads). Snapshots are taken under the session filters mutex, and values may be slightly out of sync between
+each other, which is acceptable for monitoring purposes.
+
+Per-packet queue times use the start time of the task run by the dispatching filter as clock rather than querying the system clock.
+This clock is owned by the filter and only accessed by the thread running it. Blocking times query the system clock.
+
+In single-threaded sessions there is no filters mutex (creating one has a significant cost), and running an extra server thread would
+slow down the whole process (the C library disables its single-thread fast paths once a thread is created). The server socket is then
+polled without blocking by the session thread in between two tasks, and requests are answered from that thread. The connection is
+non-blocking and the response is sent over several polls if needed, so that a slow client never stalls the session.
+
+The server binds to the loopback interface unless an address is given.
+*/
+
+//interval in microseconds between two polls of the server socket by the session thread
+#define METRICS_POLL_INTERVAL	20000
+//maximum time in microseconds to wait for a complete request header
+#define METRICS_REQUEST_TIMEOUT	2000000
+//size of the request header buffer
+#define METRICS_REQUEST_SIZE	2048
+
+//upper bounds in microseconds of the queue residence histogram buckets, last bucket is +Inf
+static const u32 QueueBuckets[GF_FS_METRICS_NB_BUCKETS-1] = {
+	100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000
+};
+
+static const char *TaskCategoryNames[GF_FS_TASK_CAT_COUNT] = {
+	"process", "configure", "event", "other"
+};
+
+typedef struct __gf_fs_metrics
+{
+	GF_FilterSession *fsess;
+	GF_Socket *server;
+	GF_Thread *th;
+	volatile Bool stop;
+
+	//pending connection when polled by the session thread
+	GF_Socket *conn;
+	char req[METRICS_REQUEST_SIZE];
+	u32 req_size;
+	u64 conn_time, last_poll;
+	//response being sent on the pending connection, NULL while reading the request
+	char *resp;
+	u32 resp_size, resp_sent;
+} GF_FSMetrics;
+
+static void metrics_poll(GF_FSMetrics *metrics, u64 now);
+
+static u32 gf_fs_metrics_task_category(GF_FSTask *task)
+{
+	const char *name = task->log_name;
+	if (!name) return GF_FS_TASK_OTHER;
+	//fast path for process tasks, by far the most common ones
+	if ((name[0]=='p') && (name[1]=='r') && !strcmp(name, "process")) return GF_FS_TASK_PROCESS;
+	if (!strcmp(name, "downstream_event") || !strcmp(name, "upstream_event")) return GF_FS_TASK_EVENT;
+	if (!strcmp(name, "pid_init") || !strcmp(name, "pid_connect") || !strcmp(name, "pidinst_reconfigure")
+		|| !strcmp(name, "filter reconfigure output") || !strcmp(name, "filter renegociate")
+	)
+		return GF_FS_TASK_CONFIGURE;
+	return GF_FS_TASK_OTHER;
+}
+
+void gf_fs_metrics_task_done(GF_SessionThread *sess_th, GF_FSTask *task, GF_Filter *filter, u64 task_start, u64 task_time)
+{
+	GF_FSMetrics *metrics;
+	u32 cat = gf_fs_metrics_task_category(task);
+	sess_th->cat_tasks[cat]++;
+	sess_th->cat_time[cat] += task_time;
+	if (filter)
+		filter->cat_time[cat] += task_time;
+
+	//server polled by the session thread
+	metrics = sess_th->fsess ? sess_th->fsess->metrics : NULL;
+	if (metrics && metrics->server && !metrics->th) {
+		u64 now = task_start + task_time;
+		if (now - metrics->last_poll >= METRICS_POLL_INTERVAL)
+			metrics_poll(metrics, now);
+	}
+}
+
+void gf_fs_metrics_pck_dropped(GF_FilterPidInst *pidi, u64 queue_time, u64 now)
+{
+	u32 i;
+	u64 res = (now > queue_time) ? now - queue_time : 0;
+
+	for (i=0; i<GF_FS_METRICS_NB_BUCKETS-1; i++) {
+		if (res <= QueueBuckets[i]) break;
+	}
+	pidi->queue_hist[i]++;
+	pidi->queue_time_sum += res;
+}
+
+typedef struct
+{
+	char *data;
+	u32 size, alloc;
+	GF_Err e;
+} GF_MetricsText;
+
+static void mtxt_printf(GF_MetricsText *txt, const char *fmt, ...)
+{
+	s32 len;
+	va_list args;
+	if (txt->e) return;
+
+	while (1) {
+		va_start(args, fmt);
+		len = vsnprintf(txt->data + txt->size, txt->alloc - txt->size, fmt, args);
+		va_end(args);
+		if (len<0) {
+			txt->e = GF_IO_ERR;
+			return;
+		}
+		if (txt->size + (u32) len < txt->alloc) break;
+
+		txt->alloc = 2*txt->alloc + (u32) len + 1;
+		txt->data = gf_realloc(txt->data, txt->alloc);
+		if (!txt->data) {
+			txt->e = GF_OUT_OF_MEM;
+			return;
+		}
+	}
+	txt->size += (u32) len;
+}
+
+//writes a label value, escaping as required by OpenMetrics
+static void mtxt_label(GF_MetricsText *txt, const char *label, const char *value, Bool first)
+{
+	char szEsc[256];
+	u32 i=0;
+	if (!value) value = "";
+	while (*value && (i+3<sizeof(szEsc))) {
+		char c = *value++;
+		if ((c=='\\') || (c=='"')) {
+			szEsc[i++] = '\\';
+			szEsc[i++] = c;
+		} else if (c=='\n') {
+			szEsc[i++] = '\\';
+			szEsc[i++] = 'n';
+		} else {
+			szEsc[i++] = c;
+		}
+	}
+	szEsc[i] = 0;
+	mtxt_printf(txt, "%s%s=\"%s\"", first ? "" : ",", label, szEsc);
+}
+
+static void mtxt_family(GF_MetricsText *txt, const char *name, const char *type, const char *help)
+{
+	mtxt_printf(txt, "# TYPE %s %s\n", name, type);
+	if (strstr(name, "_seconds"))
+		mtxt_printf(txt, "# UNIT %s seconds\n", name);
+	mtxt_printf(txt, "# HELP %s %s\n", name, help);
+}
+
+static const char *metrics_filter_name(GF_Filter *f)
+{
+	return f->name ? f->name : f->freg->name;
+}
+
+static void mtxt_filter_labels(GF_MetricsText *txt, GF_Filter *f, u32 idx)
+{
+	char szIdx[20];
+	sprintf(szIdx, "%u", idx);
+	mtxt_label(txt, "filter", metrics_filter_name(f), GF_TRUE);
+	mtxt_label(txt, "idx", szIdx, GF_FALSE);
+}
+
+static void mtxt_pidi_labels(GF_MetricsText *txt, GF_Filter *f, u32 idx, GF_FilterPidInst *pidi)
+{
+	mtxt_filter_labels(txt, f, idx);
+	mtxt_label(txt, "pid", pidi->pid->name, GF_FALSE);
+	mtxt_label(txt, "source", metrics_filter_name(pidi->pid->filter), GF_FALSE);
+}
+
+static void mtxt_pid_labels(GF_MetricsText *txt, GF_Filter *f, u32 idx, GF_FilterPid *pid)
+{
+	mtxt_filter_labels(txt, f, idx);
+	mtxt_label(txt, "pid", pid->name, GF_FALSE);
+}
+
+#define SEC(_us)	((Double) (_us) / 1000000)
+
+enum
+{
+	MF_TASK_TIME=0,
+	MF_TASKS,
+	MF_PCK_PROCESSED,
+	MF_BYTES_PROCESSED,
+	MF_PCK_SENT,
+	MF_BYTES_SENT,
+	MF_ERRORS,
+	MF_FILTER_LAST,
+
+	MF_QUEUE_PACKETS=MF_FILTER_LAST,
+	MF_QUEUE_DURATION,
+	MF_QUEUE_RESIDENCE,
+	MF_PIDI_LAST,
+
+	MF_PID_BUFFER=MF_PIDI_LAST,
+	MF_PID_BUFFER_MAX,
+	MF_PID_UNITS,
+	MF_PID_UNITS_MAX,
+	MF_PID_OCCUPANCY,
+	MF_PID_BLOCKED,
+	MF_PID_BLOCKS,
+	MF_PID_MEM,
+	MF_PID_SPILL,
+	MF_PID_SENT,
+	MF_LAST
+};
+
+static const struct {
+	const char *name, *type, *help;
+} MetricFamilies[MF_LAST] = {
+	{"gpac_filter_task_seconds", "counter", "Time spent running filter tasks, per task type"},
+	{"gpac_filter_tasks", "counter", "Number of tasks executed by the filter"},
+	{"gpac_filter_packets_processed", "counter", "Number of packets consumed by the filter"},
+	{"gpac_filter_bytes_processed", "counter", "Number of bytes consumed by the filter"},
+	{"gpac_filter_packets_sent", "counter", "Number of packets sent by the filter"},
+	{"gpac_filter_bytes_sent", "counter", "Number of bytes sent by the filter"},
+	{"gpac_filter_errors", "counter", "Number of processing errors of the filter"},
+	{"gpac_pid_queue_packets", "gauge", "Number of packets waiting in the input PID queue"},
+	{"gpac_pid_queue_duration_seconds", "gauge", "Media duration of packets waiting in the input PID queue"},
+	{"gpac_pid_queue_residence_seconds", "histogram", "Time spent by packets in the input PID queue before being consumed"},
+	{"gpac_pid_buffer_seconds", "gauge", "Buffered media duration of output PID in its most filled destination"},
+	{"gpac_pid_buffer_max_seconds", "gauge", "Maximum buffer duration of output PID before blocking"},
+	{"gpac_pid_buffer_units", "gauge", "Number of buffered units of output PID in its most filled destination"},
+	{"gpac_pid_buffer_max_units", "gauge", "Maximum buffered units of output PID before blocking, 0 if blocking on duration"},
+	{"gpac_pid_buffer_occupancy_ratio", "gauge", "Buffer occupancy of output PID relative to its blocking threshold"},
+	{"gpac_pid_blocked_seconds", "counter", "Time spent by output PID in blocking state"},
+	{"gpac_pid_blocks", "counter", "Number of times output PID entered blocking state"},
+	{"gpac_pid_memory_bytes", "gauge", "Memory used by packets queued on output PID, excluding packets spilled to disk"},
+	{"gpac_pid_spilled_bytes", "gauge", "Size of packets queued on output PID and spilled to disk"},
+	{"gpac_pid_packets_sent", "counter", "Number of packets sent on output PID"},
+};
+
+static void metrics_dump_filter(GF_MetricsText *txt, u32 family, GF_Filter *f, u32 idx, u64 now)
+{
+	u32 i, k;
+	const char *name = MetricFamilies[family].name;
+
+	if (family < MF_FILTER_LAST) {
+		u64 val;
+		if (family == MF_TASK_TIME) {
+			for (k=0; k<GF_FS_TASK_CAT_COUNT; k++) {
+				mtxt_printf(txt, "%s_total{", name);
+				mtxt_filter_labels(txt, f, idx);
+				mtxt_label(txt, "type", TaskCategoryNames[k], GF_FALSE);
+				mtxt_printf(txt, "} %g\n", SEC(f->cat_time[k]));
+			}
+			return;
+		}
+		switch (family) {
+		case MF_TASKS: val = f->nb_tasks_done; break;
+		case MF_PCK_PROCESSED: val = f->nb_pck_processed; break;
+		case MF_BYTES_PROCESSED: val = f->nb_bytes_processed; break;
+		case MF_PCK_SENT: val = f->nb_pck_sent; break;
+		case MF_BYTES_SENT: val = f->nb_bytes_sent; break;
+		default: val = f->nb_errors; break;
+		}
+		mtxt_printf(txt, "%s_total{", name);
+		mtxt_filter_labels(txt, f, idx);
+		mtxt_printf(txt, "} "LLU"\n", val);
+		return;
+	}
+
+	if (family < MF_PIDI_LAST) {
+		for (i=0; i<f->num_input_pids; i++) {
+			GF_FilterPidInst *pidi = gf_list_get(f->input_pids, i);
+			if (!pidi || !pidi->pid) continue;
+
+			if (family==MF_QUEUE_PACKETS) {
+				mtxt_printf(txt, "%s{", name);
+				mtxt_pidi_labels(txt, f, idx, pidi);
+				mtxt_printf(txt, "} %u\n", gf_fq_count(pidi->packets));
+			} else if (family==MF_QUEUE_DURATION) {
+				mtxt_printf(txt, "%s{", name);
+				mtxt_pidi_labels(txt, f, idx, pidi);
+				mtxt_printf(txt, "} %g\n", SEC(pidi->buffer_duration));
+			} else {
+				u64 cumul = 0;
+				for (k=0; k<GF_FS_METRICS_NB_BUCKETS; k++) {
+					cumul += pidi->queue_hist[k];
+					mtxt_printf(txt, "%s_bucket{", name);
+					mtxt_pidi_labels(txt, f, idx, pidi);
+					if (k+1<GF_FS_METRICS_NB_BUCKETS)
+						mtxt_printf(txt, ",le=\"%g\"} "LLU"\n", SEC(QueueBuckets[k]), cumul);
+					else
+						mtxt_printf(txt, ",le=\"+Inf\"} "LLU"\n", cumul);
+				}
+				mtxt_printf(txt, "%s_count{", name);
+				mtxt_pidi_labels(txt, f, idx, pidi);
+				mtxt_printf(txt, "} "LLU"\n", cumul);
+				mtxt_printf(txt, "%s_sum{", name);
+				mtxt_pidi_labels(txt, f, idx, pidi);
+				mtxt_printf(txt, "} %g\n", SEC(pidi->queue_time_sum));
+			}
+		}
+		return;
+	}
+
+	for (i=0; i<f->num_output_pids; i++) {
+		Double val;
+		Bool is_int = GF_FALSE;
+		GF_FilterPid *pid = gf_list_get(f->output_pids, i);
+		if (!pid) continue;
+
+		switch (family) {
+		case MF_PID_BUFFER: val = SEC(pid->buffer_duration); break;
+		case MF_PID_BUFFER_MAX: val = SEC(pid->max_buffer_time); break;
+		case MF_PID_UNITS: val = pid->nb_buffer_unit; is_int = GF_TRUE; break;
+		case MF_PID_UNITS_MAX: val = pid->max_buffer_unit; is_int = GF_TRUE; break;
+		case MF_PID_OCCUPANCY:
+			//same rules as gf_filter_pid_would_block
+			if (pid->max_buffer_unit) val = (Double) pid->nb_buffer_unit / pid->max_buffer_unit;
+			else if (pid->max_buffer_time) val = (Double) pid->buffer_duration / pid->max_buffer_time;
+			else val = 0;
+			break;
+		case MF_PID_BLOCKED:
+		{
+			u64 block_start = pid->block_start;
+			u64 blocked = pid->block_time;
+			if (block_start && (now > block_start)) blocked += now - block_start;
+			val = SEC(blocked);
+		}
+			break;
+		case MF_PID_BLOCKS: val = pid->nb_blocks; is_int = GF_TRUE; break;
+		case MF_PID_MEM: val = (Double) pid->mem_used; break;
+		case MF_PID_SPILL:
+		{
+			u64 spill_size = 0;
+			if (pid->spill) gf_filter_pid_get_spill_stats(pid, &spill_size, NULL, NULL);
+			val = (Double) spill_size;
+		}
+			break;
+		default: val = pid->nb_pck_sent; is_int = GF_TRUE; break;
+		}
+		mtxt_printf(txt, "%s%s{", name, !strcmp(MetricFamilies[family].type, "counter") ? "_total" : "");
+		mtxt_pid_labels(txt, f, idx, pid);
+		if (is_int) mtxt_printf(txt, "} %u\n", (u32) val);
+		else mtxt_printf(txt, "} %g\n", val);
+	}
+}
+
+static void metrics_dump_thread(GF_MetricsText *txt, GF_SessionThread *th, u32 idx, u32 family)
+{
+	u32 k;
+	char szIdx[20];
+	sprintf(szIdx, "%u", idx);
+	if (family==0) {
+		mtxt_printf(txt, "gpac_thread_active_seconds_total{");
+		mtxt_label(txt, "thread", szIdx, GF_TRUE);
+		mtxt_printf(txt, "} %g\n", SEC(th->active_time));
+		return;
+	}
+	for (k=0; k<GF_FS_TASK_CAT_COUNT; k++) {
+		mtxt_printf(txt, "%s{", (family==1) ? "gpac_thread_tasks_total" : "gpac_thread_task_seconds_total");
+		mtxt_label(txt, "thread", szIdx, GF_TRUE);
+		mtxt_label(txt, "type", TaskCategoryNames[k], GF_FALSE);
+		if (family==1) mtxt_printf(txt, "} "LLU"\n", th->cat_tasks[k]);
+		else mtxt_printf(txt, "} %g\n", SEC(th->cat_time[k]));
+	}
+}
+
+GF_EXPORT
+GF_Err gf_fs_get_metrics(GF_FilterSession *fsess, char **out_text)
+{
+	u32 i, j, count, nb_threads;
+	u64 now;
+	GF_MetricsText txt;
+	if (!fsess || !out_text) return GF_BAD_PARAM;
+	*out_text = NULL;
+	if (!fsess->metrics) return GF_NOT_SUPPORTED;
+
+	memset(&txt, 0, sizeof(GF_MetricsText));
+	txt.alloc = 16000;
+	txt.data = gf_malloc(txt.alloc);
+	if (!txt.data) return GF_OUT_OF_MEM;
+	txt.data[0] = 0;
+
+	now = gf_sys_clock_high_res();
+	gf_mx_p(fsess->filters_mx);
+	count = gf_list_count(fsess->filters);
+	//OpenMetrics requires samples of a family to be grouped
+	for (j=0; j<MF_LAST; j++) {
+		mtxt_family(&txt, MetricFamilies[j].name, MetricFamilies[j].type, MetricFamilies[j].help);
+		for (i=0; i<count; i++) {
+			GF_Filter *f = gf_list_get(fsess->filters, i);
+			if (f->multi_sink_target || f->removed || f->finalized) continue;
+
+			//lock pid lists
+			gf_mx_p(f->tasks_mx);
+			metrics_dump_filter(&txt, j, f, i, now);
+			gf_mx_v(f->tasks_mx);
+		}
+	}
+	gf_mx_v(fsess->filters_mx);
+
+	nb_threads = gf_list_count(fsess->threads);
+	for (j=0; j<3; j++) {
+		if (j==0) mtxt_family(&txt, "gpac_thread_active_seconds", "counter", "Time spent by session thread running tasks");
+		else if (j==1) mtxt_family(&txt, "gpac_thread_tasks", "counter", "Number of tasks executed by session thread, per task type");
+		else mtxt_family(&txt, "gpac_thread_task_seconds", "counter", "Time spent by session thread running tasks, per task type");
+
+		metrics_dump_thread(&txt, &fsess->main_th, 1, j);
+		for (i=0; i<nb_threads; i++) {
+			metrics_dump_thread(&txt, gf_list_get(fsess->threads, i), i+2, j);
+		}
+	}
+	mtxt_family(&txt, "gpac_session_memory_bytes", "gauge", "Memory used by packets queued in the session, excluding packets spilled to disk");
+	mtxt_printf(&txt, "gpac_session_memory_bytes "LLD"\n", fsess->pck_mem_used);
+	mtxt_family(&txt, "gpac_session_memory_peak_bytes", "gauge", "Peak memory used by packets queued in the session");
+	mtxt_printf(&txt, "gpac_session_memory_peak_bytes "LLU"\n", fsess->pck_mem_peak);
+	mtxt_family(&txt, "gpac_session_memory_cap_bytes", "gauge", "Memory cap for packets queued in the session, 0 if none");
+	mtxt_printf(&txt, "gpac_session_memory_cap_bytes "LLU"\n", fsess->sess_mem_cap);
+	mtxt_family(&txt, "gpac_session_spilled_bytes", "gauge", "Size of packets queued in the session and spilled to disk");
+	mtxt_printf(&txt, "gpac_session_spilled_bytes "LLD"\n", fsess->spill_size);
+	mtxt_printf(&txt, "# EOF\n");
+
+	if (txt.e) {
+		if (txt.data) gf_free(txt.data);
+		return txt.e;
+	}
+	*out_text = txt.data;
+	return GF_OK;
+}
+
+//builds the response to a request, szReq holding the request header
+static char *metrics_build_response(GF_FSMetrics *metrics, const char *szReq, u32 *size)
+{
+	char szHdr[400];
+	char *text = NULL;
+	char *resp;
+	u32 hdr_len, text_len;
+	GF_Err e;
+
+	if (strncmp(szReq, "GET ", 4)) {
+		sprintf(szHdr, "HTTP/1.1 405 Method Not Allowed\r\nAllow: GET\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+	} else if (strncmp(szReq+4, "/metrics", 8) && strncmp(szReq+4, "/ ", 2)) {
+		sprintf(szHdr, "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+	} else {
+		e = gf_fs_get_metrics(metrics->fsess, &text);
+		if (e) {
+			sprintf(szHdr, "HTTP/1.1 500 Internal Server Error\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+		} else {
+			sprintf(szHdr, "HTTP/1.1 200 OK\r\nContent-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\nContent-Length: %u\r\nConnection: close\r\n\r\n", (u32) strlen(text));
+		}
+	}
+	hdr_len = (u32) strlen(szHdr);
+	text_len = text ? (u32) strlen(text) : 0;
+	resp = gf_malloc(sizeof(char) * (hdr_len + text_len + 1));
+	if (resp) {
+		memcpy(resp, szHdr, hdr_len);
+		if (text_len) memcpy(resp + hdr_len, text, text_len);
+		resp[hdr_len + text_len] = 0;
+		*size = hdr_len + text_len;
+	}
+	if (text) gf_free(text);
+	return resp;
+}
+
+//answers a request from the server thread, blocking until sent
+static void metrics_respond(GF_FSMetrics *metrics, GF_Socket *conn, const char *szReq)
+{
+	GF_Err e;
+	u32 size = 0;
+	char *resp = metrics_build_response(metrics, szReq, &size);
+	if (!resp) return;
+	e = gf_sk_send(conn, resp, size);
+	if (e) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_FILTER, ("[Metrics] Failed to send response: %s\n", gf_error_to_string(e) ));
+	}
+	gf_free(resp);
+}
+
+static void metrics_close_conn(GF_FSMetrics *metrics)
+{
+	if (metrics->conn) gf_sk_del(metrics->conn);
+	metrics->conn = NULL;
+	if (metrics->resp) gf_free(metrics->resp);
+	metrics->resp = NULL;
+}
+
+//reads available request data, returns GF_TRUE if the request header is complete or cannot be completed
+static Bool metrics_read_request(GF_Socket *conn, char *szReq, u32 *size)
+{
+	u32 read;
+	GF_Err e = gf_sk_receive_wait(conn, szReq + *size, METRICS_REQUEST_SIZE - 1 - *size, &read, 0);
+	if ((e == GF_IP_NETWORK_EMPTY) || (e == GF_IP_SOCK_WOULD_BLOCK)) return GF_FALSE;
+	if (e || !read) return GF_TRUE;
+	*size += read;
+	szReq[*size] = 0;
+	if (strstr(szReq, "\r\n\r\n") || (*size + 1 == METRICS_REQUEST_SIZE)) return GF_TRUE;
+	return GF_FALSE;
+}
+
+static u32 metrics_server_run(void *par)
+{
+	GF_FSMetrics *metrics = (GF_FSMetrics *)par;
+	while (!metrics->stop) {
+		u64 start;
+		u32 size = 0;
+		GF_Socket *conn = NULL;
+		//accept and receive block in select for at most the socket wait time
+		GF_Err e = gf_sk_accept(metrics->server, &conn);
+		if (e==GF_IP_NETWORK_EMPTY) continue;
+		if (e || !conn) {
+			gf_sleep(10);
+			continue;
+		}
+		//get request header, we only need the request line but read the entire header
+		metrics->req[0] = 0;
+		start = gf_sys_clock_high_res();
+		while (!metrics->stop && (gf_sys_clock_high_res() - start < METRICS_REQUEST_TIMEOUT)) {
+			if (metrics_read_request(conn, metrics->req, &size)) break;
+		}
+		metrics_respond(metrics, conn, metrics->req);
+		gf_sk_del(conn);
+	}
+	return 0;
+}
+
+//polls the server socket from the session thread without blocking
+static void metrics_poll(GF_FSMetrics *metrics, u64 now)
+{
+	GF_Err e;
+	u32 written;
+	metrics->last_poll = now;
+	if (!metrics->conn) {
+		e = gf_sk_accept(metrics->server, &metrics->conn);
+		if (e || !metrics->conn) {
+			metrics->conn = NULL;
+			return;
+		}
+		gf_sk_set_usec_wait(metrics->conn, 0);
+		gf_sk_set_block_mode(metrics->conn, GF_TRUE);
+		metrics->req[0] = 0;
+		metrics->req_size = 0;
+		metrics->conn_time = now;
+	}
+	//client too slow to send its request or to read the response, drop it
+	if (now - metrics->conn_time >= METRICS_REQUEST_TIMEOUT) {
+		if (metrics->resp) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_FILTER, ("[Metrics] Client too slow, dropping connection after %u/%u bytes\n", metrics->resp_sent, metrics->resp_size));
+			metrics_close_conn(metrics);
+			return;
+		}
+	} else if (!metrics->resp && !metrics_read_request(metrics->conn, metrics->req, &metrics->req_size)) {
+		return;
+	}
+	if (!metrics->resp) {
+		metrics->resp_sent = 0;
+		metrics->resp = metrics_build_response(metrics, metrics->req, &metrics->resp_size);
+		if (!metrics->resp) {
+			metrics_close_conn(metrics);
+			return;
+		}
+		//allow the same time to read the response as to send the request
+		metrics->conn_time = now;
+	}
+	//send what the socket accepts and resume at next poll
+	e = gf_sk_send_ex(metrics->conn, metrics->resp + metrics->resp_sent, metrics->resp_size - metrics->resp_sent, &written);
+	metrics->resp_sent += written;
+	if ((e == GF_IP_SOCK_WOULD_BLOCK) || (e == GF_IP_NETWORK_EMPTY)) return;
+	if (e) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_FILTER, ("[Metrics] Failed to send response: %s\n", gf_error_to_string(e) ));
+	} else if (metrics->resp_sent < metrics->resp_size) {
+		return;
+	}
+	metrics_close_conn(metrics);
+}
+
+GF_EXPORT
+GF_Err gf_fs_enable_metrics(GF_FilterSession *fsess, const char *server_address)
+{
+	GF_FSMetrics *metrics;
+	if (!fsess) return GF_BAD_PARAM;
+	if (fsess->metrics) return GF_OK;
+
+	GF_SAFEALLOC(metrics, GF_FSMetrics);
+	if (!metrics) return GF_OUT_OF_MEM;
+	metrics->fsess = fsess;
+
+	if (server_address) {
+		GF_Err e;
+		char szIP[GF_MAX_IP_NAME_LEN];
+		const char *ip = NULL;
+		u32 port;
+		char *sep = strrchr(server_address, ':');
+		if (sep) {
+			u32 len = (u32) (sep - server_address);
+			if (len >= GF_MAX_IP_NAME_LEN) len = GF_MAX_IP_NAME_LEN-1;
+			strncpy(szIP, server_address, len);
+			szIP[len] = 0;
+			if (szIP[0]) ip = szIP;
+			port = atoi(sep+1);
+		} else {
+			port = atoi(server_address);
+		}
+		//metrics expose the session graph, only serve them locally unless an address is given
+		if (!ip) ip = "127.0.0.1";
+		if (!port || (port>0xFFFF)) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("[Metrics] Invalid server address %s, expecting [IP:]port\n", server_address));
+			gf_free(metrics);
+			return GF_BAD_PARAM;
+		}
+		metrics->server = gf_sk_new(GF_SOCK_TYPE_TCP);
+		e = metrics->server ? GF_OK : GF_IP_NETWORK_FAILURE;
+		if (!e) e = gf_sk_bind(metrics->server, ip, (u16) port, NULL, 0, GF_SOCK_REUSE_PORT);
+		if (!e) e = gf_sk_listen(metrics->server, 4);
+		if (e) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("[Metrics] Failed to start server on port %d: %s\n", port, gf_error_to_string(e) ));
+			if (metrics->server) gf_sk_del(metrics->server);
+			gf_free(metrics);
+			return e;
+		}
+		fsess->metrics = metrics;
+		//no extra thread in the session, poll the server from the session thread
+		if (!fsess->filters_mx) {
+			gf_sk_set_usec_wait(metrics->server, 0);
+		} else {
+			//accept and receive timeout, used to check for exit
+			gf_sk_set_usec_wait(metrics->server, 100000);
+			metrics->th = gf_th_new("FSMetrics");
+			e = metrics->th ? gf_th_run(metrics->th, metrics_server_run, metrics) : GF_OUT_OF_MEM;
+			if (e) {
+				gf_fs_metrics_del(fsess);
+				return e;
+			}
+		}
+		GF_LOG(GF_LOG_INFO, GF_LOG_FILTER, ("[Metrics] Serving session metrics on %s:%d/metrics\n", ip, port));
+		return GF_OK;
+	}
+	fsess->metrics = metrics;
+	return GF_OK;
+}
+
+void gf_fs_metrics_del(GF_FilterSession *fsess)
+{
+	GF_FSMetrics *metrics = fsess->metrics;
+	if (!metrics) return;
+	if (metrics->th) {
+		metrics->stop = GF_TRUE;
+		gf_th_stop(metrics->th);
+		gf_th_del(metrics->th);
+	}
+	metrics_close_conn(metrics);
+	if (metrics->server) gf_sk_del(metrics->server);
+	gf_free(metrics);
+	fsess->metrics = NULL;
+}
@@ -34,6 +34,8 @@ static void gf_filter_pck_reset_props(GF_FilterPacket *pck, GF_FilterPid *pid)
 	pck->pid = pid;
 	pck->src_filter = pid->filter;
 	pck->session = pid->filter->session;
+	pck->mem_tracked = GF_FALSE;
+	pck->spill_chunk = NULL;
 }
 
 GF_EXPORT
@@ -491,6 +493,9 @@ void gf_filter_packet_destroy(GF_FilterPacket *pck)
 		GF_LOG(GF_LOG_DEBUG, GF_LOG_FILTER, ("Filter %s PID %s has %d shared packets out\n", pck->pid->filter->name, pck->pid->name, pck->pid->nb_shared_packets_out));
 	}
 
+	if (pck->mem_tracked || pck->spill_chunk)
+		gf_filter_pck_mem_release(pck);
+
 	pck->data_length = 0;
 	pck->pid = NULL;
 
@@ -934,6 +939,9 @@ GF_Err gf_filter_pck_send_internal(GF_FilterPacket *pck, Bool from_filter)
 		GF_LOG(GF_LOG_DEBUG, GF_LOG_FILTER, ("Filter %s PID %s sent clock reference "LLU"%s\n", pck->pid->filter->name, pck->pid->name, pck->info.cts, (cktype==GF_FILTER_CLOCK_PCR_DISC) ? " - discontinuity detected" : ""));
 	}
 
+	//account packet memory and spill payload to disk if needed, before the packet is visible to destinations
+	if (!cktype && !(pck->info.flags & GF_PCK_CMD_MASK))
+		gf_filter_pid_track_packet(pid, pck);
 
 
 	//protect packet from destruction - this could happen
@@ -988,6 +996,10 @@ GF_Err gf_filter_pck_send_internal(GF_FilterPacket *pck, Bool from_filter)
 		inst->pid = dst;
 		inst->pid_props_change_done = 0;
 		inst->pid_info_change_done = 0;
+		//packets are dispatched by the filter being run on this thread, use its task clock
+		inst->queue_time = dst->filter->session->metrics ? pck->pid->filter->metrics_clock : 0;
+		if (dst->filter->session->trace)
+			gf_fs_trace_pck(pck->pid->filter, inst, GF_TRUE);
 		//if packet is an openGL interface, force scheduling on main thread for the destination
 		if (pck->frame_ifce&&pck->frame_ifce->get_gl_texture)
 			dst->filter->main_thread_forced = GF_TRUE;
@@ -1244,6 +1256,8 @@ const u8 *gf_filter_pck_get_data(GF_FilterPacket *pck, u32 *size)
 	assert(size);
 	//get true packet pointer
 	pck=pck->pck;
+	if (pck->spill_chunk)
+		gf_filter_pck_spill_load(pck);
 	*size = pck->data_length;
 	return (const char *)pck->data;
 }
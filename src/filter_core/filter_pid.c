@@ -126,6 +126,14 @@ static void gf_filter_pid_check_unblock(GF_FilterPid *pid)
 		assert(pid->would_block);
 		safe_int_dec(&pid->would_block);
 
+		if (pid->block_start) {
+			//unblocking may be triggered from any thread, blocking episodes are rare enough to query the clock
+			u64 now = gf_sys_clock_high_res();
+			if (now > pid->block_start)
+				pid->block_time += now - pid->block_start;
+			pid->block_start = 0;
+		}
+
 		assert(pid->filter->would_block);
 		safe_int_dec(&pid->filter->would_block);
 		assert((s32)pid->filter->would_block>=0);
@@ -2260,6 +2268,132 @@ static s32 gf_filter_reg_get_bundle_stream_type(const GF_FilterRegister *freg, u
 	return 0;
 }
 
+static GF_FilterRegEdge *gf_filter_reg_desc_new_edge(GF_FilterRegDesc *reg_desc)
+{
+	GF_FilterRegEdge *edge;
+	if (reg_desc->nb_edges==reg_desc->nb_alloc_edges) {
+		reg_desc->nb_alloc_edges += 10;
+		reg_desc->edges = gf_realloc(reg_desc->edges, sizeof(GF_FilterRegEdge) * reg_desc->nb_alloc_edges);
+	}
+	edge = &reg_desc->edges[reg_desc->nb_edges];
+	memset(edge, 0, sizeof(GF_FilterRegEdge));
+	reg_desc->nb_edges++;
+	return edge;
+}
+
+/*computes input edges of a register descriptor created with pending edges by gf_filter_sess_build_graph.
+Edge order matters for dijkstra tie-breaking, and is the one obtained by inserting registers one by one in the graph:
+- edges from registers before this one in the graph are created iterating on source bundles first
+- edges from registers after this one are created iterating on destination bundles first, with loaded filter flags not inverted
+*/
+static void gf_filter_reg_desc_load_edges(GF_FilterSession *fsess, GF_FilterRegDesc *reg_desc, GF_CapsBundleStore *capstore)
+{
+	u32 i, k, l, nb_regs, nb_dst_caps;
+	Bool src_before = GF_TRUE;
+	const GF_FilterRegister *freg = reg_desc->freg;
+
+	reg_desc->edges_pending = GF_FALSE;
+	nb_dst_caps = gf_filter_caps_bundle_count(freg->caps, freg->nb_caps);
+
+	nb_regs = gf_list_count(fsess->links);
+	for (i=0; i<nb_regs; i++) {
+		u32 nb_src_caps, nb_k, nb_l;
+		GF_FilterRegDesc *a_reg = gf_list_get(fsess->links, i);
+		if (a_reg == reg_desc) {
+			src_before = GF_FALSE;
+			continue;
+		}
+		if (a_reg->freg == freg) continue;
+		if (!gf_filter_has_out_caps(a_reg->freg->caps, a_reg->freg->nb_caps)) continue;
+
+		nb_src_caps = gf_filter_caps_bundle_count(a_reg->freg->caps, a_reg->freg->nb_caps);
+		nb_k = src_before ? nb_src_caps : nb_dst_caps;
+		nb_l = src_before ? nb_dst_caps : nb_src_caps;
+		for (k=0; k<nb_k; k++) {
+			for (l=0; l<nb_l; l++) {
+				GF_FilterRegEdge *edge;
+				u32 path_weight, bundle_idx=0;
+				u32 loaded_filter_only_flags = 0;
+				u32 src_cap_idx = src_before ? k : l;
+				u32 dst_cap_idx = src_before ? l : k;
+
+				path_weight = gf_filter_caps_to_caps_match(a_reg->freg, src_cap_idx, freg, NULL, &bundle_idx, dst_cap_idx, &loaded_filter_only_flags, capstore);
+				if (!path_weight || (bundle_idx != dst_cap_idx)) continue;
+
+				edge = gf_filter_reg_desc_new_edge(reg_desc);
+				edge->src_reg = a_reg;
+				edge->weight = (u8) path_weight;
+				edge->src_cap_idx = (u16) src_cap_idx;
+				edge->dst_cap_idx = (u16) dst_cap_idx;
+				if (src_before) {
+					//we inverted the caps, invert the flags
+					if (loaded_filter_only_flags & EDGE_LOADED_SOURCE_ONLY)
+						edge->loaded_filter_only |= EDGE_LOADED_DEST_ONLY;
+					if (loaded_filter_only_flags & EDGE_LOADED_DEST_ONLY)
+						edge->loaded_filter_only |= EDGE_LOADED_SOURCE_ONLY;
+				} else {
+					edge->loaded_filter_only = loaded_filter_only_flags;
+				}
+				edge->src_stream_type = gf_filter_reg_get_bundle_stream_type(a_reg->freg, src_cap_idx, GF_TRUE);
+			}
+		}
+	}
+}
+
+void gf_filter_sess_load_graph_edges(GF_FilterSession *fsess)
+{
+	u32 i, count;
+	GF_CapsBundleStore capstore;
+	memset(&capstore, 0, sizeof(GF_CapsBundleStore));
+
+	count = fsess->links ? gf_list_count(fsess->links) : 0;
+	for (i=0; i<count; i++) {
+		GF_FilterRegDesc *reg_desc = gf_list_get(fsess->links, i);
+		if (reg_desc->edges_pending)
+			gf_filter_reg_desc_load_edges(fsess, reg_desc, &capstore);
+	}
+	if (capstore.bundles_cap_found) gf_free(capstore.bundles_cap_found);
+	if (capstore.bundles_in_ok) gf_free(capstore.bundles_in_ok);
+	if (capstore.bundles_in_scores) gf_free(capstore.bundles_in_scores);
+}
+
+//reset edge status of a register descriptor before link resolution
+static void gf_filter_reg_desc_reset_edges(GF_FilterRegDesc *reg_desc, GF_FilterPid *pid, u32 *max_weight)
+{
+	u32 j;
+	for (j=0; j<reg_desc->nb_edges; j++) {
+		GF_FilterRegEdge *edge = &reg_desc->edges[j];
+
+		edge->disabled_depth = 0;
+		if (reg_desc->resolve_disabled) {
+			edge->status = EDGE_STATUS_DISABLED;
+			continue;
+		}
+		edge->status = EDGE_STATUS_NONE;
+
+		//connection from source, disable edge if pid caps mismatch
+		if (edge->src_reg->freg == pid->filter->freg) {
+			u8 priority=0;
+			u32 dst_bundle_idx;
+			//check path weight for the given dst cap - we MUST give the target cap otherwise we might get a default match to another cap
+			u32 path_weight = gf_filter_pid_caps_match(pid, reg_desc->freg, NULL, &priority, &dst_bundle_idx, pid->filter->dst_filter, edge->dst_cap_idx);
+			if (!path_weight) {
+				edge->status = EDGE_STATUS_DISABLED;
+				continue;
+			}
+		}
+
+		//if source is not edge origin and edge is only valid for explicitly loaded filters, disable edge
+		if ((edge->loaded_filter_only & EDGE_LOADED_SOURCE_ONLY) && (edge->src_reg->freg != pid->filter->freg) ) {
+			edge->status = EDGE_STATUS_DISABLED;
+			continue;
+		}
+
+		if ((u32) edge->weight + 1 > *max_weight)
+			*max_weight = (u32) edge->weight + 1;
+	}
+}
+
 /*recursively enable edges of the graph.
 	returns 0 if subgraph shall be disabled (will marke edge at the root of the subgraph disabled)
 	returns 1 if subgraph shall be enabled (will marke edge at the root of the subgraph enabled)
@@ -2292,6 +2426,18 @@ static u32 gf_filter_pid_enable_edges(GF_FilterSession *fsess, GF_FilterRegDesc
 	if ((rlevel>1) && (dst_stream_type==GF_STREAM_FILE))
 		return 0;
 
+	//first time this filter is reached, compute its input edges and reset them as done for the other filters
+	if (reg_desc->edges_pending) {
+		u32 max_weight=0;
+		GF_CapsBundleStore capstore;
+		memset(&capstore, 0, sizeof(GF_CapsBundleStore));
+		gf_filter_reg_desc_load_edges(fsess, reg_desc, &capstore);
+		gf_filter_reg_desc_reset_edges(reg_desc, pid, &max_weight);
+		if (capstore.bundles_cap_found) gf_free(capstore.bundles_cap_found);
+		if (capstore.bundles_in_ok) gf_free(capstore.bundles_in_ok);
+		if (capstore.bundles_in_scores) gf_free(capstore.bundles_in_scores);
+	}
+
 	reg_desc->in_edges_enabling = 1;
 
 	for (i=0; i<reg_desc->nb_edges; i++) {
@@ -2383,10 +2529,10 @@ static u32 gf_filter_pid_enable_edges(GF_FilterSession *fsess, GF_FilterRegDesc
 }
 
 
-static GF_FilterRegDesc *gf_filter_reg_build_graph(GF_List *links, const GF_FilterRegister *freg, GF_CapsBundleStore *capstore, GF_FilterPid *src_pid, GF_Filter *dst_filter)
+//builds the register descriptor of the destination filter for link resolution, with input edges from the given register descriptors
+static GF_FilterRegDesc *gf_filter_reg_build_graph(GF_List *links, const GF_FilterRegister *freg, GF_CapsBundleStore *capstore, GF_Filter *dst_filter)
 {
 	u32 nb_dst_caps, nb_regs, i, nb_caps;
-	Bool freg_has_output;
 
 	GF_FilterRegDesc *reg_desc = NULL;
 	const GF_FilterCapability *caps = freg->caps;
@@ -2396,8 +2542,6 @@ static GF_FilterRegDesc *gf_filter_reg_build_graph(GF_List *links, const GF_Filt
 		nb_caps = dst_filter->nb_forced_caps;
 	}
 
-	freg_has_output = gf_filter_has_out_caps(caps, nb_caps);
-
 	GF_SAFEALLOC(reg_desc, GF_FilterRegDesc);
 	if (!reg_desc) return NULL;
 
@@ -2405,10 +2549,6 @@ static GF_FilterRegDesc *gf_filter_reg_build_graph(GF_List *links, const GF_Filt
 
 	nb_dst_caps = gf_filter_caps_bundle_count(caps, nb_caps);
 
-
-	//we are building a register descriptor acting as destination, ignore any output caps
-	if (src_pid || dst_filter) freg_has_output = GF_FALSE;
-
 	//setup all connections
 	nb_regs = gf_list_count(links);
 	for (i=0; i<nb_regs; i++) {
@@ -2416,85 +2556,64 @@ static GF_FilterRegDesc *gf_filter_reg_build_graph(GF_List *links, const GF_Filt
 		u32 path_weight;
 		GF_FilterRegDesc *a_reg = gf_list_get(links, i);
 		if (a_reg->freg == freg) continue;
+		if (!gf_filter_has_out_caps(a_reg->freg->caps, a_reg->freg->nb_caps)) continue;
 
 		//check which cap of this filter matches our destination
 		nb_src_caps = gf_filter_caps_bundle_count(a_reg->freg->caps, a_reg->freg->nb_caps);
 		for (k=0; k<nb_src_caps; k++) {
 			for (l=0; l<nb_dst_caps; l++) {
-				s32 bundle_idx;
-
-				if (gf_filter_has_out_caps(a_reg->freg->caps, a_reg->freg->nb_caps)) {
-					u32 loaded_filter_only_flags = 0;
-
-					path_weight = gf_filter_caps_to_caps_match(a_reg->freg, k, (const GF_FilterRegister *) freg, dst_filter, &bundle_idx, l, &loaded_filter_only_flags, capstore);
-
-					if (path_weight && (bundle_idx == l)) {
-						GF_FilterRegEdge *edge;
-						if (reg_desc->nb_edges==reg_desc->nb_alloc_edges) {
-							reg_desc->nb_alloc_edges += 10;
-							reg_desc->edges = gf_realloc(reg_desc->edges, sizeof(GF_FilterRegEdge) * reg_desc->nb_alloc_edges);
-						}
-						assert(path_weight<0xFF);
-						assert(k<0xFFFF);
-						assert(l<0xFFFF);
-						edge = &reg_desc->edges[reg_desc->nb_edges];
-						memset(edge, 0, sizeof(GF_FilterRegEdge));
-						edge->src_reg = a_reg;
-						edge->weight = (u8) path_weight;
-						edge->src_cap_idx = (u16) k;
-						edge->dst_cap_idx = (u16) l;
-
-						//we inverted the caps, invert the flags
-						if (loaded_filter_only_flags & EDGE_LOADED_SOURCE_ONLY)
-							edge->loaded_filter_only |= EDGE_LOADED_DEST_ONLY;
-						if (loaded_filter_only_flags & EDGE_LOADED_DEST_ONLY)
-							edge->loaded_filter_only |= EDGE_LOADED_SOURCE_ONLY;
-					 	edge->src_stream_type = gf_filter_reg_get_bundle_stream_type(edge->src_reg->freg, edge->src_cap_idx, GF_TRUE);
-						reg_desc->nb_edges++;
-					}
-				}
-
-				if ( freg_has_output ) {
-					u32 loaded_filter_only_flags = 0;
-
-					path_weight = gf_filter_caps_to_caps_match(freg, l, a_reg->freg, dst_filter, &bundle_idx, k, &loaded_filter_only_flags, capstore);
-
-					if (path_weight && (bundle_idx == k)) {
-						GF_FilterRegEdge *edge;
-						if (a_reg->nb_edges==a_reg->nb_alloc_edges) {
-							a_reg->nb_alloc_edges += 10;
-							a_reg->edges = gf_realloc(a_reg->edges, sizeof(GF_FilterRegEdge) * a_reg->nb_alloc_edges);
-						}
-						edge = &a_reg->edges[a_reg->nb_edges];
-						edge->src_reg = reg_desc;
-						edge->weight = (u8) path_weight;
-						edge->src_cap_idx = (u16) l;
-						edge->dst_cap_idx = (u16) k;
-						edge->priority = 0;
-						edge->loaded_filter_only = loaded_filter_only_flags;
-					 	edge->src_stream_type = gf_filter_reg_get_bundle_stream_type(edge->src_reg->freg, edge->src_cap_idx, GF_TRUE);
-						a_reg->nb_edges++;
-					}
-				}
+				u32 bundle_idx=0;
+				u32 loaded_filter_only_flags = 0;
+				GF_FilterRegEdge *edge;
+
+				path_weight = gf_filter_caps_to_caps_match(a_reg->freg, k, (const GF_FilterRegister *) freg, dst_filter, &bundle_idx, l, &loaded_filter_only_flags, capstore);
+
+				if (!path_weight || (bundle_idx != l)) continue;
+
+				assert(path_weight<0xFF);
+				assert(k<0xFFFF);
+				assert(l<0xFFFF);
+				edge = gf_filter_reg_desc_new_edge(reg_desc);
+				edge->src_reg = a_reg;
+				edge->weight = (u8) path_weight;
+				edge->src_cap_idx = (u16) k;
+				edge->dst_cap_idx = (u16) l;
+
+				//we inverted the caps, invert the flags
+				if (loaded_filter_only_flags & EDGE_LOADED_SOURCE_ONLY)
+					edge->loaded_filter_only |= EDGE_LOADED_DEST_ONLY;
+				if (loaded_filter_only_flags & EDGE_LOADED_DEST_ONLY)
+					edge->loaded_filter_only |= EDGE_LOADED_SOURCE_ONLY;
+				edge->src_stream_type = gf_filter_reg_get_bundle_stream_type(edge->src_reg->freg, edge->src_cap_idx, GF_TRUE);
 			}
 		}
 	}
 	return reg_desc;
 }
 
+/*builds the filter registry graph. Only register descriptors are created, their input edges are computed the first time
+they are needed for link resolution (cf gf_filter_pid_enable_edges), which avoids checking the caps of all register pairs at startup*/
 void gf_filter_sess_build_graph(GF_FilterSession *fsess, const GF_FilterRegister *for_reg)
 {
 	u32 i, count;
-	GF_CapsBundleStore capstore;
-	memset(&capstore, 0, sizeof(GF_CapsBundleStore));
+	GF_FilterRegDesc *freg_desc;
 
 	if (!fsess->links) fsess->links = gf_list_new();
 
 	if (for_reg) {
-		GF_FilterRegDesc *freg_desc = gf_filter_reg_build_graph(fsess->links, for_reg, &capstore, NULL, NULL);
+		//already computed edges do not include the new register, recompute them when needed
+		count = gf_list_count(fsess->links);
+		for (i=0; i<count; i++) {
+			freg_desc = gf_list_get(fsess->links, i);
+			freg_desc->nb_edges = 0;
+			freg_desc->edges_pending = GF_TRUE;
+		}
+		GF_SAFEALLOC(freg_desc, GF_FilterRegDesc);
 		if (!freg_desc) {
 			GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("Failed to build graph entry for filter %s\n", for_reg->name));
 		} else {
+			freg_desc->freg = for_reg;
+			freg_desc->edges_pending = GF_TRUE;
 			gf_list_add(fsess->links, freg_desc);
 		}
 	} else {
@@ -2504,10 +2623,12 @@ void gf_filter_sess_build_graph(GF_FilterSession *fsess, const GF_FilterRegister
 		count = gf_list_count(fsess->registry);
 		for (i=0; i<count; i++) {
 			const GF_FilterRegister *freg = gf_list_get(fsess->registry, i);
-			GF_FilterRegDesc *freg_desc = gf_filter_reg_build_graph(fsess->links, freg, &capstore, NULL, NULL);
+			GF_SAFEALLOC(freg_desc, GF_FilterRegDesc);
 			if (!freg_desc) {
 				GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("Failed to build graph entry for filter %s\n", freg->name));
 			} else {
+				freg_desc->freg = freg;
+				freg_desc->edges_pending = GF_TRUE;
 				gf_list_add(fsess->links, freg_desc);
 			}
 		}
@@ -2515,9 +2636,10 @@ void gf_filter_sess_build_graph(GF_FilterSession *fsess, const GF_FilterRegister
 
 		if (fsess->flags & GF_FS_FLAG_PRINT_CONNECTIONS) {
 			u32 j;
+			gf_filter_sess_load_graph_edges(fsess);
 			count = gf_list_count(fsess->links);
 			for (i=0; i<count; i++) {
-				GF_FilterRegDesc *freg_desc = gf_list_get(fsess->links, i);
+				freg_desc = gf_list_get(fsess->links, i);
 				GF_LOG(GF_LOG_DEBUG, GF_LOG_FILTER, ("Filter %s sources:", freg_desc->freg->name));
 				for (j=0; j<freg_desc->nb_edges; j++ ) {
 					GF_LOG(GF_LOG_DEBUG, GF_LOG_FILTER, (" %s(%d,%d->%d)", freg_desc->edges[j].src_reg->freg->name, freg_desc->edges[j].weight, freg_desc->edges[j].src_cap_idx, freg_desc->edges[j].dst_cap_idx));
@@ -2526,9 +2648,6 @@ void gf_filter_sess_build_graph(GF_FilterSession *fsess, const GF_FilterRegister
 			}
 		}
 	}
-	if (capstore.bundles_cap_found) gf_free(capstore.bundles_cap_found);
-	if (capstore.bundles_in_ok) gf_free(capstore.bundles_in_ok);
-	if (capstore.bundles_in_scores) gf_free(capstore.bundles_in_scores);
 }
 
 void gf_filter_sess_reset_graph(GF_FilterSession *fsess, const GF_FilterRegister *freg)
@@ -2613,6 +2732,11 @@ static void gf_filter_pid_resolve_link_dijkstra(GF_FilterPid *pid, GF_Filter *ds
 	u32 path_weight, pid_stream_type, max_weight=0;
 	u64 dijkstra_time_us, sort_time_us, start_time_us = gf_sys_clock_high_res();
 	const GF_PropertyValue *p;
+	char *cache_key = NULL;
+
+	if (fsess->graph_cache && gf_fs_graph_cache_get_chain(pid, dst, prefRegister, reconfigurable_only, out_reg_chain, &cache_key))
+		return;
+
 	if (!fsess->links || ! gf_list_count( fsess->links))
 	 	gf_filter_sess_build_graph(fsess, NULL);
 
@@ -2627,7 +2751,6 @@ static void gf_filter_pid_resolve_link_dijkstra(GF_FilterPid *pid, GF_Filter *ds
 	//1: select all elligible filters for the graph resolution: exclude sources, sinks, explicits, blacklisted and not reconfigurable if we reconfigure
 	count = gf_list_count(fsess->links);
 	for (i=0; i<count; i++) {
-		u32 j;
 		Bool disable_filter = GF_FALSE;
 		GF_FilterRegDesc *reg_desc = gf_list_get(fsess->links, i);
 		const GF_FilterRegister *freg = reg_desc->freg;
@@ -2679,37 +2802,9 @@ static void gf_filter_pid_resolve_link_dijkstra(GF_FilterPid *pid, GF_Filter *ds
 		}
 
 		//reset edge status
-		for (j=0; j<reg_desc->nb_edges; j++) {
-			GF_FilterRegEdge *edge = &reg_desc->edges[j];
+		reg_desc->resolve_disabled = disable_filter;
+		gf_filter_reg_desc_reset_edges(reg_desc, pid, &max_weight);
 
-			edge->disabled_depth = 0;
-			if (disable_filter) {
-				edge->status = EDGE_STATUS_DISABLED;
-				continue;
-			}
-			edge->status = EDGE_STATUS_NONE;
-
-			//connection from source, disable edge if pid caps mismatch
-			if (edge->src_reg->freg == pid->filter->freg) {
-				u8 priority=0;
-				u32 dst_bundle_idx;
-				//check path weight for the given dst cap - we MUST give the target cap otherwise we might get a default match to another cap
-				path_weight = gf_filter_pid_caps_match(pid, freg, NULL, &priority, &dst_bundle_idx, pid->filter->dst_filter, edge->dst_cap_idx);
-				if (!path_weight) {
-					edge->status = EDGE_STATUS_DISABLED;
-					continue;
-				}
-			}
-
-			//if source is not edge origin and edge is only valid for explicitly loaded filters, disable edge
-			if ((edge->loaded_filter_only & EDGE_LOADED_SOURCE_ONLY) && (edge->src_reg->freg != pid->filter->freg) ) {
-				edge->status = EDGE_STATUS_DISABLED;
-				continue;
-			}
-
-			if ((u32) edge->weight + 1 > max_weight)
-				max_weight = (u32) edge->weight + 1;
-		}
 		//not in set
 		if (disable_filter)
 			continue;
@@ -2725,7 +2820,7 @@ static void gf_filter_pid_resolve_link_dijkstra(GF_FilterPid *pid, GF_Filter *ds
 	}
 	//create a new node for the destination based on elligible filters in the graph
 	memset(&capstore, 0, sizeof(GF_CapsBundleStore));
-	reg_dst = gf_filter_reg_build_graph(dijkstra_nodes, dst->freg, &capstore, pid, dst);
+	reg_dst = gf_filter_reg_build_graph(dijkstra_nodes, dst->freg, &capstore, dst);
 	reg_dst->dist = 0;
 	reg_dst->priority = 0;
 	reg_dst->in_edges_enabling = 0;
@@ -2920,6 +3015,9 @@ static void gf_filter_pid_resolve_link_dijkstra(GF_FilterPid *pid, GF_Filter *ds
 	} else {
 		GF_LOG(GF_LOG_INFO, GF_LOG_FILTER, ("[Filters] Dijkstra: no results found!\n"));
 	}
+	if (cache_key)
+		gf_fs_graph_cache_add_chain(fsess, cache_key, out_reg_chain);
+
 	gf_list_del(dijkstra_nodes);
 
 	gf_free(reg_dst->edges);
@@ -4232,6 +4330,7 @@ void gf_filter_pid_del(GF_FilterPid *pid)
 			gf_props_del(pid->infos);
 		}
 	}
+	gf_filter_pid_spill_del(pid);
 	if (pid->name) gf_free(pid->name);
 	gf_free(pid);
 }
@@ -4859,6 +4958,10 @@ GF_FilterPacket *gf_filter_pid_get_packet(GF_FilterPid *pid)
 	}
 	pcki->pid->is_end_of_stream = GF_FALSE;
 
+	//payload spilled to disk, reload it and the next spilled packets
+	if (pcki->pck->spill_chunk)
+		gf_filter_pid_spill_readahead(pidinst, pcki);
+
 	if ( (pcki->pck->info.flags & GF_PCKF_PROPS_CHANGED) && !pcki->pid_props_change_done) {
 		GF_Err e;
 		Bool skip_props = GF_FALSE;
@@ -4988,10 +5091,11 @@ Bool gf_filter_pid_first_packet_is_empty(GF_FilterPid *pid)
 }
 
 
-static void gf_filter_pidinst_update_stats(GF_FilterPidInst *pidi, GF_FilterPacket *pck)
+static void gf_filter_pidinst_update_stats(GF_FilterPidInst *pidi, GF_FilterPacket *pck, u64 queue_time)
 {
 	u64 now = gf_sys_clock_high_res();
 	u64 dec_time = now - pidi->last_pck_fetch_time;
+	if (queue_time) gf_fs_metrics_pck_dropped(pidi, queue_time, now);
 	if (pck->info.flags & GF_PCK_CMD_MASK) return;
 	if (!pidi->filter || pidi->pid->filter->removed) return;
 
@@ -5118,7 +5222,10 @@ void gf_filter_pid_drop_packet(GF_FilterPid *pid)
 	//move to source pid
 	pid = pid->pid;
 
-	gf_filter_pidinst_update_stats(pidinst, pck);
+	gf_filter_pidinst_update_stats(pidinst, pck, pcki->queue_time);
+	if (pidinst->filter && pidinst->filter->session->trace)
+		gf_fs_trace_pck(pidinst->filter, pcki, GF_FALSE);
+
 	if (pck->info.cts!=GF_FILTER_NO_TS) {
 		pidinst->last_ts_drop.num = pck->info.cts;
 		pidinst->last_ts_drop.den = pck->pid_props->timescale;
@@ -5345,6 +5452,11 @@ Bool gf_filter_pid_would_block(GF_FilterPid *pid)
 		safe_int_inc(&pid->filter->would_block);
 		assert(pid->filter->would_block + pid->filter->num_out_pids_not_connected <= pid->filter->num_output_pids);
 
+		if (pid->filter->session->metrics) {
+			pid->block_start = gf_sys_clock_high_res();
+			pid->nb_blocks++;
+		}
+
 #ifndef GPAC_DISABLE_LOG
 		if (gf_log_tool_level_on(GF_LOG_FILTER, GF_LOG_DEBUG)) {
 			if (pid->max_buffer_unit) {
@@ -6024,6 +6136,15 @@ static void filter_pid_collect_stats(GF_List *pidi_list, GF_FilterPidStatistics
 
 		if (stats->buffer_time < pidi->pid->buffer_duration)
 			stats->buffer_time = pidi->pid->buffer_duration;
+
+		if (stats->buffer_mem < (u64) pidi->pid->mem_used)
+			stats->buffer_mem = pidi->pid->mem_used;
+		if (pidi->pid->spill) {
+			u64 spill_size;
+			gf_filter_pid_get_spill_stats(pidi->pid, &spill_size, NULL, NULL);
+			if (stats->spill_size < spill_size)
+				stats->spill_size = spill_size;
+		}
 	}
 }
 
@@ -110,6 +110,7 @@ const GF_FilterRegister *vout_register(GF_FilterSession *session);
 #endif
 const GF_FilterRegister *vcrop_register(GF_FilterSession *session);
 const GF_FilterRegister *vflip_register(GF_FilterSession *session);
+const GF_FilterRegister *vladder_register(GF_FilterSession *session);
 const GF_FilterRegister *rawvidreframe_register(GF_FilterSession *session);
 const GF_FilterRegister *pcmreframe_register(GF_FilterSession *session);
 const GF_FilterRegister *jpgenc_register(GF_FilterSession *session);
@@ -122,6 +123,8 @@ const GF_FilterRegister *tileagg_register(GF_FilterSession *session);
 #if !defined(GPAC_CONFIG_ANDROID)
 const GF_FilterRegister *pipein_register(GF_FilterSession *session);
 const GF_FilterRegister *pipeout_register(GF_FilterSession *session);
+const GF_FilterRegister *shmin_register(GF_FilterSession *session);
+const GF_FilterRegister *shmout_register(GF_FilterSession *session);
 #endif
 const GF_FilterRegister *gsfmx_register(GF_FilterSession *session);
 const GF_FilterRegister *gsfdmx_register(GF_FilterSession *session);
@@ -233,6 +236,7 @@ void gf_fs_reg_all(GF_FilterSession *fsess, GF_FilterSession *a_sess)
 #endif
 	gf_fs_add_filter_register(fsess, vcrop_register(a_sess) );
 	gf_fs_add_filter_register(fsess, vflip_register(a_sess) );
+	gf_fs_add_filter_register(fsess, vladder_register(a_sess) );
 	gf_fs_add_filter_register(fsess, rawvidreframe_register(a_sess) );
 	gf_fs_add_filter_register(fsess, pcmreframe_register(a_sess) );
 	gf_fs_add_filter_register(fsess, jpgenc_register(a_sess) );
@@ -245,6 +249,8 @@ void gf_fs_reg_all(GF_FilterSession *fsess, GF_FilterSession *a_sess)
 #if !defined(GPAC_CONFIG_ANDROID)
 	gf_fs_add_filter_register(fsess, pipein_register(a_sess) );
 	gf_fs_add_filter_register(fsess, pipeout_register(a_sess) );
+	gf_fs_add_filter_register(fsess, shmin_register(a_sess) );
+	gf_fs_add_filter_register(fsess, shmout_register(a_sess) );
 #endif
 	gf_fs_add_filter_register(fsess, gsfmx_register(a_sess) );
 	gf_fs_add_filter_register(fsess, gsfdmx_register(a_sess) );
@@ -35,13 +35,69 @@ struct _gf_ft_mgr *gf_font_manager_new();
 void gf_font_manager_del(struct _gf_ft_mgr *fm);
 
 
-static GFINLINE void gf_fs_sema_io(GF_FilterSession *fsess, Bool notify, Bool main)
+//posts a task to the secondary task list, or to the task list of the thread group its filter is bound to
+//returns the thread group of the task, 0 if none
+static GFINLINE u32 gf_fs_post_secondary_task(GF_FilterSession *fsess, GF_FSTask *task)
+{
+	if (task->filter && task->filter->th_group) {
+		gf_fq_add(fsess->th_groups[task->filter->th_group-1].tasks, task);
+		return task->filter->th_group;
+	}
+	gf_fq_add(fsess->tasks, task);
+	return 0;
+}
+
+//checks if tasks are pending in thread groups
+static Bool gf_fs_has_group_tasks(GF_FilterSession *fsess)
+{
+	u32 i;
+	for (i=0; i<fsess->nb_th_groups; i++) {
+		if (gf_fq_count(fsess->th_groups[i].tasks)) return GF_TRUE;
+	}
+	return GF_FALSE;
+}
+
+//notifies secondary threads. When thread groups are used, each group has its own semaphore:
+//- if th_group is set, the group is notified
+//- otherwise groups are notified in turn, since any thread can process tasks from the secondary list
+static void gf_fs_notify_secondary(GF_FilterSession *fsess, u32 th_group, u32 nb_notif)
+{
+	if (!fsess->nb_th_groups) {
+		gf_sema_notify(fsess->semaphore_other, nb_notif);
+		return;
+	}
+	//groups without threads are skipped, there is always at least one group with threads
+	while (!th_group) {
+		fsess->th_group_notif = (fsess->th_group_notif + 1) % fsess->nb_th_groups;
+		if (fsess->th_groups[fsess->th_group_notif].nb_threads)
+			th_group = fsess->th_group_notif + 1;
+	}
+	gf_sema_notify(fsess->th_groups[th_group-1].sema, nb_notif);
+}
+
+//notifies all secondary threads
+static void gf_fs_notify_all_secondary(GF_FilterSession *fsess, u32 nb_threads)
+{
+	u32 i;
+	if (!fsess->nb_th_groups) {
+		gf_sema_notify(fsess->semaphore_other, nb_threads);
+		return;
+	}
+	for (i=0; i<fsess->nb_th_groups; i++) {
+		if (fsess->th_groups[i].nb_threads)
+			gf_sema_notify(fsess->th_groups[i].sema, fsess->th_groups[i].nb_threads);
+	}
+}
+
+static GFINLINE void gf_fs_sema_io_ex(GF_FilterSession *fsess, Bool notify, Bool main, u32 th_group)
 {
 	GF_Semaphore *sem = main ? fsess->semaphore_main : fsess->semaphore_other;
 	if (sem) {
 		if (notify) {
 			GF_LOG(GF_LOG_DEBUG, GF_LOG_SCHEDULER, ("Thread %u notify scheduler %s semaphore\n", gf_th_id(), main ? "main" : "secondary"));
-			if ( ! gf_sema_notify(sem, 1)) {
+			if (!main && fsess->nb_th_groups) {
+				gf_fs_notify_secondary(fsess, th_group, 1);
+			} else if ( ! gf_sema_notify(sem, 1)) {
 				GF_LOG(GF_LOG_ERROR, GF_LOG_SCHEDULER, ("Cannot notify scheduler of new task, semaphore failure\n"));
 			}
 		} else {
@@ -51,12 +107,18 @@ static GFINLINE void gf_fs_sema_io(GF_FilterSession *fsess, Bool notify, Bool ma
 			//this also ensures that tha main thread will process tasks from secondary task lists if no
 			//dedicated main thread tasks are present (eg no GL filters)
 			if (!main && fsess->in_main_sem_wait && !gf_fq_count(fsess->main_thread_tasks)) {
-				gf_fs_sema_io(fsess, GF_TRUE, GF_TRUE);
+				gf_fs_sema_io_ex(fsess, GF_TRUE, GF_TRUE, 0);
 			}
 			nb_tasks = 1;
 			//no active threads, count number of tasks. If no posted tasks we are likely at the end of the session, don't block, rather use a sem_wait 
-			if (!fsess->active_threads)
+			if (!fsess->active_threads) {
 			 	nb_tasks = gf_fq_count(fsess->main_thread_tasks) + gf_fq_count(fsess->tasks);
+				if (!nb_tasks && gf_fs_has_group_tasks(fsess))
+					nb_tasks = 1;
+			}
+			//thread from a thread group, wait on the group semaphore
+			if (!main && th_group)
+				sem = fsess->th_groups[th_group-1].sema;
 
 			//if main semaphore, keep track that we are going to sleep
 			if (main) {
@@ -83,6 +145,7 @@ static GFINLINE void gf_fs_sema_io(GF_FilterSession *fsess, Bool notify, Bool ma
 		}
 	}
 }
+#define gf_fs_sema_io(_fsess, _notify, _main) gf_fs_sema_io_ex(_fsess, _notify, _main, 0)
 
 void gf_fs_add_filter_register(GF_FilterSession *fsess, const GF_FilterRegister *freg)
 {
@@ -107,6 +170,10 @@ void gf_fs_add_filter_register(GF_FilterSession *fsess, const GF_FilterRegister
 	}
 	gf_list_add(fsess->registry, (void *) freg);
 
+	if (fsess->init_done && fsess->graph_cache)
+		gf_fs_graph_cache_registry_changed(fsess);
+	gf_fs_reset_probe_magics(fsess);
+
 	if (fsess->init_done && fsess->links && gf_list_count( fsess->links)) {
 		gf_filter_sess_build_graph(fsess, freg);
 	}
@@ -316,8 +383,13 @@ GF_FilterSession *gf_fs_new(s32 nb_threads, GF_FilterSchedulerType sched_type, u
 	fsess->gl_providers = gf_list_new();
 #endif
 
-	if (! (fsess->flags & GF_FS_FLAG_NO_GRAPH_CACHE))
-		gf_filter_sess_build_graph(fsess, NULL);
+	if (! (fsess->flags & GF_FS_FLAG_NO_GRAPH_CACHE)) {
+		opt = gf_opts_get_key("core", "graph-cache");
+		if (opt)
+			gf_fs_graph_cache_new(fsess, opt);
+		else
+			gf_filter_sess_build_graph(fsess, NULL);
+	}
 
 	fsess->init_done = GF_TRUE;
 
@@ -393,6 +465,27 @@ void gf_fs_push_arg(GF_FilterSession *session, const char *szArg, Bool was_found
 }
 
 
+//parses a byte size option with optional K, M or G suffix (decimal units, as for other options)
+static u64 gf_fs_get_size_opt(const char *key)
+{
+	char *sep;
+	u64 val;
+	const char *opt = gf_opts_get_key("core", key);
+	if (!opt) return 0;
+	val = (u64) strtoull(opt, &sep, 10);
+	if (sep == opt) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("Invalid size %s for option %s, ignoring\n", opt, key));
+		return 0;
+	}
+	switch (sep[0]) {
+	case 'k': case 'K': val *= 1000; break;
+	case 'm': case 'M': val *= 1000000; break;
+	case 'g': case 'G': val *= 1000000000; break;
+	default: break;
+	}
+	return val;
+}
+
 GF_EXPORT
 GF_FilterSession *gf_fs_new_defaults(u32 inflags)
 {
@@ -454,10 +547,22 @@ GF_FilterSession *gf_fs_new_defaults(u32 inflags)
 
 	gf_fs_set_max_sleep_time(fsess, gf_opts_get_int("core", "max-sleep") );
 
+	gf_fs_set_memory_budget(fsess, gf_fs_get_size_opt("pid-mem"), gf_fs_get_size_opt("sess-mem") );
+
 	opt = gf_opts_get_key("core", "seps");
 	if (opt)
 		gf_fs_set_separators(fsess, opt);
 
+	opt = gf_opts_get_key("core", "metrics-addr");
+	if (opt || gf_opts_get_bool("core", "metrics"))
+		gf_fs_enable_metrics(fsess, opt);
+	opt = gf_opts_get_key("core", "trace");
+	if (opt)
+		gf_fs_enable_trace(fsess, opt, 1000*gf_opts_get_int("core", "trace-dur"));
+	opt = gf_opts_get_key("core", "th-cpus");
+	if (opt)
+		gf_fs_set_thread_groups(fsess, opt, gf_opts_get_key("core", "th-bind"));
+
 	return fsess;
 }
 
@@ -500,6 +605,174 @@ GF_Err gf_fs_set_max_sleep_time(GF_FilterSession *session, u32 max_sleep)
 	return GF_OK;
 }
 
+//parses a CPU list such as "0-3,8,10-11", or "nodeN" for the CPUs of a NUMA node
+static GF_Err gf_fs_parse_cpu_list(const char *list, GF_FSThreadGroup *group)
+{
+	char szCPUs[1024];
+	if (!strncmp(list, "node", 4)) {
+		char szPath[GF_MAX_PATH];
+		FILE *f;
+		sprintf(szPath, "/sys/devices/system/node/node%d/cpulist", atoi(list+4));
+		f = gf_file_exists(szPath) ? gf_fopen(szPath, "r") : NULL;
+		if (!f) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("Unknown NUMA node %s\n", list));
+			return GF_NOT_SUPPORTED;
+		}
+		if (!gf_fgets(szCPUs, 1024, f)) szCPUs[0] = 0;
+		gf_fclose(f);
+		list = szCPUs;
+	}
+	while (list[0]) {
+		char *sep;
+		u32 first, last;
+		first = last = (u32) strtoul(list, &sep, 10);
+		if (sep == list) return GF_BAD_PARAM;
+		if (sep[0] == '-') {
+			list = sep+1;
+			last = (u32) strtoul(list, &sep, 10);
+			if ((sep == list) || (last < first)) return GF_BAD_PARAM;
+		}
+		for (; first<=last; first++) {
+			group->cpus = gf_realloc(group->cpus, sizeof(u32) * (group->nb_cpus+1));
+			if (!group->cpus) return GF_OUT_OF_MEM;
+			group->cpus[group->nb_cpus] = first;
+			group->nb_cpus++;
+		}
+		while ((sep[0]==',') || (sep[0]=='\n') || (sep[0]=='\r') || (sep[0]==' '))
+			sep++;
+		list = sep;
+	}
+	return group->nb_cpus ? GF_OK : GF_BAD_PARAM;
+}
+
+static void gf_fs_reset_thread_groups(GF_FilterSession *fsess)
+{
+	u32 i;
+	for (i=0; i<fsess->nb_th_groups; i++) {
+		if (fsess->th_groups[i].cpus) gf_free(fsess->th_groups[i].cpus);
+		if (fsess->th_groups[i].tasks) gf_fq_del(fsess->th_groups[i].tasks, gf_void_del);
+		if (fsess->th_groups[i].sema) gf_sema_del(fsess->th_groups[i].sema);
+	}
+	if (fsess->th_groups) gf_free(fsess->th_groups);
+	fsess->th_groups = NULL;
+	fsess->nb_th_groups = 0;
+	if (fsess->th_bind) gf_free(fsess->th_bind);
+	fsess->th_bind = NULL;
+}
+
+static GF_Err gf_fs_add_thread_group(GF_FilterSession *session, const char *cpus)
+{
+	GF_FSThreadGroup *group;
+	session->th_groups = gf_realloc(session->th_groups, sizeof(GF_FSThreadGroup) * (session->nb_th_groups+1));
+	if (!session->th_groups) return GF_OUT_OF_MEM;
+	group = &session->th_groups[session->nb_th_groups];
+	memset(group, 0, sizeof(GF_FSThreadGroup));
+	session->nb_th_groups++;
+	group->tasks = gf_fq_new(session->tasks_mx);
+	group->sema = gf_sema_new(GF_INT_MAX, 0);
+	if (!group->tasks || !group->sema) return GF_OUT_OF_MEM;
+	return gf_fs_parse_cpu_list(cpus, group);
+}
+
+GF_EXPORT
+GF_Err gf_fs_set_thread_groups(GF_FilterSession *session, const char *cpu_groups, const char *filter_bindings)
+{
+	u32 i, count;
+	GF_Err e = GF_OK;
+	char szGroup[1024];
+	if (!session || !cpu_groups) return GF_BAD_PARAM;
+	count = gf_list_count(session->threads);
+	if (!count) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_FILTER, ("Thread groups ignored, session has no extra thread\n"));
+		return GF_BAD_PARAM;
+	}
+	gf_fs_reset_thread_groups(session);
+
+	while (cpu_groups[0] && !e) {
+		u32 len;
+		const char *sep = strchr(cpu_groups, ':');
+		len = sep ? (u32) (sep - cpu_groups) : (u32) strlen(cpu_groups);
+		if (len>=1024) len = 1023;
+		memcpy(szGroup, cpu_groups, len);
+		szGroup[len] = 0;
+		cpu_groups = sep ? sep+1 : cpu_groups+len;
+
+		//one group per NUMA node
+		if (!strcmp(szGroup, "numa")) {
+			char szPath[GF_MAX_PATH];
+			u32 node = 0;
+			u32 nb_groups = session->nb_th_groups;
+			while (!e) {
+				FILE *f;
+				Bool has_cpus = GF_FALSE;
+				sprintf(szPath, "/sys/devices/system/node/node%u", node);
+				if (!gf_dir_exists(szPath)) break;
+				//skip memory-only nodes, their cpulist is empty
+				strcat(szPath, "/cpulist");
+				f = gf_file_exists(szPath) ? gf_fopen(szPath, "r") : NULL;
+				if (f) {
+					if (gf_fgets(szGroup, 1024, f) && (szGroup[0]>='0') && (szGroup[0]<='9'))
+						has_cpus = GF_TRUE;
+					gf_fclose(f);
+				}
+				sprintf(szGroup, "node%u", node);
+				node++;
+				if (has_cpus)
+					e = gf_fs_add_thread_group(session, szGroup);
+			}
+			if (!e && (nb_groups == session->nb_th_groups)) e = GF_NOT_SUPPORTED;
+			continue;
+		}
+		e = gf_fs_add_thread_group(session, szGroup);
+	}
+	if (!e && !session->nb_th_groups) e = GF_BAD_PARAM;
+	if (e) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("Invalid thread CPU groups, expecting CPU lists (e.g. 0-3,8) or NUMA nodes (nodeN or numa) separated by ':'\n"));
+		gf_fs_reset_thread_groups(session);
+		return e;
+	}
+
+	//threads are assigned to groups in round-robin
+	for (i=0; i<count; i++) {
+		GF_SessionThread *sess_th = gf_list_get(session->threads, i);
+		sess_th->th_group = 1 + (i % session->nb_th_groups);
+		session->th_groups[sess_th->th_group-1].nb_threads++;
+	}
+	if (filter_bindings)
+		session->th_bind = gf_strdup(filter_bindings);
+	return GF_OK;
+}
+
+void gf_fs_filter_bind_thread_group(GF_Filter *filter)
+{
+	const char *bind = filter->session->th_bind;
+	while (bind && bind[0]) {
+		u32 len, group;
+		const char *sep = strchr(bind, ',');
+		const char *at = strchr(bind, '@');
+		len = sep ? (u32) (sep - bind) : (u32) strlen(bind);
+		if (at && (at < bind+len)) {
+			u32 nlen = (u32) (at - bind);
+			group = atoi(at+1);
+			if ((!strncmp(bind, filter->freg->name, nlen) && !filter->freg->name[nlen])
+				|| (filter->name && !strncmp(bind, filter->name, nlen) && !filter->name[nlen])
+				|| (filter->id && !strncmp(bind, filter->id, nlen) && !filter->id[nlen])
+			) {
+				if (!group || (group > filter->session->nb_th_groups) || !filter->session->th_groups[group-1].nb_threads) {
+					GF_LOG(GF_LOG_WARNING, GF_LOG_FILTER, ("Filter %s bound to unknown or empty thread group %d, ignoring\n", filter->name, group));
+				} else if (filter->freg->flags & GF_FS_REG_MAIN_THREAD) {
+					GF_LOG(GF_LOG_WARNING, GF_LOG_FILTER, ("Filter %s requires main thread, ignoring thread group binding\n", filter->name));
+				} else {
+					filter->th_group = group;
+					GF_LOG(GF_LOG_INFO, GF_LOG_FILTER, ("Filter %s bound to thread group %d\n", filter->name, group));
+				}
+				return;
+			}
+		}
+		bind = sep ? sep+1 : NULL;
+	}
+}
+
 GF_EXPORT
 u32 gf_fs_get_max_resolution_chain_length(GF_FilterSession *session)
 {
@@ -510,9 +783,102 @@ u32 gf_fs_get_max_resolution_chain_length(GF_FilterSession *session)
 void gf_fs_remove_filter_register(GF_FilterSession *session, GF_FilterRegister *freg)
 {
 	gf_list_del_item(session->registry, freg);
+	if (session->graph_cache)
+		gf_fs_graph_cache_registry_changed(session);
+	gf_fs_reset_probe_magics(session);
 	gf_filter_sess_reset_graph(session, freg);
 }
 
+static void gf_fs_build_probe_magics(GF_FilterSession *fsess)
+{
+	u32 i, j, count, nb_magics=0;
+
+	fsess->probe_magic_heads = gf_malloc(sizeof(u32) * 256);
+	if (!fsess->probe_magic_heads) return;
+	memset(fsess->probe_magic_heads, 0, sizeof(u32) * 256);
+
+	count = gf_list_count(fsess->registry);
+	for (i=0; i<count; i++) {
+		const GF_FilterRegister *freg = gf_list_get(fsess->registry, i);
+		if (!freg->probe_data || !freg->probe_magics) continue;
+		for (j=0; freg->probe_magics[j].size; j++)
+			nb_magics++;
+	}
+	if (!nb_magics) return;
+	fsess->probe_magics = gf_malloc(sizeof(GF_FSProbeMagic) * nb_magics);
+	fsess->probe_magic_offsets = gf_malloc(sizeof(u32) * nb_magics);
+	if (!fsess->probe_magics || !fsess->probe_magic_offsets) {
+		gf_fs_reset_probe_magics(fsess);
+		return;
+	}
+
+	for (i=0; i<count; i++) {
+		const GF_FilterRegister *freg = gf_list_get(fsess->registry, i);
+		if (!freg->probe_data || !freg->probe_magics) continue;
+		for (j=0; freg->probe_magics[j].size; j++) {
+			u32 k;
+			const GF_FilterProbeMagic *magic = &freg->probe_magics[j];
+			GF_FSProbeMagic *pm = &fsess->probe_magics[fsess->nb_probe_magics];
+			u8 first = (u8) magic->data[0];
+
+			pm->freg = freg;
+			pm->magic = magic;
+			pm->next = fsess->probe_magic_heads[first];
+			fsess->nb_probe_magics++;
+			fsess->probe_magic_heads[first] = fsess->nb_probe_magics;
+
+			for (k=0; k<fsess->nb_probe_magic_offsets; k++) {
+				if (fsess->probe_magic_offsets[k] == magic->offset) break;
+			}
+			if (k==fsess->nb_probe_magic_offsets) {
+				fsess->probe_magic_offsets[k] = magic->offset;
+				fsess->nb_probe_magic_offsets++;
+			}
+		}
+	}
+}
+
+void gf_fs_reset_probe_magics(GF_FilterSession *fsess)
+{
+	if (fsess->probe_magics) gf_free(fsess->probe_magics);
+	if (fsess->probe_magic_heads) gf_free(fsess->probe_magic_heads);
+	if (fsess->probe_magic_offsets) gf_free(fsess->probe_magic_offsets);
+	fsess->probe_magics = NULL;
+	fsess->probe_magic_heads = NULL;
+	fsess->probe_magic_offsets = NULL;
+	fsess->nb_probe_magics = 0;
+	fsess->nb_probe_magic_offsets = 0;
+}
+
+const GF_FilterRegister *gf_fs_probe_magic_match(GF_FilterSession *fsess, const u8 *data, u32 size)
+{
+	u32 i;
+	const GF_FilterRegister *freg = NULL;
+
+	if (!fsess->probe_magic_heads)
+		gf_fs_build_probe_magics(fsess);
+	if (!fsess->nb_probe_magics) return NULL;
+
+	for (i=0; i<fsess->nb_probe_magic_offsets; i++) {
+		u32 idx;
+		u32 offset = fsess->probe_magic_offsets[i];
+		if (offset >= size) continue;
+
+		idx = fsess->probe_magic_heads[ data[offset] ];
+		while (idx) {
+			GF_FSProbeMagic *pm = &fsess->probe_magics[idx-1];
+			idx = pm->next;
+			if (pm->magic->offset != offset) continue;
+			if (offset + pm->magic->size > size) continue;
+			if (memcmp(data + offset, pm->magic->data, pm->magic->size)) continue;
+			//signature claimed by several filters
+			if (freg && (freg != pm->freg)) return NULL;
+			freg = pm->freg;
+		}
+	}
+	return freg;
+}
+
 GF_EXPORT
 void gf_fs_set_ui_callback(GF_FilterSession *fs, Bool (*ui_event_proc)(void *opaque, GF_Event *event), void *cbk_udta)
 {
@@ -557,9 +923,20 @@ void gf_fs_del(GF_FilterSession *fsess)
 {
 	assert(fsess);
 
+	if (fsess->group)
+		gf_fs_group_detach(fsess);
+
 	gf_fs_stop(fsess);
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_FILTER, ("Session destroy begin\n"));
 
+	if (fsess->metrics)
+		gf_fs_metrics_del(fsess);
+	if (fsess->trace)
+		gf_fs_trace_del(fsess);
+	//store graph cache while the registry is still valid
+	if (fsess->graph_cache)
+		gf_fs_graph_cache_del(fsess);
+
 	if (fsess->parsed_args) {
 		while (gf_list_count(fsess->parsed_args)) {
 			GF_FSArgItem *ai = gf_list_pop_back(fsess->parsed_args);
@@ -634,7 +1011,10 @@ void gf_fs_del(GF_FilterSession *fsess)
 		}
 		gf_list_del(fsess->registry);
 	}
+	gf_fs_reset_probe_magics(fsess);
 
+	//reset thread groups once all filters are destroyed, since tasks may be posted to groups during filter finalize
+	gf_fs_reset_thread_groups(fsess);
 	if (fsess->tasks)
 		gf_fq_del(fsess->tasks, gf_void_del);
 
@@ -761,7 +1141,8 @@ void gf_fs_post_task_ex(GF_FilterSession *fsess, gf_fs_task_callback task_fun, G
 		&& (gf_th_id()==fsess->main_th.th_id)
 	) {
 		GF_FSTask atask;
-		u64 task_time = gf_sys_clock_high_res();
+		u32 trace_fidx = 0;
+		u64 task_start, task_time;
 		memset(&atask, 0, sizeof(GF_FSTask));
 		atask.filter = filter;
 		atask.pid = pid;
@@ -771,13 +1152,23 @@ void gf_fs_post_task_ex(GF_FilterSession *fsess, gf_fs_task_callback task_fun, G
 		GF_LOG(GF_LOG_DEBUG, GF_LOG_SCHEDULER, ("Thread 0 task#%d %p executing Filter %s::%s (%d tasks pending)\n", fsess->main_th.nb_tasks, &atask, filter ? filter->name : "none", log_name, fsess->tasks_pending));
 		if (filter)
 			filter->scheduled_for_next_task = GF_TRUE;
+		if (fsess->trace)
+			trace_fidx = gf_fs_trace_task_start(&fsess->main_th, &atask);
+		task_start = gf_sys_clock_high_res();
+		if (fsess->metrics && filter) filter->metrics_clock = task_start;
 		task_fun(&atask);
+		task_time = gf_sys_clock_high_res() - task_start;
 		filter = atask.filter;
 		if (filter) {
-			filter->time_process += gf_sys_clock_high_res() - task_time;
+			filter->time_process += task_time;
 			filter->scheduled_for_next_task = GF_FALSE;
 			filter->nb_tasks_done++;
 		}
+		if (fsess->metrics)
+			gf_fs_metrics_task_done(&fsess->main_th, &atask, filter, task_start, task_time);
+		if (fsess->trace)
+			gf_fs_trace_task_end(&fsess->main_th, &atask, trace_fidx, task_start, task_time);
+
 		if (!atask.requeue_request)
 			return;
 		//asked to requeue the task, post it
@@ -796,6 +1187,7 @@ void gf_fs_post_task_ex(GF_FilterSession *fsess, gf_fs_task_callback task_fun, G
 	task->run_task = task_fun;
 	task->log_name = log_name;
 	task->udta = udta;
+	task->post_time = fsess->trace ? gf_sys_clock_high_res() : 0;
 
 	if (filter && is_configure) {
 		if (filter->freg->flags & GF_FS_REG_CONFIGURE_MAIN_THREAD)
@@ -848,10 +1240,14 @@ void gf_fs_post_task_ex(GF_FilterSession *fsess, gf_fs_task_callback task_fun, G
 			gf_fq_add(fsess->main_thread_tasks, task);
 			gf_fs_sema_io(fsess, GF_TRUE, GF_TRUE);
 		} else {
+			u32 th_group;
 			assert(task->run_task);
-			gf_fq_add(fsess->tasks, task);
-			gf_fs_sema_io(fsess, GF_TRUE, GF_FALSE);
+			th_group = gf_fs_post_secondary_task(fsess, task);
+			gf_fs_sema_io_ex(fsess, GF_TRUE, GF_FALSE, th_group);
 		}
+		//session run by a session group, wake up the group
+		if (fsess->group)
+			gf_fs_group_notify(fsess);
 	}
 }
 
@@ -1077,9 +1473,18 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 	u32 consecutive_filter_tasks=0;
 	Bool force_secondary_tasks = GF_FALSE;
 	Bool skip_next_sema_wait = GF_FALSE;
+	//number of tasks postponed in a row and earliest due time, for sessions run by a session group
+	u32 nb_postponed = 0;
+	u64 postponed_due = 0;
 
 	GF_Filter *current_filter = NULL;
 	sess_thread->th_id = gf_th_id();
+	if (sess_thread->th_group) {
+		GF_FSThreadGroup *group = &fsess->th_groups[sess_thread->th_group-1];
+		if (gf_th_set_cpu_affinity(NULL, group->cpus, group->nb_cpus) == GF_OK) {
+			GF_LOG(GF_LOG_INFO, GF_LOG_SCHEDULER, ("Thread %u bound to thread group %d\n", thid, sess_thread->th_group));
+		}
+	}
 
 #ifndef GPAC_DISABLE_REMOTERY
 	sess_thread->rmt_tasks=40;
@@ -1097,7 +1502,8 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 	while (1) {
 		Bool notified;
 		Bool requeue = GF_FALSE;
-		u64 active_start, task_time;
+		u64 active_start, task_start, task_time;
+		u32 trace_fidx = 0;
 		GF_FSTask *task=NULL;
 #ifdef CHECK_TASK_LIST_INTEGRITY
 		GF_Filter *prev_current_filter = NULL;
@@ -1119,7 +1525,7 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 			gf_rmt_begin(sema_wait, GF_RMT_AGGREGATE);
 			GF_LOG(GF_LOG_DEBUG, GF_LOG_SCHEDULER, ("Thread %u Waiting scheduler %s semaphore\n", sys_thid, use_main_sema ? "main" : "secondary"));
 			//wait for something to be done
-			gf_fs_sema_io(fsess, GF_FALSE, use_main_sema);
+			gf_fs_sema_io_ex(fsess, GF_FALSE, use_main_sema, sess_thread->th_group);
 			consecutive_filter_tasks = 0;
 			gf_rmt_end();
 		}
@@ -1144,7 +1550,11 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 				}
 				force_secondary_tasks = GF_FALSE;
 			} else {
-				task = gf_fq_pop(fsess->tasks);
+				//tasks of filters bound to our thread group first
+				if (sess_thread->th_group)
+					task = gf_fq_pop(fsess->th_groups[sess_thread->th_group-1].tasks);
+				if (!task)
+					task = gf_fq_pop(fsess->tasks);
 			}
 			if (task) {
 				assert( task->run_task );
@@ -1204,7 +1614,7 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 					GF_LOG(GF_LOG_DEBUG, GF_LOG_SCHEDULER, ("Thread %u notify scheduler main semaphore\n", gf_th_id()));
 					gf_sema_notify(fsess->semaphore_main, 1);
 					GF_LOG(GF_LOG_DEBUG, GF_LOG_SCHEDULER, ("Thread %u notify scheduler secondary semaphore %d\n", gf_th_id(), th_count));
-					gf_sema_notify(fsess->semaphore_other, th_count);
+					gf_fs_notify_all_secondary(fsess, th_count);
 				}
 			}
 			//this thread and the main thread are done but we still have unfinished threads, re-notify everyone
@@ -1212,7 +1622,7 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 				GF_LOG(GF_LOG_DEBUG, GF_LOG_SCHEDULER, ("Thread %u notify scheduler main semaphore\n", gf_th_id()));
 				gf_sema_notify(fsess->semaphore_main, 1);
 				GF_LOG(GF_LOG_DEBUG, GF_LOG_SCHEDULER, ("Thread %u notify scheduler secondary semaphore %d\n", gf_th_id(), th_count));
-				gf_sema_notify(fsess->semaphore_other, th_count);
+				gf_fs_notify_all_secondary(fsess, th_count);
 			}
 
 			GF_LOG(GF_LOG_DEBUG, GF_LOG_SCHEDULER, ("Thread %u: no task available\n", sys_thid));
@@ -1267,6 +1677,16 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 #endif
 					//tasks without filter are currently only posted to the secondary task list
 					gf_fq_add(fsess->tasks, task);
+					//session run by a session group, return to the group if no task is due, it will run other sessions meanwhile
+					if (fsess->group && !thid) {
+						nb_postponed++;
+						if (!postponed_due || (task->schedule_next_time < postponed_due))
+							postponed_due = task->schedule_next_time;
+						if (nb_postponed >= gf_fq_count(fsess->tasks)) {
+							fsess->group_next_due = postponed_due;
+							break;
+						}
+					}
 					if (next) {
 						if (next->schedule_next_time <= (u64) now) {
 							GF_LOG(GF_LOG_DEBUG, GF_LOG_SCHEDULER, ("Thread %u: task %s reposted, next task time ready for execution\n", sys_thid, task_log_name));
@@ -1412,14 +1832,15 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 								gf_fs_sema_io(fsess, GF_TRUE, GF_TRUE);
 							}
 						} else {
-							gf_fq_add(fsess->tasks, task);
+							u32 th_group = gf_fs_post_secondary_task(fsess, task);
 							//we are not the main thread and we are reposting to the secondary task list, don't notify/wait for the sema, just retry
 							//we are not sure to get a task from secondary list at next iteration, but the end of thread check will make
 							//sure we renotify secondary sema if some tasks are still pending
-							if (!use_main_sema) {
+							//if the task is bound to another thread group, notify that group
+							if (!use_main_sema && (th_group == sess_thread->th_group)) {
 								skip_next_sema_wait = GF_TRUE;
 							} else {
-								gf_fs_sema_io(fsess, GF_TRUE, GF_FALSE);
+								gf_fs_sema_io_ex(fsess, GF_TRUE, GF_FALSE, th_group);
 							}
 						}
 						//we temporary force the main thread to fetch a task from the secondary list
@@ -1429,6 +1850,16 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 						if (force_secondary_tasks)
 							gf_fs_sema_io(fsess, GF_TRUE, GF_TRUE);
 
+						//session run by a session group, return to the group if no task is due, it will run other sessions meanwhile
+						if (fsess->group && !thid) {
+							nb_postponed++;
+							if (!postponed_due || (task->schedule_next_time < postponed_due))
+								postponed_due = task->schedule_next_time;
+							if (nb_postponed >= gf_fq_count(fsess->tasks)) {
+								fsess->group_next_due = postponed_due;
+								break;
+							}
+						}
 						continue;
 					}
 					force_secondary_tasks=GF_FALSE;
@@ -1438,6 +1869,8 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 
 		}
 		next_task_schedule_time = 0;
+		nb_postponed = 0;
+		postponed_due = 0;
 
 		if (current_filter) {
 			current_filter->scheduled_for_next_task = GF_TRUE;
@@ -1456,19 +1889,27 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 
 		safe_int_inc(& fsess->tasks_in_process );
 		assert( task->run_task );
-		task_time = gf_sys_clock_high_res();
+		if (fsess->trace)
+			trace_fidx = gf_fs_trace_task_start(sess_thread, task);
+		task_start = gf_sys_clock_high_res();
+		if (fsess->metrics && task->filter) task->filter->metrics_clock = task_start;
 
 		task->can_swap = GF_FALSE;
 		task->requeue_request = GF_FALSE;
 		task->run_task(task);
 		requeue = task->requeue_request;
 
-		task_time = gf_sys_clock_high_res() - task_time;
+		task_time = gf_sys_clock_high_res() - task_start;
 		safe_int_dec(& fsess->tasks_in_process );
 
 		//may now be NULL if task was a filter destruction task
 		current_filter = task->filter;
 
+		if (fsess->metrics)
+			gf_fs_metrics_task_done(sess_thread, task, current_filter, task_start, task_time);
+		if (fsess->trace)
+			gf_fs_trace_task_end(sess_thread, task, trace_fidx, task_start, task_time);
+
 #ifdef CHECK_TASK_LIST_INTEGRITY
 		prev_current_filter = task->filter;
 #endif
@@ -1590,10 +2031,15 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 				//main thread
 				if (task->filter && (task->filter->freg->flags & GF_FS_REG_MAIN_THREAD)) {
 					gf_fq_add(fsess->main_thread_tasks, task);
+					gf_fs_sema_io(fsess, GF_TRUE, use_main_sema);
 				} else {
-					gf_fq_add(fsess->tasks, task);
+					u32 th_group = gf_fs_post_secondary_task(fsess, task);
+					//bound to another thread group, notify that group
+					if (th_group && (th_group != sess_thread->th_group))
+						gf_fs_sema_io_ex(fsess, GF_TRUE, GF_FALSE, th_group);
+					else
+						gf_fs_sema_io_ex(fsess, GF_TRUE, use_main_sema, sess_thread->th_group);
 				}
-				gf_fs_sema_io(fsess, GF_TRUE, use_main_sema);
 			}
 		} else {
 #ifdef CHECK_TASK_LIST_INTEGRITY
@@ -1675,6 +2121,8 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 	if (fsess->semaphore_other && ! gf_sema_notify(fsess->semaphore_other, th_count)) {
 		GF_LOG(GF_LOG_ERROR, GF_LOG_SCHEDULER, ("Failed to notify secondary semaphore, might hang up !!\n"));
 	}
+	if (fsess->nb_th_groups)
+		gf_fs_notify_all_secondary(fsess, th_count);
 
 	return 0;
 }
@@ -1833,6 +2281,24 @@ static GFINLINE void print_filter_name(GF_Filter *f, Bool skip_id, Bool skip_arg
 	GF_LOG(GF_LOG_INFO, GF_LOG_APP, (")"));
 }
 
+static void print_thread_stats(GF_SessionThread *s, u32 idx)
+{
+	GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\tThread %u: run_time "LLU" us active_time "LLU" us nb_tasks "LLU, idx, s->run_time, s->active_time, s->nb_tasks));
+	if (s->run_time) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_APP, (" utilization %.02f %%", ((Double) s->active_time) * 100 / s->run_time));
+	}
+	if (s->th_group) {
+		u32 i;
+		GF_FSThreadGroup *group = &s->fsess->th_groups[s->th_group-1];
+		GF_LOG(GF_LOG_INFO, GF_LOG_APP, (" group %u (CPUs", s->th_group));
+		for (i=0; i<group->nb_cpus; i++) {
+			GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("%c%u", i ? ',' : ' ', group->cpus[i]));
+		}
+		GF_LOG(GF_LOG_INFO, GF_LOG_APP, (")"));
+	}
+	GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\n"));
+}
+
 GF_EXPORT
 void gf_fs_print_stats(GF_FilterSession *fsess)
 {
@@ -1892,7 +2358,13 @@ void gf_fs_print_stats(GF_FilterSession *fsess)
 #ifndef GPAC_DISABLE_LOG
 		for (k=0; k<opids; k++) {
 			GF_FilterPid *pid = gf_list_get(f->output_pids, k);
-			GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\t\t* output PID %s: %d packets sent\n", pid->name, pid->nb_pck_sent));
+			GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\t\t* output PID %s: %d packets sent", pid->name, pid->nb_pck_sent));
+			if (pid->spill) {
+				u64 nb_spilled, spill_bytes;
+				gf_filter_pid_get_spill_stats(pid, NULL, &nb_spilled, &spill_bytes);
+				GF_LOG(GF_LOG_INFO, GF_LOG_APP, (" - "LLU" packets ("LLU" bytes) spilled to disk", nb_spilled, spill_bytes));
+			}
+			GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\n"));
 		}
 		if (f->nb_errors) {
 			GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\t\t%d errors while processing\n", f->nb_errors));
@@ -1905,7 +2377,7 @@ void gf_fs_print_stats(GF_FilterSession *fsess)
 	count=gf_list_count(fsess->threads);
 	GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("Session stats - threads %d\n", 1+count));
 
-	GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\tThread %u: run_time "LLU" us active_time "LLU" us nb_tasks "LLU"\n", 1, fsess->main_th.run_time, fsess->main_th.active_time, fsess->main_th.nb_tasks));
+	print_thread_stats(&fsess->main_th, 1);
 
 	run_time+=fsess->main_th.run_time;
 	active_time+=fsess->main_th.active_time;
@@ -1914,13 +2386,25 @@ void gf_fs_print_stats(GF_FilterSession *fsess)
 	for (i=0; i<count; i++) {
 		GF_SessionThread *s = gf_list_get(fsess->threads, i);
 
-		GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\tThread %u: run_time "LLU" us active_time "LLU" us nb_tasks "LLU"\n", i+2, s->run_time, s->active_time, s->nb_tasks));
+		print_thread_stats(s, i+2);
 
 		run_time+=s->run_time;
 		active_time+=s->active_time;
 		nb_tasks+=s->nb_tasks;
 	}
 	GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\nTotal: run_time "LLU" us active_time "LLU" us nb_tasks "LLU"\n", run_time, active_time, nb_tasks));
+
+	GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("Packet memory: peak "LLU" bytes", fsess->pck_mem_peak));
+	if (fsess->pid_mem_budget) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_APP, (" - PID budget "LLU" bytes", fsess->pid_mem_budget));
+	}
+	if (fsess->sess_mem_cap) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_APP, (" - session cap "LLU" bytes", fsess->sess_mem_cap));
+	}
+	if (fsess->nb_spilled) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_APP, (" - %u packets spilled to disk", fsess->nb_spilled));
+	}
+	GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\n"));
 }
 
 static void gf_fs_print_filter_outputs(GF_Filter *f, GF_List *filters_done, u32 indent, GF_FilterPid *pid, GF_Filter *alias_for)
@@ -2612,6 +3096,7 @@ void gf_fs_print_all_connections(GF_FilterSession *session, char *filter_name, v
 	u32 llev = gf_log_get_tool_level(GF_LOG_FILTER);
 
 	gf_log_set_tool_level(GF_LOG_FILTER, GF_LOG_INFO);
+	gf_filter_sess_load_graph_edges(session);
 	//load JS to inspect its connections
 	if (filter_name && strstr(filter_name, ".js")) {
 		gf_fs_print_jsf_connection(session, filter_name, print_fn);
@@ -2744,6 +3229,9 @@ GF_DownloadManager *gf_filter_get_download_manager(GF_Filter *filter)
 	if (!filter) return NULL;
 	fsess = filter->session;
 
+	//shared by all sessions of a session group
+	if (fsess->group)
+		return gf_fs_group_get_download_manager(fsess->group);
 	if (!fsess->download_manager) {
 		fsess->download_manager = gf_dm_new(fsess);
 	}
@@ -2757,6 +3245,7 @@ struct _gf_ft_mgr *gf_filter_get_font_manager(GF_Filter *filter)
 	if (!filter) return NULL;
 	fsess = filter->session;
 
+	//not shared in session groups, the font engine is not thread-safe and grouped sessions run concurrently
 	if (!fsess->font_manager) {
 		fsess->font_manager = gf_font_manager_new();
 	}
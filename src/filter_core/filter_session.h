@@ -134,6 +134,8 @@ typedef struct __gf_filter_pck_inst
 	GF_FilterPidInst *pid;
 	u8 pid_props_change_done;
 	u8 pid_info_change_done;
+	//start time of the task which queued the packet in the pid instance, only set when metrics are enabled
+	u64 queue_time;
 
 	//DO NOT EXTEND UNLESS UPDATING CODE IN gf_filter_pck_send()
 } GF_FilterPacketInstance;
@@ -234,6 +236,12 @@ struct __gf_filter_pck
 	GF_PropertyMap *props;
 	//pid properties applying to this packet
 	GF_PropertyMap *pid_props;
+
+	//set if data_length is counted in the memory usage of the pid and session
+	Bool mem_tracked;
+	//chunk of the pid spill log holding the payload, NULL if payload is in memory
+	struct __gf_spill_chunk *spill_chunk;
+	u64 spill_pos;
 };
 
 /*!
@@ -252,7 +260,8 @@ struct __gf_fs_task
 	Bool blocking;
 
 	u64 schedule_next_time;
-
+	//time at which the task was posted or requeued, only set when tracing is enabled
+	u64 post_time;
 
 	gf_fs_task_callback run_task;
 	GF_Filter *filter;
@@ -267,6 +276,29 @@ void gf_fs_post_task_ex(GF_FilterSession *fsess, gf_fs_task_callback task_fun, G
 void gf_filter_pid_send_event_downstream(GF_FSTask *task);
 
 
+//task categories used for metrics
+enum
+{
+	GF_FS_TASK_PROCESS=0,
+	GF_FS_TASK_CONFIGURE,
+	GF_FS_TASK_EVENT,
+	GF_FS_TASK_OTHER,
+	GF_FS_TASK_CAT_COUNT
+};
+
+//CPU set of a group of session threads, tasks of filters bound to this group and semaphore of the group threads
+typedef struct
+{
+	u32 *cpus;
+	u32 nb_cpus;
+	GF_FilterQueue *tasks;
+	GF_Semaphore *sema;
+	u32 nb_threads;
+} GF_FSThreadGroup;
+
+//number of buckets (including +Inf) of the packet queue residence time histograms
+#define GF_FS_METRICS_NB_BUCKETS	15
+
 typedef struct __gf_fs_thread
 {
 	//NULL for main thread
@@ -279,6 +311,13 @@ typedef struct __gf_fs_thread
 	u64 nb_tasks;
 	u64 run_time;
 	u64 active_time;
+	//per task category counters, only updated when metrics are enabled
+	u64 cat_tasks[GF_FS_TASK_CAT_COUNT];
+	u64 cat_time[GF_FS_TASK_CAT_COUNT];
+	//trace events of this thread, only written by this thread
+	struct __gf_fs_trace_buffer *trace_buf;
+	//1-based index of the thread group (CPU set) of this thread, 0 if none
+	u32 th_group;
 
 #ifndef GPAC_DISABLE_REMOTERY
 	u32 rmt_tasks;
@@ -303,6 +342,14 @@ enum
 	GF_FS_NOBLOCK
 };
 
+typedef struct
+{
+	const GF_FilterRegister *freg;
+	const GF_FilterProbeMagic *magic;
+	//index+1 of next signature starting with the same byte, 0 if none
+	u32 next;
+} GF_FSProbeMagic;
+
 struct __gf_filter_session
 {
 	u32 flags;
@@ -388,6 +435,15 @@ struct __gf_filter_session
 	u32 default_pid_buffer_max_us, decoder_pid_buffer_max_us;
 	u32 default_pid_buffer_max_units;
 
+	//memory budget of output pids and memory cap of the session for queued packets, 0 if none - see filter_spill.c
+	u64 pid_mem_budget, sess_mem_cap;
+	//payload size of queued packets in memory, and its peak value
+	volatile s64 pck_mem_used;
+	volatile u64 pck_mem_peak;
+	//payload size of queued packets spilled to disk, and number of packets spilled since session start
+	volatile s64 spill_size;
+	volatile u32 nb_spilled;
+
 #ifdef GPAC_MEMORY_TRACKING
 	Bool check_allocs;
 	u32 nb_alloc_pck, nb_realloc_pck;
@@ -407,6 +463,15 @@ struct __gf_filter_session
 	//protect access to link bank
 	GF_Mutex *links_mx;
 	GF_List *links;
+	//persistent graph and link resolution cache, NULL if disabled - see filter_graph_cache.c
+	struct __gf_fs_graph_cache *graph_cache;
+	//data signatures of the registry, built at first data probe
+	GF_FSProbeMagic *probe_magics;
+	u32 nb_probe_magics;
+	//index+1 of first signature for each value of the first signature byte, 0 if none
+	u32 *probe_magic_heads;
+	u32 *probe_magic_offsets;
+	u32 nb_probe_magic_offsets;
 
 
 	GF_List *parsed_args;
@@ -428,8 +493,75 @@ struct __gf_filter_session
 	GF_List *jstasks;
 	struct __jsfs_task *new_f_task, *del_f_task, *on_evt_task;
 #endif
+
+	//live metrics state, NULL if metrics are not enabled
+	struct __gf_fs_metrics *metrics;
+	//task trace state, NULL if tracing is not enabled
+	struct __gf_fs_trace *trace;
+
+	//thread groups, and filter to thread group bindings as NAME@GROUP list
+	GF_FSThreadGroup *th_groups;
+	u32 nb_th_groups;
+	char *th_bind;
+	//last thread group notified for secondary tasks
+	u32 th_group_notif;
+
+	//session group running this session, NULL if none - see filter_group.c
+	GF_FilterSessionGroup *group;
+	//session state in group, only modified under the group mutex
+	u32 group_state;
+	//set while a thread of the group runs the session
+	Bool group_running;
+	//pending cancel request: 1 discard, 2 flush
+	u32 group_cancel;
+	//clock time in us at which the next task of the session is due, 0 if unknown
+	u64 group_next_due;
+	u64 group_start_time, group_end_time;
+	u32 group_nb_steps;
 };
 
+//metrics collection, see filter_metrics.c
+void gf_fs_metrics_task_done(GF_SessionThread *sess_th, GF_FSTask *task, GF_Filter *filter, u64 task_start, u64 task_time);
+void gf_fs_metrics_pck_dropped(GF_FilterPidInst *pidi, u64 queue_time, u64 now);
+void gf_fs_metrics_del(GF_FilterSession *fsess);
+
+//task and packet tracing, see filter_trace.c
+u32 gf_fs_trace_task_start(GF_SessionThread *sess_th, GF_FSTask *task);
+void gf_fs_trace_task_end(GF_SessionThread *sess_th, GF_FSTask *task, u32 filter_idx, u64 start, u64 task_time);
+void gf_fs_trace_pck(GF_Filter *filter, GF_FilterPacketInstance *pcki, Bool is_send);
+void gf_fs_trace_del(GF_FilterSession *fsess);
+
+//packet memory budget and spilling to disk, see filter_spill.c
+typedef struct __gf_spill_chunk GF_SpillChunk;
+typedef struct __gf_pid_spill GF_PidSpill;
+//accounts the packet memory before dispatch and spills its payload if the pid or session budget is exceeded
+void gf_filter_pid_track_packet(GF_FilterPid *pid, GF_FilterPacket *pck);
+//reloads the payload of a spilled packet
+GF_Err gf_filter_pck_spill_load(GF_FilterPacket *pck);
+//reloads the payload of the head packet of the pid instance and of the next spilled packets
+void gf_filter_pid_spill_readahead(GF_FilterPidInst *pidi, GF_FilterPacketInstance *pcki);
+//removes the packet from memory accounting and spill log, called upon destruction
+void gf_filter_pck_mem_release(GF_FilterPacket *pck);
+void gf_filter_pid_spill_del(GF_FilterPid *pid);
+void gf_filter_pid_get_spill_stats(GF_FilterPid *pid, u64 *disk_size, u64 *nb_pck, u64 *nb_bytes);
+
+//persistent graph cache, see filter_graph_cache.c
+typedef struct __gf_fs_graph_cache GF_FSGraphCache;
+void gf_fs_graph_cache_new(GF_FilterSession *fsess, const char *path);
+void gf_fs_graph_cache_del(GF_FilterSession *fsess);
+void gf_fs_graph_cache_registry_changed(GF_FilterSession *fsess);
+//returns GF_TRUE if chain was found in cache, otherwise sets out_key to the key to use for gf_fs_graph_cache_add_chain (NULL if not cacheable)
+Bool gf_fs_graph_cache_get_chain(GF_FilterPid *pid, GF_Filter *dst, const char *prefRegister, Bool reconfigurable_only, GF_List *out_reg_chain, char **out_key);
+void gf_fs_graph_cache_add_chain(GF_FilterSession *fsess, char *key, GF_List *reg_chain);
+
+//assigns the filter to its thread group, if any
+void gf_fs_filter_bind_thread_group(GF_Filter *filter);
+
+//session groups, see filter_group.c
+void gf_fs_group_notify(GF_FilterSession *fsess);
+void gf_fs_group_detach(GF_FilterSession *fsess);
+GF_DownloadManager *gf_fs_group_get_download_manager(GF_FilterSessionGroup *group);
+
 #ifdef GPAC_HAS_QJS
 void jsfs_on_filter_created(GF_Filter *new_filter);
 void jsfs_on_filter_destroyed(GF_Filter *del_filter);
@@ -587,6 +719,17 @@ struct __gf_filter
 	u64 nb_bytes_sent;
 	//number of microseconds this filter was active
 	u64 time_process;
+	//number of microseconds this filter was active per task category, only updated when metrics are enabled
+	u64 cat_time[GF_FS_TASK_CAT_COUNT];
+	//start time of the task being run by the filter, only updated when metrics are enabled. Written and read by the thread
+	//running the filter, used as a coarse clock for per-packet metrics to avoid querying the system clock for each packet
+	u64 metrics_clock;
+	//index of the filter in the trace filter names (1-based), 0 if not yet traced
+	u32 trace_idx;
+	//session thread running the filter when tracing, used to record packet events in that thread buffer
+	GF_SessionThread *trace_th;
+	//1-based index of the thread group this filter is bound to, 0 if the filter may run on any thread
+	u32 th_group;
 
 #ifdef GPAC_MEMORY_TRACKING
 	//various stats in mem tracking mode, mostly used to detect heavy alloc/free usage by the filter
@@ -805,6 +948,9 @@ struct __gf_filter_pid_inst
 
 	GF_Fraction64 last_ts_drop;
 
+	//metrics: packet residence time in the queue, in us
+	u32 queue_hist[GF_FS_METRICS_NB_BUCKETS];
+	u64 queue_time_sum;
 };
 
 struct __gf_filter_pid
@@ -880,6 +1026,17 @@ struct __gf_filter_pid
 	//only used in filter_check_caps
 	GF_PropertyMap *local_props;
 	volatile u32 num_pidinst_del_pending;
+
+	//metrics: time at which pid entered blocking state (0 if not blocking), cumulated blocking time in us and number of blocking events
+	u64 block_start, block_time;
+	u32 nb_blocks;
+
+	//memory budget in bytes, 0 to use the session default
+	u64 mem_budget;
+	//payload size of packets sent on this pid, in memory and not yet destroyed - concurrent inc/dec
+	volatile s64 mem_used;
+	//spill log, NULL if the pid never spilled packets
+	struct __gf_pid_spill *spill;
 };
 
 
@@ -940,6 +1097,7 @@ void gf_filter_remove_internal(GF_Filter *filter, GF_Filter *until_filter, Bool
 GF_FilterPacket *gf_filter_pck_new_shared_internal(GF_FilterPid *pid, const u8 *data, u32 data_size, gf_fsess_packet_destructor destruct, Bool intern_pck);
 
 void gf_filter_sess_build_graph(GF_FilterSession *fsess, const GF_FilterRegister *freg);
+void gf_filter_sess_load_graph_edges(GF_FilterSession *fsess);
 void gf_filter_sess_reset_graph(GF_FilterSession *fsess, const GF_FilterRegister *freg);
 
 Bool gf_fs_ui_event(GF_FilterSession *session, GF_Event *uievt);
@@ -992,6 +1150,10 @@ typedef struct __freg_desc
 	u32 cap_idx;
 	u8 priority;
 	u8 in_edges_enabling;
+	//input edges not yet computed, cf gf_filter_sess_build_graph
+	u8 edges_pending;
+	//filter excluded from the current link resolution
+	u8 resolve_disabled;
 } GF_FilterRegDesc;
 
 #ifdef GPAC_MEMORY_TRACKING
@@ -1005,6 +1167,10 @@ const char *gf_fs_path_escape_colon(GF_FilterSession *sess, const char *path);
 
 void gf_fs_check_graph_load(GF_FilterSession *fsess, Bool for_load);
 
+void gf_fs_reset_probe_magics(GF_FilterSession *fsess);
+//returns the filter register claiming the data signature, NULL if none or if several registers claim it
+const GF_FilterRegister *gf_fs_probe_magic_match(GF_FilterSession *fsess, const u8 *data, u32 size);
+
 void gf_filter_renegociate_output_task(GF_FSTask *task);
 
 void gf_fs_unload_script(GF_FilterSession *fs, void *js_ctx);
@@ -0,0 +1,382 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2020
+ *					All rights reserved
+ *
+ *  This file is part of GPAC / filters sub-project
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include "filter_session.h"
+
+/*
+Memory budget of packet queues.
+
+The payload size of packets allocated by the filter core is counted per output PID and per session from dispatch until
+destruction. When the PID budget or the session cap is exceeded, the payload of the packet being dispatched is appended
+to a log of temporary files owned by the PID and its memory is released. The payload is reloaded when the packet
+reaches the head of a destination queue, along with the next spilled packets of that queue up to a read-ahead size, so
+that disk reads are done in sequential batches rather than one packet at a time.
+
+The log is made of chunks of fixed max size. A chunk is recycled once all its packets are reloaded or destroyed, so
+that the disk usage follows the amount of spilled data still queued even when the queue never empties.
+
+Packets using filter memory, frame interfaces, references to other packets or custom destructors are never spilled,
+nor are partial data blocks dispatched to a destination aggregating them.
+*/
+
+#define SPILL_CHUNK_SIZE	(64*1024*1024)
+#define SPILL_READAHEAD		(4*1024*1024)
+#define SPILL_READAHEAD_PCKS	256
+
+struct __gf_spill_chunk
+{
+	FILE *file;
+	//write position
+	u64 size;
+	//number of packets stored in this chunk and not yet reloaded or destroyed
+	u32 nb_live;
+};
+
+struct __gf_pid_spill
+{
+	//protects chunks and packet load/release, packets of a PID may be reloaded or destroyed by several consumers
+	GF_Mutex *mx;
+	//chunks with live packets, the last one being the write chunk
+	GF_List *chunks;
+	//empty chunk kept for reuse
+	GF_SpillChunk *spare;
+	Bool write_failed;
+	//bytes currently on disk, total packets and bytes spilled
+	u64 disk_size, nb_pck, nb_bytes;
+};
+
+static void pid_spill_chunk_del(GF_SpillChunk *chunk)
+{
+	if (chunk->file) gf_fclose(chunk->file);
+	gf_free(chunk);
+}
+
+static GF_SpillChunk *pid_spill_get_write_chunk(GF_PidSpill *spill, u32 size)
+{
+	GF_SpillChunk *chunk = gf_list_last(spill->chunks);
+	if (chunk && (!chunk->size || (chunk->size + size <= SPILL_CHUNK_SIZE)))
+		return chunk;
+
+	chunk = spill->spare;
+	spill->spare = NULL;
+	if (!chunk) {
+		GF_SAFEALLOC(chunk, GF_SpillChunk);
+		if (!chunk) return NULL;
+		chunk->file = gf_file_temp(NULL);
+		if (!chunk->file) {
+			gf_free(chunk);
+			return NULL;
+		}
+	}
+	chunk->size = 0;
+	gf_list_add(spill->chunks, chunk);
+	return chunk;
+}
+
+//call with spill mutex held
+static void pid_spill_chunk_release(GF_PidSpill *spill, GF_SpillChunk *chunk, u32 size)
+{
+	assert(chunk->nb_live);
+	assert(spill->disk_size >= size);
+	spill->disk_size -= size;
+	chunk->nb_live--;
+	if (chunk->nb_live) return;
+
+	//write chunk, rewind it
+	if (chunk == gf_list_last(spill->chunks)) {
+		chunk->size = 0;
+		return;
+	}
+	gf_list_del_item(spill->chunks, chunk);
+	if (!spill->spare) {
+		chunk->size = 0;
+		spill->spare = chunk;
+	} else {
+		pid_spill_chunk_del(chunk);
+	}
+}
+
+static GFINLINE u64 pid_mem_budget(GF_FilterPid *pid)
+{
+	return pid->mem_budget ? pid->mem_budget : pid->filter->session->pid_mem_budget;
+}
+
+//packets are tracked and reloaded by the threads of their producers and consumers
+static void sess_update_mem_peak(GF_FilterSession *fsess, s64 sess_mem)
+{
+	while (1) {
+		u64 peak = fsess->pck_mem_peak;
+		if ((u64) sess_mem <= peak) return;
+		if (safe_int64_cas(&fsess->pck_mem_peak, peak, sess_mem)) return;
+	}
+}
+
+static void pid_spill_packet(GF_FilterPid *pid, GF_FilterPacket *pck)
+{
+	GF_SpillChunk *chunk;
+	GF_PidSpill *spill = pid->spill;
+	GF_FilterSession *fsess = pid->filter->session;
+	u32 size = pck->data_length;
+
+	//only the filter owning the pid creates the spill state, consumers only access it for spilled packets
+	if (!spill) {
+		GF_SAFEALLOC(spill, GF_PidSpill);
+		if (!spill) return;
+		spill->mx = gf_mx_new("PIDSpill");
+		spill->chunks = gf_list_new();
+		pid->spill = spill;
+	}
+	if (spill->write_failed) return;
+
+	gf_mx_p(spill->mx);
+	chunk = pid_spill_get_write_chunk(spill, size);
+	if (chunk) {
+		gf_fseek(chunk->file, chunk->size, SEEK_SET);
+		if (gf_fwrite(pck->data, size, chunk->file) != size)
+			chunk = NULL;
+	}
+	if (!chunk) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_FILTER, ("Filter %s PID %s failed to spill packets to disk, keeping them in memory\n", pid->filter->name, pid->name));
+		spill->write_failed = GF_TRUE;
+		gf_mx_v(spill->mx);
+		return;
+	}
+	pck->spill_chunk = chunk;
+	pck->spill_pos = chunk->size;
+	chunk->size += size;
+	chunk->nb_live++;
+	spill->disk_size += size;
+	spill->nb_pck++;
+	spill->nb_bytes += size;
+	gf_mx_v(spill->mx);
+
+	gf_free(pck->data);
+	pck->data = NULL;
+	pck->alloc_size = 0;
+	pck->mem_tracked = GF_FALSE;
+	safe_int64_sub(&pid->mem_used, size);
+	safe_int64_sub(&fsess->pck_mem_used, size);
+	safe_int64_add(&fsess->spill_size, size);
+	safe_int_inc(&fsess->nb_spilled);
+
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_FILTER, ("Filter %s PID %s spilled packet of %d bytes - "LLU" bytes on disk\n", pid->filter->name, pid->name, size, spill->disk_size));
+}
+
+void gf_filter_pid_track_packet(GF_FilterPid *pid, GF_FilterPacket *pck)
+{
+	u32 i;
+	u64 budget;
+	s64 pid_mem, sess_mem;
+	GF_FilterSession *fsess = pid->filter->session;
+
+	if (pck->filter_owns_mem || pck->frame_ifce || pck->reference || !pck->data || !pck->data_length)
+		return;
+
+	pck->mem_tracked = GF_TRUE;
+	pid_mem = safe_int64_add(&pid->mem_used, pck->data_length);
+	sess_mem = safe_int64_add(&fsess->pck_mem_used, pck->data_length);
+	sess_update_mem_peak(fsess, sess_mem);
+
+	budget = pid_mem_budget(pid);
+	if (budget && ((u64) pid_mem > budget)) {
+	} else if (fsess->sess_mem_cap && ((u64) sess_mem > fsess->sess_mem_cap)) {
+	} else {
+		return;
+	}
+
+	//packet held by the filter, or with a destructor potentially accessing the payload
+	if (pck->reference_count || pck->destructor || !pid->num_destinations)
+		return;
+	//partial blocks may be aggregated at dispatch time
+	if ((pck->info.flags & (GF_PCKF_BLOCK_START|GF_PCKF_BLOCK_END)) != (GF_PCKF_BLOCK_START|GF_PCKF_BLOCK_END)) {
+		for (i=0; i<pid->num_destinations; i++) {
+			GF_FilterPidInst *pidi = gf_list_get(pid->destinations, i);
+			if (pidi->requires_full_data_block) return;
+		}
+	}
+	pid_spill_packet(pid, pck);
+}
+
+GF_Err gf_filter_pck_spill_load(GF_FilterPacket *pck)
+{
+	u32 size;
+	GF_SpillChunk *chunk;
+	GF_FilterPid *pid = pck->pid;
+	GF_PidSpill *spill = pid->spill;
+	GF_FilterSession *fsess = pid->filter->session;
+	GF_Err e = GF_OK;
+
+	gf_mx_p(spill->mx);
+	//already loaded by another consumer of the PID
+	chunk = pck->spill_chunk;
+	if (!chunk) {
+		gf_mx_v(spill->mx);
+		return GF_OK;
+	}
+	size = pck->data_length;
+	pck->data = gf_malloc(size);
+	if (!pck->data) {
+		gf_mx_v(spill->mx);
+		return GF_OUT_OF_MEM;
+	}
+	pck->alloc_size = size;
+	gf_fseek(chunk->file, pck->spill_pos, SEEK_SET);
+	if (gf_fread(pck->data, size, chunk->file) != size) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("Filter %s PID %s failed to reload spilled packet from disk\n", pid->filter->name, pid->name));
+		memset(pck->data, 0, size);
+		pck->info.flags |= GF_PCKF_CORRUPTED;
+		e = GF_IO_ERR;
+	}
+	pid_spill_chunk_release(spill, chunk, size);
+	pck->spill_chunk = NULL;
+	pck->mem_tracked = GF_TRUE;
+	gf_mx_v(spill->mx);
+
+	safe_int64_add(&pid->mem_used, size);
+	sess_update_mem_peak(fsess, safe_int64_add(&fsess->pck_mem_used, size));
+	safe_int64_sub(&fsess->spill_size, size);
+	return e;
+}
+
+typedef struct
+{
+	u32 nb_pck, size, max_size;
+	//spilled packets to reload, referenced while the queue is locked
+	u32 nb_load;
+	GF_FilterPacket *load[SPILL_READAHEAD_PCKS];
+} GF_SpillReadAhead;
+
+static Bool pid_spill_readahead_enum(void *udta, void *item)
+{
+	GF_SpillReadAhead *ra = (GF_SpillReadAhead *) udta;
+	GF_FilterPacket *pck = ((GF_FilterPacketInstance *) item)->pck;
+
+	if (pck->spill_chunk) {
+		gf_filter_pck_ref(&pck);
+		ra->load[ra->nb_load++] = pck;
+		ra->size += pck->data_length;
+	}
+	ra->nb_pck++;
+	if ((ra->size >= ra->max_size) || (ra->nb_pck >= SPILL_READAHEAD_PCKS))
+		return GF_FALSE;
+	return GF_TRUE;
+}
+
+void gf_filter_pid_spill_readahead(GF_FilterPidInst *pidi, GF_FilterPacketInstance *pcki)
+{
+	u32 i;
+	u64 budget;
+	GF_SpillReadAhead ra;
+
+	//head packet was reloaded by another consumer, or read-ahead already done
+	if (!pcki->pck->spill_chunk) return;
+
+	ra.nb_pck = ra.size = ra.nb_load = 0;
+	ra.max_size = SPILL_READAHEAD;
+	budget = pid_mem_budget(pidi->pid);
+	if (budget && (budget/4 < ra.max_size)) ra.max_size = (u32) (budget/4);
+
+	//the head packet is always reloaded, then spilled packets following it
+	//packets are collected with the queue locked and reloaded once unlocked, so that the producer is not blocked by disk reads
+	gf_fq_enum(pidi->packets, pid_spill_readahead_enum, &ra);
+	for (i=0; i<ra.nb_load; i++) {
+		gf_filter_pck_spill_load(ra.load[i]);
+		gf_filter_pck_unref(ra.load[i]);
+	}
+	if (pcki->pck->spill_chunk)
+		gf_filter_pck_spill_load(pcki->pck);
+}
+
+void gf_filter_pck_mem_release(GF_FilterPacket *pck)
+{
+	GF_FilterPid *pid = pck->pid;
+	GF_FilterSession *fsess = pck->session;
+	u32 size = pck->data_length;
+
+	if (pck->spill_chunk) {
+		GF_PidSpill *spill = pid->spill;
+		gf_mx_p(spill->mx);
+		//might have been reloaded in between
+		if (pck->spill_chunk) {
+			pid_spill_chunk_release(spill, pck->spill_chunk, size);
+			pck->spill_chunk = NULL;
+			safe_int64_sub(&fsess->spill_size, size);
+		}
+		gf_mx_v(spill->mx);
+	}
+	if (pck->mem_tracked) {
+		pck->mem_tracked = GF_FALSE;
+		safe_int64_sub(&pid->mem_used, size);
+		safe_int64_sub(&fsess->pck_mem_used, size);
+	}
+}
+
+void gf_filter_pid_spill_del(GF_FilterPid *pid)
+{
+	GF_PidSpill *spill = pid->spill;
+	if (!spill) return;
+	pid->spill = NULL;
+
+	if (spill->nb_pck) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_FILTER, ("Filter %s PID %s spilled "LLU" packets ("LLU" bytes) to disk\n", pid->filter->name, pid->name, spill->nb_pck, spill->nb_bytes));
+	}
+	if (spill->disk_size) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_FILTER, ("Filter %s PID %s destroyed with "LLU" bytes of spilled packets still queued\n", pid->filter->name, pid->name, spill->disk_size));
+	}
+	while (gf_list_count(spill->chunks)) {
+		pid_spill_chunk_del(gf_list_pop_back(spill->chunks));
+	}
+	gf_list_del(spill->chunks);
+	if (spill->spare) pid_spill_chunk_del(spill->spare);
+	gf_mx_del(spill->mx);
+	gf_free(spill);
+}
+
+void gf_filter_pid_get_spill_stats(GF_FilterPid *pid, u64 *disk_size, u64 *nb_pck, u64 *nb_bytes)
+{
+	GF_PidSpill *spill = pid->spill;
+	if (disk_size) *disk_size = spill ? spill->disk_size : 0;
+	if (nb_pck) *nb_pck = spill ? spill->nb_pck : 0;
+	if (nb_bytes) *nb_bytes = spill ? spill->nb_bytes : 0;
+}
+
+GF_EXPORT
+GF_Err gf_fs_set_memory_budget(GF_FilterSession *session, u64 pid_budget, u64 session_cap)
+{
+	if (!session) return GF_BAD_PARAM;
+	session->pid_mem_budget = pid_budget;
+	session->sess_mem_cap = session_cap;
+	return GF_OK;
+}
+
+GF_EXPORT
+void gf_filter_pid_set_memory_budget(GF_FilterPid *pid, u64 max_bytes)
+{
+	if (PID_IS_INPUT(pid)) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("Setting memory budget on input PID %s in filter %s not allowed\n", pid->pid->name, pid->filter->name));
+		return;
+	}
+	pid->mem_budget = max_bytes;
+}
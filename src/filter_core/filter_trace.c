@@ -0,0 +1,654 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2020
+ *					All rights reserved
+ *
+ *  This file is part of GPAC / filters sub-project
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include "filter_session.h"
+
+/*
+Timeline trace of a filter session.
+
+Each session thread records its task executions and packet send/drop events in its own buffer, made of fixed-size blocks.
+Only the owning thread writes to a buffer, and events are published by atomically incrementing the block event count, so
+no lock is taken when recording.
+
+In ring mode, the oldest block of a thread is recycled once all its events are older than the trace window. A dump performed
+while the session is running detects recycled blocks through their generation counter and ignores them.
+
+Traces are written either as Chrome trace event JSON (chrome://tracing, ui.perfetto.dev) or as Perfetto protobuf (.pftrace, .perfetto-trace, .pb).
+*/
+
+#define TRACE_BLOCK_SIZE	4096
+
+enum
+{
+	TRACE_EVT_TASK=0,
+	TRACE_EVT_PCK_SEND,
+	TRACE_EVT_PCK_DROP,
+};
+
+typedef struct
+{
+	u64 ts;
+	//task duration, or packet flow ID
+	u64 val;
+	//task name, always a static string
+	const char *name;
+	u32 filter_idx;
+	u32 type;
+	//task queue wait time, or packet size
+	u32 arg;
+	//thread index, only set when collecting
+	u32 th_idx;
+} GF_FSTraceEvent;
+
+typedef struct __gf_fs_trace_block
+{
+	struct __gf_fs_trace_block *next;
+	volatile u32 gen;
+	volatile u32 nb_events;
+	GF_FSTraceEvent events[TRACE_BLOCK_SIZE];
+} GF_FSTraceBlock;
+
+typedef struct __gf_fs_trace_buffer
+{
+	GF_FSTraceBlock * volatile head;
+	GF_FSTraceBlock *tail;
+	u32 nb_blocks;
+	//0 for main thread
+	u32 th_idx;
+} GF_FSTraceBuffer;
+
+typedef struct __gf_fs_trace
+{
+	GF_FilterSession *fsess;
+	char *dst;
+	//trace window in microseconds, 0 means whole session
+	u64 ring_dur;
+
+	//protects buffers and filter_names lists
+	GF_Mutex *mx;
+	GF_List *buffers;
+	GF_List *filter_names;
+
+	volatile u32 dump_request;
+	u32 nb_dumps;
+} GF_FSTrace;
+
+static GF_FSTraceEvent *trace_new_event(GF_FSTrace *trace, GF_SessionThread *sess_th, u64 now)
+{
+	GF_FSTraceBlock *blk;
+	GF_FSTraceBuffer *buf = sess_th->trace_buf;
+	if (!buf) {
+		GF_SAFEALLOC(buf, GF_FSTraceBuffer);
+		if (!buf) return NULL;
+		gf_mx_p(trace->mx);
+		if (sess_th != &trace->fsess->main_th)
+			buf->th_idx = 1 + gf_list_find(trace->fsess->threads, sess_th);
+		gf_list_add(trace->buffers, buf);
+		gf_mx_v(trace->mx);
+		sess_th->trace_buf = buf;
+	}
+	blk = buf->tail;
+	if (blk && (blk->nb_events < TRACE_BLOCK_SIZE))
+		return &blk->events[blk->nb_events];
+
+	blk = buf->head;
+	//ring mode, recycle the oldest block if all its events are out of the trace window
+	if (trace->ring_dur && (buf->nb_blocks>2) && (blk->events[TRACE_BLOCK_SIZE-1].ts + trace->ring_dur < now)) {
+		buf->head = blk->next;
+		safe_int_inc(&blk->gen);
+		blk->nb_events = 0;
+		blk->next = NULL;
+	} else {
+		GF_SAFEALLOC(blk, GF_FSTraceBlock);
+		if (!blk) return NULL;
+		buf->nb_blocks++;
+	}
+	if (buf->tail) buf->tail->next = blk;
+	else buf->head = blk;
+	buf->tail = blk;
+	return &blk->events[0];
+}
+
+static u32 trace_filter_idx(GF_FSTrace *trace, GF_Filter *filter)
+{
+	if (!filter->trace_idx) {
+		gf_mx_p(trace->mx);
+		gf_list_add(trace->filter_names, gf_strdup(filter->name ? filter->name : filter->freg->name));
+		filter->trace_idx = gf_list_count(trace->filter_names);
+		gf_mx_v(trace->mx);
+	}
+	return filter->trace_idx;
+}
+
+u32 gf_fs_trace_task_start(GF_SessionThread *sess_th, GF_FSTask *task)
+{
+	GF_Filter *filter = task->filter;
+	if (!filter) return 0;
+	filter->trace_th = sess_th;
+	return trace_filter_idx(sess_th->fsess->trace, filter);
+}
+
+static void trace_dump_requested(GF_FSTrace *trace);
+
+void gf_fs_trace_task_end(GF_SessionThread *sess_th, GF_FSTask *task, u32 filter_idx, u64 start, u64 task_time)
+{
+	GF_FSTrace *trace = sess_th->fsess->trace;
+	u64 end = start + task_time;
+	GF_FSTraceEvent *evt = trace_new_event(trace, sess_th, end);
+	if (evt) {
+		evt->ts = start;
+		evt->val = task_time;
+		evt->name = task->log_name;
+		evt->filter_idx = filter_idx;
+		evt->type = TRACE_EVT_TASK;
+		evt->arg = (task->post_time && (start > task->post_time)) ? (u32) (start - task->post_time) : 0;
+		safe_int_inc(&sess_th->trace_buf->tail->nb_events);
+	}
+	//requeued tasks wait from now on
+	if (task->requeue_request)
+		task->post_time = end;
+
+	if (trace->dump_request)
+		trace_dump_requested(trace);
+}
+
+void gf_fs_trace_pck(GF_Filter *filter, GF_FilterPacketInstance *pcki, Bool is_send)
+{
+	GF_FSTraceEvent *evt;
+	GF_SessionThread *sess_th = filter->trace_th;
+	u64 now;
+	//only record packets sent or dropped while the filter runs a task, other threads do not own a trace buffer
+	if (!sess_th || (sess_th->th_id != gf_th_id())) return;
+
+	now = gf_sys_clock_high_res();
+	evt = trace_new_event(sess_th->fsess->trace, sess_th, now);
+	if (!evt) return;
+	evt->ts = now;
+	evt->val = (u64) (size_t) pcki;
+	evt->name = NULL;
+	evt->filter_idx = filter->trace_idx;
+	evt->type = is_send ? TRACE_EVT_PCK_SEND : TRACE_EVT_PCK_DROP;
+	evt->arg = pcki->pck->data_length;
+	safe_int_inc(&sess_th->trace_buf->tail->nb_events);
+}
+
+//copies events of a thread buffer, returns GF_FALSE if a block was recycled during the copy
+static Bool trace_collect_buffer(GF_FSTraceBuffer *buf, GF_FSTraceEvent **events, u32 *nb_events, u32 *nb_alloc, u64 min_ts)
+{
+	u32 start = *nb_events;
+	GF_FSTraceBlock *blk = buf->head;
+	while (blk) {
+		u32 i, gen, count;
+		gen = (u32) safe_int_add(&blk->gen, 0);
+		count = (u32) safe_int_add(&blk->nb_events, 0);
+		if (*nb_events + count > *nb_alloc) {
+			*nb_alloc = *nb_events + count + TRACE_BLOCK_SIZE;
+			*events = gf_realloc(*events, sizeof(GF_FSTraceEvent) * (*nb_alloc));
+			if (! *events) return GF_TRUE;
+		}
+		for (i=0; i<count; i++) {
+			GF_FSTraceEvent *evt = &blk->events[i];
+			u64 end = evt->ts + ((evt->type==TRACE_EVT_TASK) ? evt->val : 0);
+			if (end < min_ts) continue;
+			(*events)[*nb_events] = *evt;
+			(*events)[*nb_events].th_idx = buf->th_idx;
+			(*nb_events)++;
+		}
+		if ((u32) safe_int_add(&blk->gen, 0) != gen) {
+			*nb_events = start;
+			return GF_FALSE;
+		}
+		blk = blk->next;
+	}
+	return GF_TRUE;
+}
+
+static int trace_evt_cmp(const void *_a, const void *_b)
+{
+	const GF_FSTraceEvent *a = _a;
+	const GF_FSTraceEvent *b = _b;
+	u64 dur_a, dur_b;
+	if (a->th_idx != b->th_idx) return (a->th_idx < b->th_idx) ? -1 : 1;
+	if (a->ts != b->ts) return (a->ts < b->ts) ? -1 : 1;
+	//enclosing tasks first
+	dur_a = (a->type==TRACE_EVT_TASK) ? a->val : 0;
+	dur_b = (b->type==TRACE_EVT_TASK) ? b->val : 0;
+	if (dur_a != dur_b) return (dur_a > dur_b) ? -1 : 1;
+	if (a->type != b->type) return (a->type < b->type) ? -1 : 1;
+	return 0;
+}
+
+static void trace_json_str(FILE *out, const char *str)
+{
+	gf_fputc('"', out);
+	while (str && *str) {
+		u8 c = (u8) *str;
+		if ((c=='"') || (c=='\\')) gf_fprintf(out, "\\%c", c);
+		else if (c<0x20) gf_fprintf(out, "\\u%04x", c);
+		else gf_fputc(c, out);
+		str++;
+	}
+	gf_fputc('"', out);
+}
+
+static const char *trace_filter_name(GF_FSTrace *trace, u32 filter_idx)
+{
+	const char *name = filter_idx ? gf_list_get(trace->filter_names, filter_idx-1) : NULL;
+	return name ? name : "session";
+}
+
+static void trace_task_name(GF_FSTrace *trace, GF_FSTraceEvent *evt, char szName[1024])
+{
+	const char *name = evt->name ? evt->name : "task";
+	if (evt->filter_idx) snprintf(szName, 1024, "%s.%s", trace_filter_name(trace, evt->filter_idx), name);
+	else snprintf(szName, 1024, "%s", name);
+	szName[1023] = 0;
+}
+
+static void trace_write_json(GF_FSTrace *trace, FILE *out, GF_FSTraceEvent *events, u32 nb_events, u32 nb_threads)
+{
+	u32 i;
+	char szName[1024];
+	gf_fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	gf_fprintf(out, "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"gpac\"}}");
+	for (i=0; i<nb_threads; i++) {
+		gf_fprintf(out, ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", i);
+		if (i) gf_fprintf(out, "\"thread %u\"}}", i);
+		else gf_fprintf(out, "\"main\"}}");
+	}
+	for (i=0; i<nb_events; i++) {
+		GF_FSTraceEvent *evt = &events[i];
+		const char *fname = trace_filter_name(trace, evt->filter_idx);
+		if (evt->type == TRACE_EVT_TASK) {
+			trace_task_name(trace, evt, szName);
+			gf_fprintf(out, ",\n{\"ph\":\"X\",\"cat\":\"task\",\"pid\":1,\"tid\":%u,\"ts\":"LLU",\"dur\":"LLU",\"name\":", evt->th_idx, evt->ts, evt->val);
+			trace_json_str(out, szName);
+			gf_fprintf(out, ",\"args\":{\"filter\":");
+			trace_json_str(out, fname);
+			gf_fprintf(out, ",\"queue_us\":%u}}", evt->arg);
+		} else {
+			Bool is_send = (evt->type == TRACE_EVT_PCK_SEND) ? GF_TRUE : GF_FALSE;
+			gf_fprintf(out, ",\n{\"ph\":\"%s\",\"cat\":\"packet\",\"name\":\"packet\",\"pid\":1,\"tid\":%u,\"ts\":"LLU",\"id\":\""LLX"\",\"args\":{\"filter\":", is_send ? "s" : "f\",\"bp\":\"e", evt->th_idx, evt->ts, evt->val);
+			trace_json_str(out, fname);
+			gf_fprintf(out, ",\"size\":%u}}", evt->arg);
+		}
+	}
+	gf_fprintf(out, "\n]}\n");
+}
+
+/*minimal protobuf writer for perfetto traces*/
+typedef struct
+{
+	u8 *data;
+	u32 size, alloc;
+} GF_PBuf;
+
+static void pb_bytes(GF_PBuf *pb, const u8 *data, u32 len)
+{
+	if (pb->size + len > pb->alloc) {
+		pb->alloc = 2*(pb->size + len) + 64;
+		pb->data = gf_realloc(pb->data, pb->alloc);
+	}
+	memcpy(pb->data + pb->size, data, len);
+	pb->size += len;
+}
+static void pb_varint(GF_PBuf *pb, u64 v)
+{
+	u8 buf[10];
+	u32 len=0;
+	do {
+		buf[len] = (u8) (v & 0x7F);
+		v >>= 7;
+		if (v) buf[len] |= 0x80;
+		len++;
+	} while (v);
+	pb_bytes(pb, buf, len);
+}
+static void pb_uint(GF_PBuf *pb, u32 field, u64 v)
+{
+	pb_varint(pb, field<<3);
+	pb_varint(pb, v);
+}
+static void pb_fixed64(GF_PBuf *pb, u32 field, u64 v)
+{
+	u8 buf[8];
+	u32 i;
+	for (i=0; i<8; i++) buf[i] = (u8) (v >> (8*i));
+	pb_varint(pb, (field<<3) | 1);
+	pb_bytes(pb, buf, 8);
+}
+static void pb_data(GF_PBuf *pb, u32 field, const u8 *data, u32 len)
+{
+	pb_varint(pb, (field<<3) | 2);
+	pb_varint(pb, len);
+	pb_bytes(pb, data, len);
+}
+static void pb_str(GF_PBuf *pb, u32 field, const char *str)
+{
+	pb_data(pb, field, (const u8 *) str, (u32) strlen(str));
+}
+//writes sub-message and resets it
+static void pb_msg(GF_PBuf *pb, u32 field, GF_PBuf *sub)
+{
+	pb_data(pb, field, sub->data, sub->size);
+	sub->size = 0;
+}
+
+//perfetto field numbers
+#define PF_TRACE_PACKET			1
+#define PF_PCK_TIMESTAMP		8
+#define PF_PCK_SEQ_ID			10
+#define PF_PCK_TRACK_EVENT		11
+#define PF_PCK_SEQ_FLAGS		13
+#define PF_PCK_TRACK_DESC		60
+#define PF_TD_UUID				1
+#define PF_TD_PROCESS			3
+#define PF_TD_THREAD			4
+#define PF_PROC_PID				1
+#define PF_PROC_NAME			6
+#define PF_THREAD_PID			1
+#define PF_THREAD_TID			2
+#define PF_THREAD_NAME			5
+#define PF_TE_ANNOTATIONS		4
+#define PF_TE_TYPE				9
+#define PF_TE_TRACK_UUID		11
+#define PF_TE_CATEGORIES		22
+#define PF_TE_NAME				23
+#define PF_TE_FLOW_IDS			47
+#define PF_TE_TERM_FLOW_IDS		48
+#define PF_DA_UINT				3
+#define PF_DA_STRING			6
+#define PF_DA_NAME				10
+
+#define PF_TYPE_SLICE_BEGIN		1
+#define PF_TYPE_SLICE_END		2
+#define PF_TYPE_INSTANT			3
+
+typedef struct
+{
+	FILE *out;
+	GF_PBuf pck, evt, sub, ann;
+	Bool first;
+} GF_PFWriter;
+
+static void pf_flush_packet(GF_PFWriter *pf, u64 ts_us)
+{
+	GF_PBuf *pck = &pf->pck;
+	pck->size = 0;
+	if (pf->first) {
+		pb_uint(pck, PF_PCK_SEQ_FLAGS, 1);
+		pf->first = GF_FALSE;
+	}
+	pb_uint(pck, PF_PCK_TIMESTAMP, ts_us*1000);
+	pb_uint(pck, PF_PCK_SEQ_ID, 1);
+	if (pf->evt.size) pb_msg(pck, PF_PCK_TRACK_EVENT, &pf->evt);
+	if (pf->sub.size) pb_msg(pck, PF_PCK_TRACK_DESC, &pf->sub);
+
+	pf->evt.size = 0;
+	pb_data(&pf->evt, PF_TRACE_PACKET, pck->data, pck->size);
+	gf_fwrite(pf->evt.data, pf->evt.size, pf->out);
+	pf->evt.size = 0;
+}
+
+static void pf_annotation(GF_PFWriter *pf, const char *name, const char *str_val, u64 val)
+{
+	pb_str(&pf->ann, PF_DA_NAME, name);
+	if (str_val) pb_str(&pf->ann, PF_DA_STRING, str_val);
+	else pb_uint(&pf->ann, PF_DA_UINT, val);
+	pb_msg(&pf->evt, PF_TE_ANNOTATIONS, &pf->ann);
+}
+
+static void pf_slice_end(GF_PFWriter *pf, GF_FSTraceEvent *evt)
+{
+	pb_uint(&pf->evt, PF_TE_TYPE, PF_TYPE_SLICE_END);
+	pb_uint(&pf->evt, PF_TE_TRACK_UUID, 2 + evt->th_idx);
+	pf_flush_packet(pf, evt->ts + evt->val);
+}
+
+static void trace_write_perfetto(GF_FSTrace *trace, FILE *out, GF_FSTraceEvent *events, u32 nb_events, u32 nb_threads)
+{
+	u32 i, depth=0;
+	char szName[1024];
+	GF_FSTraceEvent **stack;
+	GF_PFWriter pf;
+	memset(&pf, 0, sizeof(GF_PFWriter));
+	pf.out = out;
+	pf.first = GF_TRUE;
+
+	//process and thread tracks
+	pb_uint(&pf.sub, PF_TD_UUID, 1);
+	pb_uint(&pf.ann, PF_PROC_PID, 1);
+	pb_str(&pf.ann, PF_PROC_NAME, "gpac");
+	pb_msg(&pf.sub, PF_TD_PROCESS, &pf.ann);
+	pf_flush_packet(&pf, 0);
+	for (i=0; i<nb_threads; i++) {
+		pb_uint(&pf.sub, PF_TD_UUID, 2+i);
+		pb_uint(&pf.ann, PF_THREAD_PID, 1);
+		pb_uint(&pf.ann, PF_THREAD_TID, 2+i);
+		if (i) sprintf(szName, "thread %u", i);
+		else strcpy(szName, "main");
+		pb_str(&pf.ann, PF_THREAD_NAME, szName);
+		pb_msg(&pf.sub, PF_TD_THREAD, &pf.ann);
+		pf_flush_packet(&pf, 0);
+	}
+
+	//events are sorted by thread, start time and decreasing duration, so enclosing tasks come first
+	stack = gf_malloc(sizeof(GF_FSTraceEvent *) * (nb_events+1));
+	for (i=0; i<nb_events; i++) {
+		GF_FSTraceEvent *evt = &events[i];
+		const char *fname = trace_filter_name(trace, evt->filter_idx);
+		u64 end = evt->ts + ((evt->type==TRACE_EVT_TASK) ? evt->val : 0);
+
+		//close tasks ending before this event, or not on the same thread
+		while (depth) {
+			GF_FSTraceEvent *top = stack[depth-1];
+			u64 top_end = top->ts + top->val;
+			if ((top->th_idx == evt->th_idx) && (end <= top_end)) {
+				if (top_end > evt->ts) break;
+				//event at the very end of the enclosing task, keep it nested if empty
+				if ((top_end == evt->ts) && (end == evt->ts)) break;
+			}
+			pf_slice_end(&pf, top);
+			depth--;
+		}
+
+		if (evt->type == TRACE_EVT_TASK) {
+			trace_task_name(trace, evt, szName);
+			pb_uint(&pf.evt, PF_TE_TYPE, PF_TYPE_SLICE_BEGIN);
+			pb_uint(&pf.evt, PF_TE_TRACK_UUID, 2 + evt->th_idx);
+			pb_str(&pf.evt, PF_TE_CATEGORIES, "task");
+			pb_str(&pf.evt, PF_TE_NAME, szName);
+			pf_annotation(&pf, "filter", fname, 0);
+			pf_annotation(&pf, "queue_us", NULL, evt->arg);
+			pf_flush_packet(&pf, evt->ts);
+			stack[depth++] = evt;
+		} else {
+			pb_uint(&pf.evt, PF_TE_TYPE, PF_TYPE_INSTANT);
+			pb_uint(&pf.evt, PF_TE_TRACK_UUID, 2 + evt->th_idx);
+			pb_str(&pf.evt, PF_TE_CATEGORIES, "packet");
+			pb_str(&pf.evt, PF_TE_NAME, (evt->type == TRACE_EVT_PCK_SEND) ? "send" : "drop");
+			pb_fixed64(&pf.evt, (evt->type == TRACE_EVT_PCK_SEND) ? PF_TE_FLOW_IDS : PF_TE_TERM_FLOW_IDS, evt->val);
+			pf_annotation(&pf, "filter", fname, 0);
+			pf_annotation(&pf, "size", NULL, evt->arg);
+			pf_flush_packet(&pf, evt->ts);
+		}
+	}
+	while (depth) {
+		pf_slice_end(&pf, stack[depth-1]);
+		depth--;
+	}
+	gf_free(stack);
+	if (pf.pck.data) gf_free(pf.pck.data);
+	if (pf.evt.data) gf_free(pf.evt.data);
+	if (pf.sub.data) gf_free(pf.sub.data);
+	if (pf.ann.data) gf_free(pf.ann.data);
+}
+
+GF_EXPORT
+GF_Err gf_fs_dump_trace(GF_FilterSession *fsess, const char *dst)
+{
+	u32 i, count, nb_events=0, nb_alloc=0, nb_threads=0;
+	u64 min_ts = 0;
+	GF_FSTraceEvent *events = NULL;
+	Bool is_pb = GF_FALSE;
+	const char *ext;
+	FILE *out;
+	GF_FSTrace *trace = fsess ? fsess->trace : NULL;
+	if (!trace) return GF_NOT_SUPPORTED;
+	if (!dst) dst = trace->dst;
+	if (!dst) return GF_BAD_PARAM;
+
+	if (trace->ring_dur) {
+		u64 now = gf_sys_clock_high_res();
+		if (now > trace->ring_dur) min_ts = now - trace->ring_dur;
+	}
+
+	gf_mx_p(trace->mx);
+	count = gf_list_count(trace->buffers);
+	for (i=0; i<count; i++) {
+		u32 retry = 3;
+		GF_FSTraceBuffer *buf = gf_list_get(trace->buffers, i);
+		while (retry && !trace_collect_buffer(buf, &events, &nb_events, &nb_alloc, min_ts))
+			retry--;
+		if (!events) {
+			gf_mx_v(trace->mx);
+			return GF_OUT_OF_MEM;
+		}
+		if (buf->th_idx >= nb_threads) nb_threads = buf->th_idx+1;
+	}
+
+	out = gf_fopen(dst, "wb");
+	if (!out) {
+		gf_mx_v(trace->mx);
+		if (events) gf_free(events);
+		GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("[Trace] Failed to open trace file %s\n", dst));
+		return GF_IO_ERR;
+	}
+	if (nb_events)
+		qsort(events, nb_events, sizeof(GF_FSTraceEvent), trace_evt_cmp);
+
+	ext = gf_file_ext_start(dst);
+	if (ext && (!stricmp(ext, ".pftrace") || !stricmp(ext, ".perfetto-trace") || !stricmp(ext, ".pb")))
+		is_pb = GF_TRUE;
+
+	if (is_pb)
+		trace_write_perfetto(trace, out, events, nb_events, nb_threads);
+	else
+		trace_write_json(trace, out, events, nb_events, nb_threads);
+	gf_mx_v(trace->mx);
+
+	gf_fclose(out);
+	if (events) gf_free(events);
+	GF_LOG(GF_LOG_INFO, GF_LOG_FILTER, ("[Trace] Wrote %u events to %s\n", nb_events, dst));
+	return GF_OK;
+}
+
+static void trace_dump_requested(GF_FSTrace *trace)
+{
+	char szFile[GF_MAX_PATH];
+	const char *ext;
+	Bool do_dump = GF_FALSE;
+
+	gf_mx_p(trace->mx);
+	if (trace->dump_request) {
+		trace->dump_request = 0;
+		trace->nb_dumps++;
+		do_dump = GF_TRUE;
+	}
+	gf_mx_v(trace->mx);
+	if (!do_dump) return;
+
+	//insert dump index before extension
+	ext = gf_file_ext_start(trace->dst);
+	if (ext)
+		snprintf(szFile, GF_MAX_PATH, "%.*s_%u%s", (int) (ext - trace->dst), trace->dst, trace->nb_dumps, ext);
+	else
+		snprintf(szFile, GF_MAX_PATH, "%s_%u", trace->dst, trace->nb_dumps);
+	szFile[GF_MAX_PATH-1] = 0;
+	gf_fs_dump_trace(trace->fsess, szFile);
+}
+
+GF_EXPORT
+void gf_fs_request_trace_dump(GF_FilterSession *fsess)
+{
+	//may be called from a signal handler, only set the flag
+	if (fsess && fsess->trace)
+		fsess->trace->dump_request = 1;
+}
+
+GF_EXPORT
+GF_Err gf_fs_enable_trace(GF_FilterSession *fsess, const char *dst, u32 ring_dur_ms)
+{
+	GF_FSTrace *trace;
+	if (!fsess || !dst) return GF_BAD_PARAM;
+	if (fsess->trace) return GF_OK;
+
+	GF_SAFEALLOC(trace, GF_FSTrace);
+	if (!trace) return GF_OUT_OF_MEM;
+	trace->fsess = fsess;
+	trace->dst = gf_strdup(dst);
+	trace->ring_dur = ring_dur_ms;
+	trace->ring_dur *= 1000;
+	trace->mx = gf_mx_new("FSTrace");
+	trace->buffers = gf_list_new();
+	trace->filter_names = gf_list_new();
+	fsess->trace = trace;
+	GF_LOG(GF_LOG_INFO, GF_LOG_FILTER, ("[Trace] Recording session trace to %s\n", dst));
+	return GF_OK;
+}
+
+void gf_fs_trace_del(GF_FilterSession *fsess)
+{
+	u32 i;
+	GF_FSTrace *trace = fsess->trace;
+	if (!trace) return;
+
+	gf_fs_dump_trace(fsess, NULL);
+	fsess->trace = NULL;
+
+	fsess->main_th.trace_buf = NULL;
+	for (i=0; i<gf_list_count(fsess->threads); i++) {
+		GF_SessionThread *sess_th = gf_list_get(fsess->threads, i);
+		sess_th->trace_buf = NULL;
+	}
+
+	while (gf_list_count(trace->buffers)) {
+		GF_FSTraceBuffer *buf = gf_list_pop_back(trace->buffers);
+		while (buf->head) {
+			GF_FSTraceBlock *blk = buf->head;
+			buf->head = blk->next;
+			gf_free(blk);
+		}
+		gf_free(buf);
+	}
+	gf_list_del(trace->buffers);
+	while (gf_list_count(trace->filter_names)) {
+		gf_free(gf_list_pop_back(trace->filter_names));
+	}
+	gf_list_del(trace->filter_names);
+	gf_mx_del(trace->mx);
+	gf_free(trace->dst);
+	gf_free(trace);
+}
@@ -3658,17 +3658,10 @@ static GF_Err dasher_reload_context(GF_Filter *filter, GF_DasherCtx *ctx)
 	if (!gf_file_exists(ctx->state)) return GF_OK;
 
 	/* parse the MPD */
-	mpd_parser = gf_xml_dom_new();
-	e = gf_xml_dom_parse(mpd_parser, ctx->state, NULL, NULL);
-
-	if (e != GF_OK) {
-		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[Dasher] Cannot parse MPD state %s: %s\n", ctx->state, gf_xml_dom_get_error(mpd_parser) ));
-		gf_xml_dom_del(mpd_parser);
-		return GF_URL_ERROR;
-	}
 	if (ctx->mpd) gf_mpd_del(ctx->mpd);
 	ctx->mpd = gf_mpd_new();
-	e = gf_mpd_init_from_dom(gf_xml_dom_get_root(mpd_parser), ctx->mpd, ctx->state);
+	mpd_parser = gf_xml_dom_new();
+	e = gf_mpd_parse_dom(mpd_parser, ctx->state, ctx->mpd, ctx->state);
 	gf_xml_dom_del(mpd_parser);
 	//test mode, strip URL path
 	if (gf_sys_is_test_mode()) {
@@ -84,6 +84,9 @@ typedef struct
 	GF_BitStream *bs_r;
 
 	GF_DownloadManager *dm;
+
+	GF_CryptSubsample *subs;
+	u32 nb_subs_alloc;
 } GF_CENCDecCtx;
 
 
@@ -888,7 +891,14 @@ static GF_Err cenc_dec_process_cenc(GF_CENCDecCtx *ctx, GF_CENCDecStream *cstr,
 
 	//sub-sample encryption
 	if (subsample_count) {
-		u32 cur_pos = 0;
+		u32 cur_pos = 0, nb_subs = 0, carry_clear = 0;
+		u32 skip_byte_block = 0, crypt_byte_block = 0;
+
+		//pattern decryption
+		if (cbc_pattern && cbc_pattern->value.frac.den && cbc_pattern->value.frac.num) {
+			skip_byte_block = cbc_pattern->value.frac.num;
+			crypt_byte_block = cbc_pattern->value.frac.den;
+		}
 
 		while (cur_pos < data_size) {
 			u32 bytes_clear_data, bytes_encrypted_data;
@@ -906,47 +916,42 @@ static GF_Err cenc_dec_process_cenc(GF_CENCDecCtx *ctx, GF_CENCDecStream *cstr,
 			bytes_encrypted_data = gf_bs_read_u32(ctx->bs_r);
 			subsample_count--;
 
-			if (const_IV) {
-				memmove(IV, const_IV->value.data.ptr, const_IV->value.data.size);
-				if (const_IV->value.data.size == 8)
-					memset(IV+8, 0, sizeof(char)*8);
-				gf_crypt_set_IV(cstr->crypt, IV, 16);
-			}
 			if (cur_pos + bytes_clear_data + bytes_encrypted_data > data_size) {
 				GF_LOG(GF_LOG_ERROR, GF_LOG_AUTHOR, ("[CENC] Corrupted CENC sai, subsample info describe more bytes (%d) than in packet (%d)\n", cur_pos + bytes_clear_data + bytes_encrypted_data , data_size ));
 				e = GF_NON_COMPLIANT_BITSTREAM;
 				goto exit;
 			}
-			/*skip clear data*/
-			cur_pos += bytes_clear_data;
-
-			//pattern decryption
-			if (cbc_pattern && cbc_pattern->value.frac.den && cbc_pattern->value.frac.num) {
-				u32 pos = cur_pos;
-				u32 res = bytes_encrypted_data;
-				u32 skip_byte_block = cbc_pattern->value.frac.num;
-				u32 crypt_byte_block = cbc_pattern->value.frac.den;
-
-				if (cstr->is_cbc) {
-					u32 clear_trailing = res % 16;
-					res -= clear_trailing;
-				}
-
-				while (res) {
-					gf_crypt_decrypt(cstr->crypt, out_data + pos, res >= (u32) (16* crypt_byte_block) ? 16* crypt_byte_block : res);
-					if (res >= (u32) (16 * (crypt_byte_block + skip_byte_block))) {
-						pos += 16 * (crypt_byte_block + skip_byte_block);
-						res -= 16 * (crypt_byte_block + skip_byte_block);
-					} else {
-						res = 0;
-					}
+			if (nb_subs == ctx->nb_subs_alloc) {
+				GF_CryptSubsample *subs = gf_realloc(ctx->subs, sizeof(GF_CryptSubsample) * (nb_subs+16));
+				if (!subs) {
+					e = GF_OUT_OF_MEM;
+					goto exit;
 				}
+				ctx->subs = subs;
+				ctx->nb_subs_alloc = nb_subs+16;
 			}
-			//full subsample decryption
-			else {
-				gf_crypt_decrypt(cstr->crypt, out_data+cur_pos, bytes_encrypted_data);
+			ctx->subs[nb_subs].clear_bytes = carry_clear + bytes_clear_data;
+			ctx->subs[nb_subs].crypt_bytes = bytes_encrypted_data;
+			carry_clear = 0;
+			//in cbc pattern mode, trailing bytes not forming a full block are in the clear
+			if (crypt_byte_block && cstr->is_cbc) {
+				carry_clear = bytes_encrypted_data % 16;
+				ctx->subs[nb_subs].crypt_bytes -= carry_clear;
 			}
-			cur_pos += bytes_encrypted_data;
+			nb_subs++;
+			cur_pos += bytes_clear_data + bytes_encrypted_data;
+		}
+
+		//all subsamples processed at once
+		if (const_IV) {
+			memmove(IV, const_IV->value.data.ptr, const_IV->value.data.size);
+			if (const_IV->value.data.size == 8)
+				memset(IV+8, 0, sizeof(char)*8);
+		}
+		e = gf_crypt_decrypt_subsamples(cstr->crypt, out_data, data_size, ctx->subs, nb_subs, crypt_byte_block, skip_byte_block, const_IV ? (u8 *) IV : NULL, 16);
+		if (e) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_AUTHOR, ("[CENC] Failed to decrypt subsamples: %s\n", gf_error_to_string(e) ));
+			goto exit;
 		}
 	}
 	//full sample encryption
@@ -978,7 +983,6 @@ exit:
 static GF_Err cenc_dec_process_adobe(GF_CENCDecCtx *ctx, GF_CENCDecStream *cstr, GF_FilterPacket *in_pck)
 {
 	u32 data_size;
-	const u8 *in_data;
 	u8 *out_data;
 	GF_FilterPacket *out_pck;
 	GF_Err e;
@@ -988,10 +992,10 @@ static GF_Err cenc_dec_process_adobe(GF_CENCDecCtx *ctx, GF_CENCDecStream *cstr,
 	if (!cstr->crypt)
 		return GF_SERVICE_ERROR;
 
-	in_data = gf_filter_pck_get_data(in_pck, &data_size);
-	out_pck = gf_filter_pck_new_alloc(cstr->opid, data_size, &out_data);
-
-	memcpy(out_data, in_data, data_size);
+	gf_filter_pck_get_data(in_pck, &data_size);
+	//decrypt inplace whenever possible
+	out_pck = gf_filter_pck_new_clone(cstr->opid, in_pck, &out_data);
+	if (!out_pck) return GF_OUT_OF_MEM;
 
 	offset=0;
 	size = data_size;
@@ -1001,6 +1005,7 @@ static GF_Err cenc_dec_process_adobe(GF_CENCDecCtx *ctx, GF_CENCDecStream *cstr,
 		char IV[17];
 		if (size<17) {
 			GF_LOG(GF_LOG_ERROR, GF_LOG_AUTHOR, ("[ADOBE] Error in sample size, %d bytes remain but at least 17 are required\n", size ) );
+			gf_filter_pck_discard(out_pck);
 			return GF_NON_COMPLIANT_BITSTREAM;
 		}
 		memmove(IV, out_data+1, 16);
@@ -1008,6 +1013,7 @@ static GF_Err cenc_dec_process_adobe(GF_CENCDecCtx *ctx, GF_CENCDecStream *cstr,
 			e = gf_crypt_init(cstr->crypt, cstr->keys[0], IV);
 			if (e) {
 				GF_LOG(GF_LOG_ERROR, GF_LOG_AUTHOR, ("[ADOBE] Cannot initialize AES-128 CBC (%s)\n", gf_error_to_string(e)) );
+				gf_filter_pck_discard(out_pck);
 				return GF_IO_ERR;
 			}
 			cstr->crypt_init = GF_TRUE;
@@ -1015,6 +1021,7 @@ static GF_Err cenc_dec_process_adobe(GF_CENCDecCtx *ctx, GF_CENCDecStream *cstr,
 			e = gf_crypt_set_IV(cstr->crypt, IV, GF_AES_128_KEYSIZE);
 			if (e) {
 				GF_LOG(GF_LOG_ERROR, GF_LOG_AUTHOR, ("[ADOBE] Cannot set state AES-128 CBC (%s)\n", gf_error_to_string(e)) );
+				gf_filter_pck_discard(out_pck);
 				return GF_IO_ERR;
 			}
 		}
@@ -1272,6 +1279,7 @@ static void cenc_dec_finalize(GF_Filter *filter)
 
 	if (ctx->bs_r) gf_bs_del(ctx->bs_r);
 	if (ctx->cinfo) gf_crypt_info_del(ctx->cinfo);
+	if (ctx->subs) gf_free(ctx->subs);
 }
 
 
@@ -42,7 +42,7 @@ typedef struct
 	Bool max_res, immediate, abort, use_bmin;
 	char *query;
 	Bool noxlink, split_as, noseek;
-	u32 lowlat;
+	u32 lowlat, prefetch, tilepf, vphorizon, vpmargin;
 
 	GF_FilterPid *mpd_pid;
 	GF_Filter *filter;
@@ -67,8 +67,29 @@ typedef struct
 	Bool mpd_open;
 	Bool initial_play;
 	Bool check_eos;
+
+	//scratch buffer for segment prefetch sessions
+	char *prefetch_buf;
+
+	//tile prefetch stats per priority (visible, predicted, hidden) and number of tile segments not ready when needed
+	u32 tile_pf_count[3];
+	u64 tile_pf_bytes[3];
+	u32 tile_pf_waits;
 } GF_DASHDmxCtx;
 
+typedef struct
+{
+	char *url;
+	u64 start_range, end_range;
+	GF_DownloadSession *sess;
+	//0: in progress, 1: done, 2: failed
+	u32 state;
+	//tile priority plus one for tile segments, 0 otherwise
+	u32 tile_priority;
+	//set if the source filter had to wait for this segment
+	Bool waited;
+} GF_DASHPrefetch;
+
 typedef struct
 {
 	GF_DASHDmxCtx *ctx;
@@ -96,8 +117,17 @@ typedef struct
 	Bool is_playing;
 	Bool force_seg_switch;
 	u32 nb_group_deps, current_group_dep;
+
+	//segments being fetched ahead of the current one, in segment order
+	GF_List *prefetch;
+	//prefetch entry of the segment currently played, NULL if fetched by the source filter
+	GF_DASHPrefetch *prefetch_current;
+	//bytes received and time spent with at least one prefetch running, for aggregated rate estimation
+	u64 prefetch_bytes, prefetch_time, prefetch_last_run;
 } GF_DASHGroup;
 
+#define DASHDMX_PREFETCH_BUF_SIZE	16384
+
 
 void dashdmx_forward_packet(GF_DASHDmxCtx *ctx, GF_FilterPacket *in_pck, GF_FilterPid *in_pid, GF_FilterPid *out_pid, GF_DASHGroup *group)
 {
@@ -200,6 +230,244 @@ void dashdmx_forward_packet(GF_DASHDmxCtx *ctx, GF_FilterPacket *in_pck, GF_Filt
 }
 
 
+static void dashdmx_prefetch_del(GF_DASHPrefetch *pf)
+{
+	if (pf->sess) gf_dm_sess_del(pf->sess);
+	gf_free(pf->url);
+	gf_free(pf);
+}
+
+static void dashdmx_prefetch_reset(GF_DASHGroup *group)
+{
+	if (!group->prefetch) return;
+	while (gf_list_count(group->prefetch)) {
+		GF_DASHPrefetch *pf = gf_list_pop_back(group->prefetch);
+		dashdmx_prefetch_del(pf);
+	}
+	gf_list_del(group->prefetch);
+	group->prefetch = NULL;
+	group->prefetch_current = NULL;
+	group->prefetch_bytes = group->prefetch_time = group->prefetch_last_run = 0;
+}
+
+//push pending prefetch downloads, returns GF_TRUE if some are still pending
+static Bool dashdmx_prefetch_run(GF_DASHDmxCtx *ctx, GF_DASHGroup *group)
+{
+	u32 i, count;
+	u64 now;
+	Bool pending = GF_FALSE;
+	if (!group->prefetch) return GF_FALSE;
+
+	now = gf_sys_clock_high_res();
+	if (group->prefetch_last_run)
+		group->prefetch_time += now - group->prefetch_last_run;
+
+	count = gf_list_count(group->prefetch);
+	for (i=0; i<count; i++) {
+		u32 nb_idle = 0;
+		GF_DASHPrefetch *pf = gf_list_get(group->prefetch, i);
+		if (pf->state) continue;
+
+		while (1) {
+			u32 nb_read = 0;
+			GF_Err e = gf_dm_sess_fetch_data(pf->sess, ctx->prefetch_buf, DASHDMX_PREFETCH_BUF_SIZE, &nb_read);
+			group->prefetch_bytes += nb_read;
+			if (pf->tile_priority)
+				ctx->tile_pf_bytes[pf->tile_priority-1] += nb_read;
+			if (e==GF_EOS) {
+				pf->state = 1;
+				GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASHDmx] group %d segment %s prefetched\n", group->idx, pf->url));
+				break;
+			}
+			if (e==GF_IP_NETWORK_EMPTY) {
+				pending = GF_TRUE;
+				break;
+			}
+			if (e<0) {
+				pf->state = 2;
+				GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASHDmx] group %d failed to prefetch segment %s: %s\n", group->idx, pf->url, gf_error_to_string(e) ));
+				break;
+			}
+			//connection setup steps, don't loop forever
+			if (!nb_read) {
+				nb_idle++;
+				if (nb_idle>10) {
+					pending = GF_TRUE;
+					break;
+				}
+			}
+		}
+	}
+	group->prefetch_last_run = pending ? gf_sys_clock_high_res() : 0;
+	return pending;
+}
+
+//create a prefetch session for the given segment, takes ownership of url
+static GF_DASHPrefetch *dashdmx_prefetch_add(GF_DASHDmxCtx *ctx, GF_DASHGroup *group, char *url, u64 start_range, u64 end_range)
+{
+	u32 flags;
+	GF_Err e = GF_OK;
+	GF_DASHPrefetch *pf;
+
+	GF_SAFEALLOC(pf, GF_DASHPrefetch);
+	if (!pf) {
+		gf_free(url);
+		return NULL;
+	}
+	pf->url = url;
+	pf->start_range = start_range;
+	pf->end_range = end_range;
+
+	flags = GF_NETIO_SESSION_NOT_THREADED | GF_NETIO_SESSION_PERSISTENT;
+	if (ctx->segstore==2) flags |= GF_NETIO_SESSION_KEEP_CACHE;
+	pf->sess = gf_dm_sess_new(ctx->dm, url, flags, NULL, NULL, &e);
+	if (pf->sess && (start_range || end_range))
+		e = gf_dm_sess_set_range(pf->sess, start_range, end_range, GF_TRUE);
+	if (!pf->sess || e) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASHDmx] group %d cannot prefetch segment %s: %s\n", group->idx, url, gf_error_to_string(e) ));
+		dashdmx_prefetch_del(pf);
+		return NULL;
+	}
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASHDmx] group %d prefetching segment %s\n", group->idx, url));
+	gf_list_add(group->prefetch, pf);
+	if (!group->prefetch_last_run) group->prefetch_last_run = gf_sys_clock_high_res();
+	return pf;
+}
+
+//launch prefetch of the segments following the one currently played
+static void dashdmx_prefetch_start(GF_DASHDmxCtx *ctx, GF_DASHGroup *group, const char *cur_url)
+{
+	u32 i;
+	if (!group->prefetch) group->prefetch = gf_list_new();
+	if (!ctx->prefetch_buf) ctx->prefetch_buf = gf_malloc(sizeof(char) * DASHDMX_PREFETCH_BUF_SIZE);
+
+	for (i=0; i<ctx->prefetch; i++) {
+		u32 j, count;
+		char *url;
+		u64 start_range, end_range;
+		Bool found = GF_FALSE;
+		GF_Err e = gf_dash_group_get_prefetch_segment_location(ctx->dash, group->idx, i, &url, &start_range, &end_range);
+		if (e) break;
+
+		if (!strcmp(url, cur_url)) found = GF_TRUE;
+		count = gf_list_count(group->prefetch);
+		for (j=0; j<count && !found; j++) {
+			GF_DASHPrefetch *pf = gf_list_get(group->prefetch, j);
+			if (!strcmp(pf->url, url) && (pf->start_range==start_range) && (pf->end_range==end_range))
+				found = GF_TRUE;
+		}
+		if (found) {
+			gf_free(url);
+			continue;
+		}
+		if (!dashdmx_prefetch_add(ctx, group, url, start_range, end_range))
+			break;
+	}
+	dashdmx_prefetch_run(ctx, group);
+}
+
+//launch tile segments downloads of the segment being played by decreasing tile priority, keeping at most tilepf tile segments
+//downloaded or being downloaded ahead of the source filter
+static void dashdmx_tile_prefetch_fill(GF_DASHDmxCtx *ctx, GF_DASHGroup *group)
+{
+	u32 nb_pending;
+	if (!group->prefetch) group->prefetch = gf_list_new();
+	if (!ctx->prefetch_buf) ctx->prefetch_buf = gf_malloc(sizeof(char) * DASHDMX_PREFETCH_BUF_SIZE);
+
+	nb_pending = gf_list_count(group->prefetch);
+	if (group->prefetch_current) nb_pending--;
+	while (nb_pending < ctx->tilepf) {
+		u32 dep_idx, priority;
+		const char *url;
+		u64 start_range, end_range;
+		GF_DASHPrefetch *pf;
+		GF_Err e = gf_dash_group_get_next_tile_segment_location(ctx->dash, group->idx, &dep_idx, &url, &start_range, &end_range, &priority);
+		if (e) break;
+
+		pf = dashdmx_prefetch_add(ctx, group, gf_strdup(url), start_range, end_range);
+		if (!pf) break;
+		if (priority>2) priority = 2;
+		pf->tile_priority = priority + 1;
+		ctx->tile_pf_count[priority]++;
+		nb_pending++;
+	}
+}
+
+//get the prefetch entry for the given segment and drop all entries before it (already played or outdated after seek/quality switch)
+static GF_DASHPrefetch *dashdmx_prefetch_get(GF_DASHGroup *group, const char *url, u64 start_range, u64 end_range)
+{
+	u32 i, count;
+	GF_DASHPrefetch *pf = NULL;
+	if (!group->prefetch) return NULL;
+	group->prefetch_current = NULL;
+
+	count = gf_list_count(group->prefetch);
+	for (i=0; i<count; i++) {
+		pf = gf_list_get(group->prefetch, i);
+		if (!strcmp(pf->url, url) && (pf->start_range==start_range) && (pf->end_range==end_range))
+			break;
+		pf = NULL;
+	}
+	//not found, flush everything
+	if (!pf) i = count;
+	while (i) {
+		GF_DASHPrefetch *old = gf_list_pop_front(group->prefetch);
+		dashdmx_prefetch_del(old);
+		i--;
+	}
+	if (pf && (pf->state==2)) {
+		gf_list_rem(group->prefetch, 0);
+		dashdmx_prefetch_del(pf);
+		pf = NULL;
+	}
+	return pf;
+}
+
+//get the prefetch entry for the given tile segment, tile segments being fetched out of order
+static GF_DASHPrefetch *dashdmx_prefetch_get_tile(GF_DASHGroup *group, const char *url, u64 start_range, u64 end_range)
+{
+	u32 i, count;
+	if (!group->prefetch) return NULL;
+	//previous tile segment has been processed by the source filter
+	if (group->prefetch_current) {
+		gf_list_del_item(group->prefetch, group->prefetch_current);
+		dashdmx_prefetch_del(group->prefetch_current);
+		group->prefetch_current = NULL;
+	}
+
+	count = gf_list_count(group->prefetch);
+	for (i=0; i<count; i++) {
+		GF_DASHPrefetch *pf = gf_list_get(group->prefetch, i);
+		if (strcmp(pf->url, url) || (pf->start_range!=start_range) || (pf->end_range!=end_range))
+			continue;
+		if (pf->state==2) {
+			gf_list_rem(group->prefetch, i);
+			dashdmx_prefetch_del(pf);
+			return NULL;
+		}
+		return pf;
+	}
+	return NULL;
+}
+
+//store stats of the prefetched segment being played, using the aggregated throughput of all concurrent prefetch downloads
+static void dashdmx_prefetch_store_stats(GF_DASHDmxCtx *ctx, GF_DASHGroup *group)
+{
+	u32 bytes_per_sec = 0;
+	u64 total_size = 0, bytes_done = 0;
+	GF_DASHPrefetch *pf = group->prefetch_current;
+
+	gf_dm_sess_get_stats(pf->sess, NULL, NULL, &total_size, &bytes_done, &bytes_per_sec, NULL);
+	if (group->prefetch_time) {
+		bytes_per_sec = (u32) (group->prefetch_bytes * 1000000 / group->prefetch_time);
+		group->prefetch_bytes = group->prefetch_time = 0;
+	}
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASHDmx] group %d prefetched segment size "LLU" aggregated rate %d kbps\n", group->idx, total_size, bytes_per_sec*8/1000));
+
+	gf_dash_group_store_stats(ctx->dash, group->idx, bytes_per_sec, (u32) total_size, (u32) bytes_done, GF_FALSE);
+	group->stats_uploaded = GF_TRUE;
+}
+
 static void dashdmx_on_filter_setup_error(GF_Filter *failed_filter, void *udta, GF_Err err)
 {
 	GF_DASHGroup *group = (GF_DASHGroup *)udta;
@@ -564,6 +832,7 @@ GF_Err dashdmx_io_on_dash_event(GF_DASHFileIO *dashio, GF_DASHEventType dash_evt
 				gf_filter_remove_src(ctx->filter, group->seg_filter_src);
 				group->seg_filter_src = NULL;
 			}
+			dashdmx_prefetch_reset(group);
 			gf_free(group);
 			gf_dash_set_group_udta(ctx->dash, i, NULL);
 		}
@@ -1127,6 +1396,17 @@ static GF_Err dashdmx_initialize(GF_Filter *filter)
 	if (ctx->split_as)
 		gf_dash_split_adaptation_sets(ctx->dash);
 
+	//prefetched segments are handed over to the source filter through the disk cache
+	if (ctx->prefetch && !ctx->segstore) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASHDmx] Segment prefetch requires segstore to be file or cache, disabling\n"));
+		ctx->prefetch = 0;
+	}
+	if (ctx->tilepf && !ctx->segstore) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASHDmx] Tile prefetch requires segstore to be file or cache, disabling\n"));
+		ctx->tilepf = 0;
+	}
+	gf_dash_set_viewport_prediction(ctx->dash, ctx->vphorizon, ctx->vpmargin);
+
 	ctx->initial_play = GF_TRUE;
 	gf_filter_block_eos(filter, GF_TRUE);
 
@@ -1145,8 +1425,15 @@ static void dashdmx_finalize(GF_Filter *filter)
 	GF_DASHDmxCtx *ctx = (GF_DASHDmxCtx*) gf_filter_get_udta(filter);
 	assert(ctx);
 
+	if (ctx->tilepf) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASHDmx] Tile prefetch: %d visible ("LLU" kB) %d predicted ("LLU" kB) %d hidden ("LLU" kB) - %d tile segments not ready when needed\n",
+			ctx->tile_pf_count[0], ctx->tile_pf_bytes[0]/1000, ctx->tile_pf_count[1], ctx->tile_pf_bytes[1]/1000, ctx->tile_pf_count[2], ctx->tile_pf_bytes[2]/1000, ctx->tile_pf_waits));
+	}
+
 	if (ctx->dash)
 		gf_dash_del(ctx->dash);
+	if (ctx->prefetch_buf)
+		gf_free(ctx->prefetch_buf);
 }
 
 static Bool dashdmx_process_event(GF_Filter *filter, const GF_FilterEvent *fevt)
@@ -1224,6 +1511,7 @@ static Bool dashdmx_process_event(GF_Filter *filter, const GF_FilterEvent *fevt)
 		src_evt = *fevt;
 		group->is_playing = GF_TRUE;
 		ctx->check_eos = GF_FALSE;
+		dashdmx_prefetch_reset(group);
 
 		//adjust play range from media timestamps to MPD time
 		if (fevt->play.timestamp_based) {
@@ -1331,6 +1619,7 @@ static Bool dashdmx_process_event(GF_Filter *filter, const GF_FilterEvent *fevt)
 		gf_dash_set_group_done(ctx->dash, (u32) group->idx, 1);
 		gf_dash_group_select(ctx->dash, (u32) group->idx, GF_FALSE);
 		group->is_playing = GF_FALSE;
+		dashdmx_prefetch_reset(group);
 		if (ctx->nb_playing) {
 			ctx->initial_play = GF_FALSE;
 			group->force_seg_switch = GF_TRUE;
@@ -1452,9 +1741,42 @@ static void dashdmx_switch_segment(GF_DASHDmxCtx *ctx, GF_DASHGroup *group)
 		gf_filter_send_event(group->seg_filter_src, &evt, GF_FALSE);
 		return;
 	}
-	GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASHDmx] group %d queuing next media segment %s\n", group->idx, next_url));
 
 	GF_FEVT_INIT(evt, GF_FEVT_SOURCE_SWITCH, NULL);
+
+	if (group->prefetch) {
+		GF_DASHPrefetch *pf;
+		if (dependent_representation_index)
+			pf = dashdmx_prefetch_get_tile(group, next_url, start_range, end_range);
+		else
+			pf = dashdmx_prefetch_get(group, next_url, start_range, end_range);
+
+		if (pf && !pf->state)
+			dashdmx_prefetch_run(ctx, group);
+
+		//segment is being prefetched, wait for its completion rather than issuing a second request
+		if (pf && !pf->state) {
+			//we cannot go back to the previous dependent segment
+			if (group->nb_group_deps)
+				group->current_group_dep = dependent_representation_index;
+
+			if (pf->tile_priority && !pf->waited)
+				ctx->tile_pf_waits++;
+			pf->waited = GF_TRUE;
+			group->seg_was_not_ready = GF_TRUE;
+			group->stats_uploaded = GF_TRUE;
+			GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASHDmx] group %d next segment %s still being prefetched\n", group->idx, next_url));
+			gf_filter_ask_rt_reschedule(ctx->filter, 1000);
+			return;
+		}
+		if (pf) {
+			group->prefetch_current = pf;
+			evt.seek.skip_cache_expiration = GF_TRUE;
+		}
+	}
+
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASHDmx] group %d queuing next media segment %s\n", group->idx, next_url));
+
 	evt.seek.source_switch = next_url;
 	evt.seek.start_offset = start_range;
 	evt.seek.end_offset = end_range;
@@ -1463,6 +1785,15 @@ static void dashdmx_switch_segment(GF_DASHDmxCtx *ctx, GF_DASHGroup *group)
 	group->prev_is_init_segment = GF_FALSE;
 	group->init_switch_seg_sent = GF_FALSE;
 	gf_filter_send_event(group->seg_filter_src, &evt, GF_FALSE);
+
+	//base segment of a tiled group queued, launch its tile segments downloads
+	if (ctx->tilepf && group->nb_group_deps && !dependent_representation_index) {
+		dashdmx_tile_prefetch_fill(ctx, group);
+		dashdmx_prefetch_run(ctx, group);
+	}
+
+	if (ctx->prefetch)
+		dashdmx_prefetch_start(ctx, group, next_url);
 }
 
 static void dashdmx_update_group_stats(GF_DASHDmxCtx *ctx, GF_DASHGroup *group)
@@ -1476,6 +1807,11 @@ static void dashdmx_update_group_stats(GF_DASHDmxCtx *ctx, GF_DASHGroup *group)
 	if (group->prev_is_init_segment) return;
 	if (!group->seg_filter_src) return;
 
+	if (group->prefetch_current) {
+		dashdmx_prefetch_store_stats(ctx, group);
+		return;
+	}
+
 	p = gf_filter_get_info(group->seg_filter_src, GF_PROP_PID_FILE_CACHED, &pe);
 	if (!p || !p->value.boolean) {
 		gf_filter_release_property(pe);
@@ -1549,6 +1885,20 @@ GF_Err dashdmx_process(GF_Filter *filter)
 	if (next_time_ms>1000)
 		next_time_ms=1000;
 
+	//push segment prefetch downloads
+	if (ctx->prefetch || ctx->tilepf) {
+		count = gf_dash_get_group_count(ctx->dash);
+		for (i=0; i<count; i++) {
+			GF_DASHGroup *group = gf_dash_get_group_udta(ctx->dash, i);
+			if (!group) continue;
+			//refill tile downloads of the segment being played
+			if (ctx->tilepf && group->nb_group_deps && group->current_group_dep)
+				dashdmx_tile_prefetch_fill(ctx, group);
+			if (dashdmx_prefetch_run(ctx, group))
+				next_time_ms = 1;
+		}
+	}
+
 	//flush all media input
 	count = gf_filter_get_ipid_count(filter);
 	for (i=0; i<count; i++) {
@@ -1798,6 +2148,10 @@ static const GF_FilterArgs DASHDmxArgs[] =
 			"- no: disable low latency\n"
 			"- strict: strict respect of AST offset in low latency\n"
 			"- early: allow fetching segments earlier than their AST in low latency when input demux is empty", GF_PROP_UINT, "early", "no|strict|early", GF_FS_ARG_HINT_EXPERT},
+	{ OFFS(prefetch), "number of media segments to fetch in parallel ahead of the current one for each group (static sessions over HTTP only, ignored if segstore is mem)", GF_PROP_UINT, "0", NULL, GF_FS_ARG_HINT_ADVANCED},
+	{ OFFS(tilepf), "number of tile segments to fetch in parallel for tiled groups, visible tiles first, then predicted visible tiles, then hidden tiles (ignored if segstore is mem)", GF_PROP_UINT, "0", NULL, GF_FS_ARG_HINT_ADVANCED},
+	{ OFFS(vphorizon), "viewport prediction horizon in ms for tiled groups; tiles covered by the moving viewport within this horizon get an intermediate quality. If 0, segment duration is used", GF_PROP_UINT, "0", NULL, GF_FS_ARG_HINT_EXPERT},
+	{ OFFS(vpmargin), "margin around the predicted viewport, in percent of the viewport size (or of the video size for gaze)", GF_PROP_UINT, "0", NULL, GF_FS_ARG_HINT_EXPERT},
 	{0}
 };
 
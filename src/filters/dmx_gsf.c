@@ -950,23 +950,43 @@ static GF_Err gsfdmx_process_packets(GF_Filter *filter, GSF_DemuxCtx *ctx, GSF_S
 	return GF_OK;
 }
 
+static GF_Err gsfdmx_store_input(GSF_DemuxCtx *ctx, const char *data, u32 data_size)
+{
+	if (ctx->alloc_size < ctx->buf_size + data_size) {
+		char *buffer = (char*)gf_realloc(ctx->buffer, sizeof(char)*(ctx->buf_size + data_size) );
+		if (!buffer) return GF_OUT_OF_MEM;
+		ctx->buffer = buffer;
+		ctx->alloc_size = ctx->buf_size + data_size;
+	}
+	memcpy(ctx->buffer + ctx->buf_size, data, sizeof(char)*data_size);
+	ctx->buf_size += data_size;
+	return GF_OK;
+}
+
 static GF_Err gsfdmx_demux(GF_Filter *filter, GSF_DemuxCtx *ctx, char *data, u32 data_size)
 {
 	u32 last_pck_end=0;
+	char *buffer;
+	u32 buf_size;
+	Bool in_place = GF_FALSE;
 
 	//always reset input buffer if not tuned - since in reliable (pipe/file/...) this is the first packet and it is less than 40 bytes at max whe should be fine
 	if (!ctx->tuned)
 		ctx->buf_size = 0;
 
-	if (ctx->alloc_size < ctx->buf_size + data_size) {
-		ctx->buffer = (char*)gf_realloc(ctx->buffer, sizeof(char)*(ctx->buf_size + data_size) );
-		ctx->alloc_size = ctx->buf_size + data_size;
+	//nothing pending and no decryption in place: parse the input packet directly, only the incomplete tail is copied
+	if (ctx->tuned && !ctx->buf_size && !ctx->crypt) {
+		buffer = data;
+		buf_size = data_size;
+		in_place = GF_TRUE;
+	} else {
+		GF_Err e = gsfdmx_store_input(ctx, data, data_size);
+		if (e) return e;
+		buffer = ctx->buffer;
+		buf_size = ctx->buf_size;
 	}
 
-	memcpy(ctx->buffer + ctx->buf_size, data, sizeof(char)*data_size);
-	ctx->buf_size += data_size;
-
-	gf_bs_reassign_buffer(ctx->bs_r, ctx->buffer, ctx->buf_size);
+	gf_bs_reassign_buffer(ctx->bs_r, buffer, buf_size);
 	while (gf_bs_available(ctx->bs_r) > 4) { //1 byte header + 3 vlen field at least 1 bytes
 		GF_Err e = GF_OK;
 		u32 pck_len, block_size, block_offset;
@@ -1039,7 +1059,7 @@ static GF_Err gsfdmx_demux(GF_Filter *filter, GSF_DemuxCtx *ctx, char *data, u32
 				e = GF_NON_COMPLIANT_BITSTREAM;
 			} else {
 				u32 pos = (u32) gf_bs_get_position(ctx->bs_r);
-				e = gsfdmx_tune(filter, ctx, ctx->buffer + pos, pck_len, is_crypted);
+				e = gsfdmx_tune(filter, ctx, buffer + pos, pck_len, is_crypted);
 			}
 		}
 		//stream signaling or packet
@@ -1066,10 +1086,10 @@ static GF_Err gsfdmx_demux(GF_Filter *filter, GSF_DemuxCtx *ctx, char *data, u32
 					//packet: decrypt on per-packet base, and decode if not first fragment
 					if (pck_type==GFS_PCKTYPE_PCK) {
 						if (is_crypted) {
-							gsfdmx_decrypt(ctx, ctx->buffer + cur_pos, pck_len);
+							gsfdmx_decrypt(ctx, buffer + cur_pos, pck_len);
 						}
 						if (!pck_frag) {
-							gf_bs_reassign_buffer(ctx->bs_pck, ctx->buffer + cur_pos, pck_len);
+							gf_bs_reassign_buffer(ctx->bs_pck, buffer + cur_pos, pck_len);
 							e = gsfdmx_read_data_pck(ctx, gst, gpck, pck_len, full_pck, ctx->bs_pck);
 	 						append = GF_FALSE;
 						}
@@ -1084,7 +1104,7 @@ static GF_Err gsfdmx_demux(GF_Filter *filter, GSF_DemuxCtx *ctx, char *data, u32
 							e = GF_NON_COMPLIANT_BITSTREAM;
 						} else {
 							//append fragment
-							memcpy(gpck->output + block_offset, ctx->buffer + cur_pos, pck_len);
+							memcpy(gpck->output + block_offset, buffer + cur_pos, pck_len);
 
 							gsfdmx_packet_append_frag(gpck, pck_len, block_offset);
 						}
@@ -1103,6 +1123,12 @@ static GF_Err gsfdmx_demux(GF_Filter *filter, GSF_DemuxCtx *ctx, char *data, u32
 		last_pck_end = (u32) gf_bs_get_position(ctx->bs_r);
 	}
 
+	if (in_place) {
+		assert(buf_size>=last_pck_end);
+		if (buf_size > last_pck_end)
+			return gsfdmx_store_input(ctx, buffer + last_pck_end, buf_size - last_pck_end);
+		return GF_OK;
+	}
 	if (last_pck_end) {
 		assert(ctx->buf_size>=last_pck_end);
 		memmove(ctx->buffer, ctx->buffer+last_pck_end, sizeof(char) * (ctx->buf_size-last_pck_end));
@@ -1175,6 +1201,12 @@ static const char *gsfdmx_probe_data(const u8 *data, u32 data_size, GF_FilterPro
 	return NULL;
 }
 
+static const GF_FilterProbeMagic GSFDemuxMagics[] =
+{
+	PROBE_MAGIC(0, "GS5F"),
+	{0}
+};
+
 static void gsfdmx_not_enough_bytes(void *par)
 {
 	GSF_DemuxCtx *ctx = (GSF_DemuxCtx *)par;
@@ -1265,6 +1297,7 @@ GF_FilterRegister GSFDemuxRegister = {
 	.process = gsfdmx_process,
 	.process_event = gsfdmx_process_event,
 	.probe_data = gsfdmx_probe_data,
+	.probe_magics = GSFDemuxMagics,
 };
 
 
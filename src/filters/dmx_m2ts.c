@@ -55,11 +55,68 @@ enum
 
 };
 
+/*seek point in the index, time is the PTS of the RAP relative to the first PCR of the file, in 90kHz*/
+typedef struct
+{
+	u64 offset;
+	u64 time;
+} GF_M2TSDmxSeekPoint;
+
+enum
+{
+	DMX_IDX_SCAN_FIRST=0,
+	DMX_IDX_SCAN_RAP,
+	DMX_IDX_SCAN_ALL,
+};
+
+#define M2TSDMX_PTS_MASK	0x1FFFFFFFFULL
+#define M2TSDMX_IDX_NB_PCK	1024
+//max distance scanned backward from the bisection point to find a RAP
+#define M2TSDMX_IDX_MAX_BACK	(64*1024*1024)
+//max amount of input data routed before processing program lanes
+#define M2TSDMX_MT_BATCH	(1024*1024)
+#define M2TSDMX_NO_ROUTE	0xFFFF
+
+/*event produced by a program lane, dispatched by the filter thread once all lanes are processed*/
+typedef struct
+{
+	u32 type;
+	//TS packet number of PCR events, used for duration estimation
+	u32 pck_number;
+	//payload or TEMI URL location in the lane data
+	u32 data_offset, data_size;
+	//PES payload copied by the lane, owned by the output packet once dispatched
+	u8 *payload;
+	union {
+		GF_M2TS_PES_PCK pck;
+		GF_M2TS_SL_PCK sl_pck;
+		GF_M2TS_TemiLocationDescriptor temi_l;
+		GF_M2TS_TemiTimecodeDescriptor temi_t;
+	} u;
+} GF_M2TSDmxEvent;
+
+/*TS packets of PES and PCR PIDs of a program, processed by a single thread*/
+typedef struct
+{
+	//index of packets of the current batch in the batch buffer and their packet numbers
+	u32 *pcks;
+	u32 *pck_nums;
+	u32 nb_pcks, alloc_pcks;
+
+	GF_M2TSDmxEvent *evts;
+	u32 nb_evts, alloc_evts;
+	//payloads of queued events
+	u8 *data;
+	u32 data_size, data_alloc;
+} GF_M2TSDmxLane;
+
 typedef struct
 {
 	//opts
 	const char *temi_url;
-	Bool dsmcc, seeksrc;
+	Bool dsmcc, seeksrc, rapseek;
+	const char *tsidx;
+	s32 nbth;
 
 	GF_Filter *filter;
 	GF_FilterPid *ipid;
@@ -85,10 +142,36 @@ typedef struct
 
 	u32 mux_tune_state;
 	u32 wait_for_progs;
+
+	//seek index
+	char *src_path;
+	u32 pck_size;
+	Bool has_pts_origin;
+	u64 pts_origin;
+	Bool map_time_on_pcr;
+	u32 idx_pid;
+	GF_M2TSDmxSeekPoint *idx;
+	u32 nb_idx, alloc_idx;
+	Bool idx_checked;
+	u8 *idx_buf;
+
+	//multi-threaded demux: lane 0 holds PSI/SI and unassigned PIDs and is processed by the filter thread after program lanes
+	GF_WorkerPool *pool;
+	u32 nb_threads;
+	Bool in_lanes;
+	GF_M2TSDmxLane *lanes;
+	u32 nb_lanes, alloc_lanes;
+	//lane index of each PID
+	u16 *routes;
+	//TS packets of the current batch
+	u8 *batch;
+	u32 nb_batch_pcks, alloc_batch_pcks;
+	//last PAT and PMT packet of each PID, to detect changes
+	u8 **psi_pcks;
 } GF_M2TSDmxCtx;
 
 
-static void m2tsdmx_estimate_duration(GF_M2TSDmxCtx *ctx, GF_M2TS_ES *stream)
+static void m2tsdmx_estimate_duration(GF_M2TSDmxCtx *ctx, GF_M2TS_ES *stream, u64 pcr, u32 pck_number)
 {
 	Bool changed;
 	Double pck_dur;
@@ -106,25 +189,25 @@ static void m2tsdmx_estimate_duration(GF_M2TSDmxCtx *ctx, GF_M2TS_ES *stream)
 	}
 
 	if (!ctx->first_pcr_found) {
-		ctx->first_pcr_found = stream->program->last_pcr_value;
+		ctx->first_pcr_found = pcr;
 		ctx->pcr_pid = stream->pid;
-		ctx->nb_pck_at_pcr = ctx->ts->pck_number;
+		ctx->nb_pck_at_pcr = pck_number;
 		return;
 	}
 	if (ctx->pcr_pid != stream->pid) return;
-	if (stream->program->last_pcr_value < ctx->first_pcr_found) {
-		ctx->first_pcr_found = stream->program->last_pcr_value;
+	if (pcr < ctx->first_pcr_found) {
+		ctx->first_pcr_found = pcr;
 		ctx->pcr_pid = stream->pid;
-		ctx->nb_pck_at_pcr = ctx->ts->pck_number;
+		ctx->nb_pck_at_pcr = pck_number;
 		return;
 	}
-	if (stream->program->last_pcr_value - ctx->first_pcr_found <= 2*27000000)
+	if (pcr - ctx->first_pcr_found <= 2*27000000)
 		return;
 
 	changed = GF_FALSE;
 
-	pck_dur = (Double) (stream->program->last_pcr_value - ctx->first_pcr_found);
-	pck_dur /= (ctx->ts->pck_number - ctx->nb_pck_at_pcr);
+	pck_dur = (Double) (pcr - ctx->first_pcr_found);
+	pck_dur /= (pck_number - ctx->nb_pck_at_pcr);
 	pck_dur /= 27000;
 
 	pck_dur *= ctx->file_size;
@@ -134,9 +217,9 @@ static void m2tsdmx_estimate_duration(GF_M2TSDmxCtx *ctx, GF_M2TS_ES *stream)
 		ctx->duration.den = 1000;
 		changed = GF_TRUE;
 	}
-	ctx->first_pcr_found = stream->program->last_pcr_value;
+	ctx->first_pcr_found = pcr;
 	ctx->pcr_pid = stream->pid;
-	ctx->nb_pck_at_pcr = ctx->ts->pck_number;
+	ctx->nb_pck_at_pcr = pck_number;
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[M2TSDmx] Estimated duration based on instant bitrate: %g sec\n", pck_dur/1000));
 
 	if (changed) {
@@ -156,7 +239,12 @@ static void m2tsdmx_on_event_duration_probe(GF_M2TS_Demuxer *ts, u32 evt_type, v
 	if (evt_type == GF_M2TS_EVT_PES_PCR) {
 		GF_M2TS_PES_PCK *pck = ((GF_M2TS_PES_PCK *) param);
 
-		if (pck->stream) m2tsdmx_estimate_duration(ctx, (GF_M2TS_ES *) pck->stream);
+		//remember first PCR of the file, used as time origin for index-based seeking
+		if (!ctx->has_pts_origin) {
+			ctx->pts_origin = pck->PTS / 300;
+			ctx->has_pts_origin = GF_TRUE;
+		}
+		if (pck->stream) m2tsdmx_estimate_duration(ctx, (GF_M2TS_ES *) pck->stream, pck->PTS, pck->stream->program->last_pcr_value_pck_number);
 	}
 }
 
@@ -410,7 +498,15 @@ static void m2tdmx_merge_temi(GF_M2TS_ES *stream, GF_FilterPacket *pck)
 	}
 }
 
-static void m2tsdmx_send_packet(GF_M2TSDmxCtx *ctx, GF_M2TS_PES_PCK *pck)
+static void m2tsdmx_payload_destructor(GF_Filter *filter, GF_FilterPid *pid, GF_FilterPacket *pck)
+{
+	u32 size;
+	u8 *data = (u8 *) gf_filter_pck_get_data(pck, &size);
+	if (data) gf_free(data);
+}
+
+/*payload, if set, holds a copy of the packet data made by a program lane and is given to the output packet*/
+static void m2tsdmx_send_packet(GF_M2TSDmxCtx *ctx, GF_M2TS_PES_PCK *pck, u8 *payload)
 {
 	GF_FilterPid *opid;
 	GF_FilterPacket *dst_pck;
@@ -418,11 +514,23 @@ static void m2tsdmx_send_packet(GF_M2TSDmxCtx *ctx, GF_M2TS_PES_PCK *pck)
 
 	/*pcr not initialized, don't send any data*/
 //	if (! pck->stream->program->first_dts) return;
-	if (!pck->stream->user) return;
+	if (!pck->stream->user) {
+		if (payload) gf_free(payload);
+		return;
+	}
 	opid = pck->stream->user;
 
-	dst_pck = gf_filter_pck_new_alloc(opid, pck->data_len, &data);
-	memcpy(data, pck->data, pck->data_len);
+	if (payload) {
+		dst_pck = gf_filter_pck_new_shared(opid, payload, pck->data_len, m2tsdmx_payload_destructor);
+		if (!dst_pck) {
+			gf_free(payload);
+			return;
+		}
+	} else {
+		dst_pck = gf_filter_pck_new_alloc(opid, pck->data_len, &data);
+		if (!dst_pck) return;
+		memcpy(data, pck->data, pck->data_len);
+	}
 	//we don't have end of frame signaling
 	gf_filter_pck_set_framing(dst_pck, (pck->flags & GF_M2TS_PES_PCK_AU_START) ? GF_TRUE : GF_FALSE, GF_FALSE);
 
@@ -558,18 +666,188 @@ static void m2tsdmx_declare_epg_pid(GF_M2TSDmxCtx *ctx)
 }
 #endif
 
+static void m2tsdmx_on_pcr(GF_M2TSDmxCtx *ctx, GF_M2TS_PES_PCK *pck, u32 pck_number)
+{
+	u32 i, count;
+	u64 pcr;
+	Bool map_time = GF_FALSE;
+	Bool discontinuity = (pck->flags & GF_M2TS_PES_PCK_DISCONTINUITY) ? 1 : 0;
+
+	assert(pck->stream);
+	m2tsdmx_estimate_duration(ctx, (GF_M2TS_ES *) pck->stream, pck->PTS, pck_number);
+
+	if (ctx->map_time_on_prog_id && (ctx->map_time_on_prog_id==pck->stream->program->number)) {
+		map_time = GF_TRUE;
+	}
+
+	//we forward the PCR on each pid
+	pcr = pck->PTS;
+	pcr /= 300;
+	count = gf_list_count(pck->stream->program->streams);
+	for (i=0; i<count; i++) {
+		GF_FilterPacket *dst_pck;
+		GF_M2TS_PES *stream = gf_list_get(pck->stream->program->streams, i);
+		if (!stream->user) continue;
+
+		dst_pck = gf_filter_pck_new_shared(stream->user, NULL, 0, NULL);
+		gf_filter_pck_set_cts(dst_pck, pcr);
+		gf_filter_pck_set_clock_type(dst_pck, discontinuity ? GF_FILTER_CLOCK_PCR_DISC : GF_FILTER_CLOCK_PCR);
+		gf_filter_pck_send(dst_pck);
+
+		if (map_time) {
+			Double media_time = ctx->media_start_range;
+			//we seeked on a RAP before the requested time, map the PCR against the file time origin
+			if (ctx->map_time_on_pcr) {
+				media_time = (Double) ((pcr - ctx->pts_origin) & M2TSDMX_PTS_MASK);
+				media_time /= 90000;
+			}
+			gf_filter_pid_set_info_str(stream->user, "time:timestamp", &PROP_LONGUINT(pcr) );
+			gf_filter_pid_set_info_str(stream->user, "time:media", &PROP_DOUBLE(media_time) );
+		}
+	}
+
+	if (map_time) {
+		ctx->map_time_on_prog_id = 0;
+		ctx->map_time_on_pcr = GF_FALSE;
+	}
+}
+
+static void m2tsdmx_reset_routes(GF_M2TSDmxCtx *ctx)
+{
+	if (ctx->routes) memset(ctx->routes, 0xFF, sizeof(u16) * GF_M2TS_MAX_STREAMS);
+}
+
+static u32 m2tsdmx_get_program_lane(GF_M2TSDmxCtx *ctx, GF_M2TS_Program *prog)
+{
+	s32 idx = prog ? gf_list_find(ctx->ts->programs, prog) : -1;
+	return (idx<0) ? 0 : (u32) idx + 1;
+}
+
+static GF_Err m2tsdmx_lane_push_data(GF_M2TSDmxLane *lane, GF_M2TSDmxEvent *evt, const u8 *data, u32 size)
+{
+	if (lane->data_size + size > lane->data_alloc) {
+		u32 alloc = MAX(2*lane->data_alloc, lane->data_size + size);
+		u8 *buf = gf_realloc(lane->data, alloc);
+		if (!buf) return GF_OUT_OF_MEM;
+		lane->data = buf;
+		lane->data_alloc = alloc;
+	}
+	memcpy(lane->data + lane->data_size, data, size);
+	evt->data_offset = lane->data_size;
+	evt->data_size = size;
+	lane->data_size += size;
+	return GF_OK;
+}
+
+/*called from program lanes, payloads are copied since PES buffers are reused by the demuxer. PES payloads are copied in their own buffer
+so that output packets can be created without copy by the filter thread*/
+static void m2tsdmx_queue_event(GF_M2TSDmxCtx *ctx, u32 evt_type, void *param)
+{
+	u32 idx, pid;
+	GF_Err e = GF_OK;
+	GF_M2TS_ES *es = NULL;
+	GF_M2TSDmxLane *lane;
+	GF_M2TSDmxEvent *evt;
+
+	switch (evt_type) {
+	case GF_M2TS_EVT_PES_PCK:
+	case GF_M2TS_EVT_PES_PCR:
+		es = (GF_M2TS_ES *) ((GF_M2TS_PES_PCK *) param)->stream;
+		break;
+	case GF_M2TS_EVT_SL_PCK:
+		es = ((GF_M2TS_SL_PCK *) param)->stream;
+		break;
+	case GF_M2TS_EVT_TEMI_LOCATION:
+		pid = ((GF_M2TS_TemiLocationDescriptor *) param)->pid;
+		if (pid<GF_M2TS_MAX_STREAMS) es = ctx->ts->ess[pid];
+		break;
+	case GF_M2TS_EVT_TEMI_TIMECODE:
+		pid = ((GF_M2TS_TemiTimecodeDescriptor *) param)->pid;
+		if (pid<GF_M2TS_MAX_STREAMS) es = ctx->ts->ess[pid];
+		break;
+	//other events are either not produced by PES processing or not used by the filter
+	default:
+		return;
+	}
+	//TEMI not assigned to a given PID, not supported by the filter
+	if (!es) return;
+	idx = m2tsdmx_get_program_lane(ctx, es->program);
+	if (!idx || (idx >= ctx->nb_lanes)) return;
+	lane = &ctx->lanes[idx];
+
+	if (lane->nb_evts == lane->alloc_evts) {
+		u32 alloc = lane->alloc_evts ? 2*lane->alloc_evts : 64;
+		GF_M2TSDmxEvent *evts = gf_realloc(lane->evts, sizeof(GF_M2TSDmxEvent) * alloc);
+		if (!evts) {
+			e = GF_OUT_OF_MEM;
+			goto exit;
+		}
+		lane->evts = evts;
+		lane->alloc_evts = alloc;
+	}
+	evt = &lane->evts[lane->nb_evts];
+	lane->nb_evts++;
+	memset(evt, 0, sizeof(GF_M2TSDmxEvent));
+	evt->type = evt_type;
+
+	switch (evt_type) {
+	case GF_M2TS_EVT_PES_PCK:
+		evt->u.pck = *(GF_M2TS_PES_PCK *) param;
+		if (evt->u.pck.data_len) {
+			evt->payload = gf_malloc(evt->u.pck.data_len);
+			if (!evt->payload) {
+				e = GF_OUT_OF_MEM;
+				break;
+			}
+			memcpy(evt->payload, evt->u.pck.data, evt->u.pck.data_len);
+		}
+		evt->u.pck.data = evt->payload;
+		break;
+	case GF_M2TS_EVT_PES_PCR:
+		evt->u.pck = *(GF_M2TS_PES_PCK *) param;
+		evt->pck_number = es->program->last_pcr_value_pck_number;
+		break;
+	case GF_M2TS_EVT_SL_PCK:
+		evt->u.sl_pck = *(GF_M2TS_SL_PCK *) param;
+		e = m2tsdmx_lane_push_data(lane, evt, evt->u.sl_pck.data, evt->u.sl_pck.data_len);
+		break;
+	case GF_M2TS_EVT_TEMI_LOCATION:
+		evt->u.temi_l = *(GF_M2TS_TemiLocationDescriptor *) param;
+		if (evt->u.temi_l.external_URL)
+			e = m2tsdmx_lane_push_data(lane, evt, (const u8 *) evt->u.temi_l.external_URL, (u32) strlen(evt->u.temi_l.external_URL) + 1);
+		break;
+	case GF_M2TS_EVT_TEMI_TIMECODE:
+		evt->u.temi_t = *(GF_M2TS_TemiTimecodeDescriptor *) param;
+		break;
+	}
+	//event cannot be queued, drop it
+	if (e) lane->nb_evts--;
+
+exit:
+	if (e) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[M2TSDmx] Failed to queue event %d of PID %d: %s\n", evt_type, es->pid, gf_error_to_string(e) ));
+	}
+}
+
 static void m2tsdmx_on_event(GF_M2TS_Demuxer *ts, u32 evt_type, void *param)
 {
 	u32 i, count;
 	GF_Filter *filter = (GF_Filter *) ts->user;
 	GF_M2TSDmxCtx *ctx = gf_filter_get_udta(filter);
 
+	if (ctx->in_lanes) {
+		m2tsdmx_queue_event(ctx, evt_type, param);
+		return;
+	}
+
 	switch (evt_type) {
 	case GF_M2TS_EVT_PAT_UPDATE:
+		m2tsdmx_reset_routes(ctx);
 		break;
 	case GF_M2TS_EVT_AIT_FOUND:
 		break;
 	case GF_M2TS_EVT_PAT_FOUND:
+		m2tsdmx_reset_routes(ctx);
 		if (ctx->mux_tune_state==DMX_TUNE_INIT) {
 			ctx->mux_tune_state = DMX_TUNE_WAIT_PROGS;
 			ctx->wait_for_progs = gf_list_count(ts->programs);
@@ -578,6 +856,7 @@ static void m2tsdmx_on_event(GF_M2TS_Demuxer *ts, u32 evt_type, void *param)
 	case GF_M2TS_EVT_DSMCC_FOUND:
 		break;
 	case GF_M2TS_EVT_PMT_FOUND:
+		m2tsdmx_reset_routes(ctx);
 		m2tsdmx_setup_program(ctx, param);
 		if (ctx->mux_tune_state == DMX_TUNE_WAIT_PROGS) {
 			assert(ctx->wait_for_progs);
@@ -590,6 +869,7 @@ static void m2tsdmx_on_event(GF_M2TS_Demuxer *ts, u32 evt_type, void *param)
 	case GF_M2TS_EVT_PMT_REPEAT:
 		break;
 	case GF_M2TS_EVT_PMT_UPDATE:
+		m2tsdmx_reset_routes(ctx);
 		m2tsdmx_setup_program(ctx, param);
 		break;
 
@@ -629,7 +909,7 @@ static void m2tsdmx_on_event(GF_M2TS_Demuxer *ts, u32 evt_type, void *param)
 		break;
 	case GF_M2TS_EVT_PES_PCK:
 		if (ctx->mux_tune_state) break;
-		m2tsdmx_send_packet(ctx, param);
+		m2tsdmx_send_packet(ctx, param, NULL);
 		break;
 	case GF_M2TS_EVT_SL_PCK: /* DMB specific */
 		if (ctx->mux_tune_state) break;
@@ -637,43 +917,7 @@ static void m2tsdmx_on_event(GF_M2TS_Demuxer *ts, u32 evt_type, void *param)
 		break;
 	case GF_M2TS_EVT_PES_PCR:
 		if (ctx->mux_tune_state) break;
-	{
-		u64 pcr;
-		Bool map_time = GF_FALSE;
-		GF_M2TS_PES_PCK *pck = ((GF_M2TS_PES_PCK *) param);
-		Bool discontinuity = ( ((GF_M2TS_PES_PCK *) param)->flags & GF_M2TS_PES_PCK_DISCONTINUITY) ? 1 : 0;
-
-		assert(pck->stream);
-		m2tsdmx_estimate_duration(ctx, (GF_M2TS_ES *) pck->stream);
-
-		if (ctx->map_time_on_prog_id && (ctx->map_time_on_prog_id==pck->stream->program->number)) {
-			map_time = GF_TRUE;
-		}
-
-		//we forward the PCR on each pid
-		pcr = ((GF_M2TS_PES_PCK *) param)->PTS;
-		pcr /= 300;
-		count = gf_list_count(pck->stream->program->streams);
-		for (i=0; i<count; i++) {
-			GF_FilterPacket *dst_pck;
-			GF_M2TS_PES *stream = gf_list_get(pck->stream->program->streams, i);
-			if (!stream->user) continue;
-
-			dst_pck = gf_filter_pck_new_shared(stream->user, NULL, 0, NULL);
-			gf_filter_pck_set_cts(dst_pck, pcr);
-			gf_filter_pck_set_clock_type(dst_pck, discontinuity ? GF_FILTER_CLOCK_PCR_DISC : GF_FILTER_CLOCK_PCR);
-			gf_filter_pck_send(dst_pck);
-
-			if (map_time) {
-				gf_filter_pid_set_info_str(stream->user, "time:timestamp", &PROP_LONGUINT(pcr) );
-				gf_filter_pid_set_info_str(stream->user, "time:media", &PROP_DOUBLE(ctx->media_start_range) );
-			}
-		}
-
-		if (map_time) {
-			ctx->map_time_on_prog_id = 0;
-		}
-	}
+		m2tsdmx_on_pcr(ctx, param, ((GF_M2TS_PES_PCK *) param)->stream->program->last_pcr_value_pck_number);
 		break;
 
 	case GF_M2TS_EVT_TDT:
@@ -801,6 +1045,198 @@ static void m2tsdmx_on_event(GF_M2TS_Demuxer *ts, u32 evt_type, void *param)
 	}
 }
 
+static u32 m2tsdmx_get_route(GF_M2TSDmxCtx *ctx, u32 pid)
+{
+	u32 i, count;
+	GF_M2TS_ES *es;
+	if (ctx->routes[pid] != M2TSDMX_NO_ROUTE) return ctx->routes[pid];
+
+	ctx->routes[pid] = 0;
+	es = ctx->ts->ess[pid];
+	if (es) {
+		//PSI/SI and section streams stay on the filter thread
+		if (es->flags & GF_M2TS_ES_IS_PES)
+			ctx->routes[pid] = m2tsdmx_get_program_lane(ctx, es->program);
+		return ctx->routes[pid];
+	}
+	//PCR-only PID
+	count = gf_list_count(ctx->ts->programs);
+	for (i=0; i<count; i++) {
+		GF_M2TS_Program *prog = gf_list_get(ctx->ts->programs, i);
+		if (prog->pcr_pid==pid) {
+			ctx->routes[pid] = i+1;
+			break;
+		}
+	}
+	return ctx->routes[pid];
+}
+
+/*checks if a lane 0 packet may change the state used by program lanes or depend on their state: PAT and PMT packets differing from the previous one
+on their PID (repeated tables are left in lane 0), and TDT/TOT packets, mapped on the last PCR of each program*/
+static Bool m2tsdmx_is_state_packet(GF_M2TSDmxCtx *ctx, u32 pid, u8 *data)
+{
+	u8 *prev;
+	if (pid == GF_M2TS_PID_TDT_TOT_ST) return GF_TRUE;
+	if (pid != GF_M2TS_PID_PAT) {
+		GF_M2TS_ES *es = ctx->ts->ess[pid];
+		if (!es || !es->program || (es->program->pmt_pid != pid)) return GF_FALSE;
+	}
+	if (!ctx->psi_pcks) {
+		ctx->psi_pcks = gf_malloc(sizeof(u8 *) * GF_M2TS_MAX_STREAMS);
+		if (!ctx->psi_pcks) return GF_TRUE;
+		memset(ctx->psi_pcks, 0, sizeof(u8 *) * GF_M2TS_MAX_STREAMS);
+	}
+	prev = ctx->psi_pcks[pid];
+	if (!prev) {
+		prev = ctx->psi_pcks[pid] = gf_malloc(188);
+		if (!prev) return GF_TRUE;
+	}
+	//same packet except continuity counter
+	else if (((prev[3] & 0xF0) == (data[3] & 0xF0)) && !memcmp(prev+4, data+4, 184)) {
+		return GF_FALSE;
+	}
+	memcpy(prev, data, 188);
+	return GF_TRUE;
+}
+
+static void m2tsdmx_process_batch(GF_M2TSDmxCtx *ctx, Bool discard);
+
+//makes room for one more packet in the batch and in the given lane
+static GF_Err m2tsdmx_grow_batch(GF_M2TSDmxCtx *ctx, u32 idx)
+{
+	GF_M2TSDmxLane *lane;
+	if (idx >= ctx->alloc_lanes) {
+		GF_M2TSDmxLane *lanes = gf_realloc(ctx->lanes, sizeof(GF_M2TSDmxLane) * (idx+1));
+		if (!lanes) return GF_OUT_OF_MEM;
+		ctx->lanes = lanes;
+		memset(&ctx->lanes[ctx->alloc_lanes], 0, sizeof(GF_M2TSDmxLane) * (idx + 1 - ctx->alloc_lanes));
+		ctx->alloc_lanes = idx+1;
+	}
+	if (ctx->nb_batch_pcks == ctx->alloc_batch_pcks) {
+		u32 alloc = ctx->alloc_batch_pcks ? 2*ctx->alloc_batch_pcks : 1024;
+		u8 *batch = gf_realloc(ctx->batch, 188 * alloc);
+		if (!batch) return GF_OUT_OF_MEM;
+		ctx->batch = batch;
+		ctx->alloc_batch_pcks = alloc;
+	}
+	lane = &ctx->lanes[idx];
+	if (lane->nb_pcks == lane->alloc_pcks) {
+		u32 alloc = lane->alloc_pcks ? 2*lane->alloc_pcks : 256;
+		u32 *pcks = gf_realloc(lane->pcks, sizeof(u32) * alloc);
+		if (!pcks) return GF_OUT_OF_MEM;
+		lane->pcks = pcks;
+		pcks = gf_realloc(lane->pck_nums, sizeof(u32) * alloc);
+		if (!pcks) return GF_OUT_OF_MEM;
+		lane->pck_nums = pcks;
+		lane->alloc_pcks = alloc;
+	}
+	return GF_OK;
+}
+
+static void m2tsdmx_on_packet(GF_M2TS_Demuxer *ts, u8 *data, u32 pck_number)
+{
+	u32 idx, pid;
+	GF_M2TSDmxLane *lane;
+	GF_Filter *filter = (GF_Filter *) ts->user;
+	GF_M2TSDmxCtx *ctx = gf_filter_get_udta(filter);
+
+	pid = ((data[1] & 0x1F) << 8) | data[2];
+	idx = m2tsdmx_get_route(ctx, pid);
+	//process all packets received before, then this packet, so that it is processed in the same state as in single-threaded demux
+	if (!idx && m2tsdmx_is_state_packet(ctx, pid, data)) {
+		if (ctx->nb_batch_pcks)
+			m2tsdmx_process_batch(ctx, GF_FALSE);
+		gf_m2ts_process_packet(ctx->ts, data, pck_number);
+		return;
+	}
+	if (m2tsdmx_grow_batch(ctx, idx) != GF_OK) {
+		//cannot queue the packet, process pending packets and this one on the filter thread
+		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[M2TSDmx] Out of memory queuing packets, processing PID %d without lanes\n", pid));
+		if (ctx->nb_batch_pcks)
+			m2tsdmx_process_batch(ctx, GF_FALSE);
+		gf_m2ts_process_packet(ctx->ts, data, pck_number);
+		return;
+	}
+	if (idx >= ctx->nb_lanes) ctx->nb_lanes = idx+1;
+	lane = &ctx->lanes[idx];
+
+	//packets are copied, source filters may not release input packets until they are dropped
+	memcpy(ctx->batch + 188 * ctx->nb_batch_pcks, data, 188);
+	lane->pcks[lane->nb_pcks] = ctx->nb_batch_pcks;
+	lane->pck_nums[lane->nb_pcks] = pck_number;
+	lane->nb_pcks++;
+	ctx->nb_batch_pcks++;
+}
+
+static void m2tsdmx_run_lane(void *udta, u32 worker_idx, u32 task_idx)
+{
+	u32 i;
+	GF_M2TSDmxCtx *ctx = (GF_M2TSDmxCtx *) udta;
+	//program lanes start at 1
+	GF_M2TSDmxLane *lane = &ctx->lanes[task_idx+1];
+	for (i=0; i<lane->nb_pcks; i++)
+		gf_m2ts_process_packet(ctx->ts, ctx->batch + 188 * lane->pcks[i], lane->pck_nums[i]);
+}
+
+static void m2tsdmx_dispatch_lane(GF_M2TSDmxCtx *ctx, GF_M2TSDmxLane *lane)
+{
+	u32 i;
+	for (i=0; i<lane->nb_evts; i++) {
+		GF_M2TSDmxEvent *evt = &lane->evts[i];
+		switch (evt->type) {
+		case GF_M2TS_EVT_PES_PCK:
+			if (!ctx->mux_tune_state)
+				m2tsdmx_send_packet(ctx, &evt->u.pck, evt->payload);
+			else if (evt->payload)
+				gf_free(evt->payload);
+			continue;
+		case GF_M2TS_EVT_SL_PCK:
+			evt->u.sl_pck.data = lane->data + evt->data_offset;
+			break;
+		case GF_M2TS_EVT_TEMI_LOCATION:
+			evt->u.temi_l.external_URL = evt->data_size ? (const char *) lane->data + evt->data_offset : NULL;
+			break;
+		case GF_M2TS_EVT_PES_PCR:
+			//PCR state of the program has moved on, use the packet number recorded when the PCR was found
+			if (!ctx->mux_tune_state)
+				m2tsdmx_on_pcr(ctx, &evt->u.pck, evt->pck_number);
+			continue;
+		}
+		m2tsdmx_on_event(ctx->ts, evt->type, &evt->u);
+	}
+	lane->nb_evts = 0;
+	lane->data_size = 0;
+}
+
+/*processes packets routed since last call: program lanes are processed in parallel and their events are dispatched in order,
+then PSI/SI and unassigned PIDs are processed by the filter thread. PSI/SI packets changing the program state are processed before,
+see m2tsdmx_on_packet*/
+static void m2tsdmx_process_batch(GF_M2TSDmxCtx *ctx, Bool discard)
+{
+	u32 i;
+	if (!discard && (ctx->nb_lanes>1)) {
+		ctx->in_lanes = GF_TRUE;
+		gf_worker_pool_run(ctx->pool, ctx->nb_lanes-1, m2tsdmx_run_lane, ctx);
+		ctx->in_lanes = GF_FALSE;
+
+		//dispatch before PSI/SI processing, which may update or destroy programs
+		for (i=1; i<ctx->nb_lanes; i++)
+			m2tsdmx_dispatch_lane(ctx, &ctx->lanes[i]);
+	}
+	if (!discard && ctx->nb_lanes) {
+		GF_M2TSDmxLane *lane = &ctx->lanes[0];
+		for (i=0; i<lane->nb_pcks; i++)
+			gf_m2ts_process_packet(ctx->ts, ctx->batch + 188 * lane->pcks[i], lane->pck_nums[i]);
+	}
+	for (i=0; i<ctx->nb_lanes; i++) {
+		ctx->lanes[i].nb_pcks = 0;
+		ctx->lanes[i].nb_evts = 0;
+		ctx->lanes[i].data_size = 0;
+	}
+	ctx->nb_lanes = 0;
+	ctx->nb_batch_pcks = 0;
+}
+
 static GF_Err m2tsdmx_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is_remove)
 {
 	const GF_PropertyValue *p;;
@@ -834,18 +1270,23 @@ static GF_Err m2tsdmx_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool i
 		
 		ctx->ipid = pid;
 		ctx->is_file = GF_TRUE;
+		if (ctx->src_path) gf_free(ctx->src_path);
+		ctx->src_path = gf_strdup(p->value.string);
 		ctx->ts->seek_mode = GF_TRUE;
 		ctx->ts->on_event = m2tsdmx_on_event_duration_probe;
+		ctx->ts->on_packet = NULL;
 		while (!gf_feof(stream)) {
 			char buf[1880];
 			u32 nb_read = (u32) gf_fread(buf, 1880, stream);
 			gf_m2ts_process_data(ctx->ts, buf, nb_read);
 			if (ctx->duration.num || (nb_read!=1880)) break;
 		}
+		ctx->pck_size = ctx->ts->prefix_present ? 192 : 188;
 		gf_m2ts_demux_del(ctx->ts);
 		gf_fclose(stream);
 		ctx->ts = gf_m2ts_demux_new();
 		ctx->ts->on_event = m2tsdmx_on_event;
+		if (ctx->nb_threads) ctx->ts->on_packet = m2tsdmx_on_packet;
 		ctx->ts->user = filter;
 	} else if (!p) {
 		GF_FilterEvent evt;
@@ -912,6 +1353,283 @@ static void m2tsdmx_switch_quality(GF_M2TS_Program *prog, GF_M2TS_Demuxer *ts, B
 	}
 }
 
+//checks if the TS packet starts a PES on the indexed PID, and if so extracts its PTS (relative to the file time origin) and RAP flag
+static Bool m2tsdmx_idx_parse_pck(GF_M2TSDmxCtx *ctx, const u8 *data, u64 *pts, Bool *is_rap)
+{
+	u32 pos, af_ctrl;
+	u64 val;
+	if ((u32) (((data[1] & 0x1F) << 8) | data[2]) != ctx->idx_pid) return GF_FALSE;
+	//payload unit start only
+	if (!(data[1] & 0x40)) return GF_FALSE;
+	//scrambled
+	if (data[3] & 0xC0) return GF_FALSE;
+	af_ctrl = (data[3] >> 4) & 0x3;
+	if (!(af_ctrl & 0x1)) return GF_FALSE;
+
+	*is_rap = GF_FALSE;
+	pos = 4;
+	if (af_ctrl & 0x2) {
+		u32 af_len = data[4];
+		if (af_len && (data[5] & 0x40)) *is_rap = GF_TRUE;
+		pos += 1 + af_len;
+	}
+	if (pos + 14 > 188) return GF_FALSE;
+	data += pos;
+	if (data[0] || data[1] || (data[2] != 1)) return GF_FALSE;
+	//no PTS
+	if (!(data[7] & 0x80)) return GF_FALSE;
+
+	val = ((u64) (data[9] & 0x0E)) << 29;
+	val |= ((u64) data[10]) << 22;
+	val |= ((u64) (data[11] & 0xFE)) << 14;
+	val |= ((u64) data[12]) << 7;
+	val |= data[13] >> 1;
+	*pts = (val - ctx->pts_origin) & M2TSDMX_PTS_MASK;
+	return GF_TRUE;
+}
+
+/*scans PES starts of the indexed PID for packets starting in [start, end[:
+- DMX_IDX_SCAN_FIRST: stops at the first PES start found
+- DMX_IDX_SCAN_RAP: locates the last RAP with time lower than or equal to target
+- DMX_IDX_SCAN_ALL: appends all RAPs to the index
+*/
+static Bool m2tsdmx_idx_scan(GF_M2TSDmxCtx *ctx, FILE *stream, u64 start, u64 end, u32 mode, u64 target, GF_M2TSDmxSeekPoint *res)
+{
+	u32 ps = ctx->pck_size;
+	u32 hdr = ps - 188;
+	u64 pos = start;
+	Bool synced = GF_FALSE;
+	Bool found = GF_FALSE;
+
+	while (pos < end) {
+		u32 i, nb_read;
+		if (gf_fseek(stream, pos, SEEK_SET)) break;
+		nb_read = (u32) gf_fread(ctx->idx_buf, ps * M2TSDMX_IDX_NB_PCK, stream);
+		if (nb_read < ps) break;
+
+		i = 0;
+		if (!synced) {
+			if (nb_read < 3*ps) break;
+			//look for 3 consecutive sync bytes
+			for (i=0; i + 2*ps < nb_read; i++) {
+				if ((ctx->idx_buf[i+hdr] == 0x47) && (ctx->idx_buf[i+hdr+ps] == 0x47) && (ctx->idx_buf[i+hdr+2*ps] == 0x47))
+					break;
+			}
+			if (i + 2*ps >= nb_read) {
+				pos += i;
+				continue;
+			}
+			synced = GF_TRUE;
+		}
+		for (; i + ps <= nb_read; i += ps) {
+			u64 pts;
+			Bool is_rap;
+			u8 *data = ctx->idx_buf + i + hdr;
+			if (pos + i >= end) break;
+			//lost sync, resync after this byte
+			if (data[0] != 0x47) {
+				synced = GF_FALSE;
+				i++;
+				break;
+			}
+			if (!m2tsdmx_idx_parse_pck(ctx, data, &pts, &is_rap))
+				continue;
+
+			if (mode == DMX_IDX_SCAN_FIRST) {
+				res->offset = pos + i;
+				res->time = pts;
+				return GF_TRUE;
+			}
+			if (!is_rap) continue;
+
+			if (mode == DMX_IDX_SCAN_ALL) {
+				if (ctx->nb_idx == ctx->alloc_idx) {
+					ctx->alloc_idx = ctx->alloc_idx ? 2*ctx->alloc_idx : 1024;
+					ctx->idx = gf_realloc(ctx->idx, sizeof(GF_M2TSDmxSeekPoint) * ctx->alloc_idx);
+				}
+				ctx->idx[ctx->nb_idx].offset = pos + i;
+				ctx->idx[ctx->nb_idx].time = pts;
+				ctx->nb_idx++;
+				found = GF_TRUE;
+				continue;
+			}
+			//RAPs are in increasing PTS order, we are done
+			if (pts > target) return found;
+			res->offset = pos + i;
+			res->time = pts;
+			found = GF_TRUE;
+		}
+		pos += i;
+	}
+	return found;
+}
+
+static void m2tsdmx_idx_save(GF_M2TSDmxCtx *ctx)
+{
+	u32 i;
+	GF_BitStream *bs;
+	FILE *idx_file = gf_fopen(ctx->tsidx, "wb");
+	if (!idx_file) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[M2TSDmx] Failed to create seek index file %s\n", ctx->tsidx));
+		return;
+	}
+	bs = gf_bs_from_file(idx_file, GF_BITSTREAM_WRITE);
+	gf_bs_write_u32(bs, GF_4CC('G','T','S','I'));
+	gf_bs_write_u8(bs, 1);
+	gf_bs_write_u8(bs, ctx->pck_size);
+	gf_bs_write_u16(bs, ctx->idx_pid);
+	gf_bs_write_u64(bs, ctx->file_size);
+	gf_bs_write_u64(bs, ctx->pts_origin);
+	gf_bs_write_u32(bs, ctx->nb_idx);
+	for (i=0; i<ctx->nb_idx; i++) {
+		gf_bs_write_u64(bs, ctx->idx[i].offset);
+		gf_bs_write_u64(bs, ctx->idx[i].time);
+	}
+	gf_bs_del(bs);
+	gf_fclose(idx_file);
+}
+
+static Bool m2tsdmx_idx_load(GF_M2TSDmxCtx *ctx)
+{
+	u32 i, nb_idx;
+	Bool valid = GF_TRUE;
+	GF_BitStream *bs;
+	FILE *idx_file = gf_fopen(ctx->tsidx, "rb");
+	if (!idx_file) return GF_FALSE;
+
+	bs = gf_bs_from_file(idx_file, GF_BITSTREAM_READ);
+	if (gf_bs_read_u32(bs) != GF_4CC('G','T','S','I')) valid = GF_FALSE;
+	else if (gf_bs_read_u8(bs) != 1) valid = GF_FALSE;
+	else if (gf_bs_read_u8(bs) != ctx->pck_size) valid = GF_FALSE;
+	else if (gf_bs_read_u16(bs) != ctx->idx_pid) valid = GF_FALSE;
+	else if (gf_bs_read_u64(bs) != ctx->file_size) valid = GF_FALSE;
+	else if (gf_bs_read_u64(bs) != ctx->pts_origin) valid = GF_FALSE;
+
+	nb_idx = valid ? gf_bs_read_u32(bs) : 0;
+	if (valid && (gf_bs_available(bs) < (u64) nb_idx * 16)) valid = GF_FALSE;
+
+	if (valid) {
+		ctx->nb_idx = ctx->alloc_idx = nb_idx;
+		ctx->idx = gf_realloc(ctx->idx, sizeof(GF_M2TSDmxSeekPoint) * (nb_idx ? nb_idx : 1));
+		for (i=0; i<nb_idx; i++) {
+			ctx->idx[i].offset = gf_bs_read_u64(bs);
+			ctx->idx[i].time = gf_bs_read_u64(bs);
+		}
+	}
+	gf_bs_del(bs);
+	gf_fclose(idx_file);
+	return valid;
+}
+
+//returns the PID used for seek points: first video stream of the program, or the PCR PID
+static u32 m2tsdmx_idx_get_pid(GF_M2TS_PES *pes)
+{
+	u32 i, count = gf_list_count(pes->program->streams);
+	for (i=0; i<count; i++) {
+		const GF_PropertyValue *p;
+		GF_M2TS_ES *es = gf_list_get(pes->program->streams, i);
+		if (!(es->flags & GF_M2TS_ES_IS_PES) || !es->user) continue;
+		p = gf_filter_pid_get_property(es->user, GF_PROP_PID_STREAM_TYPE);
+		if (p && (p->value.uint == GF_STREAM_VISUAL)) return es->pid;
+	}
+	if (pes->program->pcr_pid && pes->program->ts->ess[pes->program->pcr_pid] && (pes->program->ts->ess[pes->program->pcr_pid]->flags & GF_M2TS_ES_IS_PES))
+		return pes->program->pcr_pid;
+	return pes->pid;
+}
+
+/*locates the closest RAP before start_range, using the sidecar index if any or PTS bisection over the file
+returns GF_FALSE if the seek point could not be found*/
+static Bool m2tsdmx_idx_locate(GF_M2TSDmxCtx *ctx, GF_M2TS_PES *pes, Double start_range, u64 *file_pos)
+{
+	GF_M2TSDmxSeekPoint pt;
+	u64 lo, hi, end, win, target;
+	u32 pid;
+	Bool found = GF_FALSE;
+	FILE *stream;
+
+	if (!ctx->src_path || !ctx->has_pts_origin || !ctx->pck_size) return GF_FALSE;
+	target = (u64) (start_range * 90000);
+
+	pid = m2tsdmx_idx_get_pid(pes);
+	if (pid != ctx->idx_pid) {
+		ctx->idx_pid = pid;
+		ctx->nb_idx = 0;
+		ctx->idx_checked = GF_FALSE;
+	}
+	if (!ctx->idx_buf)
+		ctx->idx_buf = gf_malloc(sizeof(u8) * ctx->pck_size * M2TSDMX_IDX_NB_PCK);
+
+	//load or build sidecar index once
+	if (ctx->tsidx && !ctx->idx_checked) {
+		ctx->idx_checked = GF_TRUE;
+		if (!m2tsdmx_idx_load(ctx)) {
+			u64 clock = gf_sys_clock_high_res();
+			stream = gf_fopen(ctx->src_path, "rb");
+			if (!stream) return GF_FALSE;
+			ctx->nb_idx = 0;
+			m2tsdmx_idx_scan(ctx, stream, 0, ctx->file_size, DMX_IDX_SCAN_ALL, 0, NULL);
+			gf_fclose(stream);
+			GF_LOG(GF_LOG_INFO, GF_LOG_CONTAINER, ("[M2TSDmx] Built seek index for PID %d: %d RAPs in "LLU" us\n", pid, ctx->nb_idx, gf_sys_clock_high_res() - clock));
+			m2tsdmx_idx_save(ctx);
+		}
+	}
+	if (ctx->nb_idx) {
+		u32 i_lo = 0, i_hi = ctx->nb_idx;
+		while (i_hi - i_lo > 1) {
+			u32 mid = (i_lo + i_hi) / 2;
+			if (ctx->idx[mid].time <= target) i_lo = mid;
+			else i_hi = mid;
+		}
+		*file_pos = (ctx->idx[i_lo].time <= target) ? ctx->idx[i_lo].offset : 0;
+		ctx->map_time_on_pcr = GF_TRUE;
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[M2TSDmx] Index seek to %g: RAP at %g offset "LLU"\n", start_range, ((Double) ctx->idx[i_lo].time) / 90000, *file_pos));
+		return GF_TRUE;
+	}
+
+	stream = gf_fopen(ctx->src_path, "rb");
+	if (!stream) return GF_FALSE;
+
+	//bisection on the first PES start found after the probe position
+	lo = 0;
+	hi = ctx->file_size;
+	while (hi - lo > ctx->pck_size * M2TSDMX_IDX_NB_PCK) {
+		u64 mid = lo + (hi - lo) / 2;
+		if (!m2tsdmx_idx_scan(ctx, stream, mid, hi, DMX_IDX_SCAN_FIRST, 0, &pt)) {
+			hi = mid;
+		} else if (pt.time <= target) {
+			lo = pt.offset;
+		} else {
+			hi = mid;
+		}
+	}
+	//walk back from the bisection point until a RAP is found
+	end = hi;
+	win = ctx->pck_size * M2TSDMX_IDX_NB_PCK;
+	while (1) {
+		if (m2tsdmx_idx_scan(ctx, stream, lo, end, DMX_IDX_SCAN_RAP, target, &pt)) {
+			found = GF_TRUE;
+			break;
+		}
+		if (!lo || (hi - lo >= M2TSDMX_IDX_MAX_BACK)) break;
+		end = lo + ctx->pck_size;
+		lo = (lo > win) ? lo - win : 0;
+		win *= 2;
+	}
+	gf_fclose(stream);
+
+	if (!found) {
+		//no RAP signaled (no random_access_indicator), seek on the closest PES start
+		if (!lo) return GF_FALSE;
+		GF_LOG(GF_LOG_INFO, GF_LOG_CONTAINER, ("[M2TSDmx] No RAP found before %g, seeking to closest PES start\n", start_range));
+		*file_pos = lo;
+		return GF_TRUE;
+	}
+	*file_pos = pt.offset;
+	ctx->map_time_on_pcr = GF_TRUE;
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[M2TSDmx] Bisection seek to %g: RAP at %g offset "LLU"\n", start_range, ((Double) pt.time) / 90000, *file_pos));
+	return GF_TRUE;
+}
+
 static Bool m2tsdmx_process_event(GF_Filter *filter, const GF_FilterEvent *com)
 {
 	GF_M2TS_PES *pes;
@@ -962,10 +1680,17 @@ static Bool m2tsdmx_process_event(GF_Filter *filter, const GF_FilterEvent *com)
 
 
 		if (ctx->is_file && ctx->duration.num) {
+			Bool located = GF_FALSE;
 			file_pos = (u64) (ctx->file_size * com->play.start_range);
 			file_pos *= ctx->duration.den;
 			file_pos /= ctx->duration.num;
-			if (file_pos > ctx->file_size) return GF_TRUE;
+
+			ctx->map_time_on_pcr = GF_FALSE;
+			if (ctx->rapseek && (com->play.start_range > 0))
+				located = m2tsdmx_idx_locate(ctx, pes, com->play.start_range, &file_pos);
+
+			//duration is only estimated from the initial bitrate, only trust it if seek point could not be located
+			if (!located && (file_pos > ctx->file_size)) return GF_TRUE;
 		}
 
 		if (!ctx->initial_play_done) {
@@ -1027,15 +1752,49 @@ static GF_Err m2tsdmx_initialize(GF_Filter *filter)
 		gf_m2ts_demux_dmscc_init(ctx->ts);
 	}
 
+	if (!ctx->nbth) return GF_OK;
+
+	ctx->pool = gf_worker_pool_new(ctx->nbth, "M2TSDmx");
+	ctx->routes = gf_malloc(sizeof(u16) * GF_M2TS_MAX_STREAMS);
+	if (!ctx->pool || !ctx->routes)
+		return GF_OUT_OF_MEM;
+	m2tsdmx_reset_routes(ctx);
+
+	//no extra thread available, use single-threaded demux
+	ctx->nb_threads = gf_worker_pool_get_thread_count(ctx->pool);
+	if (ctx->nb_threads)
+		ctx->ts->on_packet = m2tsdmx_on_packet;
 	return GF_OK;
 }
 
 
 static void m2tsdmx_finalize(GF_Filter *filter)
 {
+	u32 i;
 	GF_M2TSDmxCtx *ctx = gf_filter_get_udta(filter);
-	if (ctx->ts) gf_m2ts_demux_del(ctx->ts);
 
+	if (ctx->pool) gf_worker_pool_del(ctx->pool);
+	if (ctx->batch) gf_free(ctx->batch);
+	if (ctx->psi_pcks) {
+		for (i=0; i<GF_M2TS_MAX_STREAMS; i++) {
+			if (ctx->psi_pcks[i]) gf_free(ctx->psi_pcks[i]);
+		}
+		gf_free(ctx->psi_pcks);
+	}
+	for (i=0; i<ctx->alloc_lanes; i++) {
+		GF_M2TSDmxLane *lane = &ctx->lanes[i];
+		if (lane->pcks) gf_free(lane->pcks);
+		if (lane->pck_nums) gf_free(lane->pck_nums);
+		if (lane->evts) gf_free(lane->evts);
+		if (lane->data) gf_free(lane->data);
+	}
+	if (ctx->lanes) gf_free(ctx->lanes);
+	if (ctx->routes) gf_free(ctx->routes);
+
+	if (ctx->ts) gf_m2ts_demux_del(ctx->ts);
+	if (ctx->src_path) gf_free(ctx->src_path);
+	if (ctx->idx) gf_free(ctx->idx);
+	if (ctx->idx_buf) gf_free(ctx->idx_buf);
 }
 
 static GF_Err m2tsdmx_process(GF_Filter *filter)
@@ -1049,6 +1808,7 @@ static GF_Err m2tsdmx_process(GF_Filter *filter)
 		if (gf_filter_pid_is_eos(ctx->ipid)) {
 			u32 i, nb_streams = gf_filter_get_opid_count(filter);
 
+			if (ctx->nb_threads) m2tsdmx_process_batch(ctx, GF_FALSE);
 			gf_m2ts_flush_all(ctx->ts);
 			for (i=0; i<nb_streams; i++) {
 				GF_FilterPid *opid = gf_filter_get_opid(filter, i);
@@ -1061,6 +1821,8 @@ static GF_Err m2tsdmx_process(GF_Filter *filter)
 	//we process even if no stream playing: since we use unframed dispatch we may need to send packets to configure reframers
 	//which will in turn connect to the sink which will send the PLAY event marking stream(s) as playing
 	if (ctx->in_seek) {
+		//packets routed before the seek are no longer needed
+		if (ctx->nb_threads) m2tsdmx_process_batch(ctx, GF_TRUE);
 		gf_m2ts_reset_parsers(ctx->ts);
 		ctx->in_seek = GF_FALSE;
 	} else {
@@ -1082,6 +1844,10 @@ static GF_Err m2tsdmx_process(GF_Filter *filter)
 
 	gf_filter_pid_drop_packet(ctx->ipid);
 
+	//don't delay live sources nor tune-in, during which the filter may seek the source
+	if (ctx->nb_threads && (!ctx->is_file || ctx->mux_tune_state || (188 * ctx->nb_batch_pcks >= M2TSDMX_MT_BATCH)))
+		m2tsdmx_process_batch(ctx, GF_FALSE);
+
 	if (ctx->mux_tune_state==DMX_TUNE_WAIT_SEEK) {
 		GF_FilterEvent fevt;
 		GF_FEVT_INIT(fevt, GF_FEVT_SOURCE_SEEK, ctx->ipid);
@@ -1101,6 +1867,12 @@ static const char *m2tsdmx_probe_data(const u8 *data, u32 size, GF_FilterProbeSc
 	return NULL;
 }
 
+static const GF_FilterProbeMagic M2TSDmxMagics[] =
+{
+	PROBE_MAGIC(0, "\x47"),
+	{0}
+};
+
 static const GF_FilterCapability M2TSDmxCaps[] =
 {
 	CAP_UINT(GF_CAPS_INPUT, GF_PROP_PID_STREAM_TYPE, GF_STREAM_FILE),
@@ -1120,6 +1892,9 @@ static const GF_FilterArgs M2TSDmxArgs[] =
 	{ OFFS(temi_url), "force TEMI URL", GF_PROP_NAME, NULL, NULL, GF_FS_ARG_HINT_ADVANCED},
 	{ OFFS(dsmcc), "enable DSMCC receiver", GF_PROP_BOOL, "no", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(seeksrc), "seek local source file back to origin once all programs are setup", GF_PROP_BOOL, "true", NULL, GF_FS_ARG_HINT_EXPERT},
+	{ OFFS(rapseek), "for local files, locate seek points by PTS bisection and random access indicator rather than by file size ratio", GF_PROP_BOOL, "true", NULL, GF_FS_ARG_HINT_EXPERT},
+	{ OFFS(tsidx), "sidecar seek index file for local files, built on first seek if missing or not matching the source", GF_PROP_NAME, NULL, NULL, GF_FS_ARG_HINT_ADVANCED},
+	{ OFFS(nbth), "number of program demux threads besides the filter thread, 0 disables multi-threaded demux. " GF_WORKER_POOL_NBTH_HELP, GF_PROP_SINT, "0", NULL, GF_FS_ARG_HINT_ADVANCED},
 	{0}
 };
 
@@ -1127,7 +1902,14 @@ static const GF_FilterArgs M2TSDmxArgs[] =
 GF_FilterRegister M2TSDmxRegister = {
 	.name = "m2tsdmx",
 	GF_FS_SET_DESCRIPTION("MPEG-2 TS demuxer")
-	GF_FS_SET_HELP("This filter demultiplexes MPEG-2 Transport Stream files/data into a set of media PIDs and frames.")
+	GF_FS_SET_HELP("This filter demultiplexes MPEG-2 Transport Stream files/data into a set of media PIDs and frames.\n"
+	"\n"
+	"When seeking in local files, the filter locates the closest random access point (as signaled by the random_access_indicator) before the seek time on the first video stream of the program, using PTS bisection over the file.\n"
+	"The [-tsidx]() option can be used to build (on first seek) and reuse a sidecar index of all random access points, avoiding file probing on subsequent seeks.\n"
+	"\n"
+	"When [-nbth]() is set, TS packets are first routed per program, and PES reassembly of each program is done by the filter thread and [-nbth]() extra threads, packets of a given PID being always processed in order by the same thread. "
+	"PSI/SI tables are processed by the filter thread once all programs are processed, except new PAT and PMT versions and TDT/TOT which are processed once all previous packets are processed. "
+	"For local files, input data is processed by batches of 1 MByte.\n")
 	.private_size = sizeof(GF_M2TSDmxCtx),
 	.initialize = m2tsdmx_initialize,
 	.finalize = m2tsdmx_finalize,
@@ -1138,6 +1920,7 @@ GF_FilterRegister M2TSDmxRegister = {
 	.process = m2tsdmx_process,
 	.process_event = m2tsdmx_process_event,
 	.probe_data = m2tsdmx_probe_data,
+	.probe_magics = M2TSDmxMagics,
 };
 
 
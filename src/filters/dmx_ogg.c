@@ -792,6 +792,12 @@ static const char *oggdmx_probe_data(const u8 *data, u32 size, GF_FilterProbeSco
 	return NULL;
 }
 
+static const GF_FilterProbeMagic OGGDmxMagics[] =
+{
+	PROBE_MAGIC(0, "OggS"),
+	{0}
+};
+
 
 static const GF_FilterCapability OGGDmxCaps[] =
 {
@@ -829,6 +835,7 @@ GF_FilterRegister OGGDmxRegister = {
 	.process = oggdmx_process,
 	.process_event = oggdmx_process_event,
 	.probe_data = oggdmx_probe_data,
+	.probe_magics = OGGDmxMagics,
 };
 
 #endif // !defined(GPAC_DISABLE_AV_PARSERS) && !defined(GPAC_DISABLE_OGG)
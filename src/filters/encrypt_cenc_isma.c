@@ -117,6 +117,10 @@ typedef struct
 
 	GF_List *streams;
 	GF_BitStream *bs_w, *bs_r;
+
+	//encrypted ranges of the current packet
+	GF_CryptSubsample *subs;
+	u32 nb_subs, nb_subs_alloc, subs_end;
 } GF_CENCEncCtx;
 
 
@@ -1223,6 +1227,21 @@ static u32 cenc_get_clear_bytes(GF_CENCStream *cstr, GF_BitStream *plaintext_bs,
 }
 #endif
 
+static GF_Err cenc_add_subsample(GF_CENCEncCtx *ctx, u32 pos, u32 size)
+{
+	if (ctx->nb_subs == ctx->nb_subs_alloc) {
+		GF_CryptSubsample *subs = gf_realloc(ctx->subs, sizeof(GF_CryptSubsample) * (ctx->nb_subs_alloc+16));
+		if (!subs) return GF_OUT_OF_MEM;
+		ctx->subs = subs;
+		ctx->nb_subs_alloc += 16;
+	}
+	ctx->subs[ctx->nb_subs].clear_bytes = pos - ctx->subs_end;
+	ctx->subs[ctx->nb_subs].crypt_bytes = size;
+	ctx->subs_end = pos + size;
+	ctx->nb_subs++;
+	return GF_OK;
+}
+
 static GF_Err cenc_encrypt_packet(GF_CENCEncCtx *ctx, GF_CENCStream *cstr, GF_FilterPacket *pck)
 {
 	GF_BitStream *sai_bs;
@@ -1262,6 +1281,7 @@ static GF_Err cenc_encrypt_packet(GF_CENCEncCtx *ctx, GF_CENCStream *cstr, GF_Fi
 
 	gf_bs_write_data(sai_bs, cstr->IV, cstr->tci->IV_size);
 
+	ctx->nb_subs = ctx->subs_end = 0;
 	while (gf_bs_available(ctx->bs_r)) {
 		GF_Err e=GF_OK;
 
@@ -1474,29 +1494,16 @@ static GF_Err cenc_encrypt_packet(GF_CENCEncCtx *ctx, GF_CENCStream *cstr, GF_Fi
 					/*skip bytes of encrypted data*/
 					gf_bs_skip_bytes(ctx->bs_r, nalu_size - clear_bytes);
 
-					//cbcs scheme with constant IV, reinit at each sub sample,
-					if (!cstr->ctr_mode && !cstr->tci->IV_size)
-						gf_crypt_set_IV(cstr->crypt, cstr->IV, 16);
-
-					//pattern encryption
+					//encryption of all subsamples is done once the packet is parsed
 					if (cstr->tci->crypt_byte_block && cstr->tci->skip_byte_block) {
 						u32 res = nalu_size - clear_bytes - clear_bytes_at_end;
-						pos = cur_pos;
 						assert((res % 16) == 0);
 
-						while (res) {
-							e = gf_crypt_encrypt(cstr->crypt, output+pos, res >= (u32) (16*cstr->tci->crypt_byte_block) ? 16*cstr->tci->crypt_byte_block : res);
-							if (res >= (u32) (16 * (cstr->tci->crypt_byte_block + cstr->tci->skip_byte_block))) {
-								pos += 16 * (cstr->tci->crypt_byte_block + cstr->tci->skip_byte_block);
-								res -= 16 * (cstr->tci->crypt_byte_block + cstr->tci->skip_byte_block);
-							} else {
-								res = 0;
-							}
-						}
+						e = cenc_add_subsample(ctx, cur_pos, res);
 					}
 					//full subsample encryption
 					else {
-						e = gf_crypt_encrypt(cstr->crypt, output+cur_pos, nalu_size - clear_bytes);
+						e = cenc_add_subsample(ctx, cur_pos, nalu_size - clear_bytes);
 					}
 				}
 
@@ -1580,7 +1587,18 @@ static GF_Err cenc_encrypt_packet(GF_CENCEncCtx *ctx, GF_CENCStream *cstr, GF_Fi
 			return e;
 		}
 	}
-	
+
+	//pattern encryption of all subsamples at once, cbcs scheme with constant IV reinit at each subsample
+	if (ctx->nb_subs) {
+		Bool const_IV = (!cstr->ctr_mode && !cstr->tci->IV_size) ? GF_TRUE : GF_FALSE;
+		GF_Err e = gf_crypt_encrypt_subsamples(cstr->crypt, output, pck_size, ctx->subs, ctx->nb_subs, cstr->tci->crypt_byte_block, cstr->tci->skip_byte_block, const_IV ? (u8 *) cstr->IV : NULL, 16);
+		if (e) {
+			gf_bs_del(sai_bs);
+			gf_filter_pck_discard(dst_pck);
+			return e;
+		}
+	}
+
 	if (prev_entry_bytes_clear || prev_entry_bytes_crypt) {
 		if (!nb_subsamples) gf_bs_write_u16(sai_bs, 0);
 		nb_subsamples++;
@@ -1833,6 +1851,7 @@ static void cenc_enc_finalize(GF_Filter *filter)
 	gf_list_del(ctx->streams);
 	if (ctx->bs_w) gf_bs_del(ctx->bs_w);
 	if (ctx->bs_r) gf_bs_del(ctx->bs_r);
+	if (ctx->subs) gf_free(ctx->subs);
 }
 
 
@@ -73,3 +73,6 @@ u64 ffmpeg_channel_layout_from_gpac(u64 gpac_ch_layout);
 u64 ffmpeg_channel_layout_to_gpac(u64 ff_ch_layout);
 
 void ffmpeg_report_unused_options(GF_Filter *filter, AVDictionary *options);
+
+/*gets the decoded frame of a video packet dispatched by ffdec without copy, NULL if the frame interface is not an ffdec one*/
+AVFrame *ffdec_get_frame(GF_FilterFrameInterface *frame_ifce);
@@ -87,8 +87,45 @@ typedef struct _gf_ffdec_ctx
 	GF_List *src_packets;
 
 	Bool drop_non_refs;
+
+	//options
+	Bool no_copy;
+	//decoded video frames are reference counted and owned by the filter
+	Bool frame_refs;
 } GF_FFDecodeCtx;
 
+/*frame interface of dispatched video frames, holding a reference to the decoded frame*/
+typedef struct
+{
+	GF_FilterFrameInterface frame_ifce;
+	AVFrame *frame;
+} GF_FFDecFrame;
+
+static GF_Err ffdec_frame_get_plane(GF_FilterFrameInterface *frame_ifce, u32 plane_idx, const u8 **outPlane, u32 *outStride)
+{
+	GF_FFDecFrame *f = (GF_FFDecFrame *)frame_ifce->user_data;
+	if (!outPlane || !outStride) return GF_BAD_PARAM;
+	*outPlane = NULL;
+	if ((plane_idx >= AV_NUM_DATA_POINTERS) || !f->frame->data[plane_idx]) return GF_BAD_PARAM;
+	*outPlane = f->frame->data[plane_idx];
+	*outStride = f->frame->linesize[plane_idx];
+	return GF_OK;
+}
+
+static void ffdec_frame_release(GF_Filter *filter, GF_FilterPid *pid, GF_FilterPacket *pck)
+{
+	GF_FilterFrameInterface *frame_ifce = gf_filter_pck_get_frame_interface(pck);
+	GF_FFDecFrame *f = (GF_FFDecFrame *)frame_ifce->user_data;
+	av_frame_free(&f->frame);
+	gf_free(f);
+}
+
+AVFrame *ffdec_get_frame(GF_FilterFrameInterface *frame_ifce)
+{
+	if (!frame_ifce || (frame_ifce->get_plane != ffdec_frame_get_plane)) return NULL;
+	return ((GF_FFDecFrame *)frame_ifce->user_data)->frame;
+}
+
 static GF_Err ffdec_initialize(GF_Filter *filter)
 {
 	GF_FFDecodeCtx *ctx = (GF_FFDecodeCtx *) gf_filter_get_udta(filter);
@@ -130,7 +167,8 @@ static GF_Err ffdec_process_video(GF_Filter *filter, struct _gf_ffdec_ctx *ctx)
 	s32 gotpic;
 	const char *data = NULL;
 	Bool seek_flag = GF_FALSE;
-	u32 i, count;
+	Bool no_copy;
+	u32 i, count, ilaced;
 	u32 size=0, pix_fmt, outsize, pix_out, stride, stride_uv, uv_height, nb_planes;
 	u8 *out_buffer;
 	GF_FilterPacket *pck_src;
@@ -185,6 +223,9 @@ static GF_Err ffdec_process_video(GF_Filter *filter, struct _gf_ffdec_ctx *ctx)
 	/*TOCHECK: for AVC bitstreams after ISMA decryption, in case (as we do) the decryption DRM tool
 	doesn't put back nalu size, we have to do it ourselves, but we can't modify input data...*/
 
+	//release our reference to the previous frame if not dispatched
+	if (ctx->frame_refs) av_frame_unref(frame);
+
 	gotpic=0;
 	res = avcodec_decode_video2(ctx->decoder, frame, &gotpic, &pkt);
 	if (pck) gf_filter_pid_drop_packet(ctx->in_pid);
@@ -238,6 +279,18 @@ static GF_Err ffdec_process_video(GF_Filter *filter, struct _gf_ffdec_ctx *ctx)
 		return GF_NOT_SUPPORTED;
 	}
 
+	//the decoded frame layout is a GPAC pixel format, dispatch it as is
+	//GPAC uses the same stride for both chroma planes, and the luma stride for alpha
+	no_copy = GF_FALSE;
+	if (ctx->frame_refs && frame->buf[0] && ffmpeg_pixfmt_to_gpac(ctx->decoder->pix_fmt) && (frame->linesize[0]>0) && (frame->linesize[1]>=0)
+		&& ((nb_planes<3) || (frame->linesize[2]==frame->linesize[1]))
+		&& ((nb_planes<4) || (frame->linesize[3]==frame->linesize[0]))
+	) {
+		no_copy = GF_TRUE;
+		stride = frame->linesize[0];
+		stride_uv = (nb_planes>1) ? frame->linesize[1] : 0;
+	}
+
 	FF_CHECK_PROP_VAL(stride, stride, GF_PROP_PID_STRIDE)
 	FF_CHECK_PROP_VAL(stride_uv, stride_uv, GF_PROP_PID_STRIDE_UV)
 	if (ctx->sar.num * ctx->decoder->sample_aspect_ratio.den != ctx->sar.den * ctx->decoder->sample_aspect_ratio.num) {
@@ -271,7 +324,30 @@ static GF_Err ffdec_process_video(GF_Filter *filter, struct _gf_ffdec_ctx *ctx)
 		return GF_OK;
 	}
 
-	dst_pck = gf_filter_pck_new_alloc(ctx->out_pid, outsize, &out_buffer);
+	ilaced = 0;
+	if (frame->interlaced_frame)
+		ilaced = frame->top_field_first ? 2 : 1;
+
+	if (no_copy) {
+		GF_FFDecFrame *f;
+		GF_SAFEALLOC(f, GF_FFDecFrame);
+		if (f) f->frame = av_frame_alloc();
+		if (!f || !f->frame) {
+			if (f) gf_free(f);
+			return GF_OUT_OF_MEM;
+		}
+		//move our reference to the packet, released when the packet is destroyed
+		av_frame_move_ref(f->frame, frame);
+		f->frame_ifce.user_data = f;
+		f->frame_ifce.get_plane = ffdec_frame_get_plane;
+		dst_pck = gf_filter_pck_new_frame_interface(ctx->out_pid, &f->frame_ifce, ffdec_frame_release);
+		if (!dst_pck) {
+			av_frame_free(&f->frame);
+			gf_free(f);
+		}
+	} else {
+		dst_pck = gf_filter_pck_new_alloc(ctx->out_pid, outsize, &out_buffer);
+	}
 
 	if (pck_src) {
 		if (dst_pck) gf_filter_pck_merge_properties(pck_src, dst_pck);
@@ -282,6 +358,8 @@ static GF_Err ffdec_process_video(GF_Filter *filter, struct _gf_ffdec_ctx *ctx)
 	}
 	if (!dst_pck) return GF_OUT_OF_MEM;
 
+	if (no_copy) goto send_frame;
+
 
 	//TODO: cleanup, we should not convert pixel format in the decoder but through filters !
 	switch (ctx->pixel_fmt) {
@@ -348,10 +426,11 @@ static GF_Err ffdec_process_video(GF_Filter *filter, struct _gf_ffdec_ctx *ctx)
 		sws_scale(ctx->sws_ctx, (const uint8_t * const*)frame->data, frame->linesize, 0, ctx->height, pict.data, pict.linesize);
 	}
 
+send_frame:
 	gf_filter_pck_set_seek_flag(dst_pck, GF_FALSE);
 
-	if (frame->interlaced_frame)
-		gf_filter_pck_set_interlaced(dst_pck, frame->top_field_first ? 2 : 1);
+	if (ilaced)
+		gf_filter_pck_set_interlaced(dst_pck, ilaced);
 
 	gf_filter_pck_send(dst_pck);
 	return GF_OK;
@@ -585,6 +664,16 @@ static GF_Err ffdec_process(GF_Filter *filter)
 	return ctx->process(filter, ctx);
 }
 
+//keep references to decoded video frames so that we can dispatch them without copy
+static void ffdec_set_frame_refs(GF_FFDecodeCtx *ctx, u32 type)
+{
+	ctx->frame_refs = GF_FALSE;
+	if ((type==GF_STREAM_VISUAL) && ctx->no_copy) {
+		ctx->decoder->refcounted_frames = 1;
+		ctx->frame_refs = GF_TRUE;
+	}
+}
+
 static GF_Err ffdec_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is_remove)
 {
 	s32 res;
@@ -650,6 +739,7 @@ static GF_Err ffdec_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is_
 		codec = avcodec_find_decoder(ctx->decoder->codec_id);
 		if (!codec) return GF_NOT_SUPPORTED;
 
+		ffdec_set_frame_refs(ctx, type);
 		res = avcodec_open2(ctx->decoder, codec, NULL );
 		if (res < 0) {
 			GF_LOG(GF_LOG_ERROR, GF_LOG_CODEC, ("[FFDec] PID %s failed to open codec context: %s\n", gf_filter_pid_get_name(pid), av_err2str(res) ));
@@ -721,6 +811,7 @@ static GF_Err ffdec_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is_
 			ctx->extra_data_crc = gf_crc_32(prop->value.data.ptr, prop->value.data.size);
 		}
 
+		ffdec_set_frame_refs(ctx, type);
 		res = avcodec_open2(ctx->decoder, codec, NULL );
 		if (res < 0) {
 			GF_LOG(GF_LOG_ERROR, GF_LOG_CODEC, ("[FFDec] PID %s failed to open codec context: %s\n", gf_filter_pid_get_name(pid), av_err2str(res) ));
@@ -911,15 +1002,20 @@ GF_FilterRegister FFDecodeRegister = {
 };
 
 
+#define OFFS(_n)	#_n, offsetof(GF_FFDecodeCtx, _n)
+
 static const GF_FilterArgs FFDecodeArgs[] =
 {
+	{ OFFS(no_copy), "dispatch decoded video frames without copy when their layout is supported, holding a reference to the decoder frame until the packet is released", GF_PROP_BOOL, "true", NULL, GF_FS_ARG_HINT_ADVANCED},
 	{ "*", -1, "any possible options defined for AVCodecContext and sub-classes. See `gpac -hx ffdec` and `gpac -hx ffdec:*`", GF_PROP_STRING, NULL, NULL, GF_FS_ARG_META},
 	{0}
 };
 
+const int FFDEC_STATIC_ARGS = (sizeof (FFDecodeArgs) / sizeof (GF_FilterArgs)) - 1;
+
 const GF_FilterRegister *ffdec_register(GF_FilterSession *session)
 {
-	ffmpeg_build_register(session, &FFDecodeRegister, FFDecodeArgs, 1, FF_REG_TYPE_DECODE);
+	ffmpeg_build_register(session, &FFDecodeRegister, FFDecodeArgs, FFDEC_STATIC_ARGS, FF_REG_TYPE_DECODE);
 	return &FFDecodeRegister;
 }
 
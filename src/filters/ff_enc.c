@@ -335,12 +335,21 @@ static GF_Err ffenc_process_video(GF_Filter *filter, struct _gf_ffenc_ctx *ctx)
 		} else {
 			GF_Err e=GF_NOT_SUPPORTED;
 			GF_FilterFrameInterface *frame_ifce = gf_filter_pck_get_frame_interface(pck);
-			if (frame_ifce && frame_ifce->get_plane) {
+			AVFrame *dec_frame = ffdec_get_frame(frame_ifce);
+			if (dec_frame) {
+				//frame from ffdec, reference its buffers so that the encoder does not copy the frame if it needs to keep it
+				for (i=0; i<AV_NUM_DATA_POINTERS; i++) {
+					ctx->frame->data[i] = dec_frame->data[i];
+					ctx->frame->linesize[i] = dec_frame->linesize[i];
+					if (dec_frame->buf[i]) ctx->frame->buf[i] = av_buffer_ref(dec_frame->buf[i]);
+				}
+				e = GF_OK;
+			} else if (frame_ifce && frame_ifce->get_plane) {
 				e = frame_ifce->get_plane(frame_ifce, 0, (const u8 **) &ctx->frame->data[0], &ctx->frame->linesize[0]);
 				if (!e && (ctx->nb_planes>1)) {
 					e = frame_ifce->get_plane(frame_ifce, 1, (const u8 **) &ctx->frame->data[1], &ctx->frame->linesize[1]);
 					if (!e && (ctx->nb_planes>2)) {
-						e = frame_ifce->get_plane(frame_ifce, 1, (const u8 **) &ctx->frame->data[2], &ctx->frame->linesize[2]);
+						e = frame_ifce->get_plane(frame_ifce, 2, (const u8 **) &ctx->frame->data[2], &ctx->frame->linesize[2]);
 					}
 				}
 			}
@@ -381,6 +390,11 @@ static GF_Err ffenc_process_video(GF_Filter *filter, struct _gf_ffenc_ctx *ctx)
 		res = avcodec_encode_video2(ctx->encoder, &pkt, ctx->frame, &gotpck);
 		ctx->nb_frames_in++;
 
+		//release our references to the ffdec frame, the encoder holds its own if needed
+		for (i=0; i<AV_NUM_DATA_POINTERS; i++) {
+			if (ctx->frame->buf[i]) av_buffer_unref(&ctx->frame->buf[i]);
+		}
+
 		//keep ref to ource properties
 		gf_filter_pck_ref_props(&pck);
 		gf_list_add(ctx->src_packets, pck);
@@ -0,0 +1,416 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2020
+ *					All rights reserved
+ *
+ *  This file is part of GPAC / HEVC tile slice rewriting
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include "hevc_rewrite.h"
+#include <gpac/thread.h>
+
+#ifndef GPAC_DISABLE_AV_PARSERS
+
+//max growth of a rewritten slice header: slice address, slice_qp_delta, num_entry_point_offsets and alignment
+#define HEVCRW_HEADER_GROWTH	16
+
+typedef struct
+{
+	//source slice without emulation prevention bytes
+	u8 *no_epb;
+	u32 no_epb_alloc;
+} HEVCRewriteWorker;
+
+struct __hevc_rewrite_pool
+{
+	const char *log_name;
+
+	GF_WorkerPool *wpool;
+	//one per pool thread, the first one being the filter thread
+	HEVCRewriteWorker *workers;
+	u32 nb_workers;
+
+	//current job
+	HEVCRewriteTile **tiles;
+	Bool write_pass;
+
+	u64 nb_rewritten, time_spent;
+};
+
+/*bit reader on a buffer without emulation prevention bytes, reading up to 32 bits at once*/
+typedef struct
+{
+	const u8 *buf;
+	u32 size, pos;
+} HEVCBitReader;
+
+static GFINLINE u32 hevcrw_read(HEVCBitReader *br, u32 nb_bits)
+{
+	u64 v = 0;
+	u32 i, byte = br->pos >> 3;
+	if (!nb_bits) return 0;
+	//load the 5 bytes covering the bits, missing bytes read as 0
+	for (i=0; i<5; i++) {
+		v <<= 8;
+		if (byte+i < br->size) v |= br->buf[byte+i];
+	}
+	v >>= 40 - (br->pos & 7) - nb_bits;
+	br->pos += nb_bits;
+	return (u32) (v & (0xFFFFFFFFUL >> (32 - nb_bits)));
+}
+
+static u32 hevcrw_read_ue(HEVCBitReader *br)
+{
+	u32 nb_zeros = 0;
+	while (!hevcrw_read(br, 1)) {
+		nb_zeros++;
+		if (nb_zeros==32) return 0;
+	}
+	if (!nb_zeros) return 0;
+	return (1 << nb_zeros) - 1 + hevcrw_read(br, nb_zeros);
+}
+
+/*bit writer accumulating bits in a 64 bit word, flushed by bytes*/
+typedef struct
+{
+	u8 *buf;
+	u32 pos;
+	u64 cache;
+	u32 nb_bits;
+} HEVCBitWriter;
+
+static GFINLINE void hevcrw_write(HEVCBitWriter *bw, u32 val, u32 nb_bits)
+{
+	if (!nb_bits) return;
+	bw->cache = (bw->cache << nb_bits) | (val & (0xFFFFFFFFUL >> (32 - nb_bits)));
+	bw->nb_bits += nb_bits;
+	while (bw->nb_bits >= 8) {
+		bw->nb_bits -= 8;
+		bw->buf[bw->pos++] = (u8) (bw->cache >> bw->nb_bits);
+	}
+}
+
+static void hevcrw_write_ue(HEVCBitWriter *bw, u32 val)
+{
+	u32 nb_bits = 0;
+	u32 v = val + 1;
+	while (v >> nb_bits) nb_bits++;
+	//nb_bits-1 zeros followed by val+1 on nb_bits
+	if (nb_bits > 16) {
+		hevcrw_write(bw, 0, nb_bits-1);
+		hevcrw_write(bw, v, nb_bits);
+	} else {
+		hevcrw_write(bw, v, 2*nb_bits - 1);
+	}
+}
+
+static void hevcrw_write_se(HEVCBitWriter *bw, s32 val)
+{
+	hevcrw_write_ue(bw, (val <= 0) ? (u32) (-2*val) : (u32) (2*val - 1));
+}
+
+static void hevcrw_copy_bits(HEVCBitReader *br, HEVCBitWriter *bw, u32 end_pos)
+{
+	while (br->pos + 32 <= end_pos) {
+		hevcrw_write(bw, hevcrw_read(br, 32), 32);
+	}
+	if (br->pos < end_pos)
+		hevcrw_write(bw, hevcrw_read(br, end_pos - br->pos), end_pos - br->pos);
+}
+
+static GF_Err hevcrw_rewrite_slice(HEVCRewritePool *pool, HEVCRewriteWorker *worker, HEVCRewriteTile *tile, HEVCRewriteNal *nal)
+{
+	u32 size_no_epb, nal_unit_type, first_slice_segment_in_pic_flag, dependent_slice_segment_flag, payload_start;
+	HEVCBitReader br;
+	HEVCBitWriter bw;
+
+	if (worker->no_epb_alloc < nal->size) {
+		u8 *no_epb = gf_realloc(worker->no_epb, nal->size);
+		if (!no_epb) return GF_OUT_OF_MEM;
+		worker->no_epb = no_epb;
+		worker->no_epb_alloc = nal->size;
+	}
+	size_no_epb = gf_media_nalu_remove_emulation_bytes((u8 *) nal->data, worker->no_epb, nal->size);
+
+	if (tile->buf_alloc < tile->buf_size + size_no_epb + HEVCRW_HEADER_GROWTH) {
+		u32 buf_alloc = tile->buf_size + size_no_epb + HEVCRW_HEADER_GROWTH;
+		u8 *buf = gf_realloc(tile->buf, buf_alloc);
+		if (!buf) return GF_OUT_OF_MEM;
+		tile->buf = buf;
+		tile->buf_alloc = buf_alloc;
+	}
+	br.buf = worker->no_epb;
+	br.size = size_no_epb;
+	br.pos = 0;
+	memset(&bw, 0, sizeof(HEVCBitWriter));
+	bw.buf = tile->buf + tile->buf_size;
+
+	//nal_unit_header
+	nal_unit_type = hevcrw_read(&br, 7);
+	hevcrw_write(&bw, nal_unit_type, 7);
+	nal_unit_type &= 0x3F;
+	hevcrw_write(&bw, hevcrw_read(&br, 9), 9);
+
+	first_slice_segment_in_pic_flag = hevcrw_read(&br, 1);
+	hevcrw_write(&bw, nal->address ? 0 : 1, 1);
+
+	switch (nal_unit_type) {
+	case GF_HEVC_NALU_SLICE_IDR_W_DLP:
+	case GF_HEVC_NALU_SLICE_IDR_N_LP:
+	case GF_HEVC_NALU_SLICE_BLA_W_LP:
+	case GF_HEVC_NALU_SLICE_BLA_W_DLP:
+	case GF_HEVC_NALU_SLICE_BLA_N_LP:
+	case GF_HEVC_NALU_SLICE_CRA:
+		//no_output_of_prior_pics_flag
+		hevcrw_write(&bw, hevcrw_read(&br, 1), 1);
+		break;
+	}
+	//pps_id
+	hevcrw_write_ue(&bw, hevcrw_read_ue(&br));
+
+	dependent_slice_segment_flag = 0;
+	if (!first_slice_segment_in_pic_flag && nal->dependent_slices_enabled)
+		dependent_slice_segment_flag = hevcrw_read(&br, 1);
+	//skip source slice address
+	if (!first_slice_segment_in_pic_flag)
+		br.pos += nal->nb_bits_address_src;
+
+	if (nal->address) {
+		if (nal->dependent_slices_enabled)
+			hevcrw_write(&bw, dependent_slice_segment_flag, 1);
+		hevcrw_write(&bw, nal->address, nal->nb_bits_address_dst);
+	}
+
+	if (nal->rewrite_qp) {
+		//copy until slice_qp_delta and replace it
+		hevcrw_copy_bits(&br, &bw, nal->qp_delta_start);
+		hevcrw_read_ue(&br);
+		hevcrw_write_se(&bw, nal->qp_delta);
+	}
+	//copy until num_entry_point_offsets
+	hevcrw_copy_bits(&br, &bw, nal->entry_point_start);
+
+	if (nal->write_entry_points)
+		hevcrw_write_ue(&bw, 0);
+
+	//slice_segment_header_extension_length set to 0
+	//TODO: we might want to copy over the slice extension header bits
+	if (nal->header_ext_present)
+		hevcrw_write_ue(&bw, 0);
+
+	//skip entry points and slice header extension in source
+	br.pos = nal->header_end;
+
+	//read byte_alignment() is bit=1 + x bit=0
+	if (hevcrw_read(&br, 1) != 1) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_CODEC, ("[%s] source slice header not properly aligned\n", pool->log_name));
+	}
+	//write byte_alignment() is bit=1 + x bit=0
+	hevcrw_write(&bw, 1, 1);
+	if (bw.nb_bits) hevcrw_write(&bw, 0, 8 - bw.nb_bits);
+
+	//copy slice payload
+	payload_start = (br.pos + 7) / 8;
+	if (payload_start < size_no_epb) {
+		memcpy(bw.buf + bw.pos, worker->no_epb + payload_start, size_no_epb - payload_start);
+		bw.pos += size_no_epb - payload_start;
+	}
+
+	nal->offset = tile->buf_size;
+	nal->size_no_epb = bw.pos;
+	nal->out_size = bw.pos + gf_media_nalu_emulation_bytes_add_count(bw.buf, bw.pos);
+	tile->buf_size += bw.pos;
+	return GF_OK;
+}
+
+static void hevcrw_rewrite_tile(HEVCRewritePool *pool, HEVCRewriteWorker *worker, HEVCRewriteTile *tile)
+{
+	u32 i;
+	tile->buf_size = 0;
+	tile->out_size = 0;
+	tile->error = GF_OK;
+	for (i=0; i<tile->nb_nals; i++) {
+		HEVCRewriteNal *nal = &tile->nals[i];
+		if (nal->is_slice) {
+			tile->error = hevcrw_rewrite_slice(pool, worker, tile, nal);
+			if (tile->error) return;
+		} else {
+			nal->out_size = nal->size;
+		}
+		tile->out_size += tile->nalu_size_length + nal->out_size;
+	}
+}
+
+static void hevcrw_write_tile(HEVCRewriteTile *tile)
+{
+	u32 i, n;
+	u8 *dst = tile->dst;
+	for (i=0; i<tile->nb_nals; i++) {
+		HEVCRewriteNal *nal = &tile->nals[i];
+		n = 8*tile->nalu_size_length;
+		while (n) {
+			*dst = (nal->out_size >> (n-8)) & 0xFF;
+			dst++;
+			n -= 8;
+		}
+		if (nal->is_slice) {
+			gf_media_nalu_add_emulation_bytes(tile->buf + nal->offset, dst, nal->size_no_epb);
+		} else {
+			memcpy(dst, nal->data, nal->size);
+		}
+		dst += nal->out_size;
+	}
+}
+
+static void hevcrw_run_task(void *udta, u32 worker_idx, u32 tile_idx)
+{
+	HEVCRewritePool *pool = (HEVCRewritePool *) udta;
+	if (pool->write_pass)
+		hevcrw_write_tile(pool->tiles[tile_idx]);
+	else
+		hevcrw_rewrite_tile(pool, &pool->workers[worker_idx], pool->tiles[tile_idx]);
+}
+
+static void hevcrw_pool_run(HEVCRewritePool *pool, HEVCRewriteTile **tiles, u32 nb_tiles, Bool write_pass)
+{
+	pool->tiles = tiles;
+	pool->write_pass = write_pass;
+	//tiles are shared between the pool threads and the filter thread
+	gf_worker_pool_run(pool->wpool, nb_tiles, hevcrw_run_task, pool);
+}
+
+GF_Err hevcrw_pool_rewrite(HEVCRewritePool *pool, HEVCRewriteTile **tiles, u32 nb_tiles)
+{
+	u32 i;
+	u64 clock = gf_sys_clock_high_res();
+	hevcrw_pool_run(pool, tiles, nb_tiles, GF_FALSE);
+	pool->time_spent += gf_sys_clock_high_res() - clock;
+	pool->nb_rewritten += nb_tiles;
+	for (i=0; i<nb_tiles; i++) {
+		if (tiles[i]->error) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_CODEC, ("[%s] failed to rewrite tile slices: %s\n", pool->log_name, gf_error_to_string(tiles[i]->error)));
+			return tiles[i]->error;
+		}
+	}
+	return GF_OK;
+}
+
+void hevcrw_pool_write(HEVCRewritePool *pool, HEVCRewriteTile **tiles, u32 nb_tiles)
+{
+	u64 clock = gf_sys_clock_high_res();
+	hevcrw_pool_run(pool, tiles, nb_tiles, GF_TRUE);
+	pool->time_spent += gf_sys_clock_high_res() - clock;
+}
+
+void hevcrw_pool_log_stats(HEVCRewritePool *pool)
+{
+	if (!pool->nb_rewritten || !pool->time_spent) return;
+	GF_LOG(GF_LOG_INFO, GF_LOG_CODEC, ("[%s] "LLU" tiles rewritten in "LLU" us ("LLU" tiles/sec) using %d threads\n", pool->log_name, pool->nb_rewritten, pool->time_spent, pool->nb_rewritten * 1000000 / pool->time_spent, pool->nb_workers));
+}
+
+HEVCRewritePool *hevcrw_pool_new(s32 nb_threads, const char *log_name)
+{
+	HEVCRewritePool *pool;
+	GF_SAFEALLOC(pool, HEVCRewritePool);
+	if (!pool) return NULL;
+	pool->log_name = log_name;
+
+	pool->wpool = gf_worker_pool_new(nb_threads, log_name);
+	if (!pool->wpool) {
+		hevcrw_pool_del(pool);
+		return NULL;
+	}
+	pool->nb_workers = 1 + gf_worker_pool_get_thread_count(pool->wpool);
+	pool->workers = gf_malloc(sizeof(HEVCRewriteWorker) * pool->nb_workers);
+	if (!pool->workers) {
+		hevcrw_pool_del(pool);
+		return NULL;
+	}
+	memset(pool->workers, 0, sizeof(HEVCRewriteWorker) * pool->nb_workers);
+	return pool;
+}
+
+void hevcrw_pool_del(HEVCRewritePool *pool)
+{
+	u32 i;
+	if (pool->wpool) gf_worker_pool_del(pool->wpool);
+	for (i=0; i<pool->nb_workers; i++) {
+		if (pool->workers[i].no_epb) gf_free(pool->workers[i].no_epb);
+	}
+	if (pool->workers) gf_free(pool->workers);
+	gf_free(pool);
+}
+
+HEVCRewriteNal *hevcrw_tile_add_nal(HEVCRewriteTile *tile, const u8 *data, u32 size)
+{
+	HEVCRewriteNal *nal;
+	if (tile->nb_nals == tile->nb_alloc) {
+		u32 nb_alloc = tile->nb_alloc ? 2*tile->nb_alloc : 4;
+		HEVCRewriteNal *nals = gf_realloc(tile->nals, sizeof(HEVCRewriteNal) * nb_alloc);
+		if (!nals) return NULL;
+		tile->nals = nals;
+		tile->nb_alloc = nb_alloc;
+	}
+	nal = &tile->nals[tile->nb_nals];
+	memset(nal, 0, sizeof(HEVCRewriteNal));
+	nal->data = data;
+	nal->size = size;
+	tile->nb_nals++;
+	return nal;
+}
+
+HEVCRewriteNal *hevcrw_tile_add_slice(HEVCRewriteTile *tile, const u8 *data, u32 size, HEVCState *hevc)
+{
+	HEVCSliceInfo *si = &hevc->s_info;
+	HEVCRewriteNal *nal = hevcrw_tile_add_nal(tile, data, size);
+	if (!nal) return NULL;
+
+	assert(si->header_size_bits >= 0);
+	assert(si->entry_point_start_bits >= 0);
+	nal->is_slice = GF_TRUE;
+	nal->header_end = (u32) si->header_size_bits;
+	nal->entry_point_start = (u32) si->entry_point_start_bits;
+	nal->qp_delta_start = (u32) si->slice_qp_delta_start_bits;
+	nal->nb_bits_address_src = si->sps->bitsSliceSegmentAddress;
+	nal->dependent_slices_enabled = si->pps->dependent_slice_segments_enabled_flag;
+	nal->header_ext_present = si->pps->slice_segment_header_extension_present_flag;
+	return nal;
+}
+
+void hevcrw_tile_reset(HEVCRewriteTile *tile)
+{
+	tile->nb_nals = 0;
+	tile->buf_size = 0;
+	tile->out_size = 0;
+	tile->error = GF_OK;
+	tile->dst = NULL;
+}
+
+void hevcrw_tile_del_buffers(HEVCRewriteTile *tile)
+{
+	if (tile->nals) gf_free(tile->nals);
+	if (tile->buf) gf_free(tile->buf);
+	tile->nals = NULL;
+	tile->buf = NULL;
+	tile->nb_alloc = tile->buf_alloc = 0;
+	hevcrw_tile_reset(tile);
+}
+
+#endif /*GPAC_DISABLE_AV_PARSERS*/
@@ -0,0 +1,114 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2020
+ *					All rights reserved
+ *
+ *  This file is part of GPAC / HEVC tile slice rewriting
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#ifndef _GF_HEVC_REWRITE_H_
+#define _GF_HEVC_REWRITE_H_
+
+#include <gpac/filters.h>
+#include <gpac/internal/media_dev.h>
+
+/*
+Slice header rewriting shared by hevcsplit and hevcmerge.
+
+Slices are parsed on the filter thread since the HEVC parser state is sequential. Each NAL to output is then described in the
+tile it belongs to, and tiles are processed by the filter thread and the pool threads in two passes:
+- the rewrite pass removes emulation prevention bytes, rewrites the slice header and computes the final size of each NAL
+- the write pass inserts emulation prevention bytes and writes the NALs of each tile in its destination buffer, usually the output packet
+allocated by the filter between the two passes.
+*/
+
+typedef struct
+{
+	//source NAL
+	const u8 *data;
+	u32 size;
+	//if not set, NAL is copied as is
+	Bool is_slice;
+
+	//slice parsing info, positions in bits in the slice without emulation prevention bytes
+	u32 header_end, entry_point_start, qp_delta_start;
+	u32 nb_bits_address_src;
+	Bool dependent_slices_enabled, header_ext_present;
+
+	//new slice address, 0 for the first slice in the picture
+	u32 address, nb_bits_address_dst;
+	//if set, slice_qp_delta is replaced by qp_delta
+	Bool rewrite_qp;
+	s32 qp_delta;
+	//if set, num_entry_point_offsets is written and set to 0
+	Bool write_entry_points;
+
+	//set by the rewrite pass: offset of the rewritten slice in the tile buffer, its size without and with emulation prevention bytes
+	u32 offset, size_no_epb, out_size;
+} HEVCRewriteNal;
+
+typedef struct
+{
+	HEVCRewriteNal *nals;
+	u32 nb_nals, nb_alloc;
+	//size in bytes of the NAL size field
+	u32 nalu_size_length;
+
+	//rewritten slices without emulation prevention bytes
+	u8 *buf;
+	u32 buf_size, buf_alloc;
+
+	//set by the rewrite pass: size of the tile output, including NAL size fields
+	u32 out_size;
+	//set by the rewrite pass: error if any, the tile shall not be written
+	GF_Err error;
+	//destination of the write pass, shall be at least out_size bytes
+	u8 *dst;
+} HEVCRewriteTile;
+
+typedef struct __hevc_rewrite_pool HEVCRewritePool;
+
+/*creates a rewrite pool
+\param nb_threads number of threads besides the filter thread, -1 uses the session extra thread count
+\param log_name name of the filter for logs
+\return the new pool*/
+HEVCRewritePool *hevcrw_pool_new(s32 nb_threads, const char *log_name);
+/*destroys a rewrite pool*/
+void hevcrw_pool_del(HEVCRewritePool *pool);
+/*runs the rewrite pass on a set of tiles
+\return error if any tile could not be rewritten*/
+GF_Err hevcrw_pool_rewrite(HEVCRewritePool *pool, HEVCRewriteTile **tiles, u32 nb_tiles);
+/*runs the write pass on a set of tiles*/
+void hevcrw_pool_write(HEVCRewritePool *pool, HEVCRewriteTile **tiles, u32 nb_tiles);
+/*logs the number of rewritten tiles and the time spent*/
+void hevcrw_pool_log_stats(HEVCRewritePool *pool);
+
+/*adds a NAL to a tile
+\return the NAL description, with all fields but data and size set to 0, or NULL if out of memory*/
+HEVCRewriteNal *hevcrw_tile_add_nal(HEVCRewriteTile *tile, const u8 *data, u32 size);
+/*adds a slice to a tile, setting up slice parsing info from the HEVC parser state
+\return the NAL description, or NULL if out of memory*/
+HEVCRewriteNal *hevcrw_tile_add_slice(HEVCRewriteTile *tile, const u8 *data, u32 size, HEVCState *hevc);
+/*removes all NALs of the tile*/
+void hevcrw_tile_reset(HEVCRewriteTile *tile);
+/*frees the tile buffers*/
+void hevcrw_tile_del_buffers(HEVCRewriteTile *tile);
+
+#endif //_GF_HEVC_REWRITE_H_
@@ -29,8 +29,10 @@
 #include <gpac/filters.h>
 #include <gpac/avparse.h>
 #include <gpac/constants.h>
+#include <gpac/thread.h>
 #include <gpac/internal/media_dev.h>
 #include <math.h>
+#include "hevc_rewrite.h"
 
 #ifndef GPAC_DISABLE_AV_PARSERS
 
@@ -57,6 +59,10 @@ typedef struct
 	// >=0: positioning in pixel in the Y plane as given by CropOrigin
 	// <=0: positioning relative to top-left tile
 	s32 pos_x, pos_y;
+
+	//NALs of the current frame for this pid, and whether its packet is to be dropped once written
+	HEVCRewriteTile tile;
+	Bool pck_pending;
 } HEVCTilePidCtx;
 
 
@@ -75,13 +81,14 @@ typedef struct
 {
 	//options
 	Bool strict, mrows;
+	s32 nbth;
 
 	GF_FilterPid *opid;
 	s32 base_pps_init_qp_delta_minus26;
 	u32 nb_bits_per_address_dst;
 	u32 out_width, out_height;
-	u8 *buffer_nal, *buffer_nal_no_epb, *buffer_nal_in_no_epb;
-	u32 buffer_nal_alloc, buffer_nal_no_epb_alloc, buffer_nal_in_no_epb_alloc;
+	u8 *buffer_nal_no_epb;
+	u32 buffer_nal_no_epb_alloc;
 	GF_BitStream *bs_au_in;
 
 	GF_BitStream *bs_nal_in;
@@ -90,8 +97,13 @@ typedef struct
 	HEVCGridInfo *grid;
 	u32 nb_cols;
 
-	u8 *sei_suffix_buf;
-	u32 sei_suffix_len, sei_suffix_alloc;
+	//slice rewriting threads
+	HEVCRewritePool *pool;
+	//tiles with NALs in the current frame
+	HEVCRewriteTile **tiles;
+	u32 nb_alloc_tiles;
+	//last SEI suffix of the current frame, appended after all tiles
+	HEVCRewriteTile sei_suffix;
 	u32 hevc_nalu_size_length;
 	u32 max_CU_width, max_CU_height;
 
@@ -233,163 +245,6 @@ static void hevcmerge_rewrite_pps(GF_HEVCMergeCtx *ctx, char *in_PPS, u32 in_PPS
 	gf_media_nalu_add_emulation_bytes(ctx->buffer_nal_no_epb, *out_PPS, pps_size_no_epb);
 }
 
-u32 hevcmerge_rewrite_slice(GF_HEVCMergeCtx *ctx, HEVCTilePidCtx *tile_pid, char *in_slice, u32 in_slice_length)
-{
-	u64 header_end;
-	u32 out_slice_size_no_epb = 0, out_slice_length;
-	u32 num_entry_point_start;
-	u32 pps_id;
-	Bool RapPicFlag = GF_FALSE;
-	u32 slice_qp_delta_start;
-	HEVC_PPS *pps;
-	HEVC_SPS *sps;
-	u32 al, slice_size, in_slice_size_no_epb, slice_offset_orig, slice_offset_dst;
-	u32 first_slice_segment_in_pic_flag;
-	u32 dependent_slice_segment_flag;
-	u8 nal_unit_type;
-	s32 new_slice_qp_delta;
-
-	HEVCState *hevc = &tile_pid->hevc_state;
-
-	//we remove EPB directly rather than from bs reader, since we will have to copy the entire payload without EPB
-	//and gf_bs_read_data does not check for EPB
-	if (ctx->buffer_nal_in_no_epb_alloc<in_slice_length) {
-		ctx->buffer_nal_in_no_epb_alloc = in_slice_length;
-		ctx->buffer_nal_in_no_epb = gf_realloc(ctx->buffer_nal_in_no_epb, in_slice_length);
-	}
-	in_slice_size_no_epb = gf_media_nalu_remove_emulation_bytes(in_slice, ctx->buffer_nal_in_no_epb, in_slice_length);
-	gf_bs_reassign_buffer(ctx->bs_nal_in, ctx->buffer_nal_in_no_epb, in_slice_size_no_epb);
-	//disable EPB removal
-	gf_bs_enable_emulation_byte_removal(ctx->bs_nal_in, GF_FALSE);
-	if (!ctx->bs_nal_out) ctx->bs_nal_out = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
-	else gf_bs_reassign_buffer(ctx->bs_nal_out, ctx->buffer_nal_no_epb, ctx->buffer_nal_no_epb_alloc);
-
-	assert(hevc->s_info.header_size_bits >= 0);
-	assert(hevc->s_info.entry_point_start_bits >= 0);
-	header_end = (u64)hevc->s_info.header_size_bits;
-
-	num_entry_point_start = (u32)hevc->s_info.entry_point_start_bits;
-	slice_qp_delta_start = (u32)hevc->s_info.slice_qp_delta_start_bits;
-
-	// nal_unit_header			 
-	gf_bs_write_int(ctx->bs_nal_out, gf_bs_read_int(ctx->bs_nal_in, 1), 1);
-	nal_unit_type = gf_bs_read_int(ctx->bs_nal_in, 6);
-	gf_bs_write_int(ctx->bs_nal_out, nal_unit_type, 6);
-	gf_bs_write_int(ctx->bs_nal_out, gf_bs_read_int(ctx->bs_nal_in, 9), 9);
-
-	first_slice_segment_in_pic_flag = gf_bs_read_int(ctx->bs_nal_in, 1);    //first_slice_segment_in_pic_flag
-	if (tile_pid->slice_segment_address == 0)
-		gf_bs_write_int(ctx->bs_nal_out, 1, 1);
-	else
-		gf_bs_write_int(ctx->bs_nal_out, 0, 1);
-
-	switch (nal_unit_type) {
-	case GF_HEVC_NALU_SLICE_IDR_W_DLP:
-	case GF_HEVC_NALU_SLICE_IDR_N_LP:
-		RapPicFlag = GF_TRUE;
-		break;
-	case GF_HEVC_NALU_SLICE_BLA_W_LP:
-	case GF_HEVC_NALU_SLICE_BLA_W_DLP:
-	case GF_HEVC_NALU_SLICE_BLA_N_LP:
-	case GF_HEVC_NALU_SLICE_CRA:
-		RapPicFlag = GF_TRUE;
-		break;
-	}
-
-	if (RapPicFlag) {
-		//no_output_of_prior_pics_flag
-		gf_bs_write_int(ctx->bs_nal_out, gf_bs_read_int(ctx->bs_nal_in, 1), 1);
-	}
-
-	pps_id = gf_bs_get_ue(ctx->bs_nal_in);
-	gf_bs_set_ue(ctx->bs_nal_out, pps_id);
-
-	pps = &hevc->pps[pps_id];
-	sps = &hevc->sps[pps->sps_id];
-
-	if (!first_slice_segment_in_pic_flag && pps->dependent_slice_segments_enabled_flag) {
-		dependent_slice_segment_flag = gf_bs_read_int(ctx->bs_nal_in, 1);
-	} else {
-		dependent_slice_segment_flag = GF_FALSE;
-	}
-	if (!first_slice_segment_in_pic_flag) {
-		/*address_ori = */gf_bs_read_int(ctx->bs_nal_in, sps->bitsSliceSegmentAddress);
-	}
-	//else original slice segment address = 0
-
-	if (tile_pid->slice_segment_address > 0) {
-		if (pps->dependent_slice_segments_enabled_flag) {
-			gf_bs_write_int(ctx->bs_nal_out, dependent_slice_segment_flag, 1);
-		}
-		gf_bs_write_int(ctx->bs_nal_out, tile_pid->slice_segment_address, ctx->nb_bits_per_address_dst);
-	}
-	//else first slice in pic, no address
-
-	//copy over bits until start of slice_qp_delta
-	while (slice_qp_delta_start != (gf_bs_get_position(ctx->bs_nal_in) - 1) * 8 + gf_bs_get_bit_position(ctx->bs_nal_in)) {
-		gf_bs_write_int(ctx->bs_nal_out, gf_bs_read_int(ctx->bs_nal_in, 1), 1);
-	}
-	//compute new qp delta
-	new_slice_qp_delta = hevc->s_info.pps->pic_init_qp_minus26 + hevc->s_info.slice_qp_delta - ctx->base_pps_init_qp_delta_minus26;
-	gf_bs_set_se(ctx->bs_nal_out, new_slice_qp_delta);
-	gf_bs_get_se(ctx->bs_nal_in);
-
-	//copy over until num_entry_points
-	while (num_entry_point_start != (gf_bs_get_position(ctx->bs_nal_in) - 1) * 8 + gf_bs_get_bit_position(ctx->bs_nal_in)) {
-		gf_bs_write_int(ctx->bs_nal_out, gf_bs_read_int(ctx->bs_nal_in, 1), 1);
-	}
-	//write num_entry_points to 0 (always present since we use tiling)
-	gf_bs_set_ue(ctx->bs_nal_out, 0);
-
-	//write slice extension to 0
-	if (pps->slice_segment_header_extension_present_flag)
-		gf_bs_write_int(ctx->bs_nal_out, 0, 1);
-
-
-	//we may have unparsed data in the source bitstream (slice header) due to entry points or slice segment extensions
-	//TODO: we might want to copy over the slice extension header bits
-	while (header_end != (gf_bs_get_position(ctx->bs_nal_in) - 1) * 8 + gf_bs_get_bit_position(ctx->bs_nal_in))
-		gf_bs_read_int(ctx->bs_nal_in, 1);
-
-	//read byte_alignment() is bit=1 + x bit=0
-	al = gf_bs_read_int(ctx->bs_nal_in, 1);
-	if (al != 1) {
-		GF_LOG(GF_LOG_ERROR, GF_LOG_CODEC, ("[HEVCMerge] source slice header not properly aligned\n"));
-	}
-	gf_bs_align(ctx->bs_nal_in);
-
-	//write byte_alignment() is bit=1 + x bit=0
-	gf_bs_write_int(ctx->bs_nal_out, 1, 1);
-	gf_bs_align(ctx->bs_nal_out);	// align
-
-	//get the final slice header
-	gf_bs_get_content_no_truncate(ctx->bs_nal_out, &ctx->buffer_nal_no_epb, &out_slice_size_no_epb, &ctx->buffer_nal_no_epb_alloc);
-
-	//get the slice payload size (no EPB in it) and offset in payload
-	slice_size = (u32) gf_bs_available(ctx->bs_nal_in);
-	slice_offset_orig = (u32) gf_bs_get_position(ctx->bs_nal_in);
-	//slice data offset in output slice
-	slice_offset_dst = out_slice_size_no_epb;
-	//update output slice size
-	out_slice_size_no_epb += slice_size;
-
-	//copy slice data
-	if (ctx->buffer_nal_no_epb_alloc < out_slice_size_no_epb) {
-		ctx->buffer_nal_no_epb_alloc = out_slice_size_no_epb;
-		ctx->buffer_nal_no_epb = gf_realloc(ctx->buffer_nal_no_epb, out_slice_size_no_epb);
-	}
-	memcpy(ctx->buffer_nal_no_epb + slice_offset_dst, ctx->buffer_nal_in_no_epb + slice_offset_orig, sizeof(char) * slice_size);
-
-	//insert epb
-	out_slice_length = out_slice_size_no_epb + gf_media_nalu_emulation_bytes_add_count(ctx->buffer_nal_no_epb, out_slice_size_no_epb);
-	if (ctx->buffer_nal_alloc < out_slice_length) {
-		ctx->buffer_nal_alloc = out_slice_length;
-		ctx->buffer_nal = gf_realloc(ctx->buffer_nal, out_slice_length);
-	}
-	gf_media_nalu_add_emulation_bytes(ctx->buffer_nal_no_epb, ctx->buffer_nal, out_slice_size_no_epb);
-	return out_slice_length;
-}
-
 static GF_Err hevcmerge_rewrite_config(GF_HEVCMergeCtx *ctx, GF_FilterPid *opid, char *data, u32 size)
 {
 	u32 i, j;
@@ -432,18 +287,6 @@ static GF_Err hevcmerge_rewrite_config(GF_HEVCMergeCtx *ctx, GF_FilterPid *opid,
 	return GF_OK;
 }
 
-static void hevcmerge_write_nal(GF_HEVCMergeCtx *ctx, char *output_nal, char *rewritten_nal, u32 out_nal_size)
-{
-	u32 n = 8*(ctx->hevc_nalu_size_length);
-	while (n) {
-		u32 v = (out_nal_size >> (n-8)) & 0xFF;
-		*output_nal = v;
-		output_nal++;
-		n-=8;
-	}
-	memcpy(output_nal, rewritten_nal, out_nal_size);
-}
-
 static u32 hevcmerge_compute_address(GF_HEVCMergeCtx *ctx, HEVCTilePidCtx *tile_pid, Bool use_y_coord)
 {
 	u32 i, nb_pids, sum_height = 0, sum_width = 0;
@@ -1169,6 +1012,7 @@ static GF_Err hevcmerge_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool
 	if (is_remove) {
 		tile_pid = gf_filter_pid_get_udta(pid);
 		gf_list_del_item(ctx->pids, tile_pid);
+		hevcrw_tile_del_buffers(&tile_pid->tile);
 		gf_free(tile_pid);
 		if (!gf_list_count(ctx->pids)) {
 			if (ctx->opid)
@@ -1369,10 +1213,22 @@ reconfig_grid:
 	return hevcmerge_rewrite_config(ctx, ctx->opid, dsi->value.data.ptr, dsi->value.data.size);
 }
 
+//discards the tiles of the current frame, input packets are kept
+static void hevcmerge_reset_tiles(GF_HEVCMergeCtx *ctx)
+{
+	u32 i;
+	for (i = 0; i < gf_list_count(ctx->ordered_pids); i++) {
+		HEVCTilePidCtx *tile_pid = gf_list_get(ctx->ordered_pids, i);
+		hevcrw_tile_reset(&tile_pid->tile);
+		tile_pid->pck_pending = GF_FALSE;
+	}
+	hevcrw_tile_reset(&ctx->sei_suffix);
+}
+
 static GF_Err hevcmerge_process(GF_Filter *filter)
 {
 	char *data;
-	u32 pos, nal_length, data_size, i;
+	u32 pos, nal_length, data_size, i, nb_tiles;
 	s32 current_poc=0;
 	u8 temporal_id, layer_id, nal_unit_type;
 	u32 nb_eos, nb_ipid;
@@ -1380,6 +1236,8 @@ static GF_Err hevcmerge_process(GF_Filter *filter)
 	u64 min_dts = GF_FILTER_NO_TS;
 	u32 min_dts_timescale=0;
 	GF_FilterPacket *output_pck = NULL;
+	GF_FilterPacket *props_src = NULL;
+	GF_Err e = GF_OK;
 	GF_HEVCMergeCtx *ctx = (GF_HEVCMergeCtx*) gf_filter_get_udta (filter);
 
 	if (ctx->in_error)
@@ -1417,8 +1275,8 @@ static GF_Err hevcmerge_process(GF_Filter *filter)
 		return GF_EOS;
 	}
 
-	//reassemble based on the ordered list of pids
-	for (i = 0; i < nb_ipid; i++) {
+	//reassemble based on the ordered list of pids - parsing is sequential and done on the filter thread
+	for (i = 0; !e && (i < nb_ipid); i++) {
 		u64 dts;
 		GF_FilterPacket *pck_src;
 		HEVCTilePidCtx *tile_pid = gf_list_get(ctx->ordered_pids, i);
@@ -1448,15 +1306,14 @@ static GF_Err hevcmerge_process(GF_Filter *filter)
 			continue;
 		}
 		tile_pid->nb_pck++;
+		//packet data is used until the write pass, drop it after
+		tile_pid->pck_pending = GF_TRUE;
+		tile_pid->tile.nalu_size_length = ctx->hevc_nalu_size_length;
 
 		//parse the access unit for this pid
 		gf_bs_reassign_buffer(ctx->bs_au_in, data, data_size);
 
-		while (gf_bs_available(ctx->bs_au_in)) {
-			u8 *output_nal;
-			u8 *nal_pck;
-			u32 nal_pck_size;
-
+		while (!e && gf_bs_available(ctx->bs_au_in)) {
 			nal_length = gf_bs_read_int(ctx->bs_au_in, tile_pid->nalu_size_length * 8);
 			pos = (u32) gf_bs_get_position(ctx->bs_au_in);
 			gf_media_hevc_parse_nalu(data + pos, nal_length, &tile_pid->hevc_state, &nal_unit_type, &temporal_id, &layer_id);
@@ -1464,63 +1321,117 @@ static GF_Err hevcmerge_process(GF_Filter *filter)
 
 			//VCL nal, rewrite slice header
 			if (nal_unit_type < 32) {
-				if (!i) current_poc = tile_pid->hevc_state.s_info.poc;
-				else if (current_poc != tile_pid->hevc_state.s_info.poc) {
-					GF_LOG(GF_LOG_WARNING, GF_LOG_CODEC, ("[HEVCMerge] merging AU %u with different POC (%d vs %d), undefined results.\n", tile_pid->nb_pck, current_poc, tile_pid->hevc_state.s_info.poc));
+				HEVCSliceInfo *si = &tile_pid->hevc_state.s_info;
+				HEVCRewriteNal *nal;
+				if (!i) current_poc = si->poc;
+				else if (current_poc != si->poc) {
+					GF_LOG(GF_LOG_WARNING, GF_LOG_CODEC, ("[HEVCMerge] merging AU %u with different POC (%d vs %d), undefined results.\n", tile_pid->nb_pck, current_poc, si->poc));
 				}
 
-				nal_pck_size = hevcmerge_rewrite_slice(ctx, tile_pid, data + pos, nal_length);
-				nal_pck = ctx->buffer_nal;
+				nal = hevcrw_tile_add_slice(&tile_pid->tile, data + pos, nal_length, &tile_pid->hevc_state);
+				if (!nal) {
+					e = GF_OUT_OF_MEM;
+					break;
+				}
+				nal->address = tile_pid->slice_segment_address;
+				nal->nb_bits_address_dst = ctx->nb_bits_per_address_dst;
+				//compute new qp delta - not present in dependent slice segments
+				nal->rewrite_qp = si->dependent_slice_segment_flag ? GF_FALSE : GF_TRUE;
+				nal->qp_delta = si->pps->pic_init_qp_minus26 + si->slice_qp_delta - ctx->base_pps_init_qp_delta_minus26;
+				//write num_entry_points to 0 (always present since we use tiling)
+				nal->write_entry_points = GF_TRUE;
 			}
 			//NON-vcl, copy for SEI or drop (we should not have any SPS/PPS/VPS in the bitstream, they are in the decoder config prop)
-			else {
-				gf_media_hevc_parse_nalu(data + pos, nal_length, &tile_pid->hevc_state, &nal_unit_type, &temporal_id, &layer_id);
-				// Copy SEI_PREFIX only for the first sample.
-				if (nal_unit_type == GF_HEVC_NALU_SEI_PREFIX && !found_sei_prefix) {
-					found_sei_prefix = GF_TRUE;
-					nal_pck = data + pos;
-					nal_pck_size = nal_length;
-				}
-				// Copy SEI_SUFFIX only as last nalu of the sample.
-				else if (nal_unit_type == GF_HEVC_NALU_SEI_SUFFIX && ((i+1 == nb_ipid) || !found_sei_suffix) ) {
-					found_sei_suffix = GF_TRUE;
-					if (ctx->sei_suffix_alloc<nal_length) {
-						ctx->sei_suffix_alloc = nal_length;
-						ctx->sei_suffix_buf = gf_realloc(ctx->sei_suffix_buf, nal_length);
-					}
-					ctx->sei_suffix_len = nal_length;
-					memcpy(ctx->sei_suffix_buf, data+pos, nal_length);
-					continue;
+			// Copy SEI_PREFIX only for the first sample.
+			else if (nal_unit_type == GF_HEVC_NALU_SEI_PREFIX && !found_sei_prefix) {
+				found_sei_prefix = GF_TRUE;
+				if (!hevcrw_tile_add_nal(&tile_pid->tile, data + pos, nal_length)) {
+					e = GF_OUT_OF_MEM;
+					break;
 				}
-				else continue;
-			}
-			if (!output_pck) {
-				output_pck = gf_filter_pck_new_alloc(ctx->opid, ctx->hevc_nalu_size_length + nal_pck_size, &output_nal);
-				// todo: might need to rewrite crypto info
-				gf_filter_pck_merge_properties(pck_src, output_pck);
 			}
-			else {
-				u8 *data_start;
-				u32 new_size;
-				gf_filter_pck_expand(output_pck, ctx->hevc_nalu_size_length + nal_pck_size, &data_start, &output_nal, &new_size);
+			// Copy SEI_SUFFIX only as last nalu of the sample.
+			else if (nal_unit_type == GF_HEVC_NALU_SEI_SUFFIX && ((i+1 == nb_ipid) || !found_sei_suffix) ) {
+				found_sei_suffix = GF_TRUE;
+				hevcrw_tile_reset(&ctx->sei_suffix);
+				ctx->sei_suffix.nalu_size_length = ctx->hevc_nalu_size_length;
+				if (!hevcrw_tile_add_nal(&ctx->sei_suffix, data + pos, nal_length)) {
+					e = GF_OUT_OF_MEM;
+					break;
+				}
 			}
-			hevcmerge_write_nal(ctx, output_nal, nal_pck, nal_pck_size);
+			else continue;
+
+			//suffix SEI alone does not produce an output
+			if (!props_src && (nal_unit_type != GF_HEVC_NALU_SEI_SUFFIX)) props_src = pck_src;
 		}
-		gf_filter_pid_drop_packet(tile_pid->pid);
 	}
 	// end of loop on inputs
+	if (e) {
+		hevcmerge_reset_tiles(ctx);
+		return e;
+	}
 
+	//gather tiles in output order
+	nb_tiles = 0;
+	if (ctx->nb_alloc_tiles < nb_ipid + 1) {
+		HEVCRewriteTile **tiles = gf_realloc(ctx->tiles, sizeof(HEVCRewriteTile *) * (nb_ipid + 1));
+		if (!tiles) {
+			hevcmerge_reset_tiles(ctx);
+			return GF_OUT_OF_MEM;
+		}
+		ctx->tiles = tiles;
+		ctx->nb_alloc_tiles = nb_ipid + 1;
+	}
+	for (i = 0; i < nb_ipid; i++) {
+		HEVCTilePidCtx *tile_pid = gf_list_get(ctx->ordered_pids, i);
+		if (tile_pid->tile.nb_nals) {
+			ctx->tiles[nb_tiles] = &tile_pid->tile;
+			nb_tiles++;
+		}
+	}
 	//if we had a SEI suffix, append it
-	if (ctx->sei_suffix_len) {
-		if (output_pck) {
-			u8 *output_nal;
-			u8 *data_start;
-			u32 new_size;
-			gf_filter_pck_expand(output_pck, ctx->hevc_nalu_size_length + ctx->sei_suffix_len, &data_start, &output_nal, &new_size);
-			hevcmerge_write_nal(ctx, output_nal, ctx->sei_suffix_buf, ctx->sei_suffix_len);
+	if (nb_tiles && ctx->sei_suffix.nb_nals) {
+		ctx->tiles[nb_tiles] = &ctx->sei_suffix;
+		nb_tiles++;
+	}
+
+	if (nb_tiles) {
+		u32 size = 0;
+		u8 *output;
+		//rewrite slices of all tiles
+		e = hevcrw_pool_rewrite(ctx->pool, ctx->tiles, nb_tiles);
+		if (e) {
+			hevcmerge_reset_tiles(ctx);
+			return e;
+		}
+
+		//allocate output packet at its final size and write tiles in it
+		for (i = 0; i < nb_tiles; i++)
+			size += ctx->tiles[i]->out_size;
+		output_pck = gf_filter_pck_new_alloc(ctx->opid, size, &output);
+		if (!output_pck) {
+			hevcmerge_reset_tiles(ctx);
+			return GF_OUT_OF_MEM;
+		}
+		// todo: might need to rewrite crypto info
+		gf_filter_pck_merge_properties(props_src, output_pck);
+		for (i = 0; i < nb_tiles; i++) {
+			ctx->tiles[i]->dst = output;
+			output += ctx->tiles[i]->out_size;
+		}
+		hevcrw_pool_write(ctx->pool, ctx->tiles, nb_tiles);
+	}
+
+	for (i = 0; i < nb_ipid; i++) {
+		HEVCTilePidCtx *tile_pid = gf_list_get(ctx->ordered_pids, i);
+		hevcrw_tile_reset(&tile_pid->tile);
+		if (tile_pid->pck_pending) {
+			tile_pid->pck_pending = GF_FALSE;
+			gf_filter_pid_drop_packet(tile_pid->pid);
 		}
-		ctx->sei_suffix_len = 0;
 	}
+	hevcrw_tile_reset(&ctx->sei_suffix);
 
 	if (output_pck)
 		gf_filter_pck_send(output_pck);
@@ -1536,6 +1447,8 @@ static GF_Err hevcmerge_initialize(GF_Filter *filter)
 	ctx->bs_nal_in = gf_bs_new((char *)ctx, 1, GF_BITSTREAM_READ);
 	ctx->pids = gf_list_new();
 	ctx->ordered_pids = gf_list_new();
+	ctx->pool = hevcrw_pool_new(ctx->nbth, "HEVCMerge");
+	if (!ctx->pool) return GF_OUT_OF_MEM;
 	return GF_OK;
 }
 
@@ -1543,9 +1456,13 @@ static void hevcmerge_finalize(GF_Filter *filter)
 {
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_CODEC, ("[HEVCMerge] hevcmerge_finalize.\n"));
 	GF_HEVCMergeCtx *ctx = (GF_HEVCMergeCtx *)gf_filter_get_udta(filter);
-	if (ctx->buffer_nal) gf_free(ctx->buffer_nal);
 	if (ctx->buffer_nal_no_epb) gf_free(ctx->buffer_nal_no_epb);
-	if (ctx->buffer_nal_in_no_epb) gf_free(ctx->buffer_nal_in_no_epb);
+	if (ctx->pool) {
+		hevcrw_pool_log_stats(ctx->pool);
+		hevcrw_pool_del(ctx->pool);
+	}
+	if (ctx->tiles) gf_free(ctx->tiles);
+	hevcrw_tile_del_buffers(&ctx->sei_suffix);
 	gf_bs_del(ctx->bs_au_in);
 	gf_bs_del(ctx->bs_nal_in);
 	if (ctx->bs_nal_out)
@@ -1554,13 +1471,11 @@ static void hevcmerge_finalize(GF_Filter *filter)
 	if (ctx->grid) gf_free(ctx->grid);
 	while (gf_list_count(ctx->pids)) {
 		HEVCTilePidCtx *pctx = gf_list_pop_back(ctx->pids);
+		hevcrw_tile_del_buffers(&pctx->tile);
 		gf_free(pctx);
 	}
 	gf_list_del(ctx->pids);
 	gf_list_del(ctx->ordered_pids);
-
-	if (ctx->sei_suffix_buf) gf_free(ctx->sei_suffix_buf);
-
 }
 
 static const GF_FilterCapability HEVCMergeCaps[] =
@@ -1578,6 +1493,7 @@ static const GF_FilterArgs HEVCMergeArgs[] =
 {
 	{ OFFS(strict), "strict comparison of SPS and PPS of input pids - see filter help", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_ADVANCED},
 	{ OFFS(mrows), "signal multiple rows in tile grid when possible", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_ADVANCED},
+	{ OFFS(nbth), "number of slice rewriting threads besides the filter thread. " GF_WORKER_POOL_NBTH_HELP, GF_PROP_SINT, "-1", NULL, GF_FS_ARG_HINT_ADVANCED},
 	{0}
 };
 
@@ -1590,6 +1506,7 @@ GF_FilterRegister HEVCMergeRegister = {
 		"Positioning of tiles can be automatic (implicit) or explicit.\n"
 		"The filter will check the SPS and PPS configurations of input PID and warn if they are not aligned but will still process them unless [-strict]() is set.\n"
 		"The filter assumes that all input PIDs are synchronized (frames share the same timestamp) and will reassemble frames with the same dts. If pids are of unequal duration, the filter will drop frames as soon as one pid is over.\n"
+		"Slice headers of the tiles are rewritten by the filter thread and [-nbth]() extra threads. The number of rewritten tiles per second is logged at `codec@info` level when the filter is destroyed.\n"
 		"## Implicit Positioning\n"
 		"In implicit positioning, results may vary based on the order of input pids declaration.\n"
 		"In this mode the filter will automatically allocate new columns for tiles with height not a multiple of max CU height.\n"
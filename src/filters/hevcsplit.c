@@ -29,7 +29,9 @@
 #include <gpac/filters.h>
 #include <gpac/avparse.h>
 #include <gpac/constants.h>
+#include <gpac/thread.h>
 #include <gpac/internal/media_dev.h>
+#include "hevc_rewrite.h"
 
 #ifndef GPAC_DISABLE_AV_PARSERS
 
@@ -38,10 +40,15 @@ typedef struct
 	GF_FilterPid *opid;
 	u32 width, height, orig_x, orig_y;
 	GF_FilterPacket *cur_pck;
+	//NALs of the current frame for this tile
+	HEVCRewriteTile tile;
 } HEVCTilePid;
 
 typedef struct
 {
+	//options
+	s32 nbth;
+
 	GF_FilterPid *ipid;
 	GF_List *outputs;
 	u32 num_tiles, got_p;
@@ -53,18 +60,15 @@ typedef struct
 	GF_BitStream *bs_nal_in;
 	GF_BitStream *bs_nal_out;
 
-	//buffer where we will store the rewritten slice with EPB
-	u8 *buffer_nal;
-	u32 buffer_nal_alloc;
-
-	//buffer where we will store the rewritten slice or nal (sps, pps) without EPB
+	//buffer where we will store the rewritten nal (sps, pps) without EPB
 	u8 *output_no_epb;
 	u32 output_no_epb_alloc;
 
-	//buffer where we will store the input slice without EPB - we cannot use EPB removal functions from bitstream object since
-	//we don't have gf_bs_read_data support in this mode
-	u8 *input_no_epb;
-	u32 input_no_epb_alloc;
+	//slice rewriting threads
+	HEVCRewritePool *pool;
+	//tiles with NALs in the current frame
+	HEVCRewriteTile **tiles;
+	u32 nb_alloc_tiles;
 } GF_HEVCSplitCtx;
 
 //get tiles coordinates in as index in grid
@@ -433,178 +437,6 @@ static void hevcsplit_rewrite_pps_no_grid(GF_HEVCSplitCtx *ctx, char *in_PPS, u3
 	gf_media_nalu_add_emulation_bytes(ctx->output_no_epb, *out_PPS, out_size_no_epb);
 }
 
-//return the new size slice - slice data is stored in ctx->buffer_nal
-static u32 hevcsplit_remove_slice_address(GF_HEVCSplitCtx *ctx, u8 *in_slice, u32 in_slice_length)
-{
-	u32 inslice_size_no_epb, outslice_size_epb;
-	u64 header_end;
-	u32 num_entry_point_start;
-	u32 pps_id;
-	Bool RapPicFlag = GF_FALSE;
-	HEVC_PPS *pps;
-	HEVC_SPS *sps;
-	u32 al, slice_size, slice_offset_orig, slice_offset_dst;
-	u32 first_slice_segment_in_pic_flag;
-	//u32 dependent_slice_segment_flag;
-	u8 nal_unit_type;
-	HEVCState *hevc = &ctx->hevc_state;
-
-	if (ctx->input_no_epb_alloc < in_slice_length) {
-		ctx->input_no_epb = gf_realloc(ctx->input_no_epb, in_slice_length);
-		ctx->input_no_epb_alloc = in_slice_length;
-	}
-	inslice_size_no_epb = gf_media_nalu_remove_emulation_bytes(in_slice, ctx->input_no_epb, in_slice_length);
-
-	gf_bs_reassign_buffer(ctx->bs_nal_in, ctx->input_no_epb, inslice_size_no_epb);
-	gf_bs_enable_emulation_byte_removal(ctx->bs_nal_in, GF_FALSE);
-
-	if (!ctx->bs_nal_out) ctx->bs_nal_out = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
-	else gf_bs_reassign_buffer(ctx->bs_nal_out, ctx->output_no_epb, ctx->output_no_epb_alloc);
-
-
-	assert(hevc->s_info.header_size_bits >= 0);
-	assert(hevc->s_info.entry_point_start_bits >= 0);
-	header_end = (u64) hevc->s_info.header_size_bits;
-
-	num_entry_point_start = (u32) hevc->s_info.entry_point_start_bits;
-
-	// nal_unit_header			 
-	gf_bs_write_int(ctx->bs_nal_out, gf_bs_read_int(ctx->bs_nal_in, 1), 1);
-	nal_unit_type = gf_bs_read_int(ctx->bs_nal_in, 6);
-	gf_bs_write_int(ctx->bs_nal_out, nal_unit_type, 6);
-	gf_bs_write_int(ctx->bs_nal_out, gf_bs_read_int(ctx->bs_nal_in, 9), 9);
-
-	first_slice_segment_in_pic_flag = gf_bs_read_int(ctx->bs_nal_in, 1);    //first_slice_segment_in_pic_flag
-	gf_bs_write_int(ctx->bs_nal_out, 1, 1);
-
-	switch (nal_unit_type) {
-	case GF_HEVC_NALU_SLICE_IDR_W_DLP:
-	case GF_HEVC_NALU_SLICE_IDR_N_LP:
-		RapPicFlag = GF_TRUE;
-		break;
-	case GF_HEVC_NALU_SLICE_BLA_W_LP:
-	case GF_HEVC_NALU_SLICE_BLA_W_DLP:
-	case GF_HEVC_NALU_SLICE_BLA_N_LP:
-	case GF_HEVC_NALU_SLICE_CRA:
-		RapPicFlag = GF_TRUE;
-		break;
-	}
-
-	if (RapPicFlag) {
-		//no_output_of_prior_pics_flag
-		gf_bs_write_int(ctx->bs_nal_out, gf_bs_read_int(ctx->bs_nal_in, 1), 1);
-	}
-
-	pps_id = gf_bs_get_ue(ctx->bs_nal_in);					 //pps_id
-	gf_bs_set_ue(ctx->bs_nal_out, pps_id);
-
-	pps = &hevc->pps[pps_id];
-	sps = &hevc->sps[pps->sps_id];
-
-	//dependent_slice_segment_flag = 0;
-	if (!first_slice_segment_in_pic_flag && pps->dependent_slice_segments_enabled_flag) {
-		/*dependent_slice_segment_flag =*/ gf_bs_read_int(ctx->bs_nal_in, 1);
-//	} else {
-//		dependent_slice_segment_flag = GF_FALSE;
-	}
-
-	if (!first_slice_segment_in_pic_flag) {
-		gf_bs_read_int(ctx->bs_nal_in, sps->bitsSliceSegmentAddress);
-	}
-	//else original slice segment address = 0
-
-	//nothing to write for slice address, we remove the address
-
-	//copy over until num_entry_points
-	while (num_entry_point_start != (gf_bs_get_position(ctx->bs_nal_in) - 1) * 8 + gf_bs_get_bit_position(ctx->bs_nal_in)) {
-		gf_bs_write_int(ctx->bs_nal_out, gf_bs_read_int(ctx->bs_nal_in, 1), 1);
-	}
-
-	//no tilin, don't write num_entry_points
-
-	//write slice extension to 0
-	if (pps->slice_segment_header_extension_present_flag)
-		gf_bs_write_int(ctx->bs_nal_out, 0, 1);
-
-	//we may have unparsed data in the source bitstream (slice header) due to entry points or slice segment extensions
-	//TODO: we might want to copy over the slice extension header bits
-	while (header_end != (gf_bs_get_position(ctx->bs_nal_in) - 1) * 8 + gf_bs_get_bit_position(ctx->bs_nal_in))
-		gf_bs_read_int(ctx->bs_nal_in, 1);
-
-	//read byte_alignment() is bit=1 + x bit=0
-	al = gf_bs_read_int(ctx->bs_nal_in, 1);
-	if (al != 1) {
-		GF_LOG(GF_LOG_ERROR, GF_LOG_CODEC, ("[HEVCTileSplit] source slice header not properly aligned\n"));
-	}
-
-	//write byte_alignment() is bit=1 + x bit=0
-	gf_bs_write_int(ctx->bs_nal_out, 1, 1);
-	gf_bs_align(ctx->bs_nal_out);					//align
-
-	 /* get output slice header*/
-	u32 outslice_size_no_epb;
-	gf_bs_get_content_no_truncate(ctx->bs_nal_out, &ctx->output_no_epb, &outslice_size_no_epb, &ctx->output_no_epb_alloc);
-	/* slice_size: the rest of the slice after the header (no_emulation_bytes in it) in source.*/
-	slice_size = (u32) gf_bs_available(ctx->bs_nal_in);
-	 /* slice_offset_orig: Immediate next byte after header_end (start of the slice_payload) */
-	slice_offset_orig = (u32) gf_bs_get_position(ctx->bs_nal_in);
-	/* slice_offset_dst: end of header in dest (=dst_buf_size since we have not copied slice data yet)*/
-	slice_offset_dst = outslice_size_no_epb;
-	/*final slice size: add source slice size */
-	outslice_size_no_epb += slice_size;
-	if (ctx->output_no_epb_alloc < outslice_size_no_epb) {
-		ctx->output_no_epb = gf_realloc(ctx->output_no_epb, outslice_size_no_epb);
-		ctx->output_no_epb_alloc = outslice_size_no_epb;
-	}
-	memcpy(ctx->output_no_epb + slice_offset_dst, ctx->input_no_epb + slice_offset_orig, sizeof(char) * slice_size);
-
-	outslice_size_epb = outslice_size_no_epb + gf_media_nalu_emulation_bytes_add_count(ctx->output_no_epb, outslice_size_no_epb);
-
-	if (ctx->buffer_nal_alloc < outslice_size_epb) {
-		ctx->buffer_nal = gf_realloc(ctx->buffer_nal, outslice_size_epb);
-		ctx->buffer_nal_alloc = outslice_size_epb;
-	}
-	gf_media_nalu_add_emulation_bytes(ctx->output_no_epb, ctx->buffer_nal, outslice_size_no_epb);
-	return outslice_size_epb;
-}
-
-static char *hevcsplit_rewrite_nal(GF_Filter *filter, GF_HEVCSplitCtx *ctx, char *in_nal, u32 in_nal_size, u32 *out_tile_index, u32 *out_nal_size)
-{
-	u8 nal_unit_type, temporal_id, layer_id;
-	u32 buf_size;
-	HEVCState *hevc = &ctx->hevc_state;
-
-	gf_media_hevc_parse_nalu(in_nal, in_nal_size, hevc, &nal_unit_type, &temporal_id, &layer_id);
-	switch (nal_unit_type) {
-	//all VCL nal, remove slice address
-	case GF_HEVC_NALU_SLICE_TRAIL_N:
-	case GF_HEVC_NALU_SLICE_TRAIL_R:
-	case GF_HEVC_NALU_SLICE_TSA_N:
-	case GF_HEVC_NALU_SLICE_TSA_R:
-	case GF_HEVC_NALU_SLICE_STSA_N:
-	case GF_HEVC_NALU_SLICE_STSA_R:
-	case GF_HEVC_NALU_SLICE_RADL_N:
-	case GF_HEVC_NALU_SLICE_RADL_R:
-	case GF_HEVC_NALU_SLICE_RASL_N:
-	case GF_HEVC_NALU_SLICE_RASL_R:
-	case GF_HEVC_NALU_SLICE_BLA_W_LP:
-	case GF_HEVC_NALU_SLICE_BLA_W_DLP:
-	case GF_HEVC_NALU_SLICE_BLA_N_LP:
-	case GF_HEVC_NALU_SLICE_IDR_W_DLP:
-	case GF_HEVC_NALU_SLICE_IDR_N_LP:
-	case GF_HEVC_NALU_SLICE_CRA:
-		*out_tile_index = hevcsplit_get_slice_tile_index(hevc);
-		buf_size = hevcsplit_remove_slice_address(ctx, in_nal, in_nal_size);
-		*out_nal_size = buf_size;
-		return ctx->buffer_nal;
-	//non-vcl, write to bitstream
-	default:
-		*out_nal_size = in_nal_size;
-		return in_nal;
-	}
-	return NULL;
-}
-
 static GF_Err hevcsplit_rewrite_dsi(GF_HEVCSplitCtx *ctx, GF_FilterPid *opid, char *data, u32 size, u32 new_width, u32 new_height)
 {
 	u32 i, j;
@@ -647,18 +479,6 @@ static GF_Err hevcsplit_rewrite_dsi(GF_HEVCSplitCtx *ctx, GF_FilterPid *opid, ch
 	return GF_OK;
 }
 
-static void hevcsplit_write_nal(char *output_nal, char *rewritten_nal, u32 out_nal_size, u32 hevc_nalu_size_length)
-{
-	u32 n = 8*(hevc_nalu_size_length);
-	while (n) {
-		u32 v = (out_nal_size >> (n-8)) & 0xFF;
-		*output_nal = v;
-		output_nal++;
-		n-=8;
-	}
-	memcpy(output_nal, rewritten_nal, out_nal_size);
-}
-
 static GF_Err hevcsplit_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is_remove)
 {
 	u32 cfg_crc = 0, codecid, o_width, o_height;
@@ -680,7 +500,10 @@ static GF_Err hevcsplit_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool
 				gf_filter_pid_remove(tpid->opid);
 				tpid->opid = NULL;
 			}
-			if (tpid) gf_free(tpid);
+			if (tpid) {
+				hevcrw_tile_del_buffers(&tpid->tile);
+				gf_free(tpid);
+			}
 			if(opid){
 				gf_filter_pid_set_udta(opid, NULL);
 				gf_filter_pid_remove(opid);
@@ -791,16 +614,43 @@ static GF_Err hevcsplit_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool
 	return GF_OK;
 }
 
+static GF_Err hevcsplit_add_nal(GF_HEVCSplitCtx *ctx, u32 tile_idx, u8 *data, u32 size, Bool is_slice)
+{
+	HEVCRewriteNal *nal;
+	HEVCTilePid *tpid = gf_list_get(ctx->outputs, tile_idx);
+	if (!tpid || !tpid->opid) return GF_OK;
+
+	tpid->tile.nalu_size_length = ctx->hevc_nalu_size_length;
+	//slices are rewritten without slice address, other NALs are copied as is
+	if (is_slice)
+		nal = hevcrw_tile_add_slice(&tpid->tile, data, size, &ctx->hevc_state);
+	else
+		nal = hevcrw_tile_add_nal(&tpid->tile, data, size);
+	return nal ? GF_OK : GF_OUT_OF_MEM;
+}
+
+//discards the current frame of all outputs, the input packet is kept
+static void hevcsplit_reset_tiles(GF_HEVCSplitCtx *ctx)
+{
+	u32 i;
+	for (i=0; i < ctx->num_tiles; i++) {
+		HEVCTilePid *tpid = gf_list_get(ctx->outputs, i);
+		if (!tpid) continue;
+		hevcrw_tile_reset(&tpid->tile);
+		if (tpid->cur_pck) {
+			gf_filter_pck_discard(tpid->cur_pck);
+			tpid->cur_pck = NULL;
+		}
+	}
+}
+
 static GF_Err hevcsplit_process(GF_Filter *filter)
 {
-	u32 hevc_nalu_size_length;
 	u32 data_size, nal_length, opid_idx = 0;
-	u8 temporal_id, layer_id, nal_unit_type, i;
+	u8 temporal_id, layer_id, nal_unit_type;
+	u32 i, nb_tiles;
 	u8 *data;
-	u8 *output_nal;
-	u32 out_nal_size;
-	GF_FilterPid * opid;
-	HEVCTilePid * tpid;
+	GF_Err e = GF_OK;
 	GF_HEVCSplitCtx *ctx = (GF_HEVCSplitCtx*)gf_filter_get_udta(filter);
 	GF_FilterPacket *pck_src = gf_filter_pid_get_packet(ctx->ipid);
 	if (!pck_src) {
@@ -820,8 +670,8 @@ static GF_Err hevcsplit_process(GF_Filter *filter)
 	ctx->nb_pck++;
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_CODEC, ("[HEVCTileSplit] splitting frame %d DTS "LLU" CTS "LLU"\n", ctx->nb_pck, gf_filter_pck_get_dts(pck_src), gf_filter_pck_get_cts(pck_src)));
 
-	while (gf_bs_available(ctx->bs_au_in)) {
-		u8 *rewritten_nal;
+	//parse all NALs and dispatch them to their tiles - parsing is sequential and done on the filter thread
+	while (!e && gf_bs_available(ctx->bs_au_in)) {
 		// ctx->hevc_nalu_size_length filled using hvcc
 		nal_length = gf_bs_read_int(ctx->bs_au_in, ctx->hevc_nalu_size_length * 8);
 		u32 pos = (u32) gf_bs_get_position(ctx->bs_au_in);
@@ -832,52 +682,69 @@ static GF_Err hevcsplit_process(GF_Filter *filter)
 
 		// todo: might need to rewrite crypto info
 
-		rewritten_nal = hevcsplit_rewrite_nal(filter, ctx, data+pos, nal_length, &opid_idx, &out_nal_size);
-		if (!rewritten_nal) continue;
-
-		hevc_nalu_size_length = ctx->hevc_nalu_size_length;
 		//non-vcl NAL, forward to all outputs
 		if (nal_unit_type > 34) {
 			for (i=0; i<ctx->num_tiles; i++) {
-				opid = gf_filter_get_opid(filter, i);
-				tpid = gf_filter_pid_get_udta(opid);
-				if (!tpid->opid) {
-					continue;
-				}
-				if (!tpid->cur_pck) {
-					tpid->cur_pck = gf_filter_pck_new_alloc(tpid->opid, ctx->hevc_nalu_size_length + out_nal_size, &output_nal);
-					gf_filter_pck_merge_properties(pck_src, tpid->cur_pck);
-				} else {
-					u8 *data_start;
-					u32 new_size;
-					gf_filter_pck_expand(tpid->cur_pck, ctx->hevc_nalu_size_length + out_nal_size, &data_start, &output_nal, &new_size);
-				}
-				hevcsplit_write_nal(output_nal, rewritten_nal, out_nal_size, hevc_nalu_size_length);
+				e = hevcsplit_add_nal(ctx, i, data+pos, nal_length, GF_FALSE);
+				if (e) break;
 			}
+		}
+		//all VCL nal, remove slice address
+		else if (nal_unit_type <= GF_HEVC_NALU_SLICE_CRA) {
+			opid_idx = hevcsplit_get_slice_tile_index(&ctx->hevc_state);
+			e = hevcsplit_add_nal(ctx, opid_idx, data+pos, nal_length, GF_TRUE);
 		} else {
-			opid = gf_filter_get_opid(filter, opid_idx);
-			tpid = gf_filter_pid_get_udta(opid);
-			if (!tpid->opid) {
-				continue;
-			}
-			if (!tpid->cur_pck) {
-				tpid->cur_pck = gf_filter_pck_new_alloc(tpid->opid, ctx->hevc_nalu_size_length + out_nal_size, &output_nal);
-				gf_filter_pck_merge_properties(pck_src, tpid->cur_pck);
-			} else {
-				u8 *data_start;
-				u32 new_size;
-				gf_filter_pck_expand(tpid->cur_pck, ctx->hevc_nalu_size_length + out_nal_size, &data_start, &output_nal, &new_size);
-			}
-			hevcsplit_write_nal(output_nal, rewritten_nal, out_nal_size, hevc_nalu_size_length);
+			e = hevcsplit_add_nal(ctx, opid_idx, data+pos, nal_length, GF_FALSE);
+		}
+	}
+	if (e) {
+		hevcsplit_reset_tiles(ctx);
+		return e;
+	}
+
+	nb_tiles = 0;
+	if (ctx->nb_alloc_tiles < ctx->num_tiles) {
+		HEVCRewriteTile **tiles = gf_realloc(ctx->tiles, sizeof(HEVCRewriteTile *) * ctx->num_tiles);
+		if (!tiles) {
+			hevcsplit_reset_tiles(ctx);
+			return GF_OUT_OF_MEM;
 		}
+		ctx->tiles = tiles;
+		ctx->nb_alloc_tiles = ctx->num_tiles;
 	}
+	for (i=0; i < ctx->num_tiles; i++) {
+		HEVCTilePid *tpid = gf_list_get(ctx->outputs, i);
+		if (tpid && tpid->opid && tpid->tile.nb_nals) {
+			ctx->tiles[nb_tiles] = &tpid->tile;
+			nb_tiles++;
+		}
+	}
+	//rewrite slices of all tiles
+	e = hevcrw_pool_rewrite(ctx->pool, ctx->tiles, nb_tiles);
+	if (e) {
+		hevcsplit_reset_tiles(ctx);
+		return e;
+	}
+
+	//allocate output packets at their final size and write tiles in them
+	for (i=0; i < ctx->num_tiles; i++) {
+		HEVCTilePid *tpid = gf_list_get(ctx->outputs, i);
+		if (!tpid || !tpid->opid || !tpid->tile.nb_nals) continue;
+		tpid->cur_pck = gf_filter_pck_new_alloc(tpid->opid, tpid->tile.out_size, &tpid->tile.dst);
+		if (!tpid->cur_pck) {
+			hevcsplit_reset_tiles(ctx);
+			return GF_OUT_OF_MEM;
+		}
+		gf_filter_pck_merge_properties(pck_src, tpid->cur_pck);
+	}
+	hevcrw_pool_write(ctx->pool, ctx->tiles, nb_tiles);
 	gf_filter_pid_drop_packet(ctx->ipid);
+
 	// done rewriting all nals from input, send all output
 	for (i=0; i < ctx->num_tiles; i++) {
-		opid = gf_filter_get_opid(filter, i);
-		tpid = gf_filter_pid_get_udta(opid);
-
-		if (!tpid->opid) continue;
+		HEVCTilePid *tpid = gf_list_get(ctx->outputs, i);
+		if (!tpid) continue;
+		hevcrw_tile_reset(&tpid->tile);
 		if (tpid->cur_pck) {
 			gf_filter_pck_send(tpid->cur_pck);
 			tpid->cur_pck = NULL;
@@ -892,6 +759,8 @@ static GF_Err hevcsplit_initialize(GF_Filter *filter)
 	ctx->bs_au_in = gf_bs_new((char *)ctx, 1, GF_BITSTREAM_READ);
 	ctx->bs_nal_in = gf_bs_new((char *)ctx, 1, GF_BITSTREAM_READ);
 	ctx->outputs = gf_list_new();
+	ctx->pool = hevcrw_pool_new(ctx->nbth, "HEVCTileSplit");
+	if (!ctx->pool) return GF_OUT_OF_MEM;
 	return GF_OK;
 }
 
@@ -899,9 +768,12 @@ static void hevcsplit_finalize(GF_Filter *filter)
 {
 	u32 i, count;
 	GF_HEVCSplitCtx *ctx = (GF_HEVCSplitCtx *) gf_filter_get_udta(filter);
-	if (ctx->buffer_nal) gf_free(ctx->buffer_nal);
 	if (ctx->output_no_epb) gf_free(ctx->output_no_epb);
-	if (ctx->input_no_epb) gf_free(ctx->input_no_epb);
+	if (ctx->pool) {
+		hevcrw_pool_log_stats(ctx->pool);
+		hevcrw_pool_del(ctx->pool);
+	}
+	if (ctx->tiles) gf_free(ctx->tiles);
 
 	gf_bs_del(ctx->bs_au_in);
 	gf_bs_del(ctx->bs_nal_in);
@@ -911,6 +783,7 @@ static void hevcsplit_finalize(GF_Filter *filter)
 	for (i=0; i<count; i++) {
 		HEVCTilePid *tpid;
 		tpid = gf_list_get(ctx->outputs, i);
+		hevcrw_tile_del_buffers(&tpid->tile);
 		gf_free(tpid);
 	}
 	gf_list_del(ctx->outputs);
@@ -929,6 +802,7 @@ static const GF_FilterCapability HEVCSplitCaps[] =
 
 static const GF_FilterArgs HEVCSplitArgs[] =
 {
+	{ OFFS(nbth), "number of slice rewriting threads besides the filter thread. " GF_WORKER_POOL_NBTH_HELP, GF_PROP_SINT, "-1", NULL, GF_FS_ARG_HINT_ADVANCED},
 	{0}
 };
 
@@ -936,7 +810,8 @@ GF_FilterRegister HEVCSplitRegister = {
 	.name = "hevcsplit",
 	GF_FS_SET_DESCRIPTION("HEVC tile spliter")
 	GF_FS_SET_HELP("This filter splits a motion-constrained tiled HEVC PID into N independent HEVC PIDs.\n"
-			"Use hevcmerge filter to merge initially motion-constrained tiled HEVC PID in a single output.")
+			"Use hevcmerge filter to merge initially motion-constrained tiled HEVC PID in a single output.\n"
+			"Slice headers of the tiles are rewritten by the filter thread and [-nbth]() extra threads. The number of rewritten tiles per second is logged at `codec@info` level when the filter is destroyed.")
 	.private_size = sizeof(GF_HEVCSplitCtx),
 	SETCAPS(HEVCSplitCaps),
 	//hevc split shall be explicitly loaded
@@ -0,0 +1,406 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2020
+ *					All rights reserved
+ *
+ *  This file is part of GPAC / shared memory input filter
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+
+#include <gpac/filters.h>
+#include <gpac/constants.h>
+#include "shm_ring.h"
+
+typedef struct
+{
+	//position of the record in the ring
+	u64 pos;
+	//full record size in the ring
+	u32 rec_size;
+	Bool released;
+} GF_ShmInRecord;
+
+typedef struct
+{
+	//options
+	char *src, *mime, *ext;
+	u32 size, wait;
+
+	//only one output pid declared
+	GF_FilterPid *pid;
+
+	GF_ShmRing *ring;
+	//position of next record to read
+	u64 read_cursor;
+	//records read but not yet released, in ring order - protected by mx since packets may be destroyed from any thread
+	GF_List *in_flight;
+	GF_List *rec_reservoir;
+	GF_Mutex *mx;
+	//size and number of shared (not yet released) records
+	u32 in_flight_bytes, nb_shared;
+	//filter finalized while shared packets were still held downstream, the last released packet unmaps the ring
+	Bool finalized;
+
+	Bool is_end;
+	u64 bytes_read, nb_copy;
+} GF_ShmInCtx;
+
+static GF_Err shmin_open(GF_Filter *filter, GF_ShmInCtx *ctx)
+{
+	GF_Err e = shmring_open(ctx->src, ctx->size, &ctx->ring);
+	if (e==GF_IP_NETWORK_EMPTY) {
+		gf_filter_ask_rt_reschedule(filter, 1000);
+		return GF_OK;
+	}
+	if (e) {
+		gf_filter_setup_failure(filter, GF_URL_ERROR);
+		return GF_URL_ERROR;
+	}
+	if (ctx->ring->hdr->reader_state != GF_SHM_STATE_NONE) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_MMIO, ("[SHMIn] Shared memory %s already used by another reader\n", ctx->ring->path));
+		shmring_close(ctx->ring, GF_FALSE);
+		ctx->ring = NULL;
+		gf_filter_setup_failure(filter, GF_URL_ERROR);
+		return GF_URL_ERROR;
+	}
+	ctx->ring->hdr->reader_state = GF_SHM_STATE_ATTACHED;
+	ctx->read_cursor = GF_SHM_LOAD64(ctx->ring->hdr->read_pos);
+	return GF_OK;
+}
+
+static GF_Err shmin_initialize(GF_Filter *filter)
+{
+	GF_ShmInCtx *ctx = (GF_ShmInCtx *) gf_filter_get_udta(filter);
+
+	if (!ctx || !ctx->src) return GF_BAD_PARAM;
+
+	if (strnicmp(ctx->src, "shm:", 4)) {
+		gf_filter_setup_failure(filter, GF_NOT_SUPPORTED);
+		return GF_NOT_SUPPORTED;
+	}
+	ctx->in_flight = gf_list_new();
+	ctx->rec_reservoir = gf_list_new();
+	ctx->mx = gf_mx_new("SHMIn");
+	if (!ctx->in_flight || !ctx->rec_reservoir || !ctx->mx) return GF_OUT_OF_MEM;
+
+	return shmin_open(filter, ctx);
+}
+
+static void shmin_del_ring(GF_ShmInCtx *ctx)
+{
+	if (ctx->ring) {
+		shmring_close(ctx->ring, GF_TRUE);
+		ctx->ring = NULL;
+	}
+	if (ctx->in_flight) {
+		while (gf_list_count(ctx->in_flight)) gf_free(gf_list_pop_back(ctx->in_flight));
+		gf_list_del(ctx->in_flight);
+		ctx->in_flight = NULL;
+	}
+	if (ctx->rec_reservoir) {
+		while (gf_list_count(ctx->rec_reservoir)) gf_free(gf_list_pop_back(ctx->rec_reservoir));
+		gf_list_del(ctx->rec_reservoir);
+		ctx->rec_reservoir = NULL;
+	}
+}
+
+static void shmin_finalize(GF_Filter *filter)
+{
+	Bool pending;
+	GF_ShmInCtx *ctx = (GF_ShmInCtx *) gf_filter_get_udta(filter);
+
+	if (ctx->ring) {
+		//tell the writer we are gone so that it does not wait for free space forever
+		ctx->ring->hdr->reader_state = GF_SHM_STATE_EOS;
+		shmring_signal(ctx->ring, &ctx->ring->hdr->rd_seq, &ctx->ring->hdr->wr_waiting);
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_MMIO, ("[SHMIn] read "LLU" bytes, "LLU" records copied\n", ctx->bytes_read, ctx->nb_copy));
+	}
+	if (!ctx->mx) {
+		shmin_del_ring(ctx);
+		return;
+	}
+	//packets pointing to the ring may still be held downstream, keep it mapped until they are released
+	gf_mx_p(ctx->mx);
+	ctx->finalized = GF_TRUE;
+	pending = ctx->nb_shared ? GF_TRUE : GF_FALSE;
+	if (!pending) shmin_del_ring(ctx);
+	gf_mx_v(ctx->mx);
+	if (pending) {
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_MMIO, ("[SHMIn] %d packets still held downstream, ring unmapped once released\n", ctx->nb_shared));
+		return;
+	}
+	gf_mx_del(ctx->mx);
+	ctx->mx = NULL;
+}
+
+static GF_FilterProbeScore shmin_probe_url(const char *url, const char *mime_type)
+{
+	if (!strnicmp(url, "shm://", 6)) return GF_FPROBE_SUPPORTED;
+	else if (!strnicmp(url, "shm:", 4)) return GF_FPROBE_SUPPORTED;
+	return GF_FPROBE_NOT_SUPPORTED;
+}
+
+static Bool shmin_process_event(GF_Filter *filter, const GF_FilterEvent *evt)
+{
+	GF_ShmInCtx *ctx = (GF_ShmInCtx *) gf_filter_get_udta(filter);
+	if (evt->base.on_pid && (evt->base.on_pid != ctx->pid))
+		return GF_TRUE;
+
+	switch (evt->base.type) {
+	case GF_FEVT_PLAY:
+		return GF_TRUE;
+	case GF_FEVT_STOP:
+		ctx->is_end = GF_TRUE;
+		gf_filter_pid_set_eos(ctx->pid);
+		return GF_TRUE;
+	case GF_FEVT_SOURCE_SEEK:
+		GF_LOG(GF_LOG_WARNING, GF_LOG_MMIO, ("[SHMIn] Seek request not possible on shared memory, ignoring\n"));
+		return GF_TRUE;
+	default:
+		break;
+	}
+	return GF_TRUE;
+}
+
+//must be called with mutex held
+static void shmin_add_record(GF_ShmInCtx *ctx, u64 pos, u32 rec_size, Bool released)
+{
+	GF_ShmInRecord *rec = gf_list_pop_back(ctx->rec_reservoir);
+	if (!rec) {
+		GF_SAFEALLOC(rec, GF_ShmInRecord);
+		if (!rec) return;
+	}
+	rec->pos = pos;
+	rec->rec_size = rec_size;
+	rec->released = released;
+	gf_list_add(ctx->in_flight, rec);
+	if (!released) {
+		ctx->in_flight_bytes += rec_size;
+		ctx->nb_shared++;
+	}
+}
+
+//must be called with mutex held - gives back to the writer all released records at the head of the list
+static void shmin_release_head(GF_ShmInCtx *ctx)
+{
+	u64 nb_bytes = 0;
+	while (1) {
+		GF_ShmInRecord *rec = gf_list_get(ctx->in_flight, 0);
+		if (!rec || !rec->released) break;
+		gf_list_rem(ctx->in_flight, 0);
+		nb_bytes += rec->rec_size;
+		gf_list_add(ctx->rec_reservoir, rec);
+	}
+	if (!nb_bytes) return;
+	safe_int64_add(&ctx->ring->hdr->read_pos, nb_bytes);
+	shmring_signal(ctx->ring, &ctx->ring->hdr->rd_seq, &ctx->ring->hdr->wr_waiting);
+}
+
+static void shmin_pck_destructor(GF_Filter *filter, GF_FilterPid *pid, GF_FilterPacket *pck)
+{
+	u32 i, count, size;
+	const u8 *data;
+	GF_ShmInCtx *ctx = (GF_ShmInCtx *) gf_filter_get_udta(filter);
+	if (!ctx->ring || !ctx->mx) return;
+
+	data = gf_filter_pck_get_data(pck, &size);
+	gf_mx_p(ctx->mx);
+	count = gf_list_count(ctx->in_flight);
+	for (i=0; i<count; i++) {
+		GF_ShmInRecord *rec = gf_list_get(ctx->in_flight, i);
+		if (rec->released) continue;
+		if (ctx->ring->data + (rec->pos % ctx->ring->hdr->size) + sizeof(GF_ShmRecord) != data) continue;
+		rec->released = GF_TRUE;
+		ctx->in_flight_bytes -= rec->rec_size;
+		ctx->nb_shared--;
+		break;
+	}
+	if (ctx->finalized) {
+		//last packet pointing to the ring, unmap it
+		Bool done = ctx->nb_shared ? GF_FALSE : GF_TRUE;
+		if (done) shmin_del_ring(ctx);
+		gf_mx_v(ctx->mx);
+		if (done) {
+			gf_mx_del(ctx->mx);
+			ctx->mx = NULL;
+		}
+		return;
+	}
+	shmin_release_head(ctx);
+	gf_mx_v(ctx->mx);
+	//ready to process again
+	gf_filter_post_process_task(filter);
+}
+
+static GF_Err shmin_process(GF_Filter *filter)
+{
+	GF_Err e;
+	u32 seq, half_ring;
+	GF_ShmHeader *hdr;
+	GF_ShmInCtx *ctx = (GF_ShmInCtx *) gf_filter_get_udta(filter);
+
+	if (ctx->is_end)
+		return GF_EOS;
+
+	if (!ctx->ring) {
+		e = shmin_open(filter, ctx);
+		if (e || !ctx->ring) return e;
+	}
+	hdr = ctx->ring->hdr;
+	half_ring = hdr->size / 2;
+
+	while (1) {
+		GF_FilterPacket *pck;
+		GF_ShmRecord *rec;
+		u8 *payload;
+		u32 rec_size;
+		u32 writer_state;
+		u64 write_pos;
+
+		if (ctx->pid && gf_filter_pid_would_block(ctx->pid))
+			return GF_OK;
+
+		//get state and sequence number before write position: if writer is done, write_pos is final
+		writer_state = (u32) safe_int_add(&hdr->writer_state, 0);
+		seq = (u32) safe_int_add(&hdr->wr_seq, 0);
+		write_pos = GF_SHM_LOAD64(hdr->write_pos);
+
+		if (ctx->read_cursor >= write_pos) {
+			if (writer_state == GF_SHM_STATE_EOS) {
+				ctx->is_end = GF_TRUE;
+				if (ctx->pid) gf_filter_pid_set_eos(ctx->pid);
+				GF_LOG(GF_LOG_INFO, GF_LOG_MMIO, ("[SHMIn] end of stream after "LLU" bytes\n", ctx->bytes_read));
+				return GF_EOS;
+			}
+			shmring_wait(ctx->ring, &hdr->wr_seq, seq, &hdr->rd_waiting, ctx->wait);
+			return GF_OK;
+		}
+
+		rec = (GF_ShmRecord *) (ctx->ring->data + (ctx->read_cursor % hdr->size));
+		rec_size = (u32) GF_SHM_REC_SIZE(rec->size);
+		if ((rec_size > hdr->size) || (ctx->read_cursor + rec_size > write_pos)) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_MMIO, ("[SHMIn] Corrupted record at position "LLU" (size %u)\n", ctx->read_cursor, rec->size));
+			return GF_NON_COMPLIANT_BITSTREAM;
+		}
+		if (rec->flags & GF_SHM_REC_PAD) {
+			gf_mx_p(ctx->mx);
+			shmin_add_record(ctx, ctx->read_cursor, rec_size, GF_TRUE);
+			shmin_release_head(ctx);
+			gf_mx_v(ctx->mx);
+			ctx->read_cursor += rec_size;
+			continue;
+		}
+		payload = ((u8 *) rec) + sizeof(GF_ShmRecord);
+
+		if (!ctx->pid) {
+			if (!rec->size) {
+				ctx->read_cursor += rec_size;
+				continue;
+			}
+			GF_LOG(GF_LOG_INFO, GF_LOG_MMIO, ("[SHMIn] configuring stream %d probe bytes\n", rec->size));
+			e = gf_filter_pid_raw_new(filter, ctx->src, NULL, ctx->mime, ctx->ext, payload, rec->size, GF_TRUE, &ctx->pid);
+			if (e) {
+				GF_LOG(GF_LOG_WARNING, GF_LOG_MMIO, ("[SHMIn] failed to configure stream: %s\n", gf_error_to_string(e) ));
+				return e;
+			}
+			gf_filter_pid_set_property(ctx->pid, GF_PROP_PID_FILE_CACHED, &PROP_BOOL(GF_FALSE) );
+			gf_filter_pid_set_property(ctx->pid, GF_PROP_PID_PLAYBACK_MODE, &PROP_UINT(GF_PLAYBACK_MODE_NONE) );
+		}
+
+		gf_mx_p(ctx->mx);
+		//too much data held downstream, copy the record so that the writer can go on - this avoids deadlocks with filters
+		//keeping packets until more data is received
+		if (ctx->in_flight_bytes + rec_size > half_ring) {
+			u8 *output;
+			pck = gf_filter_pck_new_alloc(ctx->pid, rec->size, &output);
+			if (pck) {
+				memcpy(output, payload, rec->size);
+				shmin_add_record(ctx, ctx->read_cursor, rec_size, GF_TRUE);
+				shmin_release_head(ctx);
+				ctx->nb_copy++;
+			}
+		} else {
+			pck = gf_filter_pck_new_shared(ctx->pid, payload, rec->size, shmin_pck_destructor);
+			if (pck) shmin_add_record(ctx, ctx->read_cursor, rec_size, GF_FALSE);
+		}
+		gf_mx_v(ctx->mx);
+		if (!pck) return GF_OUT_OF_MEM;
+
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_MMIO, ("[SHMIn] sending %d bytes\n", rec->size));
+		gf_filter_pck_set_framing(pck, (rec->flags & GF_SHM_REC_START) ? GF_TRUE : GF_FALSE, (rec->flags & GF_SHM_REC_END) ? GF_TRUE : GF_FALSE);
+		gf_filter_pck_set_sap(pck, GF_FILTER_SAP_1);
+		ctx->bytes_read += rec->size;
+		ctx->read_cursor += rec_size;
+		gf_filter_pck_send(pck);
+	}
+	return GF_OK;
+}
+
+
+
+#define OFFS(_n)	#_n, offsetof(GF_ShmInCtx, _n)
+
+static const GF_FilterArgs ShmInArgs[] =
+{
+	{ OFFS(src), "name of source shared memory", GF_PROP_NAME, NULL, NULL, 0},
+	{ OFFS(ext), "indicate file extension of shared memory data", GF_PROP_STRING, NULL, NULL, 0},
+	{ OFFS(mime), "indicate mime type of shared memory data", GF_PROP_STRING, NULL, NULL, 0},
+	{ OFFS(size), "ring size in bytes if the shared memory is created by this filter", GF_PROP_UINT, "33554432", NULL, GF_FS_ARG_HINT_ADVANCED},
+	{ OFFS(wait), "maximum time in ms to wait for new data in the ring before yielding", GF_PROP_UINT, "10", NULL, GF_FS_ARG_HINT_EXPERT},
+	{0}
+};
+
+static const GF_FilterCapability ShmInCaps[] =
+{
+	CAP_UINT(GF_CAPS_OUTPUT,  GF_PROP_PID_STREAM_TYPE, GF_STREAM_FILE),
+};
+
+GF_FilterRegister ShmInRegister = {
+	.name = "shmin",
+	GF_FS_SET_DESCRIPTION("shared memory input")
+	GF_FS_SET_HELP( "This filter reads a byte stream from a shared memory ring written by a [shmout](shmout) filter in another process.\n"
+		"The associated protocol scheme is `shm://` when loaded as a generic input (eg, `-i shm://NAME` where NAME is the shared memory name).\n"
+		"Warning: Shared memory inputs cannot seek.\n"
+		"Data format of the shared memory may be specified using extension (either in name or through [-ext]()) or MIME type through [-mime]().\n"
+		"\n"
+		"Packets sent by the filter point directly to the shared memory, the ring space being given back to the writer once the packets are released.\n"
+		"If too many packets are held downstream, data is copied in order to keep the writer running.\n"
+		"\n"
+		"The shared memory is created by the first filter opening it, using its [-size](), and is removed by this filter when done.\n"
+		"The reader and the writer can therefore be launched in any order:\n"
+		"EX gpac -i shm://live.gsf vout\n"
+		"EX gpac -i source.mp4 -o shm://live.gsf\n"
+	"")
+	.private_size = sizeof(GF_ShmInCtx),
+	.args = ShmInArgs,
+	.flags = GF_FS_REG_BLOCKING,
+	SETCAPS(ShmInCaps),
+	.initialize = shmin_initialize,
+	.finalize = shmin_finalize,
+	.process = shmin_process,
+	.process_event = shmin_process_event,
+	.probe_url = shmin_probe_url
+};
+
+
+const GF_FilterRegister *shmin_register(GF_FilterSession *session)
+{
+	return &ShmInRegister;
+}
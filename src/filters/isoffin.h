@@ -114,7 +114,10 @@ typedef struct
 	Bool eos_signaled;
 	u32 mem_load_mode;
 	u8 *mem_url;
+	//mem_blob points to the live data in mem_buffer - purged bytes are skipped and only discarded when space is needed
 	GF_Blob mem_blob;
+	u8 *mem_buffer;
+	u32 mem_buffer_alloc;
 	u64 bytes_removed;
 	u64 last_min_offset;
 	GF_Err in_error;
@@ -443,7 +443,7 @@ static void isoffin_finalize(GF_Filter *filter)
 	if (!read->extern_mov && read->mov) gf_isom_close(read->mov);
 	read->mov = NULL;
 
-	if (read->mem_blob.data) gf_free(read->mem_blob.data);
+	if (read->mem_buffer) gf_free(read->mem_buffer);
 	if (read->mem_url) gf_free(read->mem_url);
 }
 
@@ -922,6 +922,32 @@ static Bool isoffin_process_event(GF_Filter *filter, const GF_FilterEvent *evt)
 	return GF_FALSE;
 }
 
+static GF_Err isoffin_mem_append(ISOMReader *read, const u8 *pck_data, u32 data_size)
+{
+	u32 start = read->mem_buffer ? (u32) (read->mem_blob.data - read->mem_buffer) : 0;
+
+	if (start + read->mem_blob.size + data_size > read->mem_buffer_alloc) {
+		//discard purged bytes
+		if (start) {
+			memmove(read->mem_buffer, read->mem_blob.data, read->mem_blob.size);
+			read->mem_blob.data = read->mem_buffer;
+		}
+		//keep at least as much free space as live data, so that data is moved at most once per buffer length
+		if (2 * (read->mem_blob.size + data_size) > read->mem_buffer_alloc) {
+			u8 *buf;
+			u32 new_alloc = 2 * (read->mem_blob.size + data_size);
+			buf = gf_realloc(read->mem_buffer, new_alloc);
+			if (!buf) return GF_OUT_OF_MEM;
+			read->mem_buffer = buf;
+			read->mem_buffer_alloc = new_alloc;
+			read->mem_blob.data = read->mem_buffer;
+		}
+	}
+	memcpy(read->mem_blob.data + read->mem_blob.size, pck_data, data_size);
+	read->mem_blob.size += data_size;
+	return GF_OK;
+}
+
 static void isoffin_push_buffer(GF_Filter *filter, ISOMReader *read, const u8 *pck_data, u32 data_size)
 {
 	u64 bytes_missing;
@@ -932,9 +958,13 @@ static void isoffin_push_buffer(GF_Filter *filter, ISOMReader *read, const u8 *p
 		sprintf(szPath, "gmem://%p", &read->mem_blob);
 		read->mem_url = gf_strdup(szPath);
 	}
-	read->mem_blob.data = gf_realloc(read->mem_blob.data, read->mem_blob.size + data_size);
-	memcpy(read->mem_blob.data + read->mem_blob.size, pck_data, data_size);
-	read->mem_blob.size += data_size;
+	e = isoffin_mem_append(read, pck_data, data_size);
+	if (e) {
+		gf_filter_setup_failure(filter, e);
+		read->mem_load_mode = 0;
+		read->in_error = e;
+		return;
+	}
 
 	if (read->mem_load_mode==1) {
 		u32 box_type;
@@ -998,7 +1028,8 @@ static void isoffin_purge_mem(ISOMReader *read, u64 min_offset)
 	nb_bytes_to_purge = (u32) (min_offset - read->bytes_removed);
 	assert(nb_bytes_to_purge<=read->mem_blob.size);
 
-	memmove(read->mem_blob.data, read->mem_blob.data+nb_bytes_to_purge, read->mem_blob.size - nb_bytes_to_purge);
+	//skip purged bytes, they are discarded at next append if space is needed
+	read->mem_blob.data += nb_bytes_to_purge;
 	read->mem_blob.size -= nb_bytes_to_purge;
 	read->bytes_removed += nb_bytes_to_purge;
 	gf_isom_set_removed_bytes(read->mov, read->bytes_removed);
@@ -1326,6 +1357,20 @@ static const char *isoffin_probe_data(const u8 *data, u32 size, GF_FilterProbeSc
 	return NULL;
 }
 
+static const GF_FilterProbeMagic ISOFFInMagics[] =
+{
+	PROBE_MAGIC(4, "ftyp"),
+	PROBE_MAGIC(4, "styp"),
+	PROBE_MAGIC(4, "moov"),
+	PROBE_MAGIC(4, "moof"),
+	PROBE_MAGIC(4, "sidx"),
+	PROBE_MAGIC(4, "free"),
+	PROBE_MAGIC(4, "skip"),
+	PROBE_MAGIC(4, "wide"),
+	PROBE_MAGIC(4, "mdat"),
+	{0}
+};
+
 #define OFFS(_n)	#_n, offsetof(ISOMReader, _n)
 
 static const GF_FilterArgs ISOFFInArgs[] =
@@ -1411,7 +1456,8 @@ GF_FilterRegister ISOFFInRegister = {
 	.configure_pid = isoffin_configure_pid,
 	SETCAPS(ISOFFInCaps),
 	.process_event = isoffin_process_event,
-	.probe_data = isoffin_probe_data
+	.probe_data = isoffin_probe_data,
+	.probe_magics = ISOFFInMagics
 };
 
 
@@ -202,7 +202,7 @@ typedef struct
 	Bool importer, pack_nal, moof_first, abs_offset, fsap, tfdt_traf;
 	u32 xps_inband;
 	u32 block_size;
-	u32 store, tktpl, mudta;
+	u32 store, tktpl, mudta, stbl;
 	s32 subs_sidx;
 	Double cdur;
 	s32 moovts;
@@ -5076,6 +5076,8 @@ static GF_Err mp4_mux_initialize(GF_Filter *filter)
 		if (ctx->store==MP4MX_MODE_FASTSTART) {
 			gf_isom_set_storage_mode(ctx->file, GF_ISOM_STORE_FASTSTART);
 		}
+		if (ctx->store<MP4MX_MODE_FRAG)
+			gf_isom_set_sample_table_mode(ctx->file, (GF_ISOSampleTableMode) ctx->stbl);
 
 	}
 	if (!ctx->moovts) ctx->moovts=600;
@@ -5488,6 +5490,10 @@ static const GF_FilterArgs MP4MuxArgs[] =
 	"- tight:  uses per-sample interleaving of all tracks (requires temporary storage of all media)\n"
 	"- frag: fragments the file using cdur duration\n"
 	"- sfrag: framents the file using cdur duration but adjusting to start with SAP1/3", GF_PROP_UINT, "inter", "inter|flat|fstart|tight|frag|sfrag", 0},
+	{ OFFS(stbl), "sample table memory mode for non-fragmented storage\n"
+	"- flat: regular sample tables\n"
+	"- pack: sample sizes and chunk offsets are delta-coded in memory\n"
+	"- tmp: same as pack but coded tables are stored in temporary files", GF_PROP_UINT, "flat", "flat|pack|tmp", GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(cdur), "chunk duration for interleaving and fragmentation modes\n"
 	"- 0: no specific interleaving but moov first\n"
 	"- negative: defaults to 1.0 unless overridden by storage profile", GF_PROP_DOUBLE, "-1.0", NULL, 0},
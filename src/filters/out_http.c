@@ -59,7 +59,7 @@ typedef struct
 	//options
 	char *dst, *user_agent, *ifce, *cache_control, *ext, *mime, *wdir, *cert, *pkey, *reqlog;
 	GF_List *rdirs;
-	Bool close, hold, quit, post, dlist, ice;
+	Bool close, hold, quit, post, dlist, ice, mprio;
 	u32 port, block_size, maxc, maxp, timeout, hmode, sutc, cors;
 
 	//internal
@@ -164,6 +164,10 @@ typedef struct __httpout_session
 	Bool do_log;
 	u64 req_id;
 	u32 method_type, reply_code;
+
+	//set when serving a DASH or HLS manifest, sent ahead of other sessions
+	Bool is_manifest;
+	Bool prio_served;
 } GF_HTTPOutSession;
 
 static void httpout_reset_socket(GF_HTTPOutSession *sess)
@@ -566,6 +570,22 @@ static Bool httpout_do_log(GF_HTTPOutSession *sess, u32 method)
 	return GF_FALSE;
 }
 
+static Bool httpout_is_manifest(const char *url, const char *mime)
+{
+	const char *ext;
+	if (mime) {
+		if (!stricmp(mime, "application/dash+xml")) return GF_TRUE;
+		if (!stricmp(mime, "video/vnd.3gpp.mpd")) return GF_TRUE;
+		if (!stricmp(mime, "application/vnd.apple.mpegurl")) return GF_TRUE;
+		if (!stricmp(mime, "application/x-mpegurl")) return GF_TRUE;
+		if (!stricmp(mime, "audio/mpegurl")) return GF_TRUE;
+	}
+	if (!url) return GF_FALSE;
+	ext = gf_file_ext_start(url);
+	if (ext && (!stricmp(ext, ".mpd") || !stricmp(ext, ".m3u8"))) return GF_TRUE;
+	return GF_FALSE;
+}
+
 #ifndef GPAC_DISABLE_LOG
 static const char *get_method_name(u32 method)
 {
@@ -825,6 +845,7 @@ static void httpout_sess_io(void *usr_cbk, GF_NETIO_Parameter *parameter)
 	sess->put_in_progress = 0;
 	sess->nb_bytes = 0;
 	sess->upload_type = 0;
+	sess->is_manifest = GF_FALSE;
 
 	if (parameter->reply==GF_HTTP_DELETE) {
 		sess->upload_type = 0;
@@ -1034,6 +1055,8 @@ static void httpout_sess_io(void *usr_cbk, GF_NETIO_Parameter *parameter)
 		}
 		mime = sess->in_source ? sess->in_source->mime : mime;
 		if (mime && !strcmp(mime, "*")) mime = NULL;
+		if (sess->ctx->mprio)
+			sess->is_manifest = httpout_is_manifest(url, mime);
 		if (mime) {
 			gf_dynstrcat(&rsp_buf, "Content-Type: ", NULL);
 			gf_dynstrcat(&rsp_buf, mime, NULL);
@@ -1949,6 +1972,8 @@ static void httpout_process_session(GF_Filter *filter, GF_HTTPOutCtx *ctx, GF_HT
 		gf_fseek(sess->resource, sess->file_pos, SEEK_SET);
 	}
 
+next_block:
+	to_read = 0;
 	//refresh file size
 	if (sess->put_in_progress==1) {
 		sess->file_size = gf_fsize(sess->resource);
@@ -2010,6 +2035,9 @@ static void httpout_process_session(GF_Filter *filter, GF_HTTPOutCtx *ctx, GF_HT
 			GF_LOG(GF_LOG_ERROR, GF_LOG_HTTP, ("[HTTPOut] Error sending data to %s for %s: %s\n", sess->peer_address, sess->path, gf_error_to_string(e) ));
 		} else {
 			GF_LOG(GF_LOG_DEBUG, GF_LOG_HTTP, ("[HTTPOut] sending data to %s for %s: "LLU"/"LLU" bytes\n", sess->peer_address, sess->path, sess->nb_bytes, sess->bytes_in_req));
+			//manifests are small and latency critical, send them in one go
+			if (sess->is_manifest && read)
+				goto next_block;
 		}
 		return;
 	}
@@ -2519,7 +2547,7 @@ static void httpout_process_inputs(GF_HTTPOutCtx *ctx)
 static GF_Err httpout_process(GF_Filter *filter)
 {
 	GF_Err e=GF_OK;
-	u32 i, count;
+	u32 i, count, pass;
 	GF_HTTPOutCtx *ctx = gf_filter_get_udta(filter);
 
 	if (ctx->done)
@@ -2535,21 +2563,33 @@ static GF_Err httpout_process(GF_Filter *filter)
 			httpout_check_new_session(ctx);
 		}
 
-		count = gf_list_count(ctx->active_sessions);
-		for (i=0; i<count; i++) {
-			GF_HTTPOutSession *sess = gf_list_get(ctx->active_sessions, i);
-			//push
-			if (sess->in_source) continue;
+		//first pass serves sessions sending a manifest, second pass all others
+		for (pass=0; pass<2; pass++) {
+			if (!pass && !ctx->mprio) continue;
+			count = gf_list_count(ctx->active_sessions);
+			for (i=0; i<count; i++) {
+				GF_HTTPOutSession *sess = gf_list_get(ctx->active_sessions, i);
+				if (pass && sess->prio_served) {
+					sess->prio_served = GF_FALSE;
+					continue;
+				}
+				//push
+				if (sess->in_source) continue;
+				if (!pass) {
+					if (!sess->is_manifest || sess->done) continue;
+					sess->prio_served = GF_TRUE;
+				}
 
-			//regular download
-			httpout_process_session(filter, ctx, sess);
-			//closed, remove
-			if (! sess->socket) {
-				httpout_del_session(sess);
-				i--;
-				count--;
-				if (!count && ctx->quit)
-					ctx->done = GF_TRUE;
+				//regular download
+				httpout_process_session(filter, ctx, sess);
+				//closed, remove
+				if (! sess->socket) {
+					httpout_del_session(sess);
+					i--;
+					count--;
+					if (!count && ctx->quit)
+						ctx->done = GF_TRUE;
+				}
 			}
 		}
 	}
@@ -2677,6 +2717,7 @@ static const GF_FilterArgs HTTPOutArgs[] =
 	{ OFFS(cors), "insert CORS header allowing all domains", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(reqlog), "provide short log of the requests indicated in this option (comma separated list, `*` for all) regardless of HTTP log settings", GF_PROP_STRING, NULL, NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(ice), "insert ICE meta-data in response headers in sink mode - see filter help", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
+	{ OFFS(mprio), "serve DASH and HLS manifests ahead of media segments and send them in one go", GF_PROP_BOOL, "true", NULL, GF_FS_ARG_HINT_EXPERT},
 	{0}
 };
 
@@ -0,0 +1,287 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2020
+ *					All rights reserved
+ *
+ *  This file is part of GPAC / shared memory output filter
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+
+#include <gpac/filters.h>
+#include <gpac/constants.h>
+#include "shm_ring.h"
+
+typedef struct
+{
+	//options
+	Double start, speed;
+	char *dst, *mime, *ext;
+	u32 size, wait;
+
+	//only one input pid
+	GF_FilterPid *pid;
+
+	GF_ShmRing *ring;
+	//bytes of current packet already written
+	u32 pck_offset;
+	u32 max_chunk;
+	u64 nb_bytes, nb_wait;
+
+	GF_FilterCapability in_caps[2];
+	char szExt[10];
+} GF_ShmOutCtx;
+
+
+static GF_Err shmout_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is_remove)
+{
+	const GF_PropertyValue *p;
+	GF_ShmOutCtx *ctx = (GF_ShmOutCtx *) gf_filter_get_udta(filter);
+	if (is_remove) {
+		ctx->pid = NULL;
+		return GF_OK;
+	}
+	gf_filter_pid_check_caps(pid);
+
+	if (!ctx->pid) {
+		GF_FilterEvent evt;
+		gf_filter_pid_init_play_event(pid, &evt, ctx->start, ctx->speed, "SHMOut");
+		gf_filter_pid_send_event(pid, &evt);
+	}
+	ctx->pid = pid;
+
+	p = gf_filter_pid_get_property(pid, GF_PROP_PID_DISABLE_PROGRESSIVE);
+	if (p && p->value.uint) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_MMIO, ("[SHMOut] Block patching is not supported by shared memory output\n"));
+		return GF_NOT_SUPPORTED;
+	}
+	return GF_OK;
+}
+
+static GF_Err shmout_initialize(GF_Filter *filter)
+{
+	char *ext;
+	GF_ShmOutCtx *ctx = (GF_ShmOutCtx *) gf_filter_get_udta(filter);
+
+	if (!ctx || !ctx->dst) return GF_OK;
+
+	if (strnicmp(ctx->dst, "shm:", 4)) {
+		gf_filter_setup_failure(filter, GF_NOT_SUPPORTED);
+		return GF_NOT_SUPPORTED;
+	}
+
+	if (ctx->ext) ext = ctx->ext;
+	else {
+		ext = gf_file_ext_start(ctx->dst);
+		if (ext) ext++;
+	}
+	if (!ext && !ctx->mime) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_MMIO, ("[SHMOut] No extension provided nor mime type for output %s, cannot infer format\n", ctx->dst));
+		return GF_NOT_SUPPORTED;
+	}
+	//static cap, streamtype = file
+	ctx->in_caps[0].code = GF_PROP_PID_STREAM_TYPE;
+	ctx->in_caps[0].val = PROP_UINT(GF_STREAM_FILE);
+	ctx->in_caps[0].flags = GF_CAPS_INPUT_STATIC;
+
+	if (ctx->mime) {
+		ctx->in_caps[1].code = GF_PROP_PID_MIME;
+		ctx->in_caps[1].val = PROP_NAME( ctx->mime );
+		ctx->in_caps[1].flags = GF_CAPS_INPUT;
+	} else {
+		strncpy(ctx->szExt, ext, 9);
+		ctx->szExt[9] = 0;
+		strlwr(ctx->szExt);
+		ctx->in_caps[1].code = GF_PROP_PID_FILE_EXT;
+		ctx->in_caps[1].val = PROP_NAME( ctx->szExt );
+		ctx->in_caps[1].flags = GF_CAPS_INPUT;
+	}
+	gf_filter_override_caps(filter, ctx->in_caps, 2);
+	return GF_OK;
+}
+
+static void shmout_finalize(GF_Filter *filter)
+{
+	GF_ShmOutCtx *ctx = (GF_ShmOutCtx *) gf_filter_get_udta(filter);
+	if (!ctx->ring) return;
+
+	//make sure the reader does not wait for us forever
+	if (ctx->ring->hdr->writer_state != GF_SHM_STATE_EOS) {
+		ctx->ring->hdr->writer_state = GF_SHM_STATE_EOS;
+		shmring_signal(ctx->ring, &ctx->ring->hdr->wr_seq, &ctx->ring->hdr->rd_waiting);
+	}
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_MMIO, ("[SHMOut] wrote "LLU" bytes, waited "LLU" times for free space\n", ctx->nb_bytes, ctx->nb_wait));
+	//the reader removes the shared memory object once done
+	shmring_close(ctx->ring, GF_FALSE);
+}
+
+static GF_Err shmout_open(GF_Filter *filter, GF_ShmOutCtx *ctx)
+{
+	GF_Err e = shmring_open(ctx->dst, ctx->size, &ctx->ring);
+	if (e==GF_IP_NETWORK_EMPTY) {
+		gf_filter_ask_rt_reschedule(filter, 1000);
+		return GF_OK;
+	}
+	if (e) {
+		gf_filter_setup_failure(filter, e);
+		return e;
+	}
+	if (ctx->ring->hdr->writer_state != GF_SHM_STATE_NONE) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_MMIO, ("[SHMOut] Shared memory %s already used by another writer, remove it or use another name\n", ctx->ring->path));
+		shmring_close(ctx->ring, GF_FALSE);
+		ctx->ring = NULL;
+		gf_filter_setup_failure(filter, GF_URL_ERROR);
+		return GF_URL_ERROR;
+	}
+	ctx->ring->hdr->writer_state = GF_SHM_STATE_ATTACHED;
+	//keep chunks small enough for several of them to be in flight
+	ctx->max_chunk = ctx->ring->hdr->size / 4 - sizeof(GF_ShmRecord);
+	return GF_OK;
+}
+
+static GF_Err shmout_process(GF_Filter *filter)
+{
+	GF_FilterPacket *pck;
+	Bool start, end;
+	const u8 *data;
+	u32 size;
+	GF_ShmHeader *hdr;
+	GF_ShmOutCtx *ctx = (GF_ShmOutCtx *) gf_filter_get_udta(filter);
+
+	if (!ctx->ring) {
+		GF_Err e = shmout_open(filter, ctx);
+		if (e || !ctx->ring) return e;
+	}
+	hdr = ctx->ring->hdr;
+
+	pck = gf_filter_pid_get_packet(ctx->pid);
+	if (!pck) {
+		if (gf_filter_pid_is_eos(ctx->pid)) {
+			if (hdr->writer_state != GF_SHM_STATE_EOS) {
+				hdr->writer_state = GF_SHM_STATE_EOS;
+				shmring_signal(ctx->ring, &hdr->wr_seq, &hdr->rd_waiting);
+			}
+			return GF_EOS;
+		}
+		return GF_OK;
+	}
+	gf_filter_pck_get_framing(pck, &start, &end);
+	data = gf_filter_pck_get_data(pck, &size);
+	if (!data && gf_filter_pck_get_frame_interface(pck)) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_MMIO, ("[SHMOut] Hardware frames not supported, discarding packet\n"));
+		size = 0;
+	}
+
+	while (1) {
+		GF_Err e;
+		u32 flags = 0;
+		u32 seq, chunk = size - ctx->pck_offset;
+		if (chunk > ctx->max_chunk) chunk = ctx->max_chunk;
+		if (!ctx->pck_offset && start) flags |= GF_SHM_REC_START;
+		if ((ctx->pck_offset + chunk == size) && end) flags |= GF_SHM_REC_END;
+
+		//get release counter before checking free space, so that we don't miss a release when waiting
+		seq = (u32) safe_int_add(&hdr->rd_seq, 0);
+		e = shmring_write(ctx->ring, data ? data + ctx->pck_offset : NULL, chunk, flags);
+		if (e == GF_BUFFER_TOO_SMALL) {
+			if (hdr->reader_state == GF_SHM_STATE_EOS) {
+				GF_LOG(GF_LOG_WARNING, GF_LOG_MMIO, ("[SHMOut] Reader of %s is gone, aborting\n", ctx->ring->path));
+				gf_filter_pid_set_discard(ctx->pid, GF_TRUE);
+				return GF_EOS;
+			}
+			//ring is full, wait for the reader to release data but keep the packet: this blocks our input pid and propagates backpressure upstream
+			ctx->nb_wait++;
+			shmring_wait(ctx->ring, &hdr->rd_seq, seq, &hdr->wr_waiting, ctx->wait);
+			gf_filter_ask_rt_reschedule(filter, 0);
+			return GF_OK;
+		}
+		if (e) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_MMIO, ("[SHMOut] Failed to write %d bytes: %s\n", chunk, gf_error_to_string(e) ));
+			return e;
+		}
+		ctx->nb_bytes += chunk;
+		ctx->pck_offset += chunk;
+		if (ctx->pck_offset >= size) break;
+	}
+	ctx->pck_offset = 0;
+	gf_filter_pid_drop_packet(ctx->pid);
+	return GF_OK;
+}
+
+static GF_FilterProbeScore shmout_probe_url(const char *url, const char *mime)
+{
+	if (!strnicmp(url, "shm://", 6)) return GF_FPROBE_SUPPORTED;
+	if (!strnicmp(url, "shm:", 4)) return GF_FPROBE_SUPPORTED;
+	return GF_FPROBE_NOT_SUPPORTED;
+}
+
+
+#define OFFS(_n)	#_n, offsetof(GF_ShmOutCtx, _n)
+
+static const GF_FilterArgs ShmOutArgs[] =
+{
+	{ OFFS(dst), "name of destination shared memory", GF_PROP_NAME, NULL, NULL, 0},
+	{ OFFS(ext), "indicate file extension of shared memory data", GF_PROP_STRING, NULL, NULL, 0},
+	{ OFFS(mime), "indicate mime type of shared memory data", GF_PROP_STRING, NULL, NULL, 0},
+	{ OFFS(start), "set playback start offset. Negative value means percent of media dur with -1 <=> dur", GF_PROP_DOUBLE, "0.0", NULL, 0},
+	{ OFFS(speed), "set playback speed. If speed is negative and start is 0, start is set to -1", GF_PROP_DOUBLE, "1.0", NULL, 0},
+	{ OFFS(size), "ring size in bytes if the shared memory is created by this filter", GF_PROP_UINT, "33554432", NULL, GF_FS_ARG_HINT_ADVANCED},
+	{ OFFS(wait), "maximum time in ms to wait for free space in the ring before yielding", GF_PROP_UINT, "10", NULL, GF_FS_ARG_HINT_EXPERT},
+	{0}
+};
+
+static const GF_FilterCapability ShmOutCaps[] =
+{
+	CAP_UINT(GF_CAPS_INPUT,GF_PROP_PID_STREAM_TYPE, GF_STREAM_FILE),
+	CAP_STRING(GF_CAPS_INPUT,GF_PROP_PID_FILE_EXT, "*"),
+	CAP_STRING(GF_CAPS_INPUT,GF_PROP_PID_MIME, "*"),
+};
+
+
+GF_FilterRegister ShmOutRegister = {
+	.name = "shmout",
+	GF_FS_SET_DESCRIPTION("shared memory output")
+	GF_FS_SET_HELP("This filter writes a byte stream to a shared memory ring read by a [shmin](shmin) filter in another process.\n"
+		"The associated protocol scheme is `shm://` when loaded as a generic output (eg, -o `shm://NAME` where NAME is the shared memory name).\n"
+		"Data format of the shared memory **shall** be specified using extension (either in name or through [-ext]() option) or MIME type through [-mime]().\n"
+		"\n"
+		"This is mostly intended to chain gpac processes using GSF serialization without going through kernel pipes or sockets:\n"
+		"EX gpac -i source.mp4 -o shm://live.gsf\n"
+		"EX gpac -i shm://live.gsf vout\n"
+		"\n"
+		"On Linux, the shared memory object is created in `/dev/shm`, on other POSIX systems in the temporary directory and on Windows as a named file mapping.\n"
+		"The shared memory is created by the first filter opening it, using its [-size]() option, and is removed by the reader once done.\n"
+		"When the ring is full, the filter waits for the reader to release data and does not consume its input, which blocks the upstream chain.\n"
+		"")
+	.private_size = sizeof(GF_ShmOutCtx),
+	.args = ShmOutArgs,
+	.flags = GF_FS_REG_BLOCKING,
+	SETCAPS(ShmOutCaps),
+	.probe_url = shmout_probe_url,
+	.initialize = shmout_initialize,
+	.finalize = shmout_finalize,
+	.configure_pid = shmout_configure_pid,
+	.process = shmout_process
+};
+
+
+const GF_FilterRegister *shmout_register(GF_FilterSession *session)
+{
+	return &ShmOutRegister;
+}
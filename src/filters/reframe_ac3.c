@@ -26,15 +26,10 @@
 #include <gpac/avparse.h>
 #include <gpac/constants.h>
 #include <gpac/filters.h>
+#include "reframe_index.h"
 
 #ifndef GPAC_DISABLE_AV_PARSERS
 
-typedef struct
-{
-	u64 pos;
-	Double duration;
-} AC3Idx;
-
 #define AC3_FRAME_SIZE 1536
 
 typedef struct
@@ -69,8 +64,9 @@ typedef struct
 
 	GF_FilterPacket *src_pck;
 
-	AC3Idx *indexes;
-	u32 index_alloc_size, index_size;
+	GF_RFIndex *rfidx;
+	GF_RFIndexEntry *indexes;
+	u32 index_size;
 } GF_AC3DmxCtx;
 
 
@@ -117,33 +113,15 @@ GF_Err ac3dmx_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is_remove
 	return GF_OK;
 }
 
-static void ac3dmx_check_dur(GF_Filter *filter, GF_AC3DmxCtx *ctx)
+//called on the index thread, only uses the parser function of the context
+static void ac3dmx_index_scan(GF_RFIndex *rfidx, FILE *stream, void *udta)
 {
-	FILE *stream;
+	GF_AC3DmxCtx *ctx = (GF_AC3DmxCtx *) udta;
 	GF_BitStream *bs;
 	GF_AC3Header hdr;
 	u64 duration, cur_dur;
 	s32 sr = -1;
-	const GF_PropertyValue *p;
-	if (!ctx->opid || ctx->timescale || ctx->file_loaded) return;
-
-	if (ctx->index<=0) {
-		ctx->file_loaded = GF_TRUE;
-		return;
-	}
-
-	p = gf_filter_pid_get_property(ctx->ipid, GF_PROP_PID_FILEPATH);
-	if (!p || !p->value.string || !strncmp(p->value.string, "gmem://", 7)) {
-		ctx->is_file = GF_FALSE;
-		ctx->file_loaded = GF_TRUE;
-		return;
-	}
-	ctx->is_file = GF_TRUE;
-
-	stream = gf_fopen(p->value.string, "rb");
-	if (!stream) return;
-
-	ctx->index_size = 0;
+	Double window = rfidx_window(rfidx);
 
 	bs = gf_bs_from_file(stream, GF_BITSTREAM_READ);
 	duration = 0;
@@ -159,27 +137,56 @@ static void ac3dmx_check_dur(GF_Filter *filter, GF_AC3DmxCtx *ctx)
 		sr = hdr.sample_rate;
 		duration += AC3_FRAME_SIZE;
 		cur_dur += AC3_FRAME_SIZE;
-		if (cur_dur > ctx->index * sr) {
-			if (!ctx->index_alloc_size) ctx->index_alloc_size = 10;
-			else if (ctx->index_alloc_size == ctx->index_size) ctx->index_alloc_size *= 2;
-			ctx->indexes = gf_realloc(ctx->indexes, sizeof(AC3Idx)*ctx->index_alloc_size);
-			ctx->indexes[ctx->index_size].pos = gf_bs_get_position(bs);
-			ctx->indexes[ctx->index_size].duration = (Double) duration;
-			ctx->indexes[ctx->index_size].duration /= sr;
-			ctx->index_size ++;
+		if (cur_dur > window * sr) {
+			rfidx_add(rfidx, gf_bs_get_position(bs), ((Double) duration) / sr);
 			cur_dur = 0;
+			if (rfidx_aborted(rfidx)) break;
 		}
 
 		gf_bs_skip_bytes(bs, hdr.framesize);
 	}
 	gf_bs_del(bs);
-	gf_fclose(stream);
 
-	if (!ctx->duration.num || (ctx->duration.num  * sr != duration * ctx->duration.den)) {
-		ctx->duration.num = (s32) duration;
-		ctx->duration.den = sr;
+	if (sr>0)
+		rfidx_set_duration(rfidx, duration, sr);
+}
 
-		gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_DURATION, & PROP_FRAC64(ctx->duration));
+static void ac3dmx_check_dur(GF_Filter *filter, GF_AC3DmxCtx *ctx)
+{
+	GF_Fraction64 duration;
+	const GF_PropertyValue *p;
+	if (!ctx->opid || ctx->timescale || ctx->file_loaded) return;
+
+	if (!ctx->rfidx) {
+		if (ctx->index<=0) {
+			ctx->file_loaded = GF_TRUE;
+			return;
+		}
+
+		p = gf_filter_pid_get_property(ctx->ipid, GF_PROP_PID_FILEPATH);
+		if (!p || !p->value.string || !strncmp(p->value.string, "gmem://", 7)) {
+			ctx->is_file = GF_FALSE;
+			ctx->file_loaded = GF_TRUE;
+			return;
+		}
+		ctx->is_file = GF_TRUE;
+
+		//index is built in the background, packets are dispatched meanwhile
+		ctx->rfidx = rfidx_new(ctx->ipid, "AC3Dmx", GF_4CC('A','C','-','3'), ctx->is_eac3, ctx->index, ac3dmx_index_scan, ctx);
+		if (!ctx->rfidx) return;
+	}
+	if (!rfidx_done(ctx->rfidx, GF_FALSE)) return;
+
+	rfidx_get(ctx->rfidx, &ctx->indexes, &ctx->index_size, &duration);
+	rfidx_del(ctx->rfidx);
+	ctx->rfidx = NULL;
+
+	if (duration.den) {
+		if (!ctx->duration.num || (ctx->duration.num * duration.den != duration.num * ctx->duration.den)) {
+			ctx->duration = duration;
+
+			gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_DURATION, & PROP_FRAC64(ctx->duration));
+		}
 	}
 
 	p = gf_filter_pid_get_property(ctx->ipid, GF_PROP_PID_FILE_CACHED);
@@ -288,6 +295,11 @@ static Bool ac3dmx_process_event(GF_Filter *filter, const GF_FilterEvent *evt)
 		ctx->in_seek = GF_TRUE;
 		ctx->file_pos = 0;
 		if (ctx->start_range) {
+			//seeking before index completion, wait for it
+			if (ctx->rfidx) {
+				rfidx_done(ctx->rfidx, GF_TRUE);
+				ac3dmx_check_dur(filter, ctx);
+			}
 			for (i=1; i<ctx->index_size; i++) {
 				if (ctx->indexes[i].duration>ctx->start_range) {
 					ctx->cts = (u64) (ctx->indexes[i-1].duration * ctx->sample_rate);
@@ -528,6 +540,7 @@ static void ac3dmx_finalize(GF_Filter *filter)
 	GF_AC3DmxCtx *ctx = gf_filter_get_udta(filter);
 	if (ctx->bs) gf_bs_del(ctx->bs);
 	if (ctx->ac3_buffer) gf_free(ctx->ac3_buffer);
+	if (ctx->rfidx) rfidx_del(ctx->rfidx);
 	if (ctx->indexes) gf_free(ctx->indexes);
 }
 
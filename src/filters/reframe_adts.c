@@ -26,6 +26,7 @@
 #include <gpac/avparse.h>
 #include <gpac/constants.h>
 #include <gpac/filters.h>
+#include "reframe_index.h"
 
 #ifndef GPAC_DISABLE_AV_PARSERS
 
@@ -42,12 +43,6 @@ typedef struct
 	u32 profile, sr_idx, nb_ch, frame_size, hdr_size;
 } ADTSHeader;
 
-typedef struct
-{
-	u64 pos;
-	Double duration;
-} ADTSIdx;
-
 typedef struct
 {
 	//filter args
@@ -84,8 +79,9 @@ typedef struct
 
 	GF_FilterPacket *src_pck;
 
-	ADTSIdx *indexes;
-	u32 index_alloc_size, index_size;
+	GF_RFIndex *rfidx;
+	GF_RFIndexEntry *indexes;
+	u32 index_size;
 
 	u8 *adts_buffer;
 	u32 adts_buffer_size, adts_buffer_alloc, resume_from;
@@ -190,33 +186,15 @@ GF_Err adts_dmx_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is_remo
 	return GF_OK;
 }
 
-static void adts_dmx_check_dur(GF_Filter *filter, GF_ADTSDmxCtx *ctx)
+//called on the index thread, only uses the frame_size option of the context
+static void adts_dmx_index_scan(GF_RFIndex *rfidx, FILE *stream, void *udta)
 {
-	FILE *stream;
+	GF_ADTSDmxCtx *ctx = (GF_ADTSDmxCtx *) udta;
 	GF_BitStream *bs;
 	ADTSHeader hdr;
 	u64 duration, cur_dur;
 	s32 sr_idx = -1;
-	const GF_PropertyValue *p;
-	if (!ctx->opid || ctx->timescale || ctx->file_loaded) return;
-
-	if (ctx->index<=0) {
-		ctx->file_loaded = GF_TRUE;
-		return;
-	}
-
-	p = gf_filter_pid_get_property(ctx->ipid, GF_PROP_PID_FILEPATH);
-	if (!p || !p->value.string || !strncmp(p->value.string, "gmem://", 7)) {
-		ctx->is_file = GF_FALSE;
-		ctx->file_loaded = GF_TRUE;
-		return;
-	}
-	ctx->is_file = GF_TRUE;
-
-	stream = gf_fopen(p->value.string, "rb");
-	if (!stream) return;
-
-	ctx->index_size = 0;
+	Double window = rfidx_window(rfidx);
 
 	bs = gf_bs_from_file(stream, GF_BITSTREAM_READ);
 	duration = 0;
@@ -232,26 +210,53 @@ static void adts_dmx_check_dur(GF_Filter *filter, GF_ADTSDmxCtx *ctx)
 		sr_idx = hdr.sr_idx;
 		duration += ctx->frame_size;
 		cur_dur += ctx->frame_size;
-		if (cur_dur > ctx->index * GF_M4ASampleRates[sr_idx]) {
-			if (!ctx->index_alloc_size) ctx->index_alloc_size = 10;
-			else if (ctx->index_alloc_size == ctx->index_size) ctx->index_alloc_size *= 2;
-			ctx->indexes = gf_realloc(ctx->indexes, sizeof(ADTSIdx)*ctx->index_alloc_size);
-			ctx->indexes[ctx->index_size].pos = gf_bs_get_position(bs) - hdr.hdr_size;
-			ctx->indexes[ctx->index_size].duration = (Double) duration;
-			ctx->indexes[ctx->index_size].duration /= GF_M4ASampleRates[sr_idx];
-			ctx->index_size ++;
+		if (cur_dur > window * GF_M4ASampleRates[sr_idx]) {
+			rfidx_add(rfidx, gf_bs_get_position(bs) - hdr.hdr_size, ((Double) duration) / GF_M4ASampleRates[sr_idx]);
 			cur_dur = 0;
+			if (rfidx_aborted(rfidx)) break;
 		}
 
 		gf_bs_skip_bytes(bs, hdr.frame_size);
 	}
 	gf_bs_del(bs);
-	gf_fclose(stream);
 
-	if (sr_idx>=0) {
-		if (!ctx->duration.num || (ctx->duration.num  * GF_M4ASampleRates[sr_idx] != duration * ctx->duration.den)) {
-			ctx->duration.num = (s32) duration;
-			ctx->duration.den = GF_M4ASampleRates[sr_idx];
+	if (sr_idx>=0)
+		rfidx_set_duration(rfidx, duration, GF_M4ASampleRates[sr_idx]);
+}
+
+static void adts_dmx_check_dur(GF_Filter *filter, GF_ADTSDmxCtx *ctx)
+{
+	GF_Fraction64 duration;
+	const GF_PropertyValue *p;
+	if (!ctx->opid || ctx->timescale || ctx->file_loaded) return;
+
+	if (!ctx->rfidx) {
+		if (ctx->index<=0) {
+			ctx->file_loaded = GF_TRUE;
+			return;
+		}
+
+		p = gf_filter_pid_get_property(ctx->ipid, GF_PROP_PID_FILEPATH);
+		if (!p || !p->value.string || !strncmp(p->value.string, "gmem://", 7)) {
+			ctx->is_file = GF_FALSE;
+			ctx->file_loaded = GF_TRUE;
+			return;
+		}
+		ctx->is_file = GF_TRUE;
+
+		//index is built in the background, packets are dispatched meanwhile
+		ctx->rfidx = rfidx_new(ctx->ipid, "ADTSDmx", GF_4CC('A','D','T','S'), ctx->frame_size, ctx->index, adts_dmx_index_scan, ctx);
+		if (!ctx->rfidx) return;
+	}
+	if (!rfidx_done(ctx->rfidx, GF_FALSE)) return;
+
+	rfidx_get(ctx->rfidx, &ctx->indexes, &ctx->index_size, &duration);
+	rfidx_del(ctx->rfidx);
+	ctx->rfidx = NULL;
+
+	if (duration.den) {
+		if (!ctx->duration.num || (ctx->duration.num * duration.den != duration.num * ctx->duration.den)) {
+			ctx->duration = duration;
 
 			gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_DURATION, & PROP_FRAC64(ctx->duration));
 		}
@@ -440,6 +445,11 @@ static Bool adts_dmx_process_event(GF_Filter *filter, const GF_FilterEvent *evt)
 		ctx->in_seek = GF_TRUE;
 		ctx->file_pos = 0;
 		if (ctx->start_range) {
+			//seeking before index completion, wait for it
+			if (ctx->rfidx) {
+				rfidx_done(ctx->rfidx, GF_TRUE);
+				adts_dmx_check_dur(filter, ctx);
+			}
 			for (i=1; i<ctx->index_size; i++) {
 				if (ctx->indexes[i].duration>ctx->start_range) {
 					ctx->cts = (u64) (ctx->indexes[i-1].duration * GF_M4ASampleRates[ctx->sr_idx]);
@@ -772,6 +782,7 @@ static void adts_dmx_finalize(GF_Filter *filter)
 {
 	GF_ADTSDmxCtx *ctx = gf_filter_get_udta(filter);
 	if (ctx->bs) gf_bs_del(ctx->bs);
+	if (ctx->rfidx) rfidx_del(ctx->rfidx);
 	if (ctx->indexes) gf_free(ctx->indexes);
 	if (ctx->adts_buffer) gf_free(ctx->adts_buffer);
 	if (ctx->id3_buffer) gf_free(ctx->id3_buffer);
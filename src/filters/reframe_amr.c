@@ -559,6 +559,14 @@ static const char * amrdmx_probe_data(const u8 *data, u32 size, GF_FilterProbeSc
 	return NULL;
 }
 
+static const GF_FilterProbeMagic AMRDmxMagics[] =
+{
+	PROBE_MAGIC(0, "#!AMR"),
+	PROBE_MAGIC(0, "#!EVRC"),
+	PROBE_MAGIC(0, "#!SMV"),
+	{0}
+};
+
 static const GF_FilterCapability AMRDmxCaps[] =
 {
 	CAP_UINT(GF_CAPS_INPUT, GF_PROP_PID_STREAM_TYPE, GF_STREAM_FILE),
@@ -592,6 +600,7 @@ GF_FilterRegister AMRDmxRegister = {
 	.configure_pid = amrdmx_configure_pid,
 	.process = amrdmx_process,
 	.probe_data = amrdmx_probe_data,
+	.probe_magics = AMRDmxMagics,
 	.process_event = amrdmx_process_event
 };
 
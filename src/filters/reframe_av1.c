@@ -1053,6 +1053,12 @@ static const char * av1dmx_probe_data(const u8 *data, u32 size, GF_FilterProbeSc
 	return NULL;
 }
 
+static const GF_FilterProbeMagic AV1DmxMagics[] =
+{
+	PROBE_MAGIC(0, "DKIF"),
+	{0}
+};
+
 static const GF_FilterCapability AV1DmxCaps[] =
 {
 	CAP_UINT(GF_CAPS_INPUT, GF_PROP_PID_STREAM_TYPE, GF_STREAM_FILE),
@@ -1096,6 +1102,7 @@ GF_FilterRegister AV1DmxRegister = {
 	.configure_pid = av1dmx_configure_pid,
 	.process = av1dmx_process,
 	.probe_data = av1dmx_probe_data,
+	.probe_magics = AV1DmxMagics,
 	.process_event = av1dmx_process_event
 };
 
@@ -618,6 +618,12 @@ static const char *flac_dmx_probe_data(const u8 *data, u32 size, GF_FilterProbeS
 	return NULL;
 }
 
+static const GF_FilterProbeMagic FLACDmxMagics[] =
+{
+	PROBE_MAGIC(0, "fLaC"),
+	{0}
+};
+
 static const GF_FilterCapability FLACDmxCaps[] =
 {
 	CAP_UINT(GF_CAPS_INPUT, GF_PROP_PID_STREAM_TYPE, GF_STREAM_FILE),
@@ -655,6 +661,7 @@ GF_FilterRegister FLACDmxRegister = {
 	.configure_pid = flac_dmx_configure_pid,
 	.process = flac_dmx_process,
 	.probe_data = flac_dmx_probe_data,
+	.probe_magics = FLACDmxMagics,
 	.process_event = flac_dmx_process_event
 };
 
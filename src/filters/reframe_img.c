@@ -393,6 +393,16 @@ static const char * img_probe_data(const u8 *data, u32 size, GF_FilterProbeScore
 	}
 	return NULL;
 }
+
+static const GF_FilterProbeMagic ReframeImgMagics[] =
+{
+	PROBE_MAGIC(0, "\xFF\xD8\xFF"),
+	PROBE_MAGIC(0, "\x89PN"),
+	PROBE_MAGIC(4, "jP  "),
+	PROBE_MAGIC(4, "jp2h"),
+	{0}
+};
+
 static const GF_FilterCapability ReframeImgCaps[] =
 {
 	CAP_UINT(GF_CAPS_INPUT, GF_PROP_PID_STREAM_TYPE, GF_STREAM_FILE),
@@ -422,6 +432,7 @@ GF_FilterRegister ReframeImgRegister = {
 	SETCAPS(ReframeImgCaps),
 	.configure_pid = img_configure_pid,
 	.probe_data = img_probe_data,
+	.probe_magics = ReframeImgMagics,
 	.process = img_process,
 	.process_event = img_process_event
 };
@@ -0,0 +1,276 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2020
+ *					All rights reserved
+ *
+ *  This file is part of GPAC / seek index of raw stream reframers
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include "reframe_index.h"
+#include <gpac/thread.h>
+#include <gpac/bitstream.h>
+
+#define RFIDX_MAGIC		GF_4CC('G','R','F','I')
+#define RFIDX_VERSION	1
+
+struct __rf_index
+{
+	char *src_path;
+	//file the index is loaded from and stored to, NULL if none
+	char *store_path;
+	const char *log_name;
+	u32 type, param;
+	Double window;
+	u64 file_size, file_mtime;
+
+	rfidx_scan_fun scan;
+	void *udta;
+
+	GF_Thread *th;
+	//set by the filter to abort the scan
+	volatile u32 abort;
+	//set by the indexing thread once the index is complete
+	u32 done;
+
+	GF_RFIndexEntry *entries;
+	u32 nb_entries, nb_alloc;
+	u64 duration;
+	u32 timescale;
+};
+
+static Bool rfidx_load(GF_RFIndex *rfidx)
+{
+	u32 i, nb_entries=0;
+	Bool valid = GF_TRUE;
+	GF_BitStream *bs;
+	FILE *idx_file;
+
+	if (!rfidx->store_path) return GF_FALSE;
+	idx_file = gf_fopen(rfidx->store_path, "rb");
+	if (!idx_file) return GF_FALSE;
+
+	bs = gf_bs_from_file(idx_file, GF_BITSTREAM_READ);
+	if (gf_bs_read_u32(bs) != RFIDX_MAGIC) valid = GF_FALSE;
+	else if (gf_bs_read_u32(bs) != RFIDX_VERSION) valid = GF_FALSE;
+	else if (gf_bs_read_u32(bs) != rfidx->type) valid = GF_FALSE;
+	else if (gf_bs_read_u32(bs) != rfidx->param) valid = GF_FALSE;
+	else if (gf_bs_read_double(bs) != rfidx->window) valid = GF_FALSE;
+	else if (gf_bs_read_u64(bs) != rfidx->file_size) valid = GF_FALSE;
+	else if (gf_bs_read_u64(bs) != rfidx->file_mtime) valid = GF_FALSE;
+
+	if (valid) {
+		rfidx->duration = gf_bs_read_u64(bs);
+		rfidx->timescale = gf_bs_read_u32(bs);
+		nb_entries = gf_bs_read_u32(bs);
+		if (gf_bs_available(bs) < (u64) nb_entries * 16) valid = GF_FALSE;
+	}
+	if (valid && nb_entries) {
+		rfidx->entries = gf_malloc(sizeof(GF_RFIndexEntry) * nb_entries);
+		rfidx->nb_entries = rfidx->nb_alloc = nb_entries;
+		for (i=0; i<nb_entries; i++) {
+			rfidx->entries[i].pos = gf_bs_read_u64(bs);
+			rfidx->entries[i].duration = gf_bs_read_double(bs);
+		}
+	}
+	gf_bs_del(bs);
+	gf_fclose(idx_file);
+	return valid;
+}
+
+static void rfidx_save(GF_RFIndex *rfidx)
+{
+	u32 i;
+	GF_BitStream *bs;
+	FILE *idx_file = gf_fopen(rfidx->store_path, "wb");
+	if (!idx_file) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_PARSER, ("[%s] Failed to store index in %s\n", rfidx->log_name, rfidx->store_path));
+		return;
+	}
+	bs = gf_bs_from_file(idx_file, GF_BITSTREAM_WRITE);
+	gf_bs_write_u32(bs, RFIDX_MAGIC);
+	gf_bs_write_u32(bs, RFIDX_VERSION);
+	gf_bs_write_u32(bs, rfidx->type);
+	gf_bs_write_u32(bs, rfidx->param);
+	gf_bs_write_double(bs, rfidx->window);
+	gf_bs_write_u64(bs, rfidx->file_size);
+	gf_bs_write_u64(bs, rfidx->file_mtime);
+	gf_bs_write_u64(bs, rfidx->duration);
+	gf_bs_write_u32(bs, rfidx->timescale);
+	gf_bs_write_u32(bs, rfidx->nb_entries);
+	for (i=0; i<rfidx->nb_entries; i++) {
+		gf_bs_write_u64(bs, rfidx->entries[i].pos);
+		gf_bs_write_double(bs, rfidx->entries[i].duration);
+	}
+	gf_bs_del(bs);
+	gf_fclose(idx_file);
+}
+
+static u32 rfidx_run(void *par)
+{
+	GF_RFIndex *rfidx = (GF_RFIndex *) par;
+	u64 clock = gf_sys_clock_high_res();
+	FILE *stream = gf_fopen(rfidx->src_path, "rb");
+
+	if (stream) {
+		rfidx->scan(rfidx, stream, rfidx->udta);
+		gf_fclose(stream);
+	}
+	if (!rfidx->abort) {
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_PARSER, ("[%s] Indexed %s in "LLU" us - %d entries\n", rfidx->log_name, rfidx->src_path, gf_sys_clock_high_res() - clock, rfidx->nb_entries));
+		if (stream && rfidx->store_path)
+			rfidx_save(rfidx);
+	}
+	safe_int_inc(&rfidx->done);
+	return 0;
+}
+
+static char *rfidx_get_store_path(GF_RFIndex *rfidx)
+{
+	char szName[100], sz4cc[GF_4CC_MSIZE];
+	char *path;
+	const char *dir;
+	const char *mode = gf_opts_get_key("core", "idx-store");
+
+	if (mode && !strcmp(mode, "none")) return NULL;
+	if (mode && !strcmp(mode, "local")) {
+		path = gf_strdup(rfidx->src_path);
+		gf_dynstrcat(&path, ".gfidx", NULL);
+		return path;
+	}
+	dir = gf_opts_get_key("core", "cache");
+	if (!dir) return NULL;
+
+	sprintf(szName, "gpac_idx_%08X_%s.gfidx", gf_crc_32((const u8 *) rfidx->src_path, (u32) strlen(rfidx->src_path)), gf_4cc_to_str_safe(rfidx->type, sz4cc));
+	path = gf_strdup(dir);
+	if ((path[strlen(path)-1] != '/') && (path[strlen(path)-1] != '\\'))
+		gf_dynstrcat(&path, "/", NULL);
+	gf_dynstrcat(&path, szName, NULL);
+	return path;
+}
+
+GF_RFIndex *rfidx_new(GF_FilterPid *ipid, const char *log_name, u32 type, u32 param, Double window, rfidx_scan_fun scan, void *udta)
+{
+	GF_RFIndex *rfidx;
+	FILE *stream;
+	const GF_PropertyValue *p = gf_filter_pid_get_property(ipid, GF_PROP_PID_FILEPATH);
+	if (!p || !p->value.string) return NULL;
+
+	stream = gf_fopen(p->value.string, "rb");
+	if (!stream) return NULL;
+
+	GF_SAFEALLOC(rfidx, GF_RFIndex);
+	if (!rfidx) {
+		gf_fclose(stream);
+		return NULL;
+	}
+	rfidx->src_path = gf_strdup(p->value.string);
+	rfidx->log_name = log_name;
+	rfidx->type = type;
+	rfidx->param = param;
+	rfidx->window = window;
+	rfidx->scan = scan;
+	rfidx->udta = udta;
+	rfidx->file_size = gf_fsize(stream);
+	rfidx->file_mtime = gf_file_modification_time(rfidx->src_path);
+	gf_fclose(stream);
+
+	//only store index of complete files
+	p = gf_filter_pid_get_property(ipid, GF_PROP_PID_FILE_CACHED);
+	if (p && p->value.boolean)
+		rfidx->store_path = rfidx_get_store_path(rfidx);
+
+	if (rfidx_load(rfidx)) {
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_PARSER, ("[%s] Loaded index of %s from %s - %d entries\n", log_name, rfidx->src_path, rfidx->store_path, rfidx->nb_entries));
+		rfidx->done = 1;
+		return rfidx;
+	}
+	rfidx->nb_entries = 0;
+	rfidx->duration = 0;
+	rfidx->timescale = 0;
+
+	rfidx->th = gf_th_new(log_name);
+	if (!rfidx->th || (gf_th_run(rfidx->th, rfidx_run, rfidx) != GF_OK)) {
+		//no thread available, index now
+		if (rfidx->th) gf_th_del(rfidx->th);
+		rfidx->th = NULL;
+		rfidx_run(rfidx);
+	}
+	return rfidx;
+}
+
+void rfidx_del(GF_RFIndex *rfidx)
+{
+	if (rfidx->th) {
+		rfidx->abort = 1;
+		gf_th_del(rfidx->th);
+	}
+	if (rfidx->entries) gf_free(rfidx->entries);
+	if (rfidx->store_path) gf_free(rfidx->store_path);
+	gf_free(rfidx->src_path);
+	gf_free(rfidx);
+}
+
+Bool rfidx_done(GF_RFIndex *rfidx, Bool wait)
+{
+	if (!safe_int_add(&rfidx->done, 0)) {
+		if (!wait) return GF_FALSE;
+		GF_LOG(GF_LOG_INFO, GF_LOG_PARSER, ("[%s] Waiting for index completion\n", rfidx->log_name));
+		gf_th_stop(rfidx->th);
+	}
+	return GF_TRUE;
+}
+
+void rfidx_get(GF_RFIndex *rfidx, GF_RFIndexEntry **entries, u32 *nb_entries, GF_Fraction64 *duration)
+{
+	if (*entries) gf_free(*entries);
+	*entries = rfidx->entries;
+	*nb_entries = rfidx->nb_entries;
+	rfidx->entries = NULL;
+	rfidx->nb_entries = rfidx->nb_alloc = 0;
+	duration->num = (s64) rfidx->duration;
+	duration->den = rfidx->timescale;
+}
+
+Double rfidx_window(GF_RFIndex *rfidx)
+{
+	return rfidx->window;
+}
+
+void rfidx_add(GF_RFIndex *rfidx, u64 pos, Double duration)
+{
+	if (rfidx->nb_entries == rfidx->nb_alloc) {
+		rfidx->nb_alloc = rfidx->nb_alloc ? 2*rfidx->nb_alloc : 10;
+		rfidx->entries = gf_realloc(rfidx->entries, sizeof(GF_RFIndexEntry)*rfidx->nb_alloc);
+	}
+	rfidx->entries[rfidx->nb_entries].pos = pos;
+	rfidx->entries[rfidx->nb_entries].duration = duration;
+	rfidx->nb_entries++;
+}
+
+void rfidx_set_duration(GF_RFIndex *rfidx, u64 duration, u32 timescale)
+{
+	rfidx->duration = duration;
+	rfidx->timescale = timescale;
+}
+
+Bool rfidx_aborted(GF_RFIndex *rfidx)
+{
+	return rfidx->abort ? GF_TRUE : GF_FALSE;
+}
@@ -0,0 +1,88 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2020
+ *					All rights reserved
+ *
+ *  This file is part of GPAC / seek index of raw stream reframers
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#ifndef _GF_REFRAME_INDEX_H_
+#define _GF_REFRAME_INDEX_H_
+
+#include <gpac/filters.h>
+
+/*
+Raw stream reframers (NALU, ADTS, LATM, MP3, AC3) build a duration and seek index by scanning the source file.
+
+The scan runs on a dedicated thread so that the reframer can dispatch packets right away; the reframer polls for completion
+in its process function, and waits for the index when a seek is requested before the index is ready.
+
+Completed indexes of local files are stored (see -idx-store option) and reused as long as the source file size and modification time,
+the reframer type, its index parameters and the index window are unchanged.
+*/
+
+typedef struct
+{
+	//byte offset of the frame
+	u64 pos;
+	//time of the frame in seconds
+	Double duration;
+} GF_RFIndexEntry;
+
+typedef struct __rf_index GF_RFIndex;
+
+/*scan function, called on the indexing thread
+The function shall only use the file, the index and data of its udta which is not modified by the filter while scanning.
+It shall check rfidx_aborted regularly and return as soon as possible if set*/
+typedef void (*rfidx_scan_fun)(GF_RFIndex *rfidx, FILE *stream, void *udta);
+
+/*creates the index for the file of the given input PID, loading it from the index store if present or starting the indexing thread
+\param ipid input PID of the reframer, must have a file path
+\param log_name name of the reframer for logs
+\param type reframer type, used to identify stored indexes
+\param param reframer parameter changing the index content (eg frame size), used to identify stored indexes
+\param window index window in seconds
+\param scan scan function
+\param udta user data of the scan function
+\return the index, or NULL if the file cannot be opened*/
+GF_RFIndex *rfidx_new(GF_FilterPid *ipid, const char *log_name, u32 type, u32 param, Double window, rfidx_scan_fun scan, void *udta);
+/*destroys the index, aborting the scan if still running*/
+void rfidx_del(GF_RFIndex *rfidx);
+/*checks if the index is complete
+\param wait if set, waits for the scan to complete
+\return GF_TRUE if complete*/
+Bool rfidx_done(GF_RFIndex *rfidx, Bool wait);
+/*gets the result of a complete index. Ownership of the entries is transferred to the caller, the previous entries are freed
+\param entries set to the index entries
+\param nb_entries set to the number of index entries
+\param duration set to the duration of the file, with den set to 0 if unknown*/
+void rfidx_get(GF_RFIndex *rfidx, GF_RFIndexEntry **entries, u32 *nb_entries, GF_Fraction64 *duration);
+
+/*functions for the scan function*/
+/*gets the index window in seconds*/
+Double rfidx_window(GF_RFIndex *rfidx);
+/*adds an index entry*/
+void rfidx_add(GF_RFIndex *rfidx, u64 pos, Double duration);
+/*sets the duration of the file*/
+void rfidx_set_duration(GF_RFIndex *rfidx, u64 duration, u32 timescale);
+/*checks if scan is aborted*/
+Bool rfidx_aborted(GF_RFIndex *rfidx);
+
+#endif //_GF_REFRAME_INDEX_H_
@@ -26,15 +26,10 @@
 #include <gpac/avparse.h>
 #include <gpac/constants.h>
 #include <gpac/filters.h>
+#include "reframe_index.h"
 
 #ifndef GPAC_DISABLE_AV_PARSERS
 
-typedef struct
-{
-	u64 pos;
-	Double duration;
-} MP3Idx;
-
 typedef struct
 {
 	//filter args
@@ -66,8 +61,9 @@ typedef struct
 	GF_FilterPacket *src_pck;
 
 	Bool recompute_cts;
-	MP3Idx *indexes;
-	u32 index_alloc_size, index_size;
+	GF_RFIndex *rfidx;
+	GF_RFIndexEntry *indexes;
+	u32 index_size;
 
 	u32 tag_size;
 	u8 *id3_buffer;
@@ -108,31 +104,12 @@ GF_Err mp3_dmx_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is_remov
 	return GF_OK;
 }
 
-static void mp3_dmx_check_dur(GF_Filter *filter, GF_MP3DmxCtx *ctx)
+//called on the index thread
+static void mp3_dmx_index_scan(GF_RFIndex *rfidx, FILE *stream, void *udta)
 {
-	FILE *stream;
 	u64 duration, cur_dur;
 	s32 prev_sr = -1;
-	const GF_PropertyValue *p;
-	if (!ctx->opid || ctx->timescale || ctx->file_loaded) return;
-
-	if (ctx->index<=0) {
-		ctx->file_loaded = GF_TRUE;
-		return;
-	}
-
-	p = gf_filter_pid_get_property(ctx->ipid, GF_PROP_PID_FILEPATH);
-	if (!p || !p->value.string || !strncmp(p->value.string, "gmem://", 7)) {
-		ctx->is_file = GF_FALSE;
-		ctx->file_loaded = GF_TRUE;
-		return;
-	}
-	ctx->is_file = GF_TRUE;
-
-	stream = gf_fopen(p->value.string, "rb");
-	if (!stream) return;
-
-	ctx->index_size = 0;
+	Double window = rfidx_window(rfidx);
 
 	duration = 0;
 	cur_dur = 0;
@@ -155,27 +132,55 @@ static void mp3_dmx_check_dur(GF_Filter *filter, GF_MP3DmxCtx *ctx)
 		duration += dur;
 		cur_dur += dur;
 		pos = gf_ftell(stream);
-		if (cur_dur > ctx->index * prev_sr) {
-			if (!ctx->index_alloc_size) ctx->index_alloc_size = 10;
-			else if (ctx->index_alloc_size == ctx->index_size) ctx->index_alloc_size *= 2;
-			ctx->indexes = gf_realloc(ctx->indexes, sizeof(MP3Idx)*ctx->index_alloc_size);
-			ctx->indexes[ctx->index_size].pos = pos - 4;
-			ctx->indexes[ctx->index_size].duration = (Double) duration;
-			ctx->indexes[ctx->index_size].duration /= prev_sr;
-			ctx->index_size ++;
+		if (cur_dur > window * prev_sr) {
+			rfidx_add(rfidx, pos - 4, ((Double) duration) / prev_sr);
 			cur_dur = 0;
+			if (rfidx_aborted(rfidx)) break;
 		}
 
 		pos = gf_ftell(stream);
 		gf_fseek(stream, pos + gf_mp3_frame_size(hdr) - 4, SEEK_SET);
 	}
-	gf_fclose(stream);
+	if (prev_sr>0)
+		rfidx_set_duration(rfidx, duration, prev_sr);
+}
 
-	if (!ctx->duration.num || (ctx->duration.num  * prev_sr != duration * ctx->duration.den)) {
-		ctx->duration.num = (s32) duration;
-		ctx->duration.den = prev_sr ;
+static void mp3_dmx_check_dur(GF_Filter *filter, GF_MP3DmxCtx *ctx)
+{
+	GF_Fraction64 duration;
+	const GF_PropertyValue *p;
+	if (!ctx->opid || ctx->timescale || ctx->file_loaded) return;
 
-		gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_DURATION, & PROP_FRAC64(ctx->duration));
+	if (!ctx->rfidx) {
+		if (ctx->index<=0) {
+			ctx->file_loaded = GF_TRUE;
+			return;
+		}
+
+		p = gf_filter_pid_get_property(ctx->ipid, GF_PROP_PID_FILEPATH);
+		if (!p || !p->value.string || !strncmp(p->value.string, "gmem://", 7)) {
+			ctx->is_file = GF_FALSE;
+			ctx->file_loaded = GF_TRUE;
+			return;
+		}
+		ctx->is_file = GF_TRUE;
+
+		//index is built in the background, packets are dispatched meanwhile
+		ctx->rfidx = rfidx_new(ctx->ipid, "MP3Dmx", GF_4CC('M','P','3','A'), 0, ctx->index, mp3_dmx_index_scan, ctx);
+		if (!ctx->rfidx) return;
+	}
+	if (!rfidx_done(ctx->rfidx, GF_FALSE)) return;
+
+	rfidx_get(ctx->rfidx, &ctx->indexes, &ctx->index_size, &duration);
+	rfidx_del(ctx->rfidx);
+	ctx->rfidx = NULL;
+
+	if (duration.den) {
+		if (!ctx->duration.num || (ctx->duration.num * duration.den != duration.num * ctx->duration.den)) {
+			ctx->duration = duration;
+
+			gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_DURATION, & PROP_FRAC64(ctx->duration));
+		}
 	}
 
 	p = gf_filter_pid_get_property(ctx->ipid, GF_PROP_PID_FILE_CACHED);
@@ -404,6 +409,11 @@ static Bool mp3_dmx_process_event(GF_Filter *filter, const GF_FilterEvent *evt)
 		ctx->in_seek = GF_TRUE;
 		ctx->file_pos = 0;
 		if (ctx->start_range) {
+			//seeking before index completion, wait for it
+			if (ctx->rfidx) {
+				rfidx_done(ctx->rfidx, GF_TRUE);
+				mp3_dmx_check_dur(filter, ctx);
+			}
 			for (i=1; i<ctx->index_size; i++) {
 				if (ctx->indexes[i].duration>ctx->start_range) {
 					ctx->cts = (u64) (ctx->indexes[i-1].duration * ctx->sr);
@@ -690,6 +700,7 @@ static void mp3_dmx_finalize(GF_Filter *filter)
 {
 	GF_MP3DmxCtx *ctx = gf_filter_get_udta(filter);
 	if (ctx->bs) gf_bs_del(ctx->bs);
+	if (ctx->rfidx) rfidx_del(ctx->rfidx);
 	if (ctx->indexes) gf_free(ctx->indexes);
 	if (ctx->mp3_buffer) gf_free(ctx->mp3_buffer);
 	if (ctx->id3_buffer) gf_free(ctx->id3_buffer);
@@ -27,6 +27,7 @@
 #include <gpac/constants.h>
 #include <gpac/filters.h>
 #include <gpac/internal/media_dev.h>
+#include "reframe_index.h"
 //for oinf stuff
 #include <gpac/internal/isomedia_dev.h>
 
@@ -40,12 +41,6 @@
 //otherwise we copy remaining bytes in the hdr store if a startcode may be split across two input packets
 #define SAFETY_NAL_STORE	50
 
-typedef struct
-{
-	u64 pos;
-	Double duration;
-} NALUIdx;
-
 
 typedef struct
 {
@@ -95,8 +90,11 @@ typedef struct
 	Bool initial_play_done;
 
 	//list of RAP entry points
-	NALUIdx *indexes;
-	u32 index_alloc_size, index_size;
+	GF_RFIndex *rfidx;
+	GF_RFIndexEntry *indexes;
+	u32 index_size;
+	//frame rate used by the indexer
+	GF_Fraction idx_fps;
 
 
 	//timescale of the input pid if any, 0 otherwise
@@ -308,40 +306,17 @@ GF_Err naludmx_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is_remov
 }
 
 
-static void naludmx_check_dur(GF_Filter *filter, GF_NALUDmxCtx *ctx)
+//called on the index thread, only uses is_hevc and idx_fps of the context
+static void naludmx_index_scan(GF_RFIndex *rfidx, FILE *stream, void *udta)
 {
-	FILE *stream;
+	GF_NALUDmxCtx *ctx = (GF_NALUDmxCtx *) udta;
 	GF_BitStream *bs;
 	u64 duration, cur_dur, nal_start, start_code_pos;
 	AVCState *avc_state = NULL;
 	HEVCState *hevc_state = NULL;
 	Bool first_slice_in_pic = GF_TRUE;
-	const GF_PropertyValue *p;
-	const char *filepath = NULL;
-	if (!ctx->opid || ctx->timescale || ctx->file_loaded) return;
-
-	p = gf_filter_pid_get_property(ctx->ipid, GF_PROP_PID_FILEPATH);
-	if (!p || !p->value.string || !strncmp(p->value.string, "gmem://", 7)) {
-		ctx->is_file = GF_FALSE;
-		ctx->file_loaded = GF_TRUE;
-		return;
-	}
-	filepath = p->value.string;
-	ctx->is_file = GF_TRUE;
-
-	if (ctx->index<0) {
-		p = gf_filter_pid_get_property(ctx->ipid, GF_PROP_PID_DOWN_SIZE);
-		if (!p || (p->value.longuint > 100000000)) {
-			GF_LOG(GF_LOG_INFO, GF_LOG_PARSER, ("[%s] Source file larger than 100M, skipping indexing\n", ctx->log_name));
-		} else {
-			ctx->index = -ctx->index;
-		}
-	}
-	if (ctx->index<=0) {
-		ctx->duration.num = 1;
-		ctx->file_loaded = GF_TRUE;
-		return;
-	}
+	GF_Fraction fps = ctx->idx_fps;
+	Double window = rfidx_window(rfidx);
 
 	if (ctx->is_hevc) {
 		GF_SAFEALLOC(hevc_state, HEVCState);
@@ -351,13 +326,6 @@ static void naludmx_check_dur(GF_Filter *filter, GF_NALUDmxCtx *ctx)
 		if (!avc_state) return;
 	}
 
-	stream = gf_fopen(filepath, "rb");
-	if (!stream) {
-		if (hevc_state) gf_free(hevc_state);
-		if (avc_state) gf_free(avc_state);
-		return;
-	}
-	ctx->index_size = 0;
 	duration = 0;
 	cur_dur = 0;
 
@@ -369,9 +337,6 @@ static void naludmx_check_dur(GF_Filter *filter, GF_NALUDmxCtx *ctx)
 		if (hevc_state) gf_free(hevc_state);
 		if (avc_state) gf_free(avc_state);
 		gf_bs_del(bs);
-		gf_fclose(stream);
-		ctx->duration.num = 1;
-		ctx->file_loaded = GF_TRUE;
 		return;
 	}
 
@@ -443,20 +408,15 @@ static void naludmx_check_dur(GF_Filter *filter, GF_NALUDmxCtx *ctx)
 			}
 		}
 
-		if (is_rap && first_slice_in_pic && (cur_dur >= ctx->index * ctx->cur_fps.num) ) {
-			if (!ctx->index_alloc_size) ctx->index_alloc_size = 10;
-			else if (ctx->index_alloc_size == ctx->index_size) ctx->index_alloc_size *= 2;
-			ctx->indexes = gf_realloc(ctx->indexes, sizeof(NALUIdx)*ctx->index_alloc_size);
-			ctx->indexes[ctx->index_size].pos = start_code_pos;
-			ctx->indexes[ctx->index_size].duration = (Double) duration;
-			ctx->indexes[ctx->index_size].duration /= ctx->cur_fps.num;
-			ctx->index_size ++;
+		if (is_rap && first_slice_in_pic && (cur_dur >= window * fps.num) ) {
+			rfidx_add(rfidx, start_code_pos, ((Double) duration) / fps.num);
 			cur_dur = 0;
+			if (rfidx_aborted(rfidx)) break;
 		}
 
 		if (is_slice && first_slice_in_pic) {
-			duration += ctx->cur_fps.den;
-			cur_dur += ctx->cur_fps.den;
+			duration += fps.den;
+			cur_dur += fps.den;
 			first_slice_in_pic = GF_FALSE;
 		}
 
@@ -476,13 +436,61 @@ static void naludmx_check_dur(GF_Filter *filter, GF_NALUDmxCtx *ctx)
 	}
 
 	gf_bs_del(bs);
-	gf_fclose(stream);
 	if (hevc_state) gf_free(hevc_state);
 	if (avc_state) gf_free(avc_state);
 
-	if (!ctx->duration.num || (ctx->duration.num  * ctx->cur_fps.num != duration * ctx->duration.den)) {
-		ctx->duration.num = (s32) duration;
-		ctx->duration.den = ctx->cur_fps.num;
+	rfidx_set_duration(rfidx, duration, fps.num);
+
+}
+
+static void naludmx_check_dur(GF_Filter *filter, GF_NALUDmxCtx *ctx)
+{
+	GF_Fraction64 duration;
+	const GF_PropertyValue *p;
+	if (!ctx->opid || ctx->timescale || ctx->file_loaded) return;
+
+	if (!ctx->rfidx) {
+		p = gf_filter_pid_get_property(ctx->ipid, GF_PROP_PID_FILEPATH);
+		if (!p || !p->value.string || !strncmp(p->value.string, "gmem://", 7)) {
+			ctx->is_file = GF_FALSE;
+			ctx->file_loaded = GF_TRUE;
+			return;
+		}
+		ctx->is_file = GF_TRUE;
+
+		if (ctx->index<0) {
+			p = gf_filter_pid_get_property(ctx->ipid, GF_PROP_PID_DOWN_SIZE);
+			if (!p || (p->value.longuint > 100000000)) {
+				GF_LOG(GF_LOG_INFO, GF_LOG_PARSER, ("[%s] Source file larger than 100M, skipping indexing\n", ctx->log_name));
+			} else {
+				ctx->index = -ctx->index;
+			}
+		}
+		if (ctx->index<=0) {
+			ctx->duration.num = 1;
+			ctx->file_loaded = GF_TRUE;
+			return;
+		}
+
+		//index is built in the background with the current frame rate, packets are dispatched meanwhile
+		ctx->idx_fps = ctx->cur_fps;
+		ctx->rfidx = rfidx_new(ctx->ipid, ctx->log_name, ctx->is_hevc ? GF_4CC('H','E','V','C') : GF_4CC('A','V','C','1'), gf_crc_32((u8 *) &ctx->idx_fps, sizeof(GF_Fraction)), ctx->index, naludmx_index_scan, ctx);
+		if (!ctx->rfidx) return;
+	}
+	if (!rfidx_done(ctx->rfidx, GF_FALSE)) return;
+
+	rfidx_get(ctx->rfidx, &ctx->indexes, &ctx->index_size, &duration);
+	rfidx_del(ctx->rfidx);
+	ctx->rfidx = NULL;
+
+	//not a NALU file
+	if (!duration.den) {
+		ctx->duration.num = 1;
+		ctx->file_loaded = GF_TRUE;
+		return;
+	}
+	if (!ctx->duration.num || (ctx->duration.num * duration.den != duration.num * ctx->duration.den)) {
+		ctx->duration = duration;
 
 		gf_filter_pid_set_property(ctx->opid, GF_PROP_PID_DURATION, & PROP_FRAC64(ctx->duration));
 	}
@@ -1283,6 +1291,11 @@ static Bool naludmx_process_event(GF_Filter *filter, const GF_FilterEvent *evt)
 		ctx->in_seek = GF_TRUE;
 
 		if (ctx->start_range) {
+			//seeking before index completion, wait for it
+			if (ctx->rfidx) {
+				rfidx_done(ctx->rfidx, GF_TRUE);
+				naludmx_check_dur(filter, ctx);
+			}
 			ctx->nb_nalus = ctx->nb_i = ctx->nb_p = ctx->nb_b = ctx->nb_sp = ctx->nb_si = ctx->nb_sei = ctx->nb_idr = 0;
 			for (i=1; i<ctx->index_size; i++) {
 				if (ctx->indexes[i].duration>ctx->start_range) {
@@ -3043,6 +3056,7 @@ static void naludmx_finalize(GF_Filter *filter)
 
 	if (ctx->bs_r) gf_bs_del(ctx->bs_r);
 	if (ctx->bs_w) gf_bs_del(ctx->bs_w);
+	if (ctx->rfidx) rfidx_del(ctx->rfidx);
 	if (ctx->indexes) gf_free(ctx->indexes);
 	if (ctx->hdr_store) gf_free(ctx->hdr_store);
 	if (ctx->pck_queue) {
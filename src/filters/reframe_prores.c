@@ -607,6 +607,12 @@ static const char * proresdmx_probe_data(const u8 *data, u32 size, GF_FilterProb
 	return NULL;
 }
 
+static const GF_FilterProbeMagic ProResDmxMagics[] =
+{
+	PROBE_MAGIC(4, "icpf"),
+	{0}
+};
+
 static const GF_FilterCapability ProResDmxCaps[] =
 {
 	CAP_UINT(GF_CAPS_INPUT, GF_PROP_PID_STREAM_TYPE, GF_STREAM_FILE),
@@ -653,6 +659,7 @@ GF_FilterRegister ProResDmxRegister = {
 	.configure_pid = proresdmx_configure_pid,
 	.process = proresdmx_process,
 	.probe_data = proresdmx_probe_data,
+	.probe_magics = ProResDmxMagics,
 	.process_event = proresdmx_process_event
 };
 
@@ -685,6 +685,12 @@ static const char *qcpdmx_probe_data(const u8 *data, u32 size, GF_FilterProbeSco
 	return "audio/qcp";
 }
 
+static const GF_FilterProbeMagic QCPDmxMagics[] =
+{
+	PROBE_MAGIC(8, "QLCM"),
+	{0}
+};
+
 static const GF_FilterCapability QCPDmxCaps[] =
 {
 	CAP_UINT(GF_CAPS_INPUT, GF_PROP_PID_STREAM_TYPE, GF_STREAM_FILE),
@@ -718,6 +724,7 @@ GF_FilterRegister QCPDmxRegister = {
 	.configure_pid = qcpdmx_configure_pid,
 	.process = qcpdmx_process,
 	.probe_data = qcpdmx_probe_data,
+	.probe_magics = QCPDmxMagics,
 	.process_event = qcpdmx_process_event
 };
 
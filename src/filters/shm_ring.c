@@ -0,0 +1,260 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2020
+ *					All rights reserved
+ *
+ *  This file is part of GPAC / shared memory ring used by shmin and shmout filters
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include "shm_ring.h"
+
+#ifndef WIN32
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#ifdef GPAC_CONFIG_LINUX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#endif
+
+#endif
+
+static char *shmring_get_path(const char *url)
+{
+	char szPath[GF_MAX_PATH];
+	const char *name = url;
+	if (!strnicmp(name, "shm://", 6)) name += 6;
+	else if (!strnicmp(name, "shm:", 4)) name += 4;
+	if (!name[0]) return NULL;
+
+#ifdef WIN32
+	if (!strncmp(name, "Local\\", 6) || !strncmp(name, "Global\\", 7)) {
+		strncpy(szPath, name, GF_MAX_PATH-1);
+	} else {
+		snprintf(szPath, GF_MAX_PATH, "Local\\gpac_shm_%s", name);
+	}
+#else
+	//absolute path, use as is
+	if (name[0] == '/') {
+		strncpy(szPath, name, GF_MAX_PATH-1);
+	}
+	//use tmpfs when available, otherwise regular temp dir (still shared through mmap)
+	else if (gf_dir_exists("/dev/shm")) {
+		snprintf(szPath, GF_MAX_PATH, "/dev/shm/gpac_shm_%s", name);
+	} else {
+		const char *tmp = getenv("TMPDIR");
+		snprintf(szPath, GF_MAX_PATH, "%s/gpac_shm_%s", tmp ? tmp : "/tmp", name);
+	}
+#endif
+	szPath[GF_MAX_PATH-1] = 0;
+	return gf_strdup(szPath);
+}
+
+GF_Err shmring_open(const char *url, u32 size, GF_ShmRing **out_ring)
+{
+	GF_ShmRing *ring;
+	u64 map_size;
+	Bool created = GF_FALSE;
+
+	*out_ring = NULL;
+	size = (size + 7) & ~7;
+	if (size < 4096) size = 4096;
+
+	GF_SAFEALLOC(ring, GF_ShmRing);
+	if (!ring) return GF_OUT_OF_MEM;
+	ring->path = shmring_get_path(url);
+	if (!ring->path) {
+		gf_free(ring);
+		return GF_BAD_PARAM;
+	}
+
+#ifdef WIN32
+	map_size = sizeof(GF_ShmHeader) + size;
+	ring->handle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD) (map_size>>32), (DWORD) (map_size & 0xFFFFFFFFUL), ring->path);
+	if (!ring->handle) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_MMIO, ("[SHM] Failed to create shared memory %s: %d\n", ring->path, GetLastError() ));
+		shmring_close(ring, GF_FALSE);
+		return GF_IO_ERR;
+	}
+	if (GetLastError() != ERROR_ALREADY_EXISTS) created = GF_TRUE;
+
+	//map the whole section, size is known from its creation
+	ring->hdr = MapViewOfFile(ring->handle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+	if (!ring->hdr) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_MMIO, ("[SHM] Failed to map shared memory %s: %d\n", ring->path, GetLastError() ));
+		shmring_close(ring, GF_FALSE);
+		return GF_IO_ERR;
+	}
+	if (!created) {
+		if (ring->hdr->magic != GF_SHM_MAGIC) {
+			shmring_close(ring, GF_FALSE);
+			return GF_IP_NETWORK_EMPTY;
+		}
+		map_size = sizeof(GF_ShmHeader) + ring->hdr->size;
+	}
+#else
+	ring->fd = open(ring->path, O_RDWR | O_CREAT | O_EXCL, 0666);
+	if (ring->fd >= 0) {
+		created = GF_TRUE;
+		map_size = sizeof(GF_ShmHeader) + size;
+		if (ftruncate(ring->fd, (off_t) map_size) < 0) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_MMIO, ("[SHM] Failed to allocate shared memory %s: %s\n", ring->path, strerror(errno) ));
+			shmring_close(ring, GF_TRUE);
+			return GF_IO_ERR;
+		}
+	} else {
+		struct stat st;
+		if (errno != EEXIST) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_MMIO, ("[SHM] Failed to create shared memory %s: %s\n", ring->path, strerror(errno) ));
+			shmring_close(ring, GF_FALSE);
+			return GF_IO_ERR;
+		}
+		ring->fd = open(ring->path, O_RDWR);
+		if ((ring->fd < 0) || fstat(ring->fd, &st) ) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_MMIO, ("[SHM] Failed to open shared memory %s: %s\n", ring->path, strerror(errno) ));
+			shmring_close(ring, GF_FALSE);
+			return GF_IO_ERR;
+		}
+		//creator has not yet allocated the object
+		if (st.st_size < (off_t) sizeof(GF_ShmHeader)) {
+			shmring_close(ring, GF_FALSE);
+			return GF_IP_NETWORK_EMPTY;
+		}
+		map_size = (u64) st.st_size;
+	}
+
+	ring->hdr = mmap(NULL, (size_t) map_size, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd, 0);
+	if (ring->hdr == MAP_FAILED) {
+		ring->hdr = NULL;
+		GF_LOG(GF_LOG_ERROR, GF_LOG_MMIO, ("[SHM] Failed to map shared memory %s: %s\n", ring->path, strerror(errno) ));
+		shmring_close(ring, created);
+		return GF_IO_ERR;
+	}
+	if (!created) {
+		if ((ring->hdr->magic != GF_SHM_MAGIC) || (sizeof(GF_ShmHeader) + ring->hdr->size > map_size)) {
+			shmring_close(ring, GF_FALSE);
+			return GF_IP_NETWORK_EMPTY;
+		}
+	}
+#endif
+	ring->map_size = map_size;
+	ring->data = ((u8 *) ring->hdr) + sizeof(GF_ShmHeader);
+	ring->created = created;
+
+	if (created) {
+		memset(ring->hdr, 0, sizeof(GF_ShmHeader));
+		ring->hdr->version = GF_SHM_VERSION;
+		ring->hdr->size = size;
+		//magic is set last, once everything is visible
+		safe_int_add(&ring->hdr->magic, GF_SHM_MAGIC);
+	} else if (ring->hdr->version != GF_SHM_VERSION) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_MMIO, ("[SHM] Unsupported shared memory version %d for %s\n", ring->hdr->version, ring->path));
+		shmring_close(ring, GF_FALSE);
+		return GF_NOT_SUPPORTED;
+	}
+	GF_LOG(GF_LOG_INFO, GF_LOG_MMIO, ("[SHM] %s shared memory %s - ring size %d\n", created ? "created" : "opened", ring->path, ring->hdr->size));
+	*out_ring = ring;
+	return GF_OK;
+}
+
+void shmring_close(GF_ShmRing *ring, Bool remove)
+{
+	if (!ring) return;
+#ifdef WIN32
+	if (ring->hdr) UnmapViewOfFile(ring->hdr);
+	if (ring->handle) CloseHandle(ring->handle);
+#else
+	if (ring->hdr) munmap(ring->hdr, (size_t) ring->map_size);
+	if (ring->fd >= 0) close(ring->fd);
+	if (remove && ring->path) gf_file_delete(ring->path);
+#endif
+	if (ring->path) gf_free(ring->path);
+	gf_free(ring);
+}
+
+GF_Err shmring_write(GF_ShmRing *ring, const u8 *data, u32 size, u32 flags)
+{
+	GF_ShmRecord *rec;
+	u64 write_pos = ring->hdr->write_pos;
+	u64 used = write_pos - GF_SHM_LOAD64(ring->hdr->read_pos);
+	u32 ring_size = ring->hdr->size;
+	u32 rec_size = (u32) GF_SHM_REC_SIZE(size);
+	u32 offset = (u32) (write_pos % ring_size);
+
+	if (rec_size > ring_size) return GF_BAD_PARAM;
+
+	//record does not fit before end of ring, pad
+	if (offset + rec_size > ring_size) {
+		u32 pad = ring_size - offset;
+		if (used + pad + rec_size > ring_size) return GF_BUFFER_TOO_SMALL;
+
+		rec = (GF_ShmRecord *) (ring->data + offset);
+		rec->size = pad - sizeof(GF_ShmRecord);
+		rec->flags = GF_SHM_REC_PAD;
+		safe_int64_add(&ring->hdr->write_pos, pad);
+		write_pos += pad;
+		used += pad;
+		offset = 0;
+	}
+	if (used + rec_size > ring_size) return GF_BUFFER_TOO_SMALL;
+
+	rec = (GF_ShmRecord *) (ring->data + offset);
+	rec->size = size;
+	rec->flags = flags;
+	if (size) memcpy(ring->data + offset + sizeof(GF_ShmRecord), data, size);
+	//atomic add acts as a full barrier, the record is visible before the new write position
+	safe_int64_add(&ring->hdr->write_pos, rec_size);
+	shmring_signal(ring, &ring->hdr->wr_seq, &ring->hdr->rd_waiting);
+	return GF_OK;
+}
+
+void shmring_wait(GF_ShmRing *ring, volatile u32 *addr, u32 val, volatile u32 *waiting, u32 timeout_ms)
+{
+	//atomic ops are full barriers: either we see the new value or the signaling side sees our waiting flag
+	safe_int_inc(waiting);
+	if ((u32) safe_int_add(addr, 0) == val) {
+#if defined(GPAC_CONFIG_LINUX) && !defined(GPAC_CONFIG_ANDROID)
+		struct timespec ts;
+		ts.tv_sec = timeout_ms / 1000;
+		ts.tv_nsec = (timeout_ms % 1000) * 1000000;
+		//shared futex (no FUTEX_PRIVATE_FLAG), the other side is in another process
+		syscall(SYS_futex, addr, FUTEX_WAIT, val, &ts, NULL, 0);
+#else
+		gf_sleep(timeout_ms ? 1 : 0);
+#endif
+	}
+	safe_int_dec(waiting);
+}
+
+void shmring_signal(GF_ShmRing *ring, volatile u32 *addr, volatile u32 *waiting)
+{
+	safe_int_inc(addr);
+	if (! safe_int_add(waiting, 0))
+		return;
+#if defined(GPAC_CONFIG_LINUX) && !defined(GPAC_CONFIG_ANDROID)
+	syscall(SYS_futex, addr, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+}
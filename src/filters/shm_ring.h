@@ -0,0 +1,122 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2020
+ *					All rights reserved
+ *
+ *  This file is part of GPAC / shared memory ring used by shmin and shmout filters
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#ifndef _GF_SHM_RING_H_
+#define _GF_SHM_RING_H_
+
+#include <gpac/tools.h>
+#include <gpac/thread.h>
+
+/*
+The ring is a single-producer single-consumer byte ring located in a named shared memory object:
+- a 64 bytes header (GF_ShmHeader)
+- followed by the ring data, made of 8-bytes aligned records (GF_ShmRecord header + payload)
+
+Records are never split across the end of the ring: if a record does not fit, a padding record is inserted and the record is written at the beginning of the ring.
+This allows the reader to expose record payloads directly, without copy.
+Positions are absolute byte counters, their difference giving the ring occupancy.
+*/
+
+#define GF_SHM_MAGIC	GF_4CC('G','S','H','M')
+#define GF_SHM_VERSION	1
+
+enum
+{
+	GF_SHM_STATE_NONE = 0,
+	GF_SHM_STATE_ATTACHED,
+	//writer is done, no more records will be written
+	GF_SHM_STATE_EOS,
+};
+
+typedef struct
+{
+	u32 magic, version;
+	//size of the ring data, multiple of 8
+	u32 size;
+	//GF_SHM_STATE_* of each side, only modified by that side
+	volatile u32 writer_state, reader_state;
+	//incremented by the writer for each record written, used as wait/wake address
+	volatile u32 wr_seq;
+	//incremented by the reader each time ring space is released, used as wait/wake address
+	volatile u32 rd_seq;
+	//set while the reader (resp. writer) waits on wr_seq (resp. rd_seq), so that signaling is only done when needed
+	volatile u32 rd_waiting, wr_waiting;
+	u32 _pad;
+	//absolute write position, only modified by the writer
+	volatile u64 write_pos;
+	//absolute release position, only modified by the reader
+	volatile u64 read_pos;
+	u8 _reserved[8];
+} GF_ShmHeader;
+
+enum
+{
+	GF_SHM_REC_START = 1,
+	GF_SHM_REC_END = 1<<1,
+	//padding up to the end of the ring
+	GF_SHM_REC_PAD = 1<<2,
+};
+
+typedef struct
+{
+	u32 size;
+	u32 flags;
+} GF_ShmRecord;
+
+#define GF_SHM_REC_SIZE(_payload)	(sizeof(GF_ShmRecord) + (((_payload) + 7) & ~7))
+
+#define GF_SHM_LOAD64(_v)	((u64) safe_int64_add(&(_v), 0))
+
+typedef struct __gf_shm_ring GF_ShmRing;
+
+struct __gf_shm_ring
+{
+	GF_ShmHeader *hdr;
+	u8 *data;
+	u64 map_size;
+	char *path;
+	Bool created;
+#ifdef WIN32
+	HANDLE handle;
+#else
+	int fd;
+#endif
+};
+
+/*opens the ring associated with the given shm:// URL, creating it with the given data size if not found
+returns GF_IP_NETWORK_EMPTY if the ring exists but is not yet initialized by its creator, in which case the call shall be retried later*/
+GF_Err shmring_open(const char *url, u32 size, GF_ShmRing **out_ring);
+/*closes the ring, removing the underlying shared memory object if remove is set*/
+void shmring_close(GF_ShmRing *ring, Bool remove);
+
+/*writes a record, returns GF_BUFFER_TOO_SMALL if not enough space in ring*/
+GF_Err shmring_write(GF_ShmRing *ring, const u8 *data, u32 size, u32 flags);
+
+/*waits for at most timeout_ms while the value at addr equals val, waiting being the associated waiter flag*/
+void shmring_wait(GF_ShmRing *ring, volatile u32 *addr, u32 val, volatile u32 *waiting, u32 timeout_ms);
+/*increments the value at addr and wakes up waiters on addr, if any*/
+void shmring_signal(GF_ShmRing *ring, volatile u32 *addr, volatile u32 *waiting);
+
+#endif //_GF_SHM_RING_H_
@@ -0,0 +1,629 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2020
+ *					All rights reserved
+ *
+ *  This file is part of GPAC / video ladder filter
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include <gpac/filters.h>
+#include <gpac/list.h>
+#include <gpac/constants.h>
+#include <gpac/thread.h>
+
+//number of destination rows processed by a thread at once
+#define VLADDER_BAND_ROWS	16
+//precision of filter coefficients
+#define VLADDER_COEF_BITS	14
+
+typedef struct
+{
+	//number of taps per destination sample
+	u32 taps;
+	//first source sample used by each destination sample
+	u32 *pos;
+	//taps coefficients of each destination sample, summing to 1<<VLADDER_COEF_BITS
+	u16 *coefs;
+} VLadderFilter;
+
+typedef struct
+{
+	u32 src_w, src_h, dst_w, dst_h;
+	VLadderFilter hf, vf;
+} VLadderScaler;
+
+typedef struct
+{
+	u32 width, height;
+	GF_FilterPid *opid;
+	//index of the rung we scale from, -1 for the input
+	s32 src_idx;
+	//rung has the input size, input packets are forwarded
+	Bool forward;
+
+	u32 out_size, nb_planes, uv_height;
+	u32 stride[3];
+	//luma and chroma scalers
+	VLadderScaler sc[2];
+
+	//packet being built and its planes, used as source of the next rungs
+	GF_FilterPacket *pck;
+	const u8 *planes[3];
+	u32 plane_stride[3];
+
+	u64 nb_frames, time_spent;
+} VLadderRung;
+
+typedef struct
+{
+	//vertical pass result of the current row
+	u32 *tmp;
+	u32 tmp_size;
+} VLadderWorker;
+
+typedef struct
+{
+	const u8 *src;
+	u32 src_stride;
+	u8 *dst;
+	u32 dst_stride;
+	VLadderScaler *sc;
+	u32 bps;
+} VLadderJob;
+
+typedef struct _vladder_ctx
+{
+	//options
+	GF_PropUIntList rungs;
+	Bool cascade;
+	s32 nbth;
+
+	//internal data
+	GF_FilterPid *ipid;
+	u32 w, h, pfmt, bps, nb_planes;
+	u32 src_stride[3], src_uv_height;
+	//chroma subsampling shifts
+	u32 cx, cy;
+	Bool passthrough;
+
+	VLadderRung *ladder;
+	u32 nb_rungs;
+
+	GF_WorkerPool *pool;
+	//one per pool thread, the first one being the filter thread
+	VLadderWorker *workers;
+	u32 nb_workers;
+	VLadderJob job;
+} GF_VLadderCtx;
+
+
+static void vladder_filter_init(VLadderFilter *f, u32 src_size, u32 dst_size)
+{
+	u32 i, j, max_j;
+	Double *w;
+	Double scale = (Double) src_size / dst_size;
+	//triangle kernel stretched by the downscale factor, bilinear when upscaling
+	Double radius = (scale>1) ? scale : 1;
+
+	f->taps = (u32) ceil(2*radius) + 1;
+	if (f->taps > src_size) f->taps = src_size;
+	f->pos = gf_realloc(f->pos, sizeof(u32) * dst_size);
+	f->coefs = gf_realloc(f->coefs, sizeof(u16) * dst_size * f->taps);
+	w = gf_malloc(sizeof(Double) * f->taps);
+
+	for (i=0; i<dst_size; i++) {
+		s32 k, first, win;
+		u32 total = 0;
+		Double sum = 0;
+		u16 *c = f->coefs + i * f->taps;
+		Double center = (i + 0.5) * scale - 0.5;
+
+		first = (s32) floor(center - radius) + 1;
+		//keep the window in the source, weights of samples outside are moved to the edge samples
+		win = first;
+		if (win + (s32) f->taps > (s32) src_size) win = src_size - f->taps;
+		if (win < 0) win = 0;
+
+		memset(w, 0, sizeof(Double) * f->taps);
+		for (k=first; k<first + (s32) f->taps; k++) {
+			s32 idx = k;
+			Double wt = 1 - fabs(k - center) / radius;
+			if (wt <= 0) continue;
+			if (idx < 0) idx = 0;
+			else if (idx >= (s32) src_size) idx = src_size-1;
+			w[idx - win] += wt;
+			sum += wt;
+		}
+		max_j = 0;
+		for (j=0; j<f->taps; j++) {
+			c[j] = (u16) (w[j] * (1<<VLADDER_COEF_BITS) / sum);
+			total += c[j];
+			if (c[j] > c[max_j]) max_j = j;
+		}
+		//rounding errors go to the main tap
+		c[max_j] += (1<<VLADDER_COEF_BITS) - total;
+		f->pos[i] = win;
+	}
+	gf_free(w);
+}
+
+static void vladder_filter_reset(VLadderFilter *f)
+{
+	if (f->pos) gf_free(f->pos);
+	if (f->coefs) gf_free(f->coefs);
+	memset(f, 0, sizeof(VLadderFilter));
+}
+
+static void vladder_scaler_init(VLadderScaler *sc, u32 src_w, u32 src_h, u32 dst_w, u32 dst_h)
+{
+	if ((sc->src_w==src_w) && (sc->src_h==src_h) && (sc->dst_w==dst_w) && (sc->dst_h==dst_h))
+		return;
+	sc->src_w = src_w;
+	sc->src_h = src_h;
+	sc->dst_w = dst_w;
+	sc->dst_h = dst_h;
+	vladder_filter_init(&sc->hf, src_w, dst_w);
+	vladder_filter_init(&sc->vf, src_h, dst_h);
+}
+
+static void vladder_scale_rows(VLadderJob *job, VLadderWorker *worker, u32 y_start, u32 y_end)
+{
+	u32 x, y, k;
+	VLadderScaler *sc = job->sc;
+	u32 *tmp;
+
+	if (worker->tmp_size < sc->src_w) {
+		worker->tmp = gf_realloc(worker->tmp, sizeof(u32) * sc->src_w);
+		worker->tmp_size = sc->src_w;
+	}
+	tmp = worker->tmp;
+
+	for (y=y_start; y<y_end; y++) {
+		const u16 *vc = sc->vf.coefs + y * sc->vf.taps;
+		const u8 *src = job->src + sc->vf.pos[y] * job->src_stride;
+		u8 *dst = job->dst + y * job->dst_stride;
+
+		//vertical pass, keeping 6 bits of extra precision
+		memset(tmp, 0, sizeof(u32) * sc->src_w);
+		for (k=0; k<sc->vf.taps; k++) {
+			u32 c = vc[k];
+			if (c) {
+				if (job->bps==1) {
+					for (x=0; x<sc->src_w; x++) tmp[x] += src[x] * c;
+				} else {
+					const u16 *src16 = (const u16 *) src;
+					for (x=0; x<sc->src_w; x++) tmp[x] += src16[x] * c;
+				}
+			}
+			src += job->src_stride;
+		}
+		for (x=0; x<sc->src_w; x++)
+			tmp[x] = (tmp[x] + (1<<(VLADDER_COEF_BITS-7))) >> (VLADDER_COEF_BITS-6);
+
+		//horizontal pass
+		for (x=0; x<sc->dst_w; x++) {
+			u32 acc = 0;
+			const u16 *hc = sc->hf.coefs + x * sc->hf.taps;
+			const u32 *t = tmp + sc->hf.pos[x];
+			for (k=0; k<sc->hf.taps; k++)
+				acc += t[k] * hc[k];
+
+			acc = (acc + (1<<(VLADDER_COEF_BITS+5))) >> (VLADDER_COEF_BITS+6);
+			if (job->bps==1) dst[x] = (u8) acc;
+			else ((u16 *)dst)[x] = (u16) acc;
+		}
+	}
+}
+
+static void vladder_scale_band(void *udta, u32 worker_idx, u32 band)
+{
+	u32 y_start, y_end;
+	GF_VLadderCtx *ctx = (GF_VLadderCtx *) udta;
+
+	y_start = band * VLADDER_BAND_ROWS;
+	y_end = y_start + VLADDER_BAND_ROWS;
+	if (y_end > ctx->job.sc->dst_h) y_end = ctx->job.sc->dst_h;
+	vladder_scale_rows(&ctx->job, &ctx->workers[worker_idx], y_start, y_end);
+}
+
+static void vladder_scale_plane(GF_VLadderCtx *ctx, VLadderScaler *sc, const u8 *src, u32 src_stride, u8 *dst, u32 dst_stride)
+{
+	ctx->job.src = src;
+	ctx->job.src_stride = src_stride;
+	ctx->job.dst = dst;
+	ctx->job.dst_stride = dst_stride;
+	ctx->job.sc = sc;
+	ctx->job.bps = ctx->bps;
+	//bands are shared between the pool threads and the filter thread
+	gf_worker_pool_run(ctx->pool, (sc->dst_h + VLADDER_BAND_ROWS - 1) / VLADDER_BAND_ROWS, vladder_scale_band, ctx);
+}
+
+static GF_Err vladder_process(GF_Filter *filter)
+{
+	const u8 *data;
+	u32 i, j, size;
+	const u8 *src_planes[3];
+	u32 src_stride[3];
+	GF_FilterFrameInterface *frame_ifce;
+	GF_VLadderCtx *ctx = gf_filter_get_udta(filter);
+	GF_FilterPacket *pck = gf_filter_pid_get_packet(ctx->ipid);
+
+	if (!pck) {
+		if (gf_filter_pid_is_eos(ctx->ipid)) {
+			for (i=0; i<ctx->nb_rungs; i++)
+				gf_filter_pid_set_eos(ctx->ladder[i].opid);
+			return GF_EOS;
+		}
+		return GF_OK;
+	}
+	//all renditions of a frame are produced at once, wait for all outputs
+	for (i=0; i<ctx->nb_rungs; i++) {
+		if (gf_filter_pid_would_block(ctx->ladder[i].opid))
+			return GF_OK;
+	}
+
+	if (ctx->passthrough) {
+		for (i=0; i<ctx->nb_rungs; i++)
+			gf_filter_pck_forward(pck, ctx->ladder[i].opid);
+		gf_filter_pid_drop_packet(ctx->ipid);
+		return GF_OK;
+	}
+
+	memset(src_planes, 0, sizeof(src_planes));
+	data = gf_filter_pck_get_data(pck, &size);
+	frame_ifce = gf_filter_pck_get_frame_interface(pck);
+	if (data) {
+		src_planes[0] = data;
+		src_stride[0] = ctx->src_stride[0];
+		for (i=1; i<ctx->nb_planes; i++) {
+			src_planes[i] = src_planes[i-1] + src_stride[i-1] * ((i==1) ? ctx->h : ctx->src_uv_height);
+			src_stride[i] = ctx->src_stride[i];
+		}
+	} else if (frame_ifce && frame_ifce->get_plane) {
+		for (i=0; i<ctx->nb_planes; i++) {
+			if (frame_ifce->get_plane(frame_ifce, i, &src_planes[i], &src_stride[i]) != GF_OK) {
+				GF_LOG(GF_LOG_ERROR, GF_LOG_MEDIA, ("[VLadder] Failed to fetch plane %d of frame\n", i));
+				gf_filter_pid_drop_packet(ctx->ipid);
+				return GF_IO_ERR;
+			}
+		}
+	} else {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_MEDIA, ("[VLadder] No data associated with packet, not supported\n"));
+		gf_filter_pid_drop_packet(ctx->ipid);
+		return GF_NOT_SUPPORTED;
+	}
+
+	for (i=0; i<ctx->nb_rungs; i++) {
+		u8 *output;
+		u64 clock;
+		const u8 **planes;
+		u32 *strides;
+		VLadderRung *rung = &ctx->ladder[i];
+
+		if (rung->forward) {
+			//same size as input, hand over the input frame
+			gf_filter_pck_forward(pck, rung->opid);
+			for (j=0; j<ctx->nb_planes; j++) {
+				rung->planes[j] = src_planes[j];
+				rung->plane_stride[j] = src_stride[j];
+			}
+			rung->nb_frames++;
+			continue;
+		}
+
+		rung->pck = gf_filter_pck_new_alloc(rung->opid, rung->out_size, &output);
+		if (!rung->pck) {
+			for (j=0; j<i; j++) {
+				if (ctx->ladder[j].pck) gf_filter_pck_discard(ctx->ladder[j].pck);
+				ctx->ladder[j].pck = NULL;
+			}
+			return GF_OUT_OF_MEM;
+		}
+		gf_filter_pck_merge_properties(pck, rung->pck);
+
+		rung->planes[0] = output;
+		for (j=1; j<ctx->nb_planes; j++)
+			rung->planes[j] = rung->planes[j-1] + rung->stride[j-1] * ((j==1) ? rung->height : rung->uv_height);
+		for (j=0; j<ctx->nb_planes; j++)
+			rung->plane_stride[j] = rung->stride[j];
+
+		if (rung->src_idx<0) {
+			planes = src_planes;
+			strides = src_stride;
+		} else {
+			planes = ctx->ladder[rung->src_idx].planes;
+			strides = ctx->ladder[rung->src_idx].plane_stride;
+		}
+
+		clock = gf_sys_clock_high_res();
+		for (j=0; j<ctx->nb_planes; j++) {
+			vladder_scale_plane(ctx, &rung->sc[j ? 1 : 0], planes[j], strides[j], (u8 *) rung->planes[j], rung->stride[j]);
+		}
+		rung->time_spent += gf_sys_clock_high_res() - clock;
+		rung->nb_frames++;
+	}
+
+	//send once all rungs are done, since lower rungs may be scaled from upper ones
+	for (i=0; i<ctx->nb_rungs; i++) {
+		if (!ctx->ladder[i].pck) continue;
+		gf_filter_pck_send(ctx->ladder[i].pck);
+		ctx->ladder[i].pck = NULL;
+	}
+	gf_filter_pid_drop_packet(ctx->ipid);
+	return GF_OK;
+}
+
+static void vladder_reset_rung(VLadderRung *rung)
+{
+	vladder_filter_reset(&rung->sc[0].hf);
+	vladder_filter_reset(&rung->sc[0].vf);
+	vladder_filter_reset(&rung->sc[1].hf);
+	vladder_filter_reset(&rung->sc[1].vf);
+}
+
+static GF_Err vladder_setup_rung(GF_VLadderCtx *ctx, VLadderRung *rung, u32 height)
+{
+	u32 src_w, src_h;
+
+	rung->height = height;
+	rung->width = (u32) ((u64) ctx->w * height / ctx->h);
+	if (ctx->cx || ctx->cy) {
+		rung->width = (rung->width + 1) & ~1;
+		rung->height = (rung->height + 1) & ~1;
+	}
+	if (!rung->width) rung->width = ctx->cx ? 2 : 1;
+
+	rung->forward = ((rung->width==ctx->w) && (rung->height==ctx->h)) ? GF_TRUE : GF_FALSE;
+
+	rung->stride[0] = rung->stride[1] = 0;
+	if (!gf_pixel_get_size_info(ctx->pfmt, rung->width, rung->height, &rung->out_size, &rung->stride[0], &rung->stride[1], &rung->nb_planes, &rung->uv_height)) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_MEDIA, ("[VLadder] Failed to query output pixel format characteristics\n"));
+		return GF_NOT_SUPPORTED;
+	}
+	rung->stride[2] = rung->stride[1];
+
+	if (rung->src_idx<0) {
+		src_w = ctx->w;
+		src_h = ctx->h;
+	} else {
+		src_w = ctx->ladder[rung->src_idx].width;
+		src_h = ctx->ladder[rung->src_idx].height;
+	}
+	if (!rung->forward) {
+		vladder_scaler_init(&rung->sc[0], src_w, src_h, rung->width, rung->height);
+		if (ctx->nb_planes>1)
+			vladder_scaler_init(&rung->sc[1], (src_w + ctx->cx) >> ctx->cx, (src_h + ctx->cy) >> ctx->cy, (rung->width + ctx->cx) >> ctx->cx, (rung->height + ctx->cy) >> ctx->cy);
+	}
+
+	gf_filter_pid_set_property(rung->opid, GF_PROP_PID_WIDTH, &PROP_UINT(rung->width));
+	gf_filter_pid_set_property(rung->opid, GF_PROP_PID_HEIGHT, &PROP_UINT(rung->height));
+	gf_filter_pid_set_property(rung->opid, GF_PROP_PID_STRIDE, &PROP_UINT(rung->forward ? ctx->src_stride[0] : rung->stride[0]));
+	if (ctx->nb_planes>1)
+		gf_filter_pid_set_property(rung->opid, GF_PROP_PID_STRIDE_UV, &PROP_UINT(rung->forward ? ctx->src_stride[1] : rung->stride[1]));
+
+	GF_LOG(GF_LOG_INFO, GF_LOG_MEDIA, ("[VLadder] Rung %dx%d %s %dx%d\n", rung->width, rung->height, rung->forward ? "forwarded from" : "scaled from", src_w, src_h));
+	return GF_OK;
+}
+
+static int vladder_sort_heights(const void *a, const void *b)
+{
+	u32 ha = *(const u32 *)a;
+	u32 hb = *(const u32 *)b;
+	if (ha==hb) return 0;
+	return (ha>hb) ? -1 : 1;
+}
+
+static GF_Err vladder_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool is_remove)
+{
+	GF_Err e;
+	const GF_PropertyValue *p;
+	u32 i, w, h, pfmt, stride, stride_uv, size, nb_rungs;
+	u32 *heights;
+	GF_VLadderCtx *ctx = gf_filter_get_udta(filter);
+
+	if (is_remove) {
+		for (i=0; i<ctx->nb_rungs; i++) {
+			if (ctx->ladder[i].opid) gf_filter_pid_remove(ctx->ladder[i].opid);
+		}
+		return GF_OK;
+	}
+	if (! gf_filter_pid_check_caps(pid))
+		return GF_NOT_SUPPORTED;
+
+	ctx->ipid = pid;
+	w = h = pfmt = stride = stride_uv = 0;
+	p = gf_filter_pid_get_property(pid, GF_PROP_PID_WIDTH);
+	if (p) w = p->value.uint;
+	p = gf_filter_pid_get_property(pid, GF_PROP_PID_HEIGHT);
+	if (p) h = p->value.uint;
+	p = gf_filter_pid_get_property(pid, GF_PROP_PID_PIXFMT);
+	if (p) pfmt = p->value.uint;
+	p = gf_filter_pid_get_property(pid, GF_PROP_PID_STRIDE);
+	if (p) stride = p->value.uint;
+	p = gf_filter_pid_get_property(pid, GF_PROP_PID_STRIDE_UV);
+	if (p) stride_uv = p->value.uint;
+
+	if (!w || !h || !pfmt) return GF_OK;
+
+	ctx->cx = ctx->cy = 0;
+	ctx->bps = 1;
+	switch (pfmt) {
+	case GF_PIXEL_YUV_10:
+		ctx->bps = 2;
+	case GF_PIXEL_YUV:
+		ctx->cx = ctx->cy = 1;
+		break;
+	case GF_PIXEL_YUV422_10:
+		ctx->bps = 2;
+	case GF_PIXEL_YUV422:
+		ctx->cx = 1;
+		break;
+	case GF_PIXEL_YUV444_10:
+		ctx->bps = 2;
+	case GF_PIXEL_YUV444:
+	case GF_PIXEL_GREYSCALE:
+		break;
+	default:
+		GF_LOG(GF_LOG_ERROR, GF_LOG_MEDIA, ("[VLadder] Pixel format %s not supported, only planar YUV and greyscale are\n", gf_pixel_fmt_name(pfmt) ));
+		return GF_NOT_SUPPORTED;
+	}
+	ctx->w = w;
+	ctx->h = h;
+	ctx->pfmt = pfmt;
+	ctx->src_stride[0] = stride;
+	ctx->src_stride[1] = stride_uv;
+	if (!gf_pixel_get_size_info(pfmt, w, h, &size, &ctx->src_stride[0], &ctx->src_stride[1], &ctx->nb_planes, &ctx->src_uv_height)) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_MEDIA, ("[VLadder] Failed to query source pixel format characteristics\n"));
+		return GF_NOT_SUPPORTED;
+	}
+	ctx->src_stride[2] = ctx->src_stride[1];
+
+	//rungs larger than the source are ignored, duplicates removed
+	heights = gf_malloc(sizeof(u32) * (ctx->rungs.nb_items + 1));
+	nb_rungs = 0;
+	for (i=0; i<ctx->rungs.nb_items; i++) {
+		if (!ctx->rungs.vals[i]) continue;
+		if (ctx->rungs.vals[i] > h) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_MEDIA, ("[VLadder] Rung height %d larger than source height %d, ignoring\n", ctx->rungs.vals[i], h));
+			continue;
+		}
+		heights[nb_rungs++] = ctx->rungs.vals[i];
+	}
+	ctx->passthrough = GF_FALSE;
+	if (!nb_rungs) {
+		heights[nb_rungs++] = h;
+		ctx->passthrough = GF_TRUE;
+	}
+	qsort(heights, nb_rungs, sizeof(u32), vladder_sort_heights);
+	for (i=1; i<nb_rungs; i++) {
+		if (heights[i]==heights[i-1]) {
+			memmove(&heights[i-1], &heights[i], sizeof(u32) * (nb_rungs-i));
+			nb_rungs--;
+			i--;
+		}
+	}
+
+	//remove outputs no longer used, create new ones
+	for (i=nb_rungs; i<ctx->nb_rungs; i++) {
+		if (ctx->ladder[i].opid) gf_filter_pid_remove(ctx->ladder[i].opid);
+		vladder_reset_rung(&ctx->ladder[i]);
+	}
+	if (nb_rungs > ctx->nb_rungs) {
+		ctx->ladder = gf_realloc(ctx->ladder, sizeof(VLadderRung) * nb_rungs);
+		memset(&ctx->ladder[ctx->nb_rungs], 0, sizeof(VLadderRung) * (nb_rungs - ctx->nb_rungs));
+	}
+	ctx->nb_rungs = nb_rungs;
+
+	e = GF_OK;
+	for (i=0; i<nb_rungs; i++) {
+		VLadderRung *rung = &ctx->ladder[i];
+		if (!rung->opid)
+			rung->opid = gf_filter_pid_new(filter);
+		//copy properties at init or reconfig
+		gf_filter_pid_copy_properties(rung->opid, pid);
+		//cascade from the previous rung, the first one is scaled from the source
+		rung->src_idx = (ctx->cascade && i) ? (s32) i-1 : -1;
+		e = vladder_setup_rung(ctx, rung, heights[i]);
+		if (e) break;
+	}
+	gf_free(heights);
+
+	//an access unit corresponds to a single packet
+	gf_filter_pid_set_framing_mode(pid, GF_TRUE);
+	return e;
+}
+
+static GF_Err vladder_initialize(GF_Filter *filter)
+{
+	GF_VLadderCtx *ctx = gf_filter_get_udta(filter);
+
+	ctx->pool = gf_worker_pool_new(ctx->nbth, "VLadder");
+	if (!ctx->pool) return GF_OUT_OF_MEM;
+	ctx->nb_workers = 1 + gf_worker_pool_get_thread_count(ctx->pool);
+	ctx->workers = gf_malloc(sizeof(VLadderWorker) * ctx->nb_workers);
+	if (!ctx->workers) return GF_OUT_OF_MEM;
+	memset(ctx->workers, 0, sizeof(VLadderWorker) * ctx->nb_workers);
+	return GF_OK;
+}
+
+static void vladder_finalize(GF_Filter *filter)
+{
+	u32 i;
+	GF_VLadderCtx *ctx = gf_filter_get_udta(filter);
+
+	if (ctx->pool) gf_worker_pool_del(ctx->pool);
+	for (i=0; i<ctx->nb_workers; i++) {
+		if (ctx->workers[i].tmp) gf_free(ctx->workers[i].tmp);
+	}
+	if (ctx->workers) gf_free(ctx->workers);
+
+	for (i=0; i<ctx->nb_rungs; i++) {
+		VLadderRung *rung = &ctx->ladder[i];
+		if (rung->nb_frames && !rung->forward) {
+			GF_LOG(GF_LOG_INFO, GF_LOG_MEDIA, ("[VLadder] Rung %dx%d: "LLU" frames scaled in "LLU" us ("LLU" us per frame)\n", rung->width, rung->height, rung->nb_frames, rung->time_spent, rung->time_spent / rung->nb_frames));
+		}
+		vladder_reset_rung(rung);
+	}
+	if (ctx->ladder) gf_free(ctx->ladder);
+}
+
+
+#define OFFS(_n)	#_n, offsetof(GF_VLadderCtx, _n)
+static GF_FilterArgs VLadderArgs[] =
+{
+	{ OFFS(rungs), "heights of the output renditions. Widths keep the source aspect ratio. Heights larger than the source are ignored", GF_PROP_UINT_LIST, "1080,720,540,360", NULL, 0},
+	{ OFFS(cascade), "scale each rendition from the next larger one rather than from the source", GF_PROP_BOOL, "true", NULL, GF_FS_ARG_HINT_ADVANCED},
+	{ OFFS(nbth), "number of scaling threads besides the filter thread. " GF_WORKER_POOL_NBTH_HELP, GF_PROP_SINT, "-1", NULL, GF_FS_ARG_HINT_ADVANCED},
+	{0}
+};
+
+static const GF_FilterCapability VLadderCaps[] =
+{
+	CAP_UINT(GF_CAPS_INPUT_OUTPUT,GF_PROP_PID_STREAM_TYPE, GF_STREAM_VISUAL),
+	CAP_UINT(GF_CAPS_INPUT_OUTPUT,GF_PROP_PID_CODECID, GF_CODECID_RAW)
+};
+
+GF_FilterRegister VLadderRegister = {
+	.name = "vladder",
+	GF_FS_SET_DESCRIPTION("Video ladder")
+	GF_FS_SET_HELP("This filter scales one raw video input into several renditions, typically to feed the encoders of an adaptive bitrate ladder.\n"
+	"Each rendition is output on its own PID. Renditions with the source size forward the source frames without copy.\n"
+	"\n"
+	"By default, each rendition is scaled from the next larger one (e.g. 2160p to 1080p to 720p), which costs much less than scaling all renditions from the source.\n"
+	"Each frame is scaled by horizontal bands shared between the filter thread and [-nbth]() extra threads.\n"
+	"\n"
+	"Only planar YUV (420, 422 and 444, 8 and 10 bits) and greyscale inputs are supported.\n"
+	"EX gpac -i src.yuv:size=3840x2160 vladder:rungs=2160,1080,720 @ enc:c=avc @ -o dst.mpd\n"
+	)
+	.private_size = sizeof(GF_VLadderCtx),
+	.flags = GF_FS_REG_EXPLICIT_ONLY,
+	.args = VLadderArgs,
+	.initialize = vladder_initialize,
+	.finalize = vladder_finalize,
+	.configure_pid = vladder_configure_pid,
+	SETCAPS(VLadderCaps),
+	.process = vladder_process,
+};
+
+
+const GF_FilterRegister *vladder_register(GF_FilterSession *session)
+{
+	return &VLadderRegister;
+}
@@ -35,6 +35,7 @@ void co64_box_del(GF_Box *s)
 	ptr = (GF_ChunkLargeOffsetBox *) s;
 	if (ptr == NULL) return;
 	if (ptr->offsets) gf_free(ptr->offsets);
+	if (ptr->dtab) stbl_dtab_del(ptr->dtab);
 	gf_free(ptr);
 }
 
@@ -78,6 +79,15 @@ GF_Err co64_box_write(GF_Box *s, GF_BitStream *bs)
 	e = gf_isom_full_box_write(s, bs);
 	if (e) return e;
 	gf_bs_write_u32(bs, ptr->nb_entries);
+	if (ptr->dtab) {
+		for (i = 0; i < ptr->nb_entries; i++ ) {
+			u64 offset;
+			e = stbl_dtab_get(ptr->dtab, i, &offset);
+			if (e) return e;
+			gf_bs_write_u64(bs, offset);
+		}
+		return GF_OK;
+	}
 	for (i = 0; i < ptr->nb_entries; i++ ) {
 		gf_bs_write_u64(bs, ptr->offsets[i]);
 	}
@@ -5088,6 +5098,7 @@ void stco_box_del(GF_Box *s)
 	GF_ChunkOffsetBox *ptr = (GF_ChunkOffsetBox *)s;
 	if (ptr == NULL) return;
 	if (ptr->offsets) gf_free(ptr->offsets);
+	if (ptr->dtab) stbl_dtab_del(ptr->dtab);
 	gf_free(ptr);
 }
 
@@ -5134,6 +5145,15 @@ GF_Err stco_box_write(GF_Box *s, GF_BitStream *bs)
 	e = gf_isom_full_box_write(s, bs);
 	if (e) return e;
 	gf_bs_write_u32(bs, ptr->nb_entries);
+	if (ptr->dtab) {
+		for (i = 0; i < ptr->nb_entries; i++) {
+			u64 offset;
+			e = stbl_dtab_get(ptr->dtab, i, &offset);
+			if (e) return e;
+			gf_bs_write_u32(bs, (u32) offset);
+		}
+		return GF_OK;
+	}
 	for (i = 0; i < ptr->nb_entries; i++) {
 		gf_bs_write_u32(bs, ptr->offsets[i]);
 	}
@@ -5525,6 +5545,7 @@ void stsz_box_del(GF_Box *s)
 	GF_SampleSizeBox *ptr = (GF_SampleSizeBox *)s;
 	if (ptr == NULL) return;
 	if (ptr->sizes) gf_free(ptr->sizes);
+	if (ptr->dtab) stbl_dtab_del(ptr->dtab);
 	gf_free(ptr);
 }
 
@@ -5661,7 +5682,14 @@ GF_Err stsz_box_write(GF_Box *s, GF_BitStream *bs)
 	gf_bs_write_u32(bs, ptr->sampleCount);
 
 	if (ptr->type == GF_ISOM_BOX_TYPE_STSZ) {
-		if (! ptr->sampleSize) {
+		if (! ptr->sampleSize && ptr->dtab && stbl_dtab_count(ptr->dtab)) {
+			for (i = 0; i < ptr->sampleCount; i++) {
+				u64 size;
+				e = stbl_dtab_get(ptr->dtab, i, &size);
+				if (e) return e;
+				gf_bs_write_u32(bs, (u32) size);
+			}
+		} else if (! ptr->sampleSize) {
 			for (i = 0; i < ptr->sampleCount; i++) {
 				gf_bs_write_u32(bs, ptr->sizes ? ptr->sizes[i] : 0);
 			}
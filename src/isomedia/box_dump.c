@@ -1027,7 +1027,13 @@ GF_Err stsz_box_dump(GF_Box *a, FILE * trace)
 	gf_fprintf(trace, ">\n");
 
 	if ((a->type != GF_ISOM_BOX_TYPE_STSZ) || !p->sampleSize) {
-		if (!p->sizes && p->size) {
+		if (p->dtab) {
+			for (i=0; i<p->sampleCount; i++) {
+				u64 size;
+				if (stbl_dtab_get(p->dtab, i, &size)) break;
+				gf_fprintf(trace, "<SampleSizeEntry Size=\"%d\"/>\n", (u32) size);
+			}
+		} else if (!p->sizes && p->size) {
 			gf_fprintf(trace, "<!--WARNING: No Sample Size indications-->\n");
 		} else if (p->sizes) {
 			for (i=0; i<p->sampleCount; i++) {
@@ -1054,7 +1060,13 @@ GF_Err stco_box_dump(GF_Box *a, FILE * trace)
 	gf_isom_box_dump_start(a, "ChunkOffsetBox", trace);
 	gf_fprintf(trace, "EntryCount=\"%d\">\n", p->nb_entries);
 
-	if (!p->offsets && p->size) {
+	if (p->dtab) {
+		for (i=0; i<p->nb_entries; i++) {
+			u64 offset;
+			if (stbl_dtab_get(p->dtab, i, &offset)) break;
+			gf_fprintf(trace, "<ChunkEntry offset=\"%u\"/>\n", (u32) offset);
+		}
+	} else if (!p->offsets && p->size) {
 		gf_fprintf(trace, "<!--Warning: No Chunk Offsets indications-->\n");
 	} else if (p->offsets) {
 		for (i=0; i<p->nb_entries; i++) {
@@ -1195,7 +1207,13 @@ GF_Err co64_box_dump(GF_Box *a, FILE * trace)
 	gf_isom_box_dump_start(a, "ChunkLargeOffsetBox", trace);
 	gf_fprintf(trace, "EntryCount=\"%d\">\n", p->nb_entries);
 
-	if (!p->offsets && p->size) {
+	if (p->dtab) {
+		for (i=0; i<p->nb_entries; i++) {
+			u64 offset;
+			if (stbl_dtab_get(p->dtab, i, &offset)) break;
+			gf_fprintf(trace, "<ChunkOffsetEntry offset=\""LLU"\"/>\n", offset);
+		}
+	} else if (!p->offsets && p->size) {
 		gf_fprintf(trace, "<!-- Warning: No Chunk Offsets indications/>\n");
 	} else if (p->offsets) {
 		for (i=0; i<p->nb_entries; i++)
@@ -1464,7 +1464,8 @@ void gf_isom_registry_disable(u32 boxCode, Bool disable)
 static u32 get_box_reg_idx(u32 boxCode, u32 parent_type, u32 start_from)
 {
 	u32 i=0, count = gf_isom_get_num_supported_boxes();
-	const char *parent_name = parent_type ? gf_4cc_to_str(parent_type) : NULL;
+	char szParent[GF_4CC_MSIZE];
+	const char *parent_name = parent_type ? gf_4cc_to_str_safe(parent_type, szParent) : NULL;
 
 	if (!start_from) start_from = 1;
 
@@ -1594,9 +1595,10 @@ GF_Err gf_isom_box_array_read_ex(GF_Box *parent, GF_BitStream *bs, GF_Err (*chec
 		//check container validity
 		if (strlen(a->registry->parents_4cc)) {
 			Bool parent_OK = GF_FALSE;
-			const char *parent_code = gf_4cc_to_str(parent->type);
+			char szParent[GF_4CC_MSIZE];
+			const char *parent_code = gf_4cc_to_str_safe(parent->type, szParent);
 			if (parent->type == GF_ISOM_BOX_TYPE_UNKNOWN)
-				parent_code = gf_4cc_to_str( ((GF_UnknownBox*)parent)->original_4cc );
+				parent_code = gf_4cc_to_str_safe( ((GF_UnknownBox*)parent)->original_4cc, szParent);
 			if (strstr(a->registry->parents_4cc, parent_code) != NULL) {
 				parent_OK = GF_TRUE;
 			} else if (!strcmp(a->registry->parents_4cc, "*") || strstr(a->registry->parents_4cc, "* ") || strstr(a->registry->parents_4cc, " *")) {
@@ -407,6 +407,8 @@ GF_DataMap *gf_isom_fdm_new(const char *sPath, u8 mode)
 			gf_free(tmp);
 			return NULL;
 		}
+		//remember blob URL for in-place refresh
+		tmp->szName = gf_strdup(sPath);
 		return (GF_DataMap *)tmp;
 	}
 
@@ -482,6 +484,21 @@ void gf_isom_fdm_del(GF_FileDataMap *ptr)
 	gf_free(ptr);
 }
 
+GF_Err gf_isom_datamap_refresh_blob(GF_DataMap *map, const char *location)
+{
+	u8 *mem_address;
+	u32 size;
+	if (!map || !location || (map->type != GF_ISOM_DATA_FILE) || !map->szName) return GF_NOT_SUPPORTED;
+	if (((GF_FileDataMap *)map)->stream) return GF_NOT_SUPPORTED;
+	if (strncmp(location, "gmem://", 7) || strcmp(map->szName, location)) return GF_NOT_SUPPORTED;
+
+	if (gf_blob_get_data(location, &mem_address, &size) != GF_OK)
+		return GF_BAD_PARAM;
+	//blob data may have been moved or reallocated, position is reset as for a new map
+	map->curPos = 0;
+	return gf_bs_reassign_buffer(map->bs, mem_address, size);
+}
+
 u32 gf_isom_fdm_get_data(GF_FileDataMap *ptr, u8 *buffer, u32 bufferLength, u64 fileOffset)
 {
 	u32 bytesRead;
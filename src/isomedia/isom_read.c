@@ -2822,6 +2822,11 @@ GF_Err gf_isom_refresh_fragmented(GF_ISOFile *movie, u64 *MissingBytes, const ch
 	/*refresh size*/
 	size = movie->movieFileMap ? gf_bs_get_size(movie->movieFileMap->bs) : 0;
 
+	//same memory blob, only update the current map rather than recreating it
+	if (new_location && (gf_isom_datamap_refresh_blob(movie->movieFileMap, new_location)==GF_OK)) {
+		new_location = NULL;
+	}
+
 	if (new_location) {
 		Bool delete_map;
 		GF_DataMap *previous_movie_fileMap_address = movie->movieFileMap;
@@ -2926,6 +2931,8 @@ GF_Err gf_isom_purge_samples(GF_ISOFile *the_file, u32 trackNumber, u32 nb_sampl
 	if (!trex) return GF_BAD_PARAM;
 
 	//first unpack chunk offsets and CTS
+	e = stbl_UnpackDeltaTables(trak->Media->information->sampleTable);
+	if (e) return e;
 	e = stbl_UnpackOffsets(trak->Media->information->sampleTable);
 	if (e) return e;
 	e = stbl_unpackCTS(trak->Media->information->sampleTable);
@@ -3668,6 +3675,14 @@ u64 gf_isom_get_media_data_size(GF_ISOFile *movie, u32 trackNumber)
 	if (!stsz) return 0;
 	if (stsz->sampleSize) return stsz->sampleSize*stsz->sampleCount;
 	size = 0;
+	if (stsz->dtab) {
+		for (i=0; i<stsz->sampleCount; i++) {
+			u64 samp_size;
+			if (stbl_dtab_get(stsz->dtab, i, &samp_size)) break;
+			size += samp_size;
+		}
+		return size;
+	}
 	for (i=0; i<stsz->sampleCount; i++) size += stsz->sizes[i];
 	return size;
 }
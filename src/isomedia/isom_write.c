@@ -45,6 +45,8 @@ static GF_Err unpack_track(GF_TrackBox *trak)
 {
 	GF_Err e = GF_OK;
 	if (!trak->is_unpacked) {
+		e = stbl_UnpackDeltaTables(trak->Media->information->sampleTable);
+		if (e) return e;
 		e = stbl_UnpackOffsets(trak->Media->information->sampleTable);
 		if (e) return e;
 		e = stbl_unpackCTS(trak->Media->information->sampleTable);
@@ -53,6 +55,31 @@ static GF_Err unpack_track(GF_TrackBox *trak)
 	return e;
 }
 
+/*tracks created in packed sample table mode keep their packed tables as long as samples are appended,
+and are unpacked as soon as a sample is inserted*/
+static GF_Err prepare_track_append(GF_ISOFile *movie, GF_TrackBox *trak, u64 DTS)
+{
+	GF_SampleTableBox *stbl = trak->Media->information->sampleTable;
+
+	if (!trak->is_unpacked && movie->stbl_mode && !stbl->SampleSize->sampleCount && !stbl->SampleSize->dtab
+		&& (stbl->SampleSize->type == GF_ISOM_BOX_TYPE_STSZ) && stbl->ChunkOffset && (stbl->ChunkOffset->type == GF_ISOM_BOX_TYPE_STCO)
+	) {
+		GF_ChunkOffsetBox *stco = (GF_ChunkOffsetBox *) stbl->ChunkOffset;
+		Bool use_tmp = (movie->stbl_mode == GF_ISOM_STBL_PACKED_TMP) ? GF_TRUE : GF_FALSE;
+		if (!stco->nb_entries && !stbl->SampleToChunk->nb_entries) {
+			stbl->SampleSize->dtab = stbl_dtab_new(use_tmp);
+			if (!stbl->SampleSize->dtab) return GF_OUT_OF_MEM;
+			stco->dtab = stbl_dtab_new(use_tmp);
+			if (!stco->dtab) return GF_OUT_OF_MEM;
+		}
+	}
+	if (stbl->SampleSize->dtab) {
+		if (!stbl->SampleSize->sampleCount || (DTS >= stbl->TimeToSample->w_LastDTS))
+			return GF_OK;
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[iso file] Inserting sample in track with packed sample tables, unpacking\n"));
+	}
+	return unpack_track(trak);
+}
 
 GF_Err FlushCaptureMode(GF_ISOFile *movie)
 {
@@ -970,7 +997,7 @@ GF_Err gf_isom_add_sample(GF_ISOFile *movie, u32 trackNumber, u32 StreamDescript
 	e = FlushCaptureMode(movie);
 	if (e) return e;
 
-	e = unpack_track(trak);
+	e = prepare_track_append(movie, trak, sample->DTS);
 	if (e) return e;
 
 	//OK, add the sample
@@ -2368,6 +2395,23 @@ GF_Err gf_isom_force_64bit_chunk_offset(GF_ISOFile *file, Bool set_on)
 	return GF_OK;
 }
 
+GF_EXPORT
+GF_Err gf_isom_set_sample_table_mode(GF_ISOFile *file, GF_ISOSampleTableMode stbl_mode)
+{
+	GF_Err e = CanAccessMovie(file, GF_ISOM_OPEN_WRITE);
+	if (e) return e;
+
+	switch (stbl_mode) {
+	case GF_ISOM_STBL_FLAT:
+	case GF_ISOM_STBL_PACKED:
+	case GF_ISOM_STBL_PACKED_TMP:
+		file->stbl_mode = stbl_mode;
+		return GF_OK;
+	default:
+		return GF_BAD_PARAM;
+	}
+}
+
 
 //update or insert a new edit segment in the track time line. Edits are used to modify
 //the media normal timing. EditTime and EditDuration are expressed in Movie TimeScale
@@ -3103,6 +3147,10 @@ GF_Err gf_isom_use_compact_size(GF_ISOFile *movie, u32 trackNumber, Bool Compact
 		return GF_ISOM_INVALID_FILE;
 
 	stsz = trak->Media->information->sampleTable->SampleSize;
+	if (stsz->dtab) {
+		e = unpack_track(trak);
+		if (e) return e;
+	}
 
 	//switch to regular table
 	if (!CompactionOn) {
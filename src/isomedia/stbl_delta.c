@@ -0,0 +1,237 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2020
+ *					All rights reserved
+ *
+ *  This file is part of GPAC / ISO Media File Format sub-project
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include <gpac/internal/isomedia_dev.h>
+
+#ifndef GPAC_DISABLE_ISOM
+
+/*values are coded by blocks: first value of the block as varint, then zigzag varint of the difference with the previous value*/
+#define DTAB_BLOCK_SIZE	1024
+/*max coded size of a block*/
+#define DTAB_MAX_CODED	(DTAB_BLOCK_SIZE*10)
+
+typedef struct
+{
+	//coded block, NULL if stored in temp file
+	u8 *data;
+	//position in temp file
+	u64 pos;
+	u32 size;
+} GF_DeltaBlock;
+
+struct __delta_table
+{
+	GF_DeltaBlock *blocks;
+	u32 nb_blocks, nb_alloc_blocks;
+
+	//values of the block being filled - never empty once a value is added, so that the last value can be modified
+	u64 values[DTAB_BLOCK_SIZE];
+	u32 nb_values;
+
+	//last decoded block
+	u64 cache[DTAB_BLOCK_SIZE];
+	s32 cache_block;
+
+	//temp file for coded blocks, NULL if kept in memory
+	FILE *tmp;
+
+	//first value, and whether all values except the last one are equal to it
+	u64 first;
+	Bool same_as_first;
+};
+
+GF_DeltaTable *stbl_dtab_new(Bool use_temp_file)
+{
+	GF_DeltaTable *dtab;
+	GF_SAFEALLOC(dtab, GF_DeltaTable);
+	if (!dtab) return NULL;
+	dtab->cache_block = -1;
+	if (use_temp_file) {
+		dtab->tmp = gf_file_temp(NULL);
+		if (!dtab->tmp) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[iso file] Failed to create temp file for sample tables, using memory\n"));
+		}
+	}
+	return dtab;
+}
+
+void stbl_dtab_reset(GF_DeltaTable *dtab)
+{
+	u32 i;
+	for (i=0; i<dtab->nb_blocks; i++) {
+		if (dtab->blocks[i].data) gf_free(dtab->blocks[i].data);
+	}
+	dtab->nb_blocks = 0;
+	dtab->nb_values = 0;
+	dtab->cache_block = -1;
+}
+
+void stbl_dtab_del(GF_DeltaTable *dtab)
+{
+	if (!dtab) return;
+	stbl_dtab_reset(dtab);
+	if (dtab->blocks) gf_free(dtab->blocks);
+	if (dtab->tmp) gf_fclose(dtab->tmp);
+	gf_free(dtab);
+}
+
+u32 stbl_dtab_count(GF_DeltaTable *dtab)
+{
+	return dtab->nb_blocks * DTAB_BLOCK_SIZE + dtab->nb_values;
+}
+
+static GFINLINE u32 dtab_write_varint(u8 *buf, u64 val)
+{
+	u32 size = 0;
+	while (val >= 0x80) {
+		buf[size++] = (u8) (val | 0x80);
+		val >>= 7;
+	}
+	buf[size++] = (u8) val;
+	return size;
+}
+
+static GFINLINE u64 dtab_read_varint(const u8 *buf, u32 *pos, u32 size)
+{
+	u64 val = 0;
+	u32 shift = 0;
+	while (*pos < size) {
+		u8 c = buf[*pos];
+		(*pos)++;
+		val |= ((u64) (c & 0x7F)) << shift;
+		if (!(c & 0x80)) break;
+		shift += 7;
+	}
+	return val;
+}
+
+static GF_Err dtab_flush_block(GF_DeltaTable *dtab)
+{
+	u8 coded[DTAB_MAX_CODED];
+	u32 i, size;
+	GF_DeltaBlock *blk;
+
+	size = dtab_write_varint(coded, dtab->values[0]);
+	for (i=1; i<dtab->nb_values; i++) {
+		s64 diff = (s64) (dtab->values[i] - dtab->values[i-1]);
+		size += dtab_write_varint(coded + size, ((u64) diff << 1) ^ (u64) (diff >> 63));
+	}
+
+	if (dtab->nb_blocks == dtab->nb_alloc_blocks) {
+		dtab->nb_alloc_blocks = dtab->nb_alloc_blocks ? 2*dtab->nb_alloc_blocks : 16;
+		dtab->blocks = gf_realloc(dtab->blocks, sizeof(GF_DeltaBlock) * dtab->nb_alloc_blocks);
+		if (!dtab->blocks) return GF_OUT_OF_MEM;
+	}
+	blk = &dtab->blocks[dtab->nb_blocks];
+	blk->size = size;
+	blk->pos = 0;
+	blk->data = NULL;
+	if (dtab->tmp) {
+		gf_fseek(dtab->tmp, 0, SEEK_END);
+		blk->pos = gf_ftell(dtab->tmp);
+		if (gf_fwrite(coded, size, dtab->tmp) != size) return GF_IO_ERR;
+	} else {
+		blk->data = gf_malloc(size);
+		if (!blk->data) return GF_OUT_OF_MEM;
+		memcpy(blk->data, coded, size);
+	}
+	dtab->nb_blocks++;
+	dtab->nb_values = 0;
+	return GF_OK;
+}
+
+GF_Err stbl_dtab_add(GF_DeltaTable *dtab, u64 val)
+{
+	if (!dtab->nb_values && !dtab->nb_blocks) {
+		dtab->first = val;
+		dtab->same_as_first = GF_TRUE;
+	} else if (dtab->nb_values && (dtab->values[dtab->nb_values-1] != dtab->first)) {
+		dtab->same_as_first = GF_FALSE;
+	}
+	if (dtab->nb_values == DTAB_BLOCK_SIZE) {
+		GF_Err e = dtab_flush_block(dtab);
+		if (e) return e;
+	}
+	dtab->values[dtab->nb_values] = val;
+	dtab->nb_values++;
+	return GF_OK;
+}
+
+void stbl_dtab_set_last(GF_DeltaTable *dtab, u64 val)
+{
+	if (!dtab->nb_values) return;
+	dtab->values[dtab->nb_values-1] = val;
+	//single value in table, it is also the first one
+	if ((dtab->nb_values==1) && !dtab->nb_blocks)
+		dtab->first = val;
+}
+
+Bool stbl_dtab_is_constant(GF_DeltaTable *dtab, u64 *val)
+{
+	if (!dtab->nb_values || !dtab->same_as_first) return GF_FALSE;
+	if (dtab->values[dtab->nb_values-1] != dtab->first) return GF_FALSE;
+	if (val) *val = dtab->first;
+	return GF_TRUE;
+}
+
+GF_Err stbl_dtab_get(GF_DeltaTable *dtab, u32 idx, u64 *val)
+{
+	u8 coded[DTAB_MAX_CODED];
+	const u8 *data;
+	u32 i, pos, block = idx / DTAB_BLOCK_SIZE;
+	GF_DeltaBlock *blk;
+
+	if (block >= dtab->nb_blocks) {
+		idx -= dtab->nb_blocks * DTAB_BLOCK_SIZE;
+		if (idx >= dtab->nb_values) return GF_BAD_PARAM;
+		*val = dtab->values[idx];
+		return GF_OK;
+	}
+	if (dtab->cache_block != (s32) block) {
+		blk = &dtab->blocks[block];
+		data = blk->data;
+		if (!data) {
+			gf_fseek(dtab->tmp, blk->pos, SEEK_SET);
+			if (gf_fread(coded, blk->size, dtab->tmp) != blk->size) {
+				GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Failed to read sample table block from temp file\n"));
+				dtab->cache_block = -1;
+				return GF_IO_ERR;
+			}
+			data = coded;
+		}
+		pos = 0;
+		dtab->cache[0] = dtab_read_varint(data, &pos, blk->size);
+		for (i=1; i<DTAB_BLOCK_SIZE; i++) {
+			u64 z = dtab_read_varint(data, &pos, blk->size);
+			s64 diff = (s64) (z >> 1) ^ -(s64) (z & 1);
+			dtab->cache[i] = dtab->cache[i-1] + (u64) diff;
+		}
+		dtab->cache_block = block;
+	}
+	*val = dtab->cache[idx % DTAB_BLOCK_SIZE];
+	return GF_OK;
+}
+
+#endif /*GPAC_DISABLE_ISOM*/
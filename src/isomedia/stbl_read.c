@@ -138,6 +138,11 @@ GF_Err stbl_GetSampleSize(GF_SampleSizeBox *stsz, u32 SampleNumber, u32 *Size)
 		(*Size) = stsz->sampleSize;
 	} else if (stsz->sizes) {
 		(*Size) = stsz->sizes[SampleNumber - 1];
+	} else if (stsz->dtab && stbl_dtab_count(stsz->dtab)) {
+		u64 size;
+		GF_Err e = stbl_dtab_get(stsz->dtab, SampleNumber - 1, &size);
+		if (e) return e;
+		(*Size) = (u32) size;
 	} else {
 		(*Size) = 0;
 	}
@@ -418,11 +423,13 @@ GF_Err stbl_GetSampleInfos(GF_SampleTableBox *stbl, u32 sampleNumber, u64 *offse
 		if (out_ent) *out_ent = ent;
 		if ( stbl->ChunkOffset->type == GF_ISOM_BOX_TYPE_STCO) {
 			stco = (GF_ChunkOffsetBox *)stbl->ChunkOffset;
+			if (stco->dtab) return stbl_dtab_get(stco->dtab, sampleNumber - 1, offset);
 			if (!stco->offsets) return GF_ISOM_INVALID_FILE;
 
 			(*offset) = (u64) stco->offsets[sampleNumber - 1];
 		} else {
 			co64 = (GF_ChunkLargeOffsetBox *)stbl->ChunkOffset;
+			if (co64->dtab) return stbl_dtab_get(co64->dtab, sampleNumber - 1, offset);
 			if (!co64->offsets) return GF_ISOM_INVALID_FILE;
 
 			(*offset) = co64->offsets[sampleNumber - 1];
@@ -528,11 +535,23 @@ sample_found:
 	if ( stbl->ChunkOffset->type == GF_ISOM_BOX_TYPE_STCO) {
 		stco = (GF_ChunkOffsetBox *)stbl->ChunkOffset;
 		if (stco->nb_entries < (*chunkNumber) ) return GF_ISOM_INVALID_FILE;
-		(*offset) = (u64) stco->offsets[(*chunkNumber) - 1] + (u64) offsetInChunk;
+		if (stco->dtab) {
+			e = stbl_dtab_get(stco->dtab, (*chunkNumber) - 1, offset);
+			if (e) return e;
+			(*offset) += (u64) offsetInChunk;
+		} else {
+			(*offset) = (u64) stco->offsets[(*chunkNumber) - 1] + (u64) offsetInChunk;
+		}
 	} else {
 		co64 = (GF_ChunkLargeOffsetBox *)stbl->ChunkOffset;
 		if (co64->nb_entries < (*chunkNumber) ) return GF_ISOM_INVALID_FILE;
-		(*offset) = co64->offsets[(*chunkNumber) - 1] + (u64) offsetInChunk;
+		if (co64->dtab) {
+			e = stbl_dtab_get(co64->dtab, (*chunkNumber) - 1, offset);
+			if (e) return e;
+			(*offset) += (u64) offsetInChunk;
+		} else {
+			(*offset) = co64->offsets[(*chunkNumber) - 1] + (u64) offsetInChunk;
+		}
 	}
 	return GF_OK;
 }
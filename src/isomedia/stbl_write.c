@@ -377,6 +377,33 @@ GF_Err stbl_AddSize(GF_SampleSizeBox *stsz, u32 sampleNumber, u32 size, u32 nb_p
 	else if (nb_pack_samples>1)
 		size /= nb_pack_samples;
 
+	//packed table, samples are only appended
+	if (stsz->dtab) {
+		GF_Err e;
+		if (sampleNumber != stsz->sampleCount + 1) return GF_BAD_PARAM;
+		//all samples have the same size so far
+		if (!stbl_dtab_count(stsz->dtab)) {
+			if (!stsz->sampleCount || (stsz->sampleSize == size)) {
+				stsz->sampleSize = size;
+				stsz->sampleCount += nb_pack_samples;
+				return GF_OK;
+			}
+			if (nb_pack_samples>1) {
+				GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Inserting packed samples with different sizes is not yet supported\n" ));
+				return GF_NOT_SUPPORTED;
+			}
+			for (i=0; i<stsz->sampleCount; i++) {
+				e = stbl_dtab_add(stsz->dtab, stsz->sampleSize);
+				if (e) return e;
+			}
+			stsz->sampleSize = 0;
+		}
+		e = stbl_dtab_add(stsz->dtab, size);
+		if (e) return e;
+		stsz->sampleCount++;
+		return GF_OK;
+	}
+
 	//all samples have the same size
 	if (stsz->sizes == NULL) {
 		//1 first sample added in NON COMPACT MODE
@@ -494,6 +521,17 @@ GF_Err stbl_AddRAP(GF_SyncSampleBox *stss, u32 sampleNumber)
 	return GF_OK;
 }
 
+//grow sample dependency table so that it can hold nb_samples
+static GF_Err sdtp_realloc(GF_SampleDependencyTypeBox *sdtp, u32 nb_samples)
+{
+	if (nb_samples <= sdtp->sample_alloc) return GF_OK;
+	ALLOC_INC(sdtp->sample_alloc);
+	if (sdtp->sample_alloc < nb_samples) sdtp->sample_alloc = nb_samples;
+	sdtp->sample_info = (u8*) gf_realloc(sdtp->sample_info, sizeof(u8) * sdtp->sample_alloc);
+	if (!sdtp->sample_info) return GF_OUT_OF_MEM;
+	return GF_OK;
+}
+
 GF_Err stbl_AddRedundant(GF_SampleTableBox *stbl, u32 sampleNumber)
 {
 	GF_SampleDependencyTypeBox *sdtp;
@@ -505,9 +543,8 @@ GF_Err stbl_AddRedundant(GF_SampleTableBox *stbl, u32 sampleNumber)
 	sdtp = stbl->SampleDep;
 	if (sdtp->sampleCount + 1 < sampleNumber) {
 		u32 missed = sampleNumber-1 - sdtp->sampleCount;
-		sdtp->sample_info = (u8*) gf_realloc(sdtp->sample_info, sizeof(u8) * (sdtp->sampleCount+missed) );
-		if (!sdtp->sample_info) return GF_OUT_OF_MEM;
-		sdtp->sample_alloc = sdtp->sampleCount+missed;
+		GF_Err e = sdtp_realloc(sdtp, sdtp->sampleCount+missed);
+		if (e) return e;
 		memset(&sdtp->sample_info[sdtp->sampleCount], 0, sizeof(u8) * missed );
 		while (missed) {
 			GF_ISOSAPType isRAP;
@@ -519,9 +556,7 @@ GF_Err stbl_AddRedundant(GF_SampleTableBox *stbl, u32 sampleNumber)
 		}
 	}
 
-	sdtp->sample_info = (u8*) gf_realloc(sdtp->sample_info, sizeof(u8) * (sdtp->sampleCount + 1));
-	if (!sdtp->sample_info) return GF_OUT_OF_MEM;
-	sdtp->sample_alloc = sdtp->sampleCount+1;
+	if (sdtp_realloc(sdtp, sdtp->sampleCount + 1)) return GF_OUT_OF_MEM;
 	if (sdtp->sampleCount < sampleNumber) {
 		sdtp->sample_info[sdtp->sampleCount] = 0x29;
 	} else {
@@ -552,9 +587,8 @@ GF_Err stbl_SetDependencyType(GF_SampleTableBox *stbl, u32 sampleNumber, u32 isL
 
 	if (sdtp->sampleCount < sampleNumber) {
 		u32 i;
-		sdtp->sample_info = (u8*) gf_realloc(sdtp->sample_info, sizeof(u8) * sampleNumber);
-		if (!sdtp->sample_info) return GF_OUT_OF_MEM;
-		sdtp->sample_alloc = sampleNumber;
+		GF_Err e = sdtp_realloc(sdtp, sampleNumber);
+		if (e) return e;
 
 		for (i=sdtp->sampleCount; i<sampleNumber; i++) {
 			sdtp->sample_info[i] = 0;
@@ -670,6 +704,69 @@ GF_Err stbl_AddShadow(GF_ShadowSyncBox *stsh, u32 sampleNumber, u32 shadowNumber
 }
 
 //used in edit/write, where sampleNumber == chunkNumber
+//append a chunk in packed tables: consecutive chunks with the same sample count and description share the same sample to chunk entry
+static GF_Err stbl_AddPackedChunkOffset(GF_MediaBox *mdia, u32 sampleNumber, u32 StreamDescIndex, u64 offset, u32 nb_pack_samples)
+{
+	GF_StscEntry *ent = NULL;
+	GF_DeltaTable *dtab;
+	GF_SampleTableBox *stbl = mdia->information->sampleTable;
+	GF_SampleToChunkBox *stsc = stbl->SampleToChunk;
+	u8 is_edited = Media_IsSelfContained(mdia, StreamDescIndex) ? 1 : 0;
+
+	if (sampleNumber != stsc->w_lastSampleNumber + 1) return GF_BAD_PARAM;
+
+	if (stsc->nb_entries) {
+		ent = &stsc->entries[stsc->nb_entries-1];
+		if ((ent->samplesPerChunk != nb_pack_samples) || (ent->sampleDescriptionIndex != StreamDescIndex) || (ent->isEdited != is_edited))
+			ent = NULL;
+	}
+	if (!ent) {
+		if (stsc->nb_entries == stsc->alloc_size) {
+			ALLOC_INC(stsc->alloc_size);
+			stsc->entries = gf_realloc(stsc->entries, sizeof(GF_StscEntry)*stsc->alloc_size);
+			if (!stsc->entries) return GF_OUT_OF_MEM;
+		}
+		ent = &stsc->entries[stsc->nb_entries];
+		stsc->nb_entries++;
+		ent->firstChunk = stsc->w_lastChunkNumber + 1;
+		ent->samplesPerChunk = nb_pack_samples;
+		ent->sampleDescriptionIndex = StreamDescIndex;
+		ent->isEdited = is_edited;
+	}
+	stsc->w_lastChunkNumber++;
+	stsc->w_lastSampleNumber = sampleNumber + nb_pack_samples - 1;
+	ent->nextChunk = stsc->w_lastChunkNumber + 1;
+
+	stsc->currentIndex = stsc->nb_entries-1;
+	stsc->firstSampleInCurrentChunk = sampleNumber;
+	stsc->currentChunk = stsc->w_lastChunkNumber + 1 - ent->firstChunk;
+	stsc->ghostNumber = ent->nextChunk - ent->firstChunk;
+
+	if (stbl->ChunkOffset->type == GF_ISOM_BOX_TYPE_STCO) {
+		GF_ChunkOffsetBox *stco = (GF_ChunkOffsetBox *)stbl->ChunkOffset;
+		//switch to large offsets, moving the packed table
+		if (offset > 0xFFFFFFFF) {
+			GF_ChunkLargeOffsetBox *co64 = (GF_ChunkLargeOffsetBox *) gf_isom_box_new_parent(&stbl->child_boxes, GF_ISOM_BOX_TYPE_CO64);
+			if (!co64) return GF_OUT_OF_MEM;
+			co64->nb_entries = stco->nb_entries;
+			co64->dtab = stco->dtab;
+			stco->dtab = NULL;
+			gf_isom_box_del_parent(&stbl->child_boxes, stbl->ChunkOffset);
+			stbl->ChunkOffset = (GF_Box *) co64;
+			dtab = co64->dtab;
+			co64->nb_entries++;
+		} else {
+			dtab = stco->dtab;
+			stco->nb_entries++;
+		}
+	} else {
+		GF_ChunkLargeOffsetBox *co64 = (GF_ChunkLargeOffsetBox *)stbl->ChunkOffset;
+		dtab = co64->dtab;
+		co64->nb_entries++;
+	}
+	return stbl_dtab_add(dtab, offset);
+}
+
 GF_Err stbl_AddChunkOffset(GF_MediaBox *mdia, u32 sampleNumber, u32 StreamDescIndex, u64 offset, u32 nb_pack_samples)
 {
 	GF_SampleTableBox *stbl;
@@ -688,6 +785,13 @@ GF_Err stbl_AddChunkOffset(GF_MediaBox *mdia, u32 sampleNumber, u32 StreamDescIn
 	if (!nb_pack_samples)
 		nb_pack_samples = 1;
 
+	if (stbl->ChunkOffset->type == GF_ISOM_BOX_TYPE_STCO) {
+		if (((GF_ChunkOffsetBox *) stbl->ChunkOffset)->dtab)
+			return stbl_AddPackedChunkOffset(mdia, sampleNumber, StreamDescIndex, offset, nb_pack_samples);
+	} else if (((GF_ChunkLargeOffsetBox *) stbl->ChunkOffset)->dtab) {
+		return stbl_AddPackedChunkOffset(mdia, sampleNumber, StreamDescIndex, offset, nb_pack_samples);
+	}
+
 	if (!stsc->nb_entries || (stsc->nb_entries + 2 >= stsc->alloc_size)) {
 		if (!stsc->alloc_size) stsc->alloc_size = 1;
 		ALLOC_INC(stsc->alloc_size);
@@ -1525,6 +1629,30 @@ GF_Err stbl_SampleSizeAppend(GF_SampleSizeBox *stsz, u32 data_size)
 	u32 i;
 	if (!stsz || !stsz->sampleCount) return GF_BAD_PARAM;
 
+	if (stsz->dtab) {
+		u64 size;
+		GF_Err e;
+		if (!stbl_dtab_count(stsz->dtab)) {
+			if (stsz->sampleCount==1) {
+				stsz->sampleSize += data_size;
+				return GF_OK;
+			}
+			for (i=0; i<stsz->sampleCount; i++) {
+				e = stbl_dtab_add(stsz->dtab, stsz->sampleSize);
+				if (e) return e;
+			}
+			stsz->sampleSize = 0;
+		}
+		e = stbl_dtab_get(stsz->dtab, stsz->sampleCount-1, &size);
+		if (e) return e;
+		stbl_dtab_set_last(stsz->dtab, size + data_size);
+		if (stbl_dtab_is_constant(stsz->dtab, &size)) {
+			stsz->sampleSize = (u32) size;
+			stbl_dtab_reset(stsz->dtab);
+		}
+		return GF_OK;
+	}
+
 	//we must realloc our table
 	if (stsz->sampleSize) {
 		stsz->sizes = (u32*)gf_malloc(sizeof(u32)*stsz->sampleCount);
@@ -1859,6 +1987,52 @@ GF_Err stbl_AppendDepType(GF_SampleTableBox *stbl, u32 DepType)
 
 
 
+static GF_Err stbl_UnpackDeltaTable(GF_DeltaTable **dtab, u32 count, u32 **offsets32, u64 **offsets64, u32 *alloc_size)
+{
+	u32 i;
+	GF_Err e = GF_OK;
+	if (! *dtab) return GF_OK;
+
+	if (stbl_dtab_count(*dtab)) {
+		if (offsets32) {
+			*offsets32 = (u32 *) gf_malloc(sizeof(u32) * count);
+			if (! *offsets32) return GF_OUT_OF_MEM;
+		} else {
+			*offsets64 = (u64 *) gf_malloc(sizeof(u64) * count);
+			if (! *offsets64) return GF_OUT_OF_MEM;
+		}
+		*alloc_size = count;
+		for (i=0; i<count; i++) {
+			u64 val;
+			e = stbl_dtab_get(*dtab, i, &val);
+			if (e) break;
+			if (offsets32) (*offsets32)[i] = (u32) val;
+			else (*offsets64)[i] = val;
+		}
+	}
+	stbl_dtab_del(*dtab);
+	*dtab = NULL;
+	return e;
+}
+
+GF_Err stbl_UnpackDeltaTables(GF_SampleTableBox *stbl)
+{
+	GF_Err e;
+	if (!stbl) return GF_BAD_PARAM;
+	if (stbl->SampleSize) {
+		e = stbl_UnpackDeltaTable(&stbl->SampleSize->dtab, stbl->SampleSize->sampleCount, &stbl->SampleSize->sizes, NULL, &stbl->SampleSize->alloc_size);
+		if (e) return e;
+	}
+	if (!stbl->ChunkOffset) return GF_OK;
+	if (stbl->ChunkOffset->type == GF_ISOM_BOX_TYPE_STCO) {
+		GF_ChunkOffsetBox *stco = (GF_ChunkOffsetBox *) stbl->ChunkOffset;
+		return stbl_UnpackDeltaTable(&stco->dtab, stco->nb_entries, &stco->offsets, NULL, &stco->alloc_size);
+	} else {
+		GF_ChunkLargeOffsetBox *co64 = (GF_ChunkLargeOffsetBox *) stbl->ChunkOffset;
+		return stbl_UnpackDeltaTable(&co64->dtab, co64->nb_entries, NULL, &co64->offsets, &co64->alloc_size);
+	}
+}
+
 //This functions unpack the offset for easy editing, eg each sample
 //is contained in one chunk...
 GF_Err stbl_UnpackOffsets(GF_SampleTableBox *stbl)
@@ -2128,6 +2302,15 @@ GF_Err gf_isom_refresh_size_info(GF_ISOFile *file, u32 trackNumber)
 	stsz = trak->Media->information->sampleTable->SampleSize;
 	if (stsz->sampleSize || !stsz->sampleCount) return GF_OK;
 
+	if (stsz->dtab) {
+		u64 dsize;
+		if (stbl_dtab_is_constant(stsz->dtab, &dsize)) {
+			stsz->sampleSize = (u32) dsize;
+			stbl_dtab_reset(stsz->dtab);
+		}
+		return GF_OK;
+	}
+
 	size = stsz->sizes[0];
 	for (i=1; i<stsz->sampleCount; i++) {
 		if (stsz->sizes[i] != size) {
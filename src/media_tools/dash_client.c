@@ -164,6 +164,8 @@ struct __dash_client
 	Bool period_groups_setup;
 	u32 tile_rate_decrease;
 	GF_DASHTileAdaptationMode tile_adapt_mode;
+	//viewport prediction horizon in ms (0 means segment duration) and margin in percent
+	u32 vp_horizon, vp_margin;
 
 	GF_List *SRDs;
 
@@ -191,6 +193,13 @@ typedef struct
 	char *key_url;
 	bin128 key_IV;
 	Bool has_dep_following;
+	/*group and segment index the entry was resolved from, used for late upgrade of tile segments*/
+	GF_DASH_Group *group;
+	s32 seg_idx;
+	/*priority of the tile when the entry was resolved*/
+	u32 tile_priority;
+	/*set once the entry location has been given to the user*/
+	Bool requested;
 } segment_cache_entry;
 
 typedef enum
@@ -345,6 +354,20 @@ struct __dash_group
 
 	u32 quality_degradation_hint;
 
+	/*viewport tracking for groups with dependent tile groups: last visible rect as signaled, center and size of the viewport
+	and its estimated velocity in SRD units per ms*/
+	u32 vp_min_x, vp_max_x, vp_min_y, vp_max_y;
+	Double vp_cx, vp_cy, vp_w, vp_h, vp_vx, vp_vy;
+	u32 vp_last_time;
+	Bool vp_set, vp_is_gaze, vp_wrap;
+	/*mutex for viewport and tile priority access (written by the app, read in download)*/
+	GF_Mutex *vp_mutex;
+	/*for groups with dependent tile groups in non-threaded mode: bytes and download time (us) of the segments fetched
+	through this group over roughly the last segment duration, used as download rate*/
+	u64 tile_dl_bytes, tile_dl_us;
+	/*for tile groups: 0 if visible, 1 if predicted visible, 2 if hidden*/
+	u32 tile_priority;
+
 	Bool rate_adaptation_postponed;
 
 	/* current segment index in BBA and BOLA algorithm */
@@ -938,6 +961,13 @@ static void gf_dash_group_timeline_setup(GF_MPD *mpd, GF_DASH_Group *group, u64
 			}
 
 			repeat = 1+ent->repeat_count;
+			//current time is after this entry, skip all its segments at once
+			if (repeat && (current_time_rescale >= segtime + (u64) repeat * ent->duration)) {
+				segtime += (u64) repeat * ent->duration;
+				seg_idx += repeat;
+				last_s_dur = ent->duration;
+				continue;
+			}
 			while (repeat) {
 				if ((current_time_rescale >= segtime) && (current_time_rescale < segtime + ent->duration)) {
 					GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] Found segment %d for current time "LLU" is in SegmentTimeline ["LLU"-"LLU"] (timecale %d - current index %d - startNumber %d)\n", seg_idx, current_time_rescale, start_segtime, segtime + ent->duration, timescale, group->download_segment_index, start_number));
@@ -1525,11 +1555,26 @@ static u32 gf_dash_get_index_in_timeline(GF_MPD_SegmentTimeline *timeline, u64 s
 	u32 i, count, repeat;
 	count = gf_list_count(timeline->entries);
 	for (i=0; i<count; i++) {
+		u64 last_start;
 		GF_MPD_SegmentTimelineEntry *ent = gf_list_get(timeline->entries, i);
 
 		if (!i || ent->start_time) start_time = ent->start_time;
 
 		repeat = ent->repeat_count+1;
+		//last segment of this entry is before the one we look for, skip the entry
+		last_start = start_time + (u64) (repeat-1) * ent->duration;
+		if ((start_timescale==timescale) ? (last_start < segment_start) : (last_start*start_timescale < segment_start*timescale)) {
+			start_time = last_start + ent->duration;
+			idx += repeat;
+			continue;
+		}
+		//move to the segment directly
+		if ((start_timescale==timescale) && ent->duration && (segment_start > start_time)) {
+			u32 nb_skip = (u32) ((segment_start - start_time) / ent->duration);
+			start_time += (u64) nb_skip * ent->duration;
+			idx += nb_skip;
+			repeat -= nb_skip;
+		}
 		while (repeat) {
 			if (start_timescale==timescale) {
 				if (start_time == segment_start ) return idx;
@@ -1561,6 +1606,191 @@ static u32 gf_dash_get_index_in_timeline(GF_MPD_SegmentTimeline *timeline, u64 s
 }
 
 
+//end time of a timeline in timeline timescale, 0 if unknown
+static u64 gf_dash_get_timeline_end(GF_MPD_SegmentTimeline *timeline)
+{
+	u64 start_time = 0;
+	u32 i, count;
+	count = gf_list_count(timeline->entries);
+	for (i=0; i<count; i++) {
+		GF_MPD_SegmentTimelineEntry *ent = gf_list_get(timeline->entries, i);
+		if (!i || ent->start_time) start_time = ent->start_time;
+		if (ent->repeat_count >= (u32) -2) return 0;
+		start_time += (u64) ent->duration * (ent->repeat_count+1);
+	}
+	return start_time;
+}
+
+static Bool gf_dash_update_known_segments_end(GF_MPD_SegmentTemplate *tpl, Double *end)
+{
+	u64 tl_end;
+	//only timelines of templates with their own timescale are skipped by the parser
+	if (!tpl || !tpl->segment_timeline || !tpl->timescale) return GF_TRUE;
+	tl_end = gf_dash_get_timeline_end(tpl->segment_timeline);
+	if (!tl_end) return GF_FALSE;
+	if (! *end || (*end > (Double) tl_end / tpl->timescale))
+		*end = (Double) tl_end / tpl->timescale;
+	return GF_TRUE;
+}
+
+//time in seconds up to which all SegmentTemplate timelines of the period are known, 0 if none
+static Double gf_dash_get_known_segments_end(GF_MPD_Period *period)
+{
+	u32 i, j;
+	Double end = 0;
+	if (!gf_dash_update_known_segments_end(period->segment_template, &end)) return 0;
+	for (i=0; i<gf_list_count(period->adaptation_sets); i++) {
+		GF_MPD_AdaptationSet *set = gf_list_get(period->adaptation_sets, i);
+		if (!gf_dash_update_known_segments_end(set->segment_template, &end)) return 0;
+		for (j=0; j<gf_list_count(set->representations); j++) {
+			GF_MPD_Representation *rep = gf_list_get(set->representations, j);
+			if (!gf_dash_update_known_segments_end(rep->segment_template, &end)) return 0;
+		}
+	}
+	return end;
+}
+
+static Bool gf_dash_timeline_has_skipped(GF_MPD_SegmentTemplate *tpl)
+{
+	if (tpl && tpl->segment_timeline && tpl->segment_timeline->nb_skipped) return GF_TRUE;
+	return GF_FALSE;
+}
+
+static Bool gf_dash_can_splice_segment_timeline(GF_MPD_SegmentTemplate *old_tpl, GF_MPD_SegmentTemplate *new_tpl)
+{
+	if (!gf_dash_timeline_has_skipped(new_tpl)) return GF_TRUE;
+	if (!old_tpl || !old_tpl->segment_timeline || (old_tpl->timescale != new_tpl->timescale)) return GF_FALSE;
+	if (gf_dash_get_timeline_end(old_tpl->segment_timeline) < new_tpl->segment_timeline->skipped_end) return GF_FALSE;
+	return GF_TRUE;
+}
+
+//checks that the segments not loaded from the updated manifest are all present in the current period
+static Bool gf_dash_check_skipped_segments(GF_MPD_Period *period, GF_MPD *new_mpd)
+{
+	u32 i, j, k, l;
+	Bool period_found = GF_FALSE;
+	for (i=0; i<gf_list_count(new_mpd->periods); i++) {
+		GF_MPD_Period *new_period = gf_list_get(new_mpd->periods, i);
+		GF_MPD_Period *ref = NULL;
+		//same period matching as in gf_dash_update_manifest
+		if (!period_found && (new_period->start == period->start)) {
+			ref = period;
+			period_found = GF_TRUE;
+		}
+		if (!gf_dash_can_splice_segment_timeline(ref ? ref->segment_template : NULL, new_period->segment_template)) return GF_FALSE;
+		//the update will fail, reload the full manifest so that the current one is not modified
+		if (ref && (gf_list_count(ref->adaptation_sets) != gf_list_count(new_period->adaptation_sets))) return GF_FALSE;
+
+		for (j=0; j<gf_list_count(new_period->adaptation_sets); j++) {
+			GF_MPD_AdaptationSet *set = gf_list_get(new_period->adaptation_sets, j);
+			GF_MPD_AdaptationSet *ref_set = ref ? gf_list_get(ref->adaptation_sets, j) : NULL;
+			if (!gf_dash_can_splice_segment_timeline(ref_set ? ref_set->segment_template : NULL, set->segment_template)) return GF_FALSE;
+			if (ref_set && (gf_list_count(ref_set->representations) != gf_list_count(set->representations))) return GF_FALSE;
+
+			for (k=0; k<gf_list_count(set->representations); k++) {
+				GF_MPD_Representation *rep = gf_list_get(set->representations, k);
+				if (!gf_dash_timeline_has_skipped(rep->segment_template)) continue;
+				//representations are matched after sorting, check against all of them
+				if (!ref_set || !gf_list_count(ref_set->representations)) return GF_FALSE;
+				for (l=0; l<gf_list_count(ref_set->representations); l++) {
+					GF_MPD_Representation *ref_rep = gf_list_get(ref_set->representations, l);
+					if (!gf_dash_can_splice_segment_timeline(ref_rep->segment_template, rep->segment_template)) return GF_FALSE;
+				}
+			}
+		}
+	}
+	return GF_TRUE;
+}
+
+//moves the segments of the current timeline not loaded in the new one before the new timeline entries
+static void gf_dash_splice_segment_timeline(GF_MPD_SegmentTimeline *old_timeline, GF_MPD_SegmentTimeline *new_timeline)
+{
+	GF_List *entries;
+	u64 start_time = 0;
+	u32 i, count, first, last;
+
+	count = gf_list_count(old_timeline->entries);
+	first = count;
+	last = 0;
+	for (i=0; i<count; i++) {
+		u64 seg_start;
+		u32 nb_before, nb_in, repeat;
+		GF_MPD_SegmentTimelineEntry *ent = gf_list_get(old_timeline->entries, i);
+		if (!i || ent->start_time) start_time = ent->start_time;
+		repeat = ent->repeat_count+1;
+
+		//segments starting before the new timeline are gone
+		nb_before = 0;
+		if (start_time < new_timeline->skipped_start) {
+			nb_before = ent->duration ? (u32) ((new_timeline->skipped_start - start_time + ent->duration - 1) / ent->duration) : repeat;
+			if (nb_before > repeat) nb_before = repeat;
+		}
+		seg_start = start_time + (u64) nb_before * ent->duration;
+		//segments starting before the first loaded entry are kept
+		nb_in = 0;
+		if ((nb_before < repeat) && (seg_start < new_timeline->skipped_end)) {
+			nb_in = ent->duration ? (u32) ((new_timeline->skipped_end - seg_start + ent->duration - 1) / ent->duration) : repeat - nb_before;
+			if (nb_in > repeat - nb_before) nb_in = repeat - nb_before;
+		}
+		start_time += (u64) ent->duration * repeat;
+		if (!nb_in) continue;
+
+		if (first == count) {
+			first = i;
+			ent->start_time = seg_start;
+		}
+		ent->repeat_count = nb_in - 1;
+		last = i+1;
+	}
+	if (first == count) first = last = 0;
+
+	//drop entries outside of the skipped range
+	while (gf_list_count(old_timeline->entries) > last) {
+		GF_MPD_SegmentTimelineEntry *ent = gf_list_pop_back(old_timeline->entries);
+		gf_free(ent);
+	}
+	while (first) {
+		GF_MPD_SegmentTimelineEntry *ent = gf_list_pop_front(old_timeline->entries);
+		gf_free(ent);
+		first--;
+	}
+	//append new entries and swap lists, the old list is destroyed with the old manifest
+	count = gf_list_count(new_timeline->entries);
+	for (i=0; i<count; i++) {
+		gf_list_add(old_timeline->entries, gf_list_get(new_timeline->entries, i));
+	}
+	gf_list_reset(new_timeline->entries);
+	entries = new_timeline->entries;
+	new_timeline->entries = old_timeline->entries;
+	old_timeline->entries = entries;
+
+	new_timeline->nb_skipped = 0;
+	new_timeline->skipped_start = new_timeline->skipped_end = 0;
+}
+
+//splices timelines of a group not being updated
+static void gf_dash_splice_set_segment_timelines(GF_MPD_AdaptationSet *set, GF_MPD_AdaptationSet *new_set)
+{
+	u32 i, j;
+	if (gf_dash_timeline_has_skipped(new_set->segment_template))
+		gf_dash_splice_segment_timeline(set->segment_template->segment_timeline, new_set->segment_template->segment_timeline);
+
+	for (i=0; i<gf_list_count(new_set->representations); i++) {
+		GF_MPD_Representation *rep = NULL;
+		GF_MPD_Representation *new_rep = gf_list_get(new_set->representations, i);
+		if (!gf_dash_timeline_has_skipped(new_rep->segment_template)) continue;
+		//representations of these groups are not sorted, match by ID
+		for (j=0; j<gf_list_count(set->representations); j++) {
+			rep = gf_list_get(set->representations, j);
+			if (rep->id && new_rep->id && !strcmp(rep->id, new_rep->id)) break;
+			rep = NULL;
+		}
+		if (!rep) rep = gf_list_get(set->representations, i);
+		if (rep)
+			gf_dash_splice_segment_timeline(rep->segment_template->segment_timeline, new_rep->segment_template->segment_timeline);
+	}
+}
+
 static GF_Err gf_dash_merge_segment_timeline(GF_DASH_Group *group, GF_DashClient *dash, GF_MPD_SegmentList *old_list, GF_MPD_SegmentTemplate *old_template, GF_MPD_SegmentList *new_list, GF_MPD_SegmentTemplate *new_template, Double min_start_time)
 {
 	GF_MPD_SegmentTimeline *old_timeline, *new_timeline;
@@ -1587,14 +1817,9 @@ static GF_Err gf_dash_merge_segment_timeline(GF_DASH_Group *group, GF_DashClient
 	}
 	if (!old_timeline && !new_timeline) return GF_OK;
 
-	if (group) {
-		group->current_start_time = gf_dash_get_segment_start_time_with_timescale(group, NULL, &group->current_timescale);
-	} else {
-		for (i=0; i<gf_list_count(dash->groups); i++) {
-			GF_DASH_Group *a_group = gf_list_get(dash->groups, i);
-			a_group->current_start_time = gf_dash_get_segment_start_time_with_timescale(a_group, NULL, &a_group->current_timescale);
-		}
-	}
+	//segments known from the previous manifest were not loaded
+	if (new_timeline->nb_skipped)
+		gf_dash_splice_segment_timeline(old_timeline, new_timeline);
 
 	nb_new_segs = 0;
 	idx=0;
@@ -1625,11 +1850,12 @@ static GF_Err gf_dash_merge_segment_timeline(GF_DASH_Group *group, GF_DashClient
 
 
 #ifndef GPAC_DISABLE_LOG
-	if (gf_log_tool_level_on(GF_LOG_DASH, GF_LOG_INFO) ) {
-		GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] New SegmentTimeline: \n"));
+	//dumping the complete timeline at each update is quite costly for large timeshift buffers, only do it in debug
+	if (gf_log_tool_level_on(GF_LOG_DASH, GF_LOG_DEBUG) ) {
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] New SegmentTimeline: \n"));
 		for (idx=0; idx<gf_list_count(new_timeline->entries); idx++) {
 			ent = gf_list_get(new_timeline->entries, idx);
-			GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("\tt="LLU" d=%d r=%d\n", ent->start_time, ent->duration, ent->repeat_count));
+			GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("\tt="LLU" d=%d r=%d\n", ent->start_time, ent->duration, ent->repeat_count));
 		}
 	}
 #endif
@@ -1815,7 +2041,7 @@ static GF_Err gf_dash_update_manifest(GF_DashClient *dash)
 	const char *local_url;
 	char mime[128];
 	char * purl;
-	Double timeline_start_time;
+	Double timeline_start_time, skip_end;
 	GF_MPD *new_mpd=NULL;
 	Bool fetch_only = GF_FALSE;
 
@@ -1957,19 +2183,27 @@ static GF_Err gf_dash_update_manifest(GF_DashClient *dash)
 		memcpy(dash->lastMPDSignature, signature, GF_SHA1_DIGEST_SIZE);
 
 		/* It means we have to reparse the file ... */
-		/* parse the MPD */
-		mpd_parser = gf_xml_dom_new();
-		e = gf_xml_dom_parse(mpd_parser, local_url, NULL, NULL);
-		if (e != GF_OK) {
-			gf_xml_dom_del(mpd_parser);
-			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Error - cannot update playlist: error in XML parsing %s\n", gf_error_to_string(e)));
-			return GF_NON_COMPLIANT_BITSTREAM;
+		/* for live sessions, SegmentTimeline entries of the active period already known are not loaded and are moved from the current manifest when merging */
+		period = gf_list_get(dash->mpd->periods, dash->active_period_index);
+		skip_end = 0;
+		if ((dash->mpd->type==GF_MPD_TYPE_DYNAMIC) && !dash->is_smooth && !dash->split_adaptation_set && !force_timeline_setup
+			&& period && !period->origin_base_url && !period->xlink_href
+		) {
+			skip_end = gf_dash_get_known_segments_end(period);
 		}
+
+		mpd_parser = gf_xml_dom_new();
 		new_mpd = gf_mpd_new();
-		e = gf_mpd_init_from_dom(gf_xml_dom_get_root(mpd_parser), new_mpd, purl);
+		e = gf_mpd_parse_dom_update(mpd_parser, local_url, new_mpd, purl, period ? period->start : 0, skip_end);
+		if (!e && skip_end && !gf_dash_check_skipped_segments(period, new_mpd)) {
+			GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] Updated manifest timelines do not match the current ones, reloading full manifest\n"));
+			gf_mpd_del(new_mpd);
+			new_mpd = gf_mpd_new();
+			e = gf_mpd_parse_dom(mpd_parser, local_url, new_mpd, purl);
+		}
 		gf_xml_dom_del(mpd_parser);
 		if (e) {
-			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Error - cannot update playlist: error in MPD creation %s\n", gf_error_to_string(e)));
+			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Error - cannot update playlist: error in MPD parsing %s\n", gf_error_to_string(e)));
 			gf_mpd_del(new_mpd);
 			return GF_NON_COMPLIANT_BITSTREAM;
 		}
@@ -2096,6 +2330,12 @@ restart_period_check:
 		else timeline_start_time = 0;
 	}
 
+	/*current position of each group, computed on the old manifest before any timeline is updated*/
+	for (group_idx=0; group_idx<gf_list_count(dash->groups); group_idx++) {
+		GF_DASH_Group *group = gf_list_get(dash->groups, group_idx);
+		group->current_start_time = gf_dash_get_segment_start_time_with_timescale(group, NULL, &group->current_timescale);
+	}
+
 	/*update segmentTimeline at Period level*/
 	e = gf_dash_merge_segment_timeline(NULL, dash, period->segment_list, period->segment_template, new_period->segment_list, new_period->segment_template, timeline_start_time);
 	if (e) {
@@ -2108,13 +2348,15 @@ restart_period_check:
 		u32 rep_i;
 		GF_DASH_Group *group = gf_list_get(dash->groups, group_idx);
 
-		/*update info even if the group is not selected !*/
-		if (group->selection==GF_DASH_GROUP_NOT_SELECTABLE)
-			continue;
-
 		set = group->adaptation_set;
 		new_set = gf_list_get(new_period->adaptation_sets, group_idx);
 
+		/*update info even if the group is not selected !*/
+		if (group->selection==GF_DASH_GROUP_NOT_SELECTABLE) {
+			gf_dash_splice_set_segment_timelines(set, new_set);
+			continue;
+		}
+
 		//sort by bandwidth and quality
 		for (rep_i = 1; rep_i < gf_list_count(new_set->representations); rep_i++) {
 			Bool swap=GF_FALSE;
@@ -4151,6 +4393,8 @@ static void gf_dash_reset_groups(GF_DashClient *dash)
 
 		if (group->cache_mutex)
 			gf_mx_del(group->cache_mutex);
+		if (group->vp_mutex)
+			gf_mx_del(group->vp_mutex);
 		if (group->bs_switching_init_segment_url)
 			gf_free(group->bs_switching_init_segment_url);
 
@@ -4300,6 +4544,7 @@ GF_Err gf_dash_setup_groups(GF_DashClient *dash)
 				group->download_th = gf_th_new("DashGroupDownload");
 
 			group->cache_mutex = gf_mx_new("DashGroupMutex");
+			group->vp_mutex = gf_mx_new("DashGroupViewportMutex");
 		}
 
 		group->bitstream_switching = (set->bitstream_switching || period->bitstream_switching) ? GF_TRUE : GF_FALSE;
@@ -4933,7 +5178,6 @@ exit:
 
 static void gf_dash_solve_period_xlink(GF_DashClient *dash, GF_List *period_list, u32 period_idx)
 {
-	u32 count, i;
 	GF_Err e;
 	u64 start = 0;
 	u64 src_duration = 0;
@@ -5027,9 +5271,11 @@ static void gf_dash_solve_period_xlink(GF_DashClient *dash, GF_List *period_list
 		local_url = dash->dash_io->get_cache_name(dash->dash_io, xlink_sess);
 	}
 
-	/* parse the MPD */
+	/* parse the MPD, all root periods are loaded */
 	parser = gf_xml_dom_new();
-	e = gf_xml_dom_parse(parser, local_url, NULL, NULL);
+	new_mpd = gf_mpd_new();
+	e = gf_mpd_parse_dom(parser, local_url, new_mpd, period->xlink_href);
+	gf_xml_dom_del(parser);
 	if (url) gf_free(url);
 	url = NULL;
 
@@ -5039,29 +5285,8 @@ static void gf_dash_solve_period_xlink(GF_DashClient *dash, GF_List *period_list
 		if (url) url = gf_strdup(url);
 		dash->dash_io->del(dash->dash_io, xlink_sess);
 	}
-	if (e != GF_OK) {
-		gf_xml_dom_del(parser);
-		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Error - cannot parse xlink periods: error in XML parsing %s\n", gf_error_to_string(e)));
-		gf_free(period->xlink_href);
-		period->xlink_href = NULL;
-		if (dash->dash_mutex) gf_mx_v(dash->dash_mutex);
-		if (url) gf_free(url);
-		return;
-	}
-	new_mpd = gf_mpd_new();
-
-	count = gf_xml_dom_get_root_nodes_count(parser);
-	for (i=0; i<count; i++) {
-		GF_XMLNode *root = gf_xml_dom_get_root_idx(parser, i);
-		if (i) {
-			e = gf_mpd_complete_from_dom(root, new_mpd, period->xlink_href);
-		} else {
-			e = gf_mpd_init_from_dom(root, new_mpd, period->xlink_href);
-		}
-		if (e) break;
-	}
-	gf_xml_dom_del(parser);
 	if (e) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Error - cannot parse xlink periods: %s\n", gf_error_to_string(e)));
 		gf_free(period->xlink_href);
 		period->xlink_href = NULL;
 		gf_mpd_del(new_mpd);
@@ -5118,6 +5343,264 @@ static void gf_dash_solve_period_xlink(GF_DashClient *dash, GF_List *period_list
 	if (dash->dash_mutex) gf_mx_v(dash->dash_mutex);
 }
 
+static Bool dash_tile_in_rect(GF_DASH_Group *a_group, u32 min_x, u32 max_x, u32 min_y, u32 max_y, Bool is_gaze)
+{
+	if (is_gaze) {
+		if (min_x < a_group->srd_x) return GF_FALSE;
+		if (min_x > a_group->srd_x + a_group->srd_w) return GF_FALSE;
+		if (min_y < a_group->srd_y) return GF_FALSE;
+		if (min_y > a_group->srd_y + a_group->srd_h) return GF_FALSE;
+		return GF_TRUE;
+	}
+	//single rectangle case
+	if (min_x<max_x) {
+		if (a_group->srd_x+a_group->srd_w <min_x) return GF_FALSE;
+		if (a_group->srd_x>max_x) return GF_FALSE;
+	} else {
+		if ( (a_group->srd_x>max_x) && (a_group->srd_x+a_group->srd_w<min_x)) return GF_FALSE;
+	}
+	if (a_group->srd_y>max_y) return GF_FALSE;
+	if (a_group->srd_y+a_group->srd_h < min_y) return GF_FALSE;
+	return GF_TRUE;
+}
+
+static Bool dash_tile_in_region(GF_DASH_Group *a_group, Double min_x, Double max_x, Double min_y, Double max_y, u32 ref_w, Bool wrap)
+{
+	if (a_group->srd_y > max_y) return GF_FALSE;
+	if (a_group->srd_y + a_group->srd_h < min_y) return GF_FALSE;
+
+	if (wrap && ref_w) {
+		if (max_x - min_x >= ref_w) return GF_TRUE;
+		while (min_x < 0) {
+			min_x += ref_w;
+			max_x += ref_w;
+		}
+		while (min_x >= ref_w) {
+			min_x -= ref_w;
+			max_x -= ref_w;
+		}
+		//region crosses the right edge
+		if ((max_x > ref_w) && (a_group->srd_x <= max_x - ref_w))
+			return GF_TRUE;
+	}
+	if (a_group->srd_x > max_x) return GF_FALSE;
+	if (a_group->srd_x + a_group->srd_w < min_x) return GF_FALSE;
+	return GF_TRUE;
+}
+
+static void dash_group_get_srd_size(GF_DASH_Group *group, u32 *ref_w, u32 *ref_h)
+{
+	u32 i, count = gf_list_count(group->groups_depending_on);
+	*ref_w = *ref_h = 0;
+	for (i=0; i<count; i++) {
+		GF_DASH_Group *a_group = gf_list_get(group->groups_depending_on, i);
+		if (!a_group->srd_desc) continue;
+		*ref_w = a_group->srd_desc->srd_fw;
+		*ref_h = a_group->srd_desc->srd_fh;
+		return;
+	}
+}
+
+//update viewport position and velocity estimate from a visible rect or gaze position
+static void dash_group_update_viewport(GF_DASH_Group *group, u32 min_x, u32 max_x, u32 min_y, u32 max_y, Bool is_gaze)
+{
+	Double cx, cy;
+	u32 ref_w, ref_h, now = gf_sys_clock();
+	Bool prev_wrap = group->vp_set ? group->vp_wrap : GF_FALSE;
+
+	dash_group_get_srd_size(group, &ref_w, &ref_h);
+	//viewport crosses the right edge of the video (360 content), checked at each update
+	group->vp_wrap = (!is_gaze && (min_x > max_x)) ? GF_TRUE : GF_FALSE;
+
+	if (is_gaze) {
+		cx = min_x;
+		cy = min_y;
+		group->vp_w = group->vp_h = 0;
+	} else {
+		group->vp_w = (min_x > max_x) ? (Double) ref_w - min_x + max_x : (Double) max_x - min_x;
+		group->vp_h = (Double) max_y - min_y;
+		cx = min_x + group->vp_w/2;
+		if (ref_w && (cx >= ref_w)) cx -= ref_w;
+		cy = min_y + group->vp_h/2;
+	}
+
+	if (!group->vp_set || (group->vp_is_gaze != is_gaze) || (now - group->vp_last_time >= 1000)) {
+		group->vp_vx = group->vp_vy = 0;
+	} else if (now > group->vp_last_time) {
+		Double dt = now - group->vp_last_time;
+		Double dx = cx - group->vp_cx;
+		Double dy = cy - group->vp_cy;
+		//take the shortest path if the viewport crosses or just crossed the right edge
+		if ((group->vp_wrap || prev_wrap) && ref_w) {
+			if (2*dx > ref_w) dx -= ref_w;
+			else if (-2*dx > ref_w) dx += ref_w;
+		}
+		//smooth velocity over the last updates
+		group->vp_vx = (group->vp_vx + dx/dt) / 2;
+		group->vp_vy = (group->vp_vy + dy/dt) / 2;
+	}
+	group->vp_cx = cx;
+	group->vp_cy = cy;
+	group->vp_min_x = min_x;
+	group->vp_max_x = max_x;
+	group->vp_min_y = min_y;
+	group->vp_max_y = max_y;
+	group->vp_is_gaze = is_gaze;
+	group->vp_last_time = now;
+	group->vp_set = GF_TRUE;
+}
+
+//classify tiles of a base group as visible, predicted visible or hidden, and set their quality hint accordingly
+static void dash_group_refresh_tile_priorities(GF_DashClient *dash, GF_DASH_Group *group)
+{
+	u32 i, count, ref_w, ref_h, horizon;
+	Double px, py, mx, my;
+
+	if (!group->groups_depending_on) return;
+
+	if (group->vp_mutex) gf_mx_p(group->vp_mutex);
+	if (!group->vp_set) {
+		if (group->vp_mutex) gf_mx_v(group->vp_mutex);
+		return;
+	}
+	//no viewport update for a while, assume it is no longer moving
+	if (gf_sys_clock() - group->vp_last_time >= 1000)
+		group->vp_vx = group->vp_vy = 0;
+
+	dash_group_get_srd_size(group, &ref_w, &ref_h);
+	horizon = dash->vp_horizon ? dash->vp_horizon : (u32) (group->segment_duration * 1000);
+	px = group->vp_cx + group->vp_vx * horizon;
+	py = group->vp_cy + group->vp_vy * horizon;
+	mx = group->vp_w/2 + dash->vp_margin * (group->vp_is_gaze ? ref_w : group->vp_w) / 100;
+	my = group->vp_h/2 + dash->vp_margin * (group->vp_is_gaze ? ref_h : group->vp_h) / 100;
+
+	count = gf_list_count(group->groups_depending_on);
+	for (i=0; i<count; i++) {
+		u32 priority = 0;
+		GF_DASH_Group *a_group = gf_list_get(group->groups_depending_on, i);
+		if (!a_group->srd_w || !a_group->srd_h) continue;
+
+		if (!dash_tile_in_rect(a_group, group->vp_min_x, group->vp_max_x, group->vp_min_y, group->vp_max_y, group->vp_is_gaze)) {
+			//region swept by the viewport until the prediction horizon
+			if (dash_tile_in_region(a_group, MIN(group->vp_cx, px) - mx, MAX(group->vp_cx, px) + mx, MIN(group->vp_cy, py) - my, MAX(group->vp_cy, py) + my, ref_w, group->vp_wrap))
+				priority = 1;
+			else
+				priority = 2;
+		}
+		if (a_group->tile_priority != priority) {
+			GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Group SRD %d,%d,%d,%d is %s\n", a_group->srd_x, a_group->srd_w, a_group->srd_y, a_group->srd_h, !priority ? "visible" : ((priority==1) ? "predicted visible" : "hidden")));
+		}
+		a_group->tile_priority = priority;
+		a_group->quality_degradation_hint = priority * 50;
+	}
+	if (group->vp_mutex) gf_mx_v(group->vp_mutex);
+}
+
+//upgrade tile segments resolved while their tile was not visible and not yet requested, to the best quality of visible tiles in the same segment
+static void dash_group_upgrade_tiles(GF_DashClient *dash, GF_DASH_Group *group)
+{
+	u32 i, j, end, target;
+	Bool has_target;
+	const char *base_url;
+
+	if (dash->thread_mode || !group->groups_depending_on || !group->vp_set) return;
+	//don't spend bandwidth on upgrades when the buffer is running low
+	if (group->buffer_max_ms && (group->buffer_occupancy_ms < group->segment_duration * 1000)) return;
+
+	dash_group_refresh_tile_priorities(dash, group);
+
+	for (i=0; i<group->nb_cached_segments; i=end+1) {
+		end = i;
+		while ((end+1 < group->nb_cached_segments) && group->cached[end].has_dep_following)
+			end++;
+
+		has_target = GF_FALSE;
+		target = 0;
+		for (j=i; j<=end; j++) {
+			segment_cache_entry *entry = &group->cached[j];
+			if (!entry->group || !entry->group->depend_on_group || entry->tile_priority) continue;
+			if (!has_target || (entry->representation_index > target)) target = entry->representation_index;
+			has_target = GF_TRUE;
+		}
+		if (!has_target) continue;
+
+		for (j=i; j<=end; j++) {
+			GF_Err e;
+			u64 start_range, end_range, duration;
+			char *url = NULL, *key_url = NULL;
+			bin128 key_iv;
+			GF_MPD_Representation *rep;
+			segment_cache_entry *entry = &group->cached[j];
+			GF_DASH_Group *a_group = entry->group;
+
+			if (entry->requested || !a_group || !a_group->depend_on_group) continue;
+			if (!entry->tile_priority || a_group->tile_priority) continue;
+			if (entry->representation_index >= target) continue;
+
+			rep = gf_list_get(a_group->adaptation_set->representations, target);
+			if (!rep || rep->playback.disabled) continue;
+
+			base_url = dash->base_url;
+			if (a_group->period->origin_base_url) base_url = a_group->period->origin_base_url;
+			start_range = end_range = 0;
+			e = gf_dash_resolve_url(dash->mpd, rep, a_group, base_url, GF_MPD_RESOLVE_URL_MEDIA, entry->seg_idx, &url, &start_range, &end_range, &duration, NULL, &key_url, &key_iv, NULL);
+			if (e || !url) {
+				if (url) gf_free(url);
+				if (key_url) gf_free(key_url);
+				continue;
+			}
+			GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] Tile SRD %d,%d,%d,%d became visible, upgrading segment %s to %s\n", a_group->srd_x, a_group->srd_w, a_group->srd_y, a_group->srd_h, entry->url, url));
+
+			gf_free(entry->cache);
+			gf_free(entry->url);
+			if (entry->key_url) gf_free(entry->key_url);
+			entry->cache = gf_strdup(url);
+			entry->url = url;
+			entry->start_range = start_range;
+			entry->end_range = end_range;
+			entry->key_url = key_url;
+			if (key_url) memcpy(entry->key_IV, key_iv, sizeof(bin128));
+			entry->representation_index = target;
+			entry->tile_priority = 0;
+		}
+	}
+}
+
+//in threaded mode, tile segments are downloaded as soon as resolved: upgrade a tile that became visible since the last rate allocation
+//to the best quality of visible tiles, right before its segment is downloaded
+static void dash_group_upgrade_tile_rep(GF_DashClient *dash, GF_DASH_Group *base_group, GF_DASH_Group *tile_group)
+{
+	u32 i, count, target = 0;
+	Bool has_target = GF_FALSE;
+	GF_MPD_Representation *rep;
+
+	if ((tile_group==base_group) || !tile_group->srd_w) return;
+	//don't spend bandwidth on upgrades when the buffer is running low
+	if (base_group->buffer_max_ms && (base_group->buffer_occupancy_ms < base_group->segment_duration * 1000)) return;
+
+	dash_group_refresh_tile_priorities(dash, base_group);
+
+	//tile priorities may be updated by the app at any time, read them all in one go
+	if (base_group->vp_mutex) gf_mx_p(base_group->vp_mutex);
+	if (base_group->vp_set && !tile_group->tile_priority) {
+		count = gf_list_count(base_group->groups_depending_on);
+		for (i=0; i<count; i++) {
+			GF_DASH_Group *a_group = gf_list_get(base_group->groups_depending_on, i);
+			if ((a_group==tile_group) || a_group->tile_priority || (a_group->selection != GF_DASH_GROUP_SELECTED)) continue;
+			if (!has_target || (a_group->active_rep_index > target)) target = a_group->active_rep_index;
+			has_target = GF_TRUE;
+		}
+	}
+	if (base_group->vp_mutex) gf_mx_v(base_group->vp_mutex);
+	if (!has_target || (tile_group->active_rep_index >= target)) return;
+
+	rep = gf_list_get(tile_group->adaptation_set->representations, target);
+	if (!rep || rep->playback.disabled) return;
+
+	GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] Tile SRD %d,%d,%d,%d became visible, upgrading from representation %d to %d\n", tile_group->srd_x, tile_group->srd_w, tile_group->srd_y, tile_group->srd_h, tile_group->active_rep_index, target));
+	gf_dash_set_group_representation(tile_group, rep);
+}
+
 static u32 gf_dash_get_tiles_quality_rank(GF_DashClient *dash, GF_DASH_Group *tile_group)
 {
 	s32 res, res2;
@@ -6151,6 +6634,9 @@ static DownloadGroupStatus dash_download_group_download(GF_DashClient *dash, GF_
 			cache_entry->duration = (u32) group->current_downloaded_segment_duration;
 			cache_entry->loop_detected = group->loop_detected;
 			cache_entry->has_dep_following = has_dep_following;
+			cache_entry->group = group;
+			cache_entry->seg_idx = group->download_segment_index;
+			cache_entry->tile_priority = group->tile_priority;
 			if (key_url) {
 				cache_entry->key_url = key_url;
 				memcpy(cache_entry->key_IV, key_iv, sizeof(bin128));
@@ -6216,6 +6702,13 @@ static DownloadGroupStatus dash_download_group(GF_DashClient *dash, GF_DASH_Grou
 	DownloadGroupStatus res;
 
 	if (!group->current_dep_idx) {
+		//update tile priorities before resolving the tile segments
+		if (group->groups_depending_on && (group==base_group))
+			dash_group_refresh_tile_priorities(dash, group);
+
+		else if (dash->thread_mode && group->depend_on_group)
+			dash_group_upgrade_tile_rep(dash, base_group, group);
+
 		res = dash_download_group_download(dash, group, base_group, has_dep_following);
 		if (res==GF_DASH_DownloadRestart) return res;
 		if (res==GF_DASH_DownloadCancel) return res;
@@ -6264,6 +6757,13 @@ static void dash_global_rate_adaptation(GF_DashClient *dash, Bool for_postponed_
 	nb_qualities = 1;
 	max_fsize = 0;
 
+	//update tile priorities from the viewport motion
+	for (i=0; i<count; i++) {
+		GF_DASH_Group *group = gf_list_get(dash->groups, i);
+		if (group->selection != GF_DASH_GROUP_SELECTED) continue;
+		dash_group_refresh_tile_priorities(dash, group);
+	}
+
 	//get max qualities due to SRD descriptions
 	//for now, consider all non-SRDs group to run in max quality
 	for (i=0; i<gf_list_count(dash->SRDs); i++) {
@@ -7390,13 +7890,18 @@ GF_Err gf_dash_open(GF_DashClient *dash, const char *manifest_url)
 
 		/* parse the MPD */
 		mpd_parser = gf_xml_dom_new();
-		e = gf_xml_dom_parse(mpd_parser, local_url, NULL, NULL);
+		if (dash->is_smooth) {
+			e = gf_xml_dom_parse(mpd_parser, local_url, NULL, NULL);
+		} else {
+			e = gf_mpd_parse_dom(mpd_parser, local_url, dash->mpd, manifest_url);
+		}
 
 		if (sep_cgi) sep_cgi[0] = '?';
 		if (sep_frag) sep_frag[0] = '#';
 
 		if (e != GF_OK) {
-			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Error - cannot connect service: MPD parsing problem %s\n", gf_xml_dom_get_error(mpd_parser) ));
+			const char *err_msg = gf_xml_dom_get_error(mpd_parser);
+			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Error - cannot connect service: MPD parsing problem %s\n", (err_msg && err_msg[0]) ? err_msg : gf_error_to_string(e) ));
 			gf_xml_dom_del(mpd_parser);
 			dash->dash_io->del(dash->dash_io, dash->mpd_dnload);
 			dash->mpd_dnload = NULL;
@@ -7405,8 +7910,6 @@ GF_Err gf_dash_open(GF_DashClient *dash, const char *manifest_url)
 
 		if (dash->is_smooth) {
 			e = gf_mpd_init_smooth_from_dom(gf_xml_dom_get_root(mpd_parser), dash->mpd, manifest_url);
-		} else {
-			e = gf_mpd_init_from_dom(gf_xml_dom_get_root(mpd_parser), dash->mpd, manifest_url);
 		}
 		gf_xml_dom_del(mpd_parser);
 
@@ -8285,6 +8788,10 @@ GF_Err gf_dash_group_get_next_segment_location(GF_DashClient *dash, u32 idx, u32
 		return GF_BUFFER_TOO_SMALL;
 	}
 
+	//tile segment about to be requested, check if it should be upgraded
+	if (dependent_representation_index && group->cached[0].has_dep_following)
+		dash_group_upgrade_tiles(dash, group);
+
 	/*check the dependent rep is in the cache and does not target next segment (next in time)*/
 	has_dep_following = group->cached[0].has_dep_following;
 	index = 0;
@@ -8305,6 +8812,7 @@ GF_Err gf_dash_group_get_next_segment_location(GF_DashClient *dash, u32 idx, u32
 		}
 
 		if (err) {
+			if (group->cache_mutex) gf_mx_v(group->cache_mutex);
 			if (dash->dash_mutex) gf_mx_v(dash->dash_mutex);
 			return err;
 		}
@@ -8313,6 +8821,7 @@ GF_Err gf_dash_group_get_next_segment_location(GF_DashClient *dash, u32 idx, u32
 	}
 
 	*url = group->cached[index].cache;
+	group->cached[index].requested = GF_TRUE;
 	if (start_range)
 		*start_range = group->cached[index].start_range;
 	if (end_range)
@@ -8350,6 +8859,113 @@ GF_Err gf_dash_group_get_next_segment_location(GF_DashClient *dash, u32 idx, u32
 	return GF_OK;
 }
 
+GF_EXPORT
+GF_Err gf_dash_group_get_next_tile_segment_location(GF_DashClient *dash, u32 idx, u32 *dependent_representation_index, const char **url, u64 *start_range, u64 *end_range, u32 *priority)
+{
+	u32 i, best = 0, best_priority = 0;
+	GF_DASH_Group *group;
+
+	*url = NULL;
+	*dependent_representation_index = 0;
+	if (start_range) *start_range = 0;
+	if (end_range) *end_range = 0;
+	if (priority) *priority = 0;
+
+	group = gf_list_get(dash->groups, idx);
+	if (!group || !group->groups_depending_on) return GF_BAD_PARAM;
+
+	if (dash->dash_mutex) gf_mx_p(dash->dash_mutex);
+	if (group->cache_mutex) gf_mx_p(group->cache_mutex);
+
+	if (!group->nb_cached_segments) {
+		if (group->cache_mutex) gf_mx_v(group->cache_mutex);
+		if (dash->dash_mutex) gf_mx_v(dash->dash_mutex);
+		return group->done ? GF_EOS : GF_BUFFER_TOO_SMALL;
+	}
+	dash_group_upgrade_tiles(dash, group);
+
+	//pick the first tile segment not yet requested with the highest priority
+	for (i=1; (i<group->nb_cached_segments) && group->cached[i-1].has_dep_following; i++) {
+		segment_cache_entry *entry = &group->cached[i];
+		if (entry->requested || !entry->group) continue;
+		if (!best || (entry->group->tile_priority < best_priority)) {
+			best = i;
+			best_priority = entry->group->tile_priority;
+		}
+	}
+	if (best) {
+		segment_cache_entry *entry = &group->cached[best];
+		entry->requested = GF_TRUE;
+		*dependent_representation_index = best;
+		*url = entry->cache;
+		if (start_range) *start_range = entry->start_range;
+		if (end_range) *end_range = entry->end_range;
+		if (priority) *priority = best_priority;
+	}
+	if (group->cache_mutex) gf_mx_v(group->cache_mutex);
+	if (dash->dash_mutex) gf_mx_v(dash->dash_mutex);
+	return best ? GF_OK : GF_EOS;
+}
+
+GF_EXPORT
+GF_Err gf_dash_group_get_prefetch_segment_location(GF_DashClient *dash, u32 idx, u32 seg_offset, char **url, u64 *start_range, u64 *end_range)
+{
+	GF_Err e;
+	GF_DASH_Group *group;
+	GF_MPD_Representation *rep;
+	const char *base_url;
+	char *key_url = NULL;
+	bin128 key_iv;
+	u64 seg_dur;
+	u32 seg_idx;
+
+	*url = NULL;
+	if (start_range) *start_range = 0;
+	if (end_range) *end_range = 0;
+	//only static sessions, we don't know the availability time of segments ahead in live
+	if (!dash->mpd || (dash->mpd->type != GF_MPD_TYPE_STATIC) || (dash->speed<0))
+		return GF_NOT_SUPPORTED;
+
+	if (dash->dash_mutex) gf_mx_p(dash->dash_mutex);
+	group = gf_list_get(dash->groups, idx);
+	if (!group || (group->selection != GF_DASH_GROUP_SELECTED) || !group->timeline_setup
+		|| group->base_rep_index_plus_one || gf_list_count(group->groups_depending_on)
+	) {
+		if (dash->dash_mutex) gf_mx_v(dash->dash_mutex);
+		return GF_NOT_SUPPORTED;
+	}
+	if (group->done) {
+		if (dash->dash_mutex) gf_mx_v(dash->dash_mutex);
+		return GF_EOS;
+	}
+	seg_idx = group->download_segment_index + seg_offset;
+	if (group->nb_segments_in_rep && (seg_idx >= group->nb_segments_in_rep)) {
+		if (dash->dash_mutex) gf_mx_v(dash->dash_mutex);
+		return GF_EOS;
+	}
+	rep = gf_list_get(group->adaptation_set->representations, group->active_rep_index);
+	base_url = dash->base_url;
+	if (group->period->origin_base_url) base_url = group->period->origin_base_url;
+
+	e = gf_dash_resolve_url(dash->mpd, rep, group, base_url, GF_MPD_RESOLVE_URL_MEDIA, seg_idx, url, start_range, end_range, &seg_dur, NULL, &key_url, &key_iv, NULL);
+	if (dash->dash_mutex) gf_mx_v(dash->dash_mutex);
+	if (key_url) gf_free(key_url);
+
+	if (e) {
+		if (*url) gf_free(*url);
+		*url = NULL;
+		return e;
+	}
+	if (! *url) return GF_EOS;
+	//local files and custom IOs are not prefetched
+	if (!strstr(*url, "://") || !strnicmp(*url, "file://", 7) || !strnicmp(*url, "gmem://", 7) || !strnicmp(*url, "gfio://", 7)) {
+		gf_free(*url);
+		*url = NULL;
+		return GF_NOT_SUPPORTED;
+	}
+	return GF_OK;
+}
+
 GF_EXPORT
 GF_Err gf_dash_group_probe_current_download_segment_location(GF_DashClient *dash, u32 idx, const char **url, s32 *switching_index, const char **switching_url, const char **original_url, Bool *switched)
 {
@@ -9118,55 +9734,48 @@ GF_Err gf_dash_group_set_visible_rect(GF_DashClient *dash, u32 idx, u32 min_x, u
 	GF_DASH_Group *group = gf_list_get(dash->groups, idx);
 	if (!group) return GF_BAD_PARAM;
 
+	//viewport state is read by the download threads
+	if (group->vp_mutex) gf_mx_p(group->vp_mutex);
 	if (!min_x && !max_x && !min_y && !max_y) {
 		group->quality_degradation_hint = 0;
+		//stop viewport tracking
+		group->vp_set = GF_FALSE;
+		group->vp_vx = group->vp_vy = 0;
 	}
 
 
 	//TODO - single video, we may want to switch down quality if not a lot of the video is visible
 	//we will need the zoom factor as well
-	if (!group->groups_depending_on) return GF_OK;
+	if (!group->groups_depending_on) {
+		if (group->vp_mutex) gf_mx_v(group->vp_mutex);
+		return GF_OK;
+	}
 
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Group Visible rect %d,%d,%d,%d \n", min_x, max_x, min_y, max_y));
-	count = gf_list_count(group->groups_depending_on);
-	for (i=0; i<count; i++) {
-		Bool is_visible = GF_TRUE;
-		GF_DASH_Group *a_group = gf_list_get(group->groups_depending_on, i);
-		if (!a_group->srd_w || !a_group->srd_h) continue;
-
-		if (is_gaze) {
-
-			if (min_x < a_group->srd_x)
-				is_visible = GF_FALSE;
-			else if (min_x > a_group->srd_x + a_group->srd_w)
-				is_visible = GF_FALSE;
-			else if (min_y < a_group->srd_y)
-				is_visible = GF_FALSE;
-			else if (min_y > a_group->srd_y + a_group->srd_h)
-				is_visible = GF_FALSE;
-
-		} else {
-
-			//single rectangle case
-			if (min_x<max_x) {
-				if (a_group->srd_x+a_group->srd_w <min_x) is_visible = GF_FALSE;
-				else if (a_group->srd_x>max_x) is_visible = GF_FALSE;
-			} else {
-				if ( (a_group->srd_x>max_x) && (a_group->srd_x+a_group->srd_w<min_x)) is_visible = GF_FALSE;
-			}
-
-			if (a_group->srd_y>max_y) is_visible = GF_FALSE;
-			else if (a_group->srd_y+a_group->srd_h < min_y) is_visible = GF_FALSE;
-
+	//no viewport tracking, tiles are only checked against the rect as signaled
+	if (!min_x && !max_x && !min_y && !max_y) {
+		count = gf_list_count(group->groups_depending_on);
+		for (i=0; i<count; i++) {
+			GF_DASH_Group *a_group = gf_list_get(group->groups_depending_on, i);
+			if (!a_group->srd_w || !a_group->srd_h) continue;
+			a_group->tile_priority = dash_tile_in_rect(a_group, min_x, max_x, min_y, max_y, is_gaze) ? 0 : 2;
+			a_group->quality_degradation_hint = a_group->tile_priority * 50;
 		}
-
-		a_group->quality_degradation_hint = is_visible ? 0 : 100;
-
-		GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Group SRD %d,%d,%d,%d is %s\n", a_group->srd_x, a_group->srd_w, a_group->srd_y, a_group->srd_h, is_visible ? "visible" : "hidden"));
+	} else {
+		dash_group_update_viewport(group, min_x, max_x, min_y, max_y, is_gaze);
+		dash_group_refresh_tile_priorities(dash, group);
 	}
+	if (group->vp_mutex) gf_mx_v(group->vp_mutex);
 	return GF_OK;
 }
 
+GF_EXPORT
+void gf_dash_set_viewport_prediction(GF_DashClient *dash, u32 horizon_ms, u32 margin)
+{
+	dash->vp_horizon = horizon_ms;
+	dash->vp_margin = margin;
+}
+
 void gf_dash_set_group_download_state(GF_DashClient *dash, u32 idx, GF_Err err)
 {
 	GF_MPD_Representation *rep;
@@ -9219,6 +9828,28 @@ void gf_dash_group_store_stats(GF_DashClient *dash, u32 idx, u32 bytes_per_sec,
 
 	dash_store_stats(dash, group, bytes_per_sec, file_size, is_broadcast);
 
+	//tile segments are fetched through their base group, share its download rate with the tile groups for tile rate allocation
+	if (group->groups_depending_on) {
+		u32 i, count = gf_list_count(group->groups_depending_on);
+		//the min rate kept by dash_store_stats never increases and is set by the smallest, latency bound tile requests:
+		//use the aggregated rate of the segments downloaded over the last segment duration instead
+		if (!is_broadcast && bytes_per_sec) {
+			group->tile_dl_bytes += file_size;
+			group->tile_dl_us += (u64) file_size * 1000000 / bytes_per_sec;
+			if (group->tile_dl_us > 1000000 * group->segment_duration) {
+				group->tile_dl_bytes /= 2;
+				group->tile_dl_us /= 2;
+			}
+			if (group->tile_dl_us)
+				group->bytes_per_sec = (u32) (group->tile_dl_bytes * 1000000 / group->tile_dl_us);
+		}
+		for (i=0; i<count; i++) {
+			GF_DASH_Group *a_group = gf_list_get(group->groups_depending_on, i);
+			a_group->bytes_per_sec = group->bytes_per_sec;
+			a_group->total_size = group->total_size;
+		}
+	}
+
 	if (file_size==bytes_done) {
 		dash_global_rate_adaptation(dash, GF_FALSE);
 	}
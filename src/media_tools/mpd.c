@@ -351,15 +351,151 @@ static void gf_mpd_parse_segment_base_generic(GF_MPD *mpd, GF_MPD_SegmentBase *s
 	}
 }
 
-static GF_MPD_SegmentTimeline *gf_mpd_parse_segment_timeline(GF_MPD *mpd, GF_XMLNode *root)
+static void gf_mpd_parse_segment_timeline_entry(GF_MPD_SegmentTimelineEntry *seg_tl_ent, const GF_XMLAttribute *att)
+{
+	if (!strcmp(att->name, "t"))
+		seg_tl_ent->start_time = gf_mpd_parse_long_int(att->value);
+	else if (!strcmp(att->name, "d"))
+		seg_tl_ent->duration = gf_mpd_parse_int(att->value);
+	else if (!strcmp(att->name, "r")) {
+		seg_tl_ent->repeat_count = gf_mpd_parse_int(att->value);
+		if (seg_tl_ent->repeat_count == (u32)-1)
+			seg_tl_ent->repeat_count--;
+	}
+}
+
+typedef struct
+{
+	//SegmentTimeline DOM node, only valid while the DOM is loaded
+	GF_XMLNode *node;
+	GF_MPD_SegmentTimeline *timeline;
+	//number of S entries found so far, loaded or not
+	u32 nb_entries;
+	//end time of the last S entry
+	u64 end_time;
+	//timescale of the parent SegmentTemplate, 0 if leading entries cannot be skipped
+	u32 timescale;
+} GF_MPD_DOMTimeline;
+
+//state of gf_mpd_parse_dom, only used during the call
+typedef struct
+{
+	//timelines loaded while parsing the document and not yet assigned
+	GF_List *timelines;
+	//update mode: start of the updated period in ms, and time in seconds before which segments are not loaded
+	u64 period_start;
+	Double skip_end;
+	//set when parsing the updated period
+	Bool in_period;
+	//skip timescale for the next timeline
+	u32 next_timescale;
+} GF_MPD_DOMLoader;
+
+static Bool gf_mpd_dom_filter(void *cbk, GF_XMLNode *parent, const char *name, const char *ns, const GF_XMLAttribute *attributes, u32 nb_attributes)
+{
+	u32 i;
+	u64 start_time;
+	GF_MPD_DOMTimeline *dtl;
+	GF_MPD_SegmentTimelineEntry *seg_tl_ent, ent;
+	GF_MPD_DOMLoader *ld = (GF_MPD_DOMLoader *)cbk;
+
+	if (ld->skip_end) {
+		if (!strcmp(name, "Period")) {
+			u64 start = 0;
+			for (i=0; i<nb_attributes; i++) {
+				if (!strcmp(attributes[i].name, "start")) start = gf_mpd_parse_duration(attributes[i].value);
+			}
+			ld->in_period = (start == ld->period_start) ? GF_TRUE : GF_FALSE;
+			return GF_FALSE;
+		}
+		//only timelines of a SegmentTemplate with its own timescale can be skipped, the timescale of SegmentList and inherited timescales are not known at this point
+		if (parent && !strcmp(name, "SegmentTimeline")) {
+			ld->next_timescale = 0;
+			if (ld->in_period && !strcmp(parent->name, "SegmentTemplate")) {
+				GF_XMLAttribute *att;
+				i = 0;
+				while ( (att = gf_list_enum(parent->attributes, &i)) ) {
+					if (!strcmp(att->name, "timescale")) ld->next_timescale = gf_mpd_parse_int(att->value);
+				}
+			}
+			return GF_FALSE;
+		}
+	}
+
+	if (!parent || strcmp(name, "S") || strcmp(parent->name, "SegmentTimeline")) return GF_FALSE;
+	//same namespace as parent timeline, namespace checking is done when parsing the timeline
+	if ((ns && !parent->ns) || (!ns && parent->ns) || (ns && strcmp(ns, parent->ns))) return GF_FALSE;
+
+	//entries of a timeline are consecutive
+	dtl = gf_list_last(ld->timelines);
+	if (!dtl || (dtl->node != parent)) {
+		GF_SAFEALLOC(dtl, GF_MPD_DOMTimeline);
+		if (!dtl) return GF_FALSE;
+		GF_SAFEALLOC(dtl->timeline, GF_MPD_SegmentTimeline);
+		if (!dtl->timeline) {
+			gf_free(dtl);
+			return GF_FALSE;
+		}
+		dtl->timeline->entries = gf_list_new();
+		dtl->node = parent;
+		dtl->timescale = ld->next_timescale;
+		ld->next_timescale = 0;
+		gf_list_add(ld->timelines, dtl);
+	}
+
+	memset(&ent, 0, sizeof(GF_MPD_SegmentTimelineEntry));
+	for (i=0; i<nb_attributes; i++) {
+		gf_mpd_parse_segment_timeline_entry(&ent, &attributes[i]);
+	}
+	start_time = (!dtl->nb_entries || ent.start_time) ? ent.start_time : dtl->end_time;
+	dtl->nb_entries++;
+	if (ent.repeat_count >= (u32) -2) {
+		//open-ended entry, no more skipping
+		dtl->timescale = 0;
+	} else {
+		dtl->end_time = start_time + (u64) ent.duration * (ent.repeat_count+1);
+		//entries ending before the skip time are already known, only keep track of them
+		if (dtl->timescale && !gf_list_count(dtl->timeline->entries) && ((Double) dtl->end_time / dtl->timescale <= ld->skip_end)) {
+			if (!dtl->timeline->nb_skipped) dtl->timeline->skipped_start = start_time;
+			dtl->timeline->nb_skipped += ent.repeat_count+1;
+			dtl->timeline->skipped_end = dtl->end_time;
+			return GF_TRUE;
+		}
+	}
+	GF_SAFEALLOC(seg_tl_ent, GF_MPD_SegmentTimelineEntry);
+	if (!seg_tl_ent) return GF_FALSE;
+	*seg_tl_ent = ent;
+	//first loaded entry after skipped ones must be explicitly timed
+	if (dtl->timeline->nb_skipped && !gf_list_count(dtl->timeline->entries))
+		seg_tl_ent->start_time = start_time;
+	gf_list_add(dtl->timeline->entries, seg_tl_ent);
+	return GF_TRUE;
+}
+
+static GF_MPD_SegmentTimeline *gf_mpd_parse_segment_timeline(GF_MPD *mpd, GF_XMLNode *root, GF_MPD_DOMLoader *ld)
 {
 	u32 i, j;
 	GF_XMLAttribute *att;
 	GF_XMLNode *child;
-	GF_MPD_SegmentTimeline *seg;
-	GF_SAFEALLOC(seg, GF_MPD_SegmentTimeline);
-	if (!seg) return NULL;
-	seg->entries = gf_list_new();
+	GF_MPD_SegmentTimeline *seg = NULL;
+
+	//entries already loaded while parsing the document
+	i = 0;
+	while (ld && (i < gf_list_count(ld->timelines))) {
+		GF_MPD_DOMTimeline *dtl = gf_list_get(ld->timelines, i);
+		if (dtl->node == root) {
+			seg = dtl->timeline;
+			gf_list_rem(ld->timelines, i);
+			gf_free(dtl);
+			break;
+		}
+		i++;
+	}
+	if (!seg) {
+		GF_SAFEALLOC(seg, GF_MPD_SegmentTimeline);
+		if (!seg) return NULL;
+		seg->entries = gf_list_new();
+	}
 
 	i = 0;
 	while ( (child = gf_list_enum(root->content, &i))) {
@@ -372,15 +508,7 @@ static GF_MPD_SegmentTimeline *gf_mpd_parse_segment_timeline(GF_MPD *mpd, GF_XML
 
 			j = 0;
 			while ( (att = gf_list_enum(child->attributes, &j)) ) {
-				if (!strcmp(att->name, "t"))
-					seg_tl_ent->start_time = gf_mpd_parse_long_int(att->value);
-				else if (!strcmp(att->name, "d"))
-					seg_tl_ent->duration = gf_mpd_parse_int(att->value);
-				else if (!strcmp(att->name, "r")) {
-					seg_tl_ent->repeat_count = gf_mpd_parse_int(att->value);
-					if (seg_tl_ent->repeat_count == (u32)-1)
-						seg_tl_ent->repeat_count--;
-				}
+				gf_mpd_parse_segment_timeline_entry(seg_tl_ent, att);
 			}
 		}
 	}
@@ -396,7 +524,7 @@ static GF_MPD_SegmentBase *gf_mpd_parse_segment_base(GF_MPD *mpd, GF_XMLNode *ro
 	return seg;
 }
 
-void gf_mpd_parse_multiple_segment_base(GF_MPD *mpd, GF_MPD_MultipleSegmentBase *seg, GF_XMLNode *root)
+static void gf_mpd_parse_multiple_segment_base(GF_MPD *mpd, GF_MPD_MultipleSegmentBase *seg, GF_XMLNode *root, GF_MPD_DOMLoader *ld)
 {
 	u32 i;
 	GF_XMLAttribute *att;
@@ -414,7 +542,7 @@ void gf_mpd_parse_multiple_segment_base(GF_MPD *mpd, GF_MPD_MultipleSegmentBase
 	i = 0;
 	while ( (child = gf_list_enum(root->content, &i))) {
 		if (!gf_mpd_valid_child(mpd, child)) continue;
-		if (!strcmp(child->name, "SegmentTimeline")) seg->segment_timeline = gf_mpd_parse_segment_timeline(mpd, child);
+		if (!strcmp(child->name, "SegmentTimeline")) seg->segment_timeline = gf_mpd_parse_segment_timeline(mpd, child, ld);
 		else if (!strcmp(child->name, "BitstreamSwitching")) seg->bitstream_switching_url = gf_mpd_parse_url(child);
 	}
 }
@@ -467,7 +595,7 @@ void gf_mpd_parse_segment_url(GF_List *container, GF_XMLNode *root)
 	}
 }
 
-static GF_MPD_SegmentList *gf_mpd_parse_segment_list(GF_MPD *mpd, GF_XMLNode *root)
+static GF_MPD_SegmentList *gf_mpd_parse_segment_list(GF_MPD *mpd, GF_XMLNode *root, GF_MPD_DOMLoader *ld)
 {
 	u32 i;
 	GF_MPD_SegmentList *seg;
@@ -483,7 +611,7 @@ static GF_MPD_SegmentList *gf_mpd_parse_segment_list(GF_MPD *mpd, GF_XMLNode *ro
 		if (strstr(att->name, "href")) seg->xlink_href = gf_mpd_parse_string(att->value);
 		else if (strstr(att->name, "actuate")) seg->xlink_actuate_on_load = !strcmp(att->value, "onLoad") ? 1 : 0;
 	}
-	gf_mpd_parse_multiple_segment_base(mpd, (GF_MPD_MultipleSegmentBase *)seg, root);
+	gf_mpd_parse_multiple_segment_base(mpd, (GF_MPD_MultipleSegmentBase *)seg, root, ld);
 
 	i = 0;
 	while ( (child = gf_list_enum(root->content, &i))) {
@@ -497,7 +625,7 @@ static GF_MPD_SegmentList *gf_mpd_parse_segment_list(GF_MPD *mpd, GF_XMLNode *ro
 	return seg;
 }
 
-static GF_MPD_SegmentTemplate *gf_mpd_parse_segment_template(GF_MPD *mpd, GF_XMLNode *root)
+static GF_MPD_SegmentTemplate *gf_mpd_parse_segment_template(GF_MPD *mpd, GF_XMLNode *root, GF_MPD_DOMLoader *ld)
 {
 	u32 i;
 	GF_MPD_SegmentTemplate *seg;
@@ -517,7 +645,7 @@ static GF_MPD_SegmentTemplate *gf_mpd_parse_segment_template(GF_MPD *mpd, GF_XML
 		}
 		else if (!strcmp(att->name, "bitstreamSwitching")) seg->bitstream_switching = gf_mpd_parse_string(att->value);
 	}
-	gf_mpd_parse_multiple_segment_base(mpd, (GF_MPD_MultipleSegmentBase *)seg, root);
+	gf_mpd_parse_multiple_segment_base(mpd, (GF_MPD_MultipleSegmentBase *)seg, root, ld);
 	return seg;
 }
 
@@ -792,7 +920,7 @@ static GF_List *gf_mpd_parse_segments_context(GF_MPD *mpd, GF_XMLNode *root)
 	return res;
 }
 
-static GF_Err gf_mpd_parse_representation(GF_MPD *mpd, GF_List *container, GF_XMLNode *root)
+static GF_Err gf_mpd_parse_representation(GF_MPD *mpd, GF_List *container, GF_XMLNode *root, GF_MPD_DOMLoader *ld)
 {
 	u32 i;
 	GF_MPD_Representation *rep;
@@ -825,10 +953,10 @@ static GF_Err gf_mpd_parse_representation(GF_MPD *mpd, GF_List *container, GF_XM
 			rep->segment_base = gf_mpd_parse_segment_base(mpd, child);
 		}
 		else if (!strcmp(child->name, "SegmentList")) {
-			rep->segment_list = gf_mpd_parse_segment_list(mpd, child);
+			rep->segment_list = gf_mpd_parse_segment_list(mpd, child, ld);
 		}
 		else if (!strcmp(child->name, "SegmentTemplate")) {
-			rep->segment_template = gf_mpd_parse_segment_template(mpd, child);
+			rep->segment_template = gf_mpd_parse_segment_template(mpd, child, ld);
 		}
 		else if (!strcmp(child->name, "SubRepresentation")) {
 			/*TODO
@@ -873,7 +1001,7 @@ GF_MPD_AdaptationSet *gf_mpd_adaptation_set_new() {
 	return set;
 }
 
-static GF_Err gf_mpd_parse_adaptation_set(GF_MPD *mpd, GF_List *container, GF_XMLNode *root)
+static GF_Err gf_mpd_parse_adaptation_set(GF_MPD *mpd, GF_List *container, GF_XMLNode *root, GF_MPD_DOMLoader *ld)
 {
 	u32 i;
 	GF_MPD_AdaptationSet *set;
@@ -948,13 +1076,13 @@ static GF_Err gf_mpd_parse_adaptation_set(GF_MPD *mpd, GF_List *container, GF_XM
 			set->segment_base = gf_mpd_parse_segment_base(mpd, child);
 		}
 		else if (!strcmp(child->name, "SegmentList")) {
-			set->segment_list = gf_mpd_parse_segment_list(mpd, child);
+			set->segment_list = gf_mpd_parse_segment_list(mpd, child, ld);
 		}
 		else if (!strcmp(child->name, "SegmentTemplate")) {
-			set->segment_template = gf_mpd_parse_segment_template(mpd, child);
+			set->segment_template = gf_mpd_parse_segment_template(mpd, child, ld);
 		}
 		else if (!strcmp(child->name, "Representation")) {
-			e = gf_mpd_parse_representation(mpd, set->representations, child);
+			e = gf_mpd_parse_representation(mpd, set->representations, child, ld);
 			if (e) return e;
 		}
 		else{
@@ -977,7 +1105,7 @@ GF_MPD_Period *gf_mpd_period_new() {
 	return period;
 }
 
-GF_Err gf_mpd_parse_period(GF_MPD *mpd, GF_XMLNode *root)
+static GF_Err gf_mpd_parse_period_ex(GF_MPD *mpd, GF_XMLNode *root, GF_MPD_DOMLoader *ld)
 {
 	u32 i;
 	GF_MPD_Period *period;
@@ -1011,13 +1139,13 @@ GF_Err gf_mpd_parse_period(GF_MPD *mpd, GF_XMLNode *root)
 			period->segment_base = gf_mpd_parse_segment_base(mpd, child);
 		}
 		else if (!strcmp(child->name, "SegmentList")) {
-			period->segment_list = gf_mpd_parse_segment_list(mpd, child);
+			period->segment_list = gf_mpd_parse_segment_list(mpd, child, ld);
 		}
 		else if (!strcmp(child->name, "SegmentTemplate")) {
-			period->segment_template = gf_mpd_parse_segment_template(mpd, child);
+			period->segment_template = gf_mpd_parse_segment_template(mpd, child, ld);
 		}
 		else if (!strcmp(child->name, "AdaptationSet")) {
-			e = gf_mpd_parse_adaptation_set(mpd, period->adaptation_sets, child);
+			e = gf_mpd_parse_adaptation_set(mpd, period->adaptation_sets, child, ld);
 			if (e) return e;
 		}
 		else if (!strcmp(child->name, "SubSet")) {
@@ -1346,7 +1474,12 @@ void gf_mpd_del(GF_MPD *mpd)
 
 
 GF_EXPORT
-GF_Err gf_mpd_complete_from_dom(GF_XMLNode *root, GF_MPD *mpd, const char *default_base_url)
+GF_Err gf_mpd_parse_period(GF_MPD *mpd, GF_XMLNode *root)
+{
+	return gf_mpd_parse_period_ex(mpd, root, NULL);
+}
+
+static GF_Err gf_mpd_complete_from_dom_ex(GF_XMLNode *root, GF_MPD *mpd, const char *default_base_url, GF_MPD_DOMLoader *ld)
 {
 	GF_Err e;
 	u32 i;
@@ -1377,7 +1510,7 @@ GF_Err gf_mpd_complete_from_dom(GF_XMLNode *root, GF_MPD *mpd, const char *defau
 	}
 
 	if (!strcmp(root->name, "Period")) {
-		return gf_mpd_parse_period(mpd, root);
+		return gf_mpd_parse_period_ex(mpd, root, ld);
 	}
 
 	i = 0;
@@ -1436,7 +1569,7 @@ GF_Err gf_mpd_complete_from_dom(GF_XMLNode *root, GF_MPD *mpd, const char *defau
 			char *str = gf_mpd_parse_text_content(child);
 			if (str) gf_list_add(mpd->locations, str);
 		} else if (!strcmp(child->name, "Period")) {
-			e = gf_mpd_parse_period(mpd, child);
+			e = gf_mpd_parse_period_ex(mpd, child, ld);
 			if (e) return e;
 		} else if (!strcmp(child->name, "Metrics")) {
 			GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[MPD] Metrics not implemented yet\n"));
@@ -1465,7 +1598,12 @@ static void gf_mpd_init_struct(GF_MPD *mpd)
 }
 
 GF_EXPORT
-GF_Err gf_mpd_init_from_dom(GF_XMLNode *root, GF_MPD *mpd, const char *default_base_url)
+GF_Err gf_mpd_complete_from_dom(GF_XMLNode *root, GF_MPD *mpd, const char *default_base_url)
+{
+	return gf_mpd_complete_from_dom_ex(root, mpd, default_base_url, NULL);
+}
+
+static GF_Err gf_mpd_init_from_dom_ex(GF_XMLNode *root, GF_MPD *mpd, const char *default_base_url, GF_MPD_DOMLoader *ld)
 {
 	if (!root || !mpd) return GF_BAD_PARAM;
 
@@ -1476,7 +1614,63 @@ GF_Err gf_mpd_init_from_dom(GF_XMLNode *root, GF_MPD *mpd, const char *default_b
 	mpd->time_shift_buffer_depth = (u32) -1; /*infinite by default*/
 	mpd->xml_namespace = NULL;
 
-	return gf_mpd_complete_from_dom(root, mpd, default_base_url);
+	return gf_mpd_complete_from_dom_ex(root, mpd, default_base_url, ld);
+}
+
+GF_EXPORT
+GF_Err gf_mpd_init_from_dom(GF_XMLNode *root, GF_MPD *mpd, const char *default_base_url)
+{
+	return gf_mpd_init_from_dom_ex(root, mpd, default_base_url, NULL);
+}
+
+static GF_Err gf_mpd_parse_dom_ex(GF_DOMParser *parser, const char *file, GF_MPD *mpd, const char *default_base_url, u64 period_start, Double skip_end)
+{
+	GF_Err e;
+	u32 i, count;
+	GF_MPD_DOMLoader ld;
+
+	if (!parser || !file || !mpd) return GF_BAD_PARAM;
+	memset(&ld, 0, sizeof(GF_MPD_DOMLoader));
+	ld.timelines = gf_list_new();
+	if (!ld.timelines) return GF_OUT_OF_MEM;
+	ld.period_start = period_start;
+	ld.skip_end = skip_end;
+
+	gf_xml_dom_set_node_filter(parser, gf_mpd_dom_filter, &ld);
+	e = gf_xml_dom_parse(parser, file, NULL, NULL);
+	gf_xml_dom_set_node_filter(parser, NULL, NULL);
+
+	count = e ? 0 : gf_xml_dom_get_root_nodes_count(parser);
+	for (i=0; i<count; i++) {
+		GF_XMLNode *root = gf_xml_dom_get_root_idx(parser, i);
+		if (i) {
+			e = gf_mpd_complete_from_dom_ex(root, mpd, default_base_url, &ld);
+		} else {
+			e = gf_mpd_init_from_dom_ex(root, mpd, default_base_url, &ld);
+		}
+		if (e) break;
+	}
+
+	//timelines not assigned, their DOM node keys are no longer used past this point
+	while (gf_list_count(ld.timelines)) {
+		GF_MPD_DOMTimeline *dtl = gf_list_pop_back(ld.timelines);
+		gf_mpd_segment_timeline_free(dtl->timeline);
+		gf_free(dtl);
+	}
+	gf_list_del(ld.timelines);
+	return e;
+}
+
+GF_EXPORT
+GF_Err gf_mpd_parse_dom(GF_DOMParser *parser, const char *file, GF_MPD *mpd, const char *default_base_url)
+{
+	return gf_mpd_parse_dom_ex(parser, file, mpd, default_base_url, 0, 0);
+}
+
+GF_EXPORT
+GF_Err gf_mpd_parse_dom_update(GF_DOMParser *parser, const char *file, GF_MPD *mpd, const char *default_base_url, u64 period_start, Double skip_end)
+{
+	return gf_mpd_parse_dom_ex(parser, file, mpd, default_base_url, period_start, skip_end);
 }
 
 static GF_Err gf_m3u8_fill_mpd_struct(MasterPlaylist *pl, const char *m3u8_file, const char *src_base_url, const char *mpd_file, char *title, Double update_interval,
@@ -2385,7 +2579,7 @@ GF_Err gf_m3u8_solve_representation_xlink(GF_MPD_Representation *rep, GF_FileDow
 GF_EXPORT
 GF_MPD_SegmentList *gf_mpd_solve_segment_list_xlink(GF_MPD *mpd, GF_XMLNode *root)
 {
-	return gf_mpd_parse_segment_list(mpd, root);
+	return gf_mpd_parse_segment_list(mpd, root, NULL);
 }
 
 GF_EXPORT
@@ -4287,20 +4481,19 @@ void gf_mpd_resolve_segment_duration(GF_MPD_Representation *rep, GF_MPD_Adaptati
 static u64 gf_mpd_segment_timeline_start(GF_MPD_SegmentTimeline *timeline, u32 segment_index, u64 *segment_duration)
 {
 	u64 start_time = 0;
-	u32 i, idx, k;
+	u32 i, idx;
 	idx = 0;
 	for (i = 0; i<gf_list_count(timeline->entries); i++) {
 		GF_MPD_SegmentTimelineEntry *ent = gf_list_get(timeline->entries, i);
 		if (ent->start_time) start_time = ent->start_time;
-		for (k = 0; k<ent->repeat_count + 1; k++) {
-			if (idx == segment_index) {
-				if (segment_duration)
-					*segment_duration = ent->duration;
-				return start_time;
-			}
-			idx++;
-			start_time += ent->duration;
+		//segment is in this entry, no need to walk repeated segments
+		if (segment_index - idx <= ent->repeat_count) {
+			if (segment_duration)
+				*segment_duration = ent->duration;
+			return start_time + (u64) (segment_index - idx) * ent->duration;
 		}
+		idx += ent->repeat_count + 1;
+		start_time += (u64) (ent->repeat_count + 1) * ent->duration;
 	}
 	return start_time;
 }
@@ -5176,7 +5369,7 @@ GF_Err gf_mpd_split_adaptation_sets(GF_MPD *mpd)
 				dom = gf_xml_dom_new();
 				gf_xml_dom_parse(dom, szAdd, NULL, NULL);
 				root = gf_xml_dom_get_root(dom);
-				gf_mpd_parse_adaptation_set(mpd, new_as, root);
+				gf_mpd_parse_adaptation_set(mpd, new_as, root, NULL);
 				gf_xml_dom_del(dom);
 				gf_free(data);
 				gf_fclose(f);
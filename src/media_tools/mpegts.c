@@ -287,17 +287,35 @@ static void gf_m2ts_reset_sections(GF_List *sections)
 	}
 }
 
+static void gf_m2ts_reset_section_copies(GF_M2TS_Table *t)
+{
+	u32 i;
+	if (!t->section_copies) return;
+	for (i=0; i<256; i++) {
+		if (t->section_copies[i]) gf_free(t->section_copies[i]);
+	}
+	gf_free(t->section_copies);
+	gf_free(t->section_sizes);
+	gf_free(t->section_allocs);
+	t->section_copies = NULL;
+	t->section_sizes = NULL;
+	t->section_allocs = NULL;
+}
+
 static void gf_m2ts_section_filter_reset(GF_M2TS_SectionFilter *sf)
 {
-	if (sf->section) {
-		gf_free(sf->section);
-		sf->section = NULL;
+	if (sf->section_buffer) {
+		gf_free(sf->section_buffer);
+		sf->section_buffer = NULL;
 	}
+	sf->section = NULL;
+	sf->section_alloc = 0;
 	while (sf->table) {
 		GF_M2TS_Table *t = sf->table;
 		sf->table = t->next;
 		gf_m2ts_reset_sections(t->sections);
 		gf_list_del(t->sections);
+		gf_m2ts_reset_section_copies(t);
 		gf_free(t);
 	}
 	sf->cc = -1;
@@ -374,12 +392,80 @@ GF_M2TS_SDT *gf_m2ts_get_sdt_info(GF_M2TS_Demuxer *ts, u32 program_id)
 	return NULL;
 }
 
+/*sections are gathered in a buffer kept by the section filter, so that no allocation is done for each section*/
+#define M2TS_SECTION_POOL_SIZE	4096
+
+static u8 *gf_m2ts_section_buffer(GF_M2TS_SectionFilter *sec, u32 size)
+{
+	if (!sec->section_buffer || (size > sec->section_alloc)) {
+		u32 alloc_size = MAX(size, M2TS_SECTION_POOL_SIZE);
+		u8 *buf = gf_realloc(sec->section_buffer, alloc_size);
+		if (!buf) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[MPEG-2 TS] Fail to allocate section buffer of %d bytes\n", size));
+			sec->section = NULL;
+			return NULL;
+		}
+		sec->section_buffer = buf;
+		sec->section_alloc = alloc_size;
+	}
+	sec->section = sec->section_buffer;
+	return sec->section;
+}
+
+/*checks CRC of a section with syntax indicator, len excluding CRC
+a section identical to the last valid one with the same section number in this table is not checked again, unless repeated sections are forwarded*/
+static Bool gf_m2ts_section_crc_check(GF_M2TS_Table *t, GF_M2TS_SECTION_ES *ses, u8 *data, u32 len)
+{
+	u8 sec_num = data[6];
+	u32 crc_val = GF_4CC((u32) data[len], (u8) data[len+1], (u8) data[len+2], (u8) data[len+3]);
+	Bool use_cache = (ses && (ses->flags & GF_M2TS_ES_SEND_REPEATED_SECTIONS)) ? GF_FALSE : GF_TRUE;
+
+	//compare the whole section including CRC, comparing is much cheaper than computing the CRC
+	if (use_cache && t->section_copies && (t->section_sizes[sec_num] == len+4)
+		&& !memcmp(t->section_copies[sec_num], data, len+4)
+	) {
+		return GF_TRUE;
+	}
+	if (gf_crc_32(data, len) != crc_val)
+		return GF_FALSE;
+
+	if (!use_cache) return GF_TRUE;
+	if (!t->section_copies) {
+		t->section_copies = gf_malloc(sizeof(u8 *) * 256);
+		t->section_sizes = gf_malloc(sizeof(u16) * 256);
+		t->section_allocs = gf_malloc(sizeof(u16) * 256);
+		if (!t->section_copies || !t->section_sizes || !t->section_allocs) {
+			if (t->section_copies) gf_free(t->section_copies);
+			if (t->section_sizes) gf_free(t->section_sizes);
+			if (t->section_allocs) gf_free(t->section_allocs);
+			t->section_copies = NULL;
+			t->section_sizes = NULL;
+			t->section_allocs = NULL;
+			return GF_TRUE;
+		}
+		memset(t->section_copies, 0, sizeof(u8 *) * 256);
+		memset(t->section_sizes, 0, sizeof(u16) * 256);
+		memset(t->section_allocs, 0, sizeof(u16) * 256);
+	}
+	if (t->section_allocs[sec_num] < len+4) {
+		u8 *copy = gf_realloc(t->section_copies[sec_num], len+4);
+		if (!copy) {
+			t->section_sizes[sec_num] = 0;
+			return GF_TRUE;
+		}
+		t->section_copies[sec_num] = copy;
+		t->section_allocs[sec_num] = len+4;
+	}
+	memcpy(t->section_copies[sec_num], data, len+4);
+	t->section_sizes[sec_num] = len+4;
+	return GF_TRUE;
+}
+
 static void gf_m2ts_section_complete(GF_M2TS_Demuxer *ts, GF_M2TS_SectionFilter *sec, GF_M2TS_SECTION_ES *ses)
 {
 	//seek mode, only process PAT and PMT
 	if (ts->seek_mode && (sec->section[0] != GF_M2TS_TABLE_ID_PAT) && (sec->section[0] != GF_M2TS_TABLE_ID_PMT)) {
 		/*clean-up (including broken sections)*/
-		if (sec->section) gf_free(sec->section);
 		sec->section = NULL;
 		sec->length = sec->received = 0;
 		return;
@@ -503,7 +589,7 @@ static void gf_m2ts_section_complete(GF_M2TS_Demuxer *ts, GF_M2TS_SectionFilter
 			} else {
 				/*remove crc32*/
 				sec->length -= 4;
-				if (gf_m2ts_crc32_check((char *)data, sec->length)) {
+				if (gf_m2ts_section_crc_check(t, ses, data, sec->length)) {
 					s32 cur_sec_num;
 					t->version_number = (data[5] >> 1) & 0x1f;
 					if (t->last_section_number && t->section_number && (t->version_number != t->last_version_number)) {
@@ -622,7 +708,6 @@ static void gf_m2ts_section_complete(GF_M2TS_Demuxer *ts, GF_M2TS_SectionFilter
 		}
 	}
 	/*clean-up (including broken sections)*/
-	if (sec->section) gf_free(sec->section);
 	sec->section = NULL;
 	sec->length = sec->received = 0;
 }
@@ -687,7 +772,10 @@ static void gf_m2ts_gather_section(GF_M2TS_Demuxer *ts, GF_M2TS_SectionFilter *s
 				sec->length = gf_m2ts_get_section_length(sec->section[0], data[1], data[2]);
 			else /* (sec->received == 2)  */
 				sec->length = gf_m2ts_get_section_length(sec->section[0], sec->section[1], data[1]);
-			sec->section = (char*)gf_realloc(sec->section, sizeof(char)*sec->length);
+			if (!gf_m2ts_section_buffer(sec, sec->length)) {
+				sec->length = sec->received = 0;
+				return;
+			}
 		}
 
 		if (sec->length && sec->received + ptr_field >= sec->length) {
@@ -704,13 +792,12 @@ static void gf_m2ts_gather_section(GF_M2TS_Demuxer *ts, GF_M2TS_SectionFilter *s
 
 aggregated_section:
 
-		if (sec->section) gf_free(sec->section);
 		sec->length = sec->received = 0;
-		sec->section = (char*)gf_malloc(sizeof(char)*data_size);
+		if (!gf_m2ts_section_buffer(sec, data_size))
+			return;
 		memcpy(sec->section, data, sizeof(char)*data_size);
 		sec->received = data_size;
 	} else if (disc) {
-		if (sec->section) gf_free(sec->section);
 		sec->section = NULL;
 		sec->received = sec->length = 0;
 		return;
@@ -720,18 +807,20 @@ aggregated_section:
 		if (sec->length && sec->received+data_size > sec->length)
 			data_size = sec->length - sec->received;
 
-		if (sec->length) {
-			memcpy(sec->section + sec->received, data, sizeof(char)*data_size);
-		} else {
-			sec->section = (char*)gf_realloc(sec->section, sizeof(char)*(sec->received+data_size));
-			memcpy(sec->section + sec->received, data, sizeof(char)*data_size);
+		if (!sec->length && !gf_m2ts_section_buffer(sec, sec->received+data_size)) {
+			sec->received = 0;
+			return;
 		}
+		memcpy(sec->section + sec->received, data, sizeof(char)*data_size);
 		sec->received += data_size;
 	}
 	/*alloc final buffer*/
 	if (!sec->length && (sec->received >= 3)) {
 		sec->length = gf_m2ts_get_section_length(sec->section[0], sec->section[1], sec->section[2]);
-		sec->section = (char*)gf_realloc(sec->section, sizeof(char)*sec->length);
+		if (!gf_m2ts_section_buffer(sec, sec->length)) {
+			sec->length = sec->received = 0;
+			return;
+		}
 
 		if (sec->received > sec->length) {
 			data_size -= sec->received - sec->length;
@@ -1956,7 +2045,7 @@ static void gf_m2ts_store_temi(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes)
 	pes->temi_pending = 1;
 }
 
-void gf_m2ts_flush_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes)
+static void gf_m2ts_flush_pes_ex(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, u32 pck_number)
 {
 	GF_M2TS_PESHeader pesh;
 	if (!ts) return;
@@ -1994,7 +2083,7 @@ void gf_m2ts_flush_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes)
 				pck.DTS = pesh.DTS;
 				pck.stream = pes;
 				if (pes->rap) pck.flags |= GF_M2TS_PES_PCK_RAP;
-				pes->pes_end_packet_number = ts->pck_number;
+				pes->pes_end_packet_number = pck_number;
 				if (ts->on_event) ts->on_event(ts, GF_M2TS_EVT_PES_TIMING, &pck);
 			}
 			GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG-2 TS] PID %d Got PES header DTS %d PTS %d\n", pes->pid, pesh.DTS, pesh.PTS));
@@ -2104,7 +2193,7 @@ void gf_m2ts_flush_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes)
 	pes->rap = 0;
 }
 
-static void gf_m2ts_process_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, GF_M2TS_Header *hdr, unsigned char *data, u32 data_size, GF_M2TS_AdaptationField *paf)
+static void gf_m2ts_process_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, GF_M2TS_Header *hdr, unsigned char *data, u32 data_size, GF_M2TS_AdaptationField *paf, u32 pck_number)
 {
 	u8 expect_cc;
 	Bool disc=0;
@@ -2150,7 +2239,7 @@ static void gf_m2ts_process_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, GF_M2TS_H
 
 	if (hdr->payload_start) {
 		flush_pes = 1;
-		pes->pes_start_packet_number = ts->pck_number;
+		pes->pes_start_packet_number = pck_number;
 		pes->before_last_pcr_value = pes->program->before_last_pcr_value;
 		pes->before_last_pcr_value_pck_number = pes->program->before_last_pcr_value_pck_number;
 		pes->last_pcr_value = pes->program->last_pcr_value;
@@ -2171,7 +2260,7 @@ static void gf_m2ts_process_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, GF_M2TS_H
 
 	/*PES first fragment: flush previous packet*/
 	if (flush_pes && pes->pck_data_len) {
-		gf_m2ts_flush_pes(ts, pes);
+		gf_m2ts_flush_pes_ex(ts, pes, pck_number);
 		if (!data_size) return;
 	}
 	/*we need to wait for first packet of PES*/
@@ -2193,11 +2282,16 @@ static void gf_m2ts_process_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, GF_M2TS_H
 		GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG-2 TS] PID %d: Got PES packet len %d\n", pes->pid, pes->pes_len));
 
 		if (pes->pes_len + 6 == pes->pck_data_len) {
-			gf_m2ts_flush_pes(ts, pes);
+			gf_m2ts_flush_pes_ex(ts, pes, pck_number);
 		}
 	}
 }
 
+void gf_m2ts_flush_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes)
+{
+	if (ts) gf_m2ts_flush_pes_ex(ts, pes, ts->pck_number);
+}
+
 void gf_m2ts_flush_all(GF_M2TS_Demuxer *ts)
 {
 	u32 i;
@@ -2366,7 +2460,8 @@ static void gf_m2ts_get_adaptation_field(GF_M2TS_Demuxer *ts, GF_M2TS_Adaptation
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG-2 TS] PID %d: Adaptation Field found: Discontinuity %d - RAP %d - PCR: "LLD"\n", pid, paf->discontinuity_indicator, paf->random_access_indicator, paf->PCR_flag ? paf->PCR_base * 300 + paf->PCR_ext : 0));
 }
 
-static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
+GF_EXPORT
+GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, u8 *data, u32 pck_number)
 {
 	GF_M2TS_ES *es;
 	GF_M2TS_Header hdr;
@@ -2374,12 +2469,10 @@ static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 	u32 payload_size, af_size;
 	u32 pos = 0;
 
-	ts->pck_number++;
-
 	/* read TS packet header*/
 	hdr.sync = data[0];
 	if (hdr.sync != 0x47) {
-		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d does not start with sync marker\n", ts->pck_number));
+		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d does not start with sync marker\n", pck_number));
 		return GF_CORRUPTED_DATA;
 	}
 	hdr.error = (data[1] & 0x80) ? 1 : 0;
@@ -2391,16 +2484,16 @@ static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 	hdr.continuity_counter = data[3] & 0xf;
 
 	if (hdr.error) {
-		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d has error (PID could be %d)\n", ts->pck_number, hdr.pid));
+		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d has error (PID could be %d)\n", pck_number, hdr.pid));
 		return GF_CORRUPTED_DATA;
 	}
 //#if DEBUG_TS_PACKET
-	GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d PID %d CC %d Encrypted %d\n", ts->pck_number, hdr.pid, hdr.continuity_counter, hdr.scrambling_ctrl));
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d PID %d CC %d Encrypted %d\n", pck_number, hdr.pid, hdr.continuity_counter, hdr.scrambling_ctrl));
 //#endif
 
 	if (hdr.scrambling_ctrl) {
 		//TODO add decyphering
-		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d is scrambled - not supported\n", ts->pck_number, hdr.pid));
+		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d is scrambled - not supported\n", pck_number, hdr.pid));
 		return GF_NOT_SUPPORTED;
 	}
 
@@ -2412,7 +2505,7 @@ static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 	case 3:
 		af_size = data[4];
 		if (af_size>183) {
-			GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d AF field larger than 183 !\n", ts->pck_number));
+			GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d AF field larger than 183 !\n", pck_number));
 			//error
 			return GF_CORRUPTED_DATA;
 		}
@@ -2421,7 +2514,7 @@ static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 		//this will stop you when processing invalid (yet existing) mpeg2ts streams in debug
 		assert( af_size<=183);
 		if (af_size>183)
-			GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d Detected wrong adaption field size %u when control value is 3\n", ts->pck_number, af_size));
+			GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d Detected wrong adaption field size %u when control value is 3\n", pck_number, af_size));
 		if (af_size) gf_m2ts_get_adaptation_field(ts, paf, data+5, af_size, hdr.pid);
 		pos += 1+af_size;
 		payload_size = 183 - af_size;
@@ -2430,7 +2523,7 @@ static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 	case 2:
 		af_size = data[4];
 		if (af_size != 183) {
-			GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d AF size is %d when it must be 183 for AF type 2\n", ts->pck_number, af_size));
+			GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] TS Packet %d AF size is %d when it must be 183 for AF type 2\n", pck_number, af_size));
 			return GF_CORRUPTED_DATA;
 		}
 		paf = &af;
@@ -2534,7 +2627,7 @@ static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 			prev_diff_in_us = (s64) (es->program->last_pcr_value /27- es->program->before_last_pcr_value/27);
 			es->program->before_last_pcr_value = es->program->last_pcr_value;
 			es->program->before_last_pcr_value_pck_number = es->program->last_pcr_value_pck_number;
-			es->program->last_pcr_value_pck_number = ts->pck_number;
+			es->program->last_pcr_value_pck_number = pck_number;
 			es->program->last_pcr_value = paf->PCR_base * 300 + paf->PCR_ext;
 			if (!es->program->last_pcr_value) es->program->last_pcr_value =  1;
 
@@ -2611,12 +2704,22 @@ static GF_Err gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 	} else {
 		GF_M2TS_PES *pes = (GF_M2TS_PES *)es;
 		/* regular stream using PES packets */
-		if (pes->reframe && payload_size) gf_m2ts_process_pes(ts, pes, &hdr, data, payload_size, paf);
+		if (pes->reframe && payload_size) gf_m2ts_process_pes(ts, pes, &hdr, data, payload_size, paf, pck_number);
 	}
 
 	return GF_OK;
 }
 
+static GF_Err gf_m2ts_route_packet(GF_M2TS_Demuxer *ts, u8 *data)
+{
+	ts->pck_number++;
+	if (ts->on_packet) {
+		ts->on_packet(ts, data, ts->pck_number);
+		return GF_OK;
+	}
+	return gf_m2ts_process_packet(ts, data, ts->pck_number);
+}
+
 GF_EXPORT
 GF_Err gf_m2ts_process_data(GF_M2TS_Demuxer *ts, u8 *data, u32 data_size)
 {
@@ -2634,7 +2737,7 @@ GF_Err gf_m2ts_process_data(GF_M2TS_Demuxer *ts, u8 *data, u32 data_size)
 				ts->buffer = (char*)gf_realloc(ts->buffer, sizeof(char)*ts->alloc_size);
 			}
 			memcpy(ts->buffer + ts->buffer_size, data, pck_size - ts->buffer_size);
-			e |= gf_m2ts_process_packet(ts, (unsigned char *)ts->buffer);
+			e |= gf_m2ts_route_packet(ts, (u8 *)ts->buffer);
 			data += (pck_size - ts->buffer_size);
 			data_size = data_size - (pck_size - ts->buffer_size);
 		}
@@ -2691,7 +2794,7 @@ GF_Err gf_m2ts_process_data(GF_M2TS_Demuxer *ts, u8 *data, u32 data_size)
 			return e;
 		}
 		/*process*/
-		e |= gf_m2ts_process_packet(ts, (unsigned char *)data + pos);
+		e |= gf_m2ts_route_packet(ts, (u8 *)data + pos);
 		pos += pck_size;
 	}
 	return e;
@@ -166,6 +166,8 @@ struct __DownloadedCacheEntryStruct
 	u8 *mem_storage;
 	char *forced_headers;
 	u32 downtime;
+	/*last time the entry was looked up, used for LRU eviction*/
+	u64 last_access;
 
 	GF_Blob cache_blob;
 };
@@ -443,6 +445,7 @@ DownloadedCacheEntry gf_cache_create_entry ( GF_DownloadManager * dm, const char
 	entry->dm = dm;
 	entry->range_start = start_range;
 	entry->range_end = end_range;
+	entry->last_access = gf_sys_clock_high_res();
 
 #ifdef ENABLE_WRITE_MX
 	{
@@ -922,6 +925,7 @@ Bool gf_cache_set_range(const DownloadedCacheEntry entry, u64 size, u64 start_ra
 	if (!entry || !entry->memory_stored) return GF_FALSE;
 	entry->range_start = start_range;
 	entry->range_end = end_range;
+	entry->last_access = gf_sys_clock_high_res();
 	entry->contentLength = (u32) size;
 	entry->continue_file = GF_FALSE;
 	return GF_TRUE;
@@ -949,6 +953,15 @@ u32 gf_cache_get_downtime(const DownloadedCacheEntry entry)
 	if (!entry) return 0;
 	return entry->downtime;
 }
+void gf_cache_set_last_access(const DownloadedCacheEntry entry)
+{
+	if (entry) entry->last_access = gf_sys_clock_high_res();
+}
+u64 gf_cache_get_last_access(const DownloadedCacheEntry entry)
+{
+	if (!entry) return 0;
+	return entry->last_access;
+}
 
 Bool gf_cache_set_content(const DownloadedCacheEntry entry, char *data, u32 size, Bool copy)
 {
@@ -61,6 +61,7 @@
 
 
 static void gf_dm_connect(GF_DownloadSession *sess);
+void http_do_requests(GF_DownloadSession *sess);
 
 /*internal flags*/
 enum
@@ -205,6 +206,29 @@ struct __gf_download_session
 	u32 put_state;
 };
 
+/*idle keep-alive connection left by a destroyed session, reused by the next session to the same host*/
+typedef struct
+{
+	char *server_name;
+	u16 port;
+	Bool use_ssl;
+	GF_Socket *sock;
+#ifdef GPAC_HAS_SSL
+	SSL *ssl;
+#endif
+	u64 park_time;
+} GF_DMIdleConnection;
+
+#ifdef GPAC_HAS_SSL
+/*TLS session kept per host for abbreviated handshakes*/
+typedef struct
+{
+	char *server_name;
+	u16 port;
+	SSL_SESSION *ssl_sess;
+} GF_DMTLSSession;
+#endif
+
 struct __gf_download_manager
 {
 	GF_Mutex *cache_mx;
@@ -221,12 +245,20 @@ struct __gf_download_manager
 
 	GF_List *skip_proxy_servers;
 	GF_List *credentials;
-	GF_List *cache_entries;
+	/*cache entries indexed by URL hash, one list of entries per bucket*/
+	GF_List **cache_buckets;
+	u32 nb_cache_buckets, nb_cache_entries;
+	/*estimated size in bytes of completed cache entries, used to trigger eviction*/
+	u64 cache_size;
+	u32 cache_hits, cache_misses;
 	/* FIXME : should be placed in DownloadedCacheEntry maybe... */
 	GF_List *partial_downloads;
 #ifdef GPAC_HAS_SSL
 	SSL_CTX *ssl_ctx;
+	GF_List *tls_sessions;
 #endif
+	/*idle persistent connections, protected by cache_mx*/
+	GF_List *idle_connections;
 
 	GF_FilterSession *filter_session;
 
@@ -295,6 +327,9 @@ void gf_cache_set_end_range(DownloadedCacheEntry entry, u64 range_end);
 /*returns 1 if cache is currently open for write*/
 Bool gf_cache_is_in_progress(const DownloadedCacheEntry entry);
 
+void gf_cache_set_last_access(const DownloadedCacheEntry entry);
+u64 gf_cache_get_last_access(const DownloadedCacheEntry entry);
+
 /**
  * Find a User's credentials for a given site
  */
@@ -415,6 +450,64 @@ Bool gf_ssl_init_lib() {
 	return GF_FALSE;
 }
 
+static int ssl_new_session_cbk(SSL *ssl, SSL_SESSION *ssl_sess)
+{
+	u32 i, count;
+	GF_DMTLSSession *tls = NULL;
+	GF_DownloadSession *sess = (GF_DownloadSession *) SSL_get_app_data(ssl);
+	if (!sess || !sess->dm || !sess->server_name) return 0;
+
+	gf_mx_p(sess->dm->cache_mx);
+	count = gf_list_count(sess->dm->tls_sessions);
+	for (i=0; i<count; i++) {
+		tls = (GF_DMTLSSession *) gf_list_get(sess->dm->tls_sessions, i);
+		if ((tls->port == sess->port) && !strcmp(tls->server_name, sess->server_name))
+			break;
+		tls = NULL;
+	}
+	if (!tls) {
+		GF_SAFEALLOC(tls, GF_DMTLSSession);
+		if (!tls) {
+			gf_mx_v(sess->dm->cache_mx);
+			return 0;
+		}
+		tls->server_name = gf_strdup(sess->server_name);
+		tls->port = sess->port;
+		gf_list_add(sess->dm->tls_sessions, tls);
+	}
+	if (tls->ssl_sess) SSL_SESSION_free(tls->ssl_sess);
+	/*we keep the reference*/
+	tls->ssl_sess = ssl_sess;
+	gf_mx_v(sess->dm->cache_mx);
+	return 1;
+}
+
+static SSL_SESSION *ssl_get_session(GF_DownloadSession *sess)
+{
+	u32 i, count;
+	SSL_SESSION *res = NULL;
+	if (!sess->dm || !sess->server_name) return NULL;
+	gf_mx_p(sess->dm->cache_mx);
+	count = gf_list_count(sess->dm->tls_sessions);
+	for (i=0; i<count; i++) {
+		GF_DMTLSSession *tls = (GF_DMTLSSession *) gf_list_get(sess->dm->tls_sessions, i);
+		if ((tls->port == sess->port) && !strcmp(tls->server_name, sess->server_name)) {
+			res = tls->ssl_sess;
+			break;
+		}
+	}
+	/*the stored session may be replaced by another thread once the lock is released, caller must free the returned reference*/
+	if (res) {
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+		CRYPTO_add(&res->references, 1, CRYPTO_LOCK_SSL_SESSION);
+#else
+		SSL_SESSION_up_ref(res);
+#endif
+	}
+	gf_mx_v(sess->dm->cache_mx);
+	return res;
+}
+
 static int ssl_init(GF_DownloadManager *dm, u32 mode)
 {
 #if OPENSSL_VERSION_NUMBER > 0x00909000
@@ -473,6 +566,10 @@ static int ssl_init(GF_DownloadManager *dm, u32 mode)
 	/* Since fd_write unconditionally assumes partial writes (and handles them correctly),
 	allow them in OpenSSL.  */
 	SSL_CTX_set_mode(dm->ssl_ctx, SSL_MODE_ENABLE_PARTIAL_WRITE);
+
+	/*keep TLS sessions per host so that new connections to the same host use an abbreviated handshake*/
+	SSL_CTX_set_session_cache_mode(dm->ssl_ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+	SSL_CTX_sess_set_new_cb(dm->ssl_ctx, ssl_new_session_cbk);
 	gf_mx_v(dm->cache_mx);
 	return 1;
 error:
@@ -584,15 +681,148 @@ static Bool gf_dm_can_handle_url(GF_DownloadManager *dm, const char *url)
 \param sess The session configured with the URL
 \param NULL if none found, the DownloadedCacheEntry otherwise
  */
+
+#define GF_DM_CACHE_MIN_BUCKETS	64
+/*max average number of entries per bucket before the cache index is grown*/
+#define GF_DM_CACHE_MAX_LOAD	4
+
+static GFINLINE u32 gf_dm_cache_url_hash(const char *url)
+{
+	return gf_crc_32((const u8 *) url, (u32) strlen(url));
+}
+
+static GFINLINE GF_List *gf_dm_cache_bucket(GF_DownloadManager *dm, const char *url)
+{
+	return dm->cache_buckets[gf_dm_cache_url_hash(url) & (dm->nb_cache_buckets-1)];
+}
+
+/*rebuilds the cache index with nb_buckets buckets (power of 2), must be called with cache mutex held*/
+static GF_Err gf_dm_cache_index_resize(GF_DownloadManager *dm, u32 nb_buckets)
+{
+	u32 i, j;
+	GF_List **buckets = (GF_List **) gf_malloc(sizeof(GF_List *) * nb_buckets);
+	if (!buckets) return GF_OUT_OF_MEM;
+	for (i=0; i<nb_buckets; i++) {
+		buckets[i] = gf_list_new();
+	}
+	for (i=0; i<dm->nb_cache_buckets; i++) {
+		GF_List *bucket = dm->cache_buckets[i];
+		for (j=0; j<gf_list_count(bucket); j++) {
+			DownloadedCacheEntry e = (DownloadedCacheEntry)gf_list_get(bucket, j);
+			gf_list_add(buckets[gf_dm_cache_url_hash(gf_cache_get_url(e)) & (nb_buckets-1)], e);
+		}
+		gf_list_del(bucket);
+	}
+	if (dm->cache_buckets) gf_free(dm->cache_buckets);
+	dm->cache_buckets = buckets;
+	dm->nb_cache_buckets = nb_buckets;
+	return GF_OK;
+}
+
+/*size accounted for an entry in the cache budget, memory entries are not accounted*/
+static u32 gf_dm_cache_entry_disk_size(DownloadedCacheEntry entry)
+{
+	const char *name = gf_cache_get_cache_filename(entry);
+	if (!name || !strncmp(name, "gmem://", 7)) return 0;
+	return gf_cache_get_content_length(entry);
+}
+
+/*adds an entry to the cache index, must be called with cache mutex held*/
+static void gf_dm_cache_entry_add(GF_DownloadManager *dm, DownloadedCacheEntry entry)
+{
+	if (dm->nb_cache_entries >= GF_DM_CACHE_MAX_LOAD * dm->nb_cache_buckets)
+		gf_dm_cache_index_resize(dm, 2 * dm->nb_cache_buckets);
+
+	gf_list_add(gf_dm_cache_bucket(dm, gf_cache_get_url(entry)), entry);
+	dm->nb_cache_entries++;
+}
+
+/*removes an entry from the cache index without destroying it, must be called with cache mutex held
+returns GF_FALSE if the entry is not in the index*/
+static Bool gf_dm_cache_entry_rem(GF_DownloadManager *dm, DownloadedCacheEntry entry)
+{
+	u32 size;
+	if (gf_list_del_item(gf_dm_cache_bucket(dm, gf_cache_get_url(entry)), entry) < 0)
+		return GF_FALSE;
+
+	dm->nb_cache_entries--;
+	size = gf_dm_cache_entry_disk_size(entry);
+	dm->cache_size = (dm->cache_size > size) ? dm->cache_size - size : 0;
+	return GF_TRUE;
+}
+
+static int gf_dm_cache_lru_cmp(const void *a, const void *b)
+{
+	u64 t_a = gf_cache_get_last_access(*(DownloadedCacheEntry *)a);
+	u64 t_b = gf_cache_get_last_access(*(DownloadedCacheEntry *)b);
+	if (t_a < t_b) return -1;
+	if (t_a > t_b) return 1;
+	return 0;
+}
+
+/*evicts least recently used entries not attached to any session until the cache size is back under 90% of the max cache size
+must be called with cache mutex held*/
+static void gf_dm_cache_evict(GF_DownloadManager *dm)
+{
+	u32 i, j, nb_cands=0, nb_evicted=0;
+	u64 target;
+	DownloadedCacheEntry *cands;
+
+	if (!dm->nb_cache_entries) return;
+	cands = (DownloadedCacheEntry *) gf_malloc(sizeof(DownloadedCacheEntry) * dm->nb_cache_entries);
+	if (!cands) return;
+
+	//recompute actual size
+	dm->cache_size = 0;
+	for (i=0; i<dm->nb_cache_buckets; i++) {
+		GF_List *bucket = dm->cache_buckets[i];
+		for (j=0; j<gf_list_count(bucket); j++) {
+			DownloadedCacheEntry e = (DownloadedCacheEntry)gf_list_get(bucket, j);
+			u32 size = gf_dm_cache_entry_disk_size(e);
+			if (!size) continue;
+			dm->cache_size += size;
+			if (gf_cache_get_sessions_count_for_cache_entry(e) || gf_cache_is_in_progress(e))
+				continue;
+			cands[nb_cands++] = e;
+		}
+	}
+	target = dm->max_cache_size - dm->max_cache_size/10;
+	if (dm->cache_size > target) {
+		qsort(cands, nb_cands, sizeof(DownloadedCacheEntry), gf_dm_cache_lru_cmp);
+		for (i=0; (i<nb_cands) && (dm->cache_size > target); i++) {
+			gf_dm_cache_entry_rem(dm, cands[i]);
+			gf_cache_entry_set_delete_files_when_deleted(cands[i]);
+			gf_cache_delete_entry(cands[i]);
+			nb_evicted++;
+		}
+		GF_LOG(GF_LOG_INFO, GF_LOG_CACHE, ("[Cache] Evicted %d entries, cache size now "LLU" bytes for "LLU" max\n", nb_evicted, dm->cache_size, dm->max_cache_size));
+	}
+	gf_free(cands);
+}
+
+/*signals a completed cache entry, evicting older entries if the max cache size is exceeded*/
+static void gf_dm_cache_entry_done(GF_DownloadManager *dm, DownloadedCacheEntry entry)
+{
+	if (!dm || !entry) return;
+	gf_mx_p(dm->cache_mx);
+	gf_cache_set_last_access(entry);
+	dm->cache_size += gf_dm_cache_entry_disk_size(entry);
+	if (dm->max_cache_size && (dm->cache_size > dm->max_cache_size))
+		gf_dm_cache_evict(dm);
+	gf_mx_v(dm->cache_mx);
+}
+
 DownloadedCacheEntry gf_dm_find_cached_entry_by_url(GF_DownloadSession * sess)
 {
 	u32 i, count;
-	assert( sess && sess->dm && sess->dm->cache_entries );
+	GF_List *bucket;
+	assert( sess && sess->dm && sess->dm->cache_buckets );
 	gf_mx_p( sess->dm->cache_mx );
-	count = gf_list_count(sess->dm->cache_entries);
+	bucket = gf_dm_cache_bucket(sess->dm, sess->orig_url);
+	count = gf_list_count(bucket);
 	for (i = 0 ; i < count; i++) {
 		const char * url;
-		DownloadedCacheEntry e = (DownloadedCacheEntry)gf_list_get(sess->dm->cache_entries, i);
+		DownloadedCacheEntry e = (DownloadedCacheEntry)gf_list_get(bucket, i);
 		assert(e);
 		url = gf_cache_get_url(e);
 		assert( url );
@@ -605,9 +835,12 @@ DownloadedCacheEntry gf_dm_find_cached_entry_by_url(GF_DownloadSession * sess)
 			if (sess->range_end != gf_cache_get_end_range(e)) continue;
 		}
 		/*OK that's ours*/
+		gf_cache_set_last_access(e);
+		sess->dm->cache_hits++;
 		gf_mx_v( sess->dm->cache_mx );
 		return e;
 	}
+	sess->dm->cache_misses++;
 	gf_mx_v( sess->dm->cache_mx );
 	return NULL;
 }
@@ -654,17 +887,10 @@ static void gf_dm_remove_cache_entry_from_session(GF_DownloadSession * sess) {
 
 		        && (0 == gf_cache_get_sessions_count_for_cache_entry(sess->cache_entry)))
 		{
-			u32 i, count;
 			gf_mx_p( sess->dm->cache_mx );
-			count = gf_list_count( sess->dm->cache_entries );
-			for (i = 0; i < count; i++) {
-				DownloadedCacheEntry ex = (DownloadedCacheEntry)gf_list_get(sess->dm->cache_entries, i);
-				if (ex == sess->cache_entry) {
-					gf_list_rem(sess->dm->cache_entries, i);
-					gf_cache_delete_entry( sess->cache_entry );
-					sess->cache_entry = NULL;
-					break;
-				}
+			if (gf_dm_cache_entry_rem(sess->dm, sess->cache_entry)) {
+				gf_cache_delete_entry( sess->cache_entry );
+				sess->cache_entry = NULL;
 			}
 			gf_mx_v( sess->dm->cache_mx );
 		}
@@ -686,11 +912,14 @@ static void gf_dm_configure_cache(GF_DownloadSession *sess)
 {
 	DownloadedCacheEntry entry;
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_CACHE, ("[Downloader] gf_dm_configure_cache(%p), cached=%s\n", sess, (sess->flags & GF_NETIO_SESSION_NOT_CACHED) ? "no" : "yes" ));
+	//lock cache until the session is attached to its entry, so that the entry cannot be evicted
+	gf_mx_p( sess->dm->cache_mx );
 	gf_dm_remove_cache_entry_from_session(sess);
 	if (sess->flags & GF_NETIO_SESSION_NOT_CACHED) {
 		sess->reused_cache_entry = GF_FALSE;
 		if (sess->cache_entry)
 			gf_cache_close_write_cache(sess->cache_entry, sess, GF_FALSE);
+		gf_mx_v( sess->dm->cache_mx );
 	} else {
 		Bool found = GF_FALSE;
 		u32 i, count;
@@ -699,6 +928,7 @@ static void gf_dm_configure_cache(GF_DownloadSession *sess)
 			if (sess->local_cache_only) {
 				sess->cache_entry = NULL;
 				sess->last_error = GF_URL_ERROR;
+				gf_mx_v( sess->dm->cache_mx );
 				return;
 			}
 			/* We found the existing session */
@@ -708,18 +938,14 @@ static void gf_dm_configure_cache(GF_DownloadSession *sess)
 					gf_cache_entry_set_delete_files_when_deleted(sess->cache_entry);
 
 				if (0 == gf_cache_get_sessions_count_for_cache_entry(sess->cache_entry)) {
-					gf_mx_p( sess->dm->cache_mx );
 					/* No session attached anymore... we can delete it */
-					gf_list_del_item(sess->dm->cache_entries, sess->cache_entry);
-					gf_mx_v( sess->dm->cache_mx );
+					gf_dm_cache_entry_rem(sess->dm, sess->cache_entry);
 					gf_cache_delete_entry(sess->cache_entry);
 				}
 				sess->cache_entry = NULL;
 			}
 			entry = gf_cache_create_entry(sess->dm, sess->dm->cache_directory, sess->orig_url, sess->range_start, sess->range_end, (sess->flags&GF_NETIO_SESSION_MEMORY_CACHE) ? GF_TRUE : GF_FALSE);
-			gf_mx_p( sess->dm->cache_mx );
-			gf_list_add(sess->dm->cache_entries, entry);
-			gf_mx_v( sess->dm->cache_mx );
+			gf_dm_cache_entry_add(sess->dm, entry);
 			sess->is_range_continuation = GF_FALSE;
 		}
 		assert( entry );
@@ -743,6 +969,7 @@ static void gf_dm_configure_cache(GF_DownloadSession *sess)
 		if (sess->needs_range)
 			gf_cache_set_range(sess->cache_entry, 0, sess->range_start, sess->range_end);
 		GF_LOG(GF_LOG_INFO, GF_LOG_HTTP, ("[CACHE] Cache setup to %p %s\n", sess, gf_cache_get_cache_filename(sess->cache_entry)));
+		gf_mx_v( sess->dm->cache_mx );
 
 
 		if ( (sess->allow_direct_reuse || sess->dm->allow_offline_cache) && !gf_cache_check_if_cache_file_is_corrupted(sess->cache_entry)
@@ -760,6 +987,7 @@ void gf_dm_delete_cached_file_entry(const GF_DownloadManager * dm,  const char *
 {
 	GF_Err e;
 	u32 count, i;
+	GF_List *bucket;
 	char * realURL;
 	GF_URL_Info info;
 	if (!url || !dm)
@@ -775,10 +1003,11 @@ void gf_dm_delete_cached_file_entry(const GF_DownloadManager * dm,  const char *
 	realURL = gf_strdup(info.canonicalRepresentation);
 	gf_dm_url_info_del(&info);
 	assert( realURL );
-	count = gf_list_count(dm->cache_entries);
+	bucket = gf_dm_cache_bucket((GF_DownloadManager *) dm, realURL);
+	count = gf_list_count(bucket);
 	for (i = 0 ; i < count; i++) {
 		const char * e_url;
-		DownloadedCacheEntry cache_ent = (DownloadedCacheEntry)gf_list_get(dm->cache_entries, i);
+		DownloadedCacheEntry cache_ent = (DownloadedCacheEntry)gf_list_get(bucket, i);
 		assert(cache_ent);
 		e_url = gf_cache_get_url(cache_ent);
 		assert( e_url );
@@ -787,7 +1016,7 @@ void gf_dm_delete_cached_file_entry(const GF_DownloadManager * dm,  const char *
 			gf_cache_entry_set_delete_files_when_deleted(cache_ent);
 			if (0 == gf_cache_get_sessions_count_for_cache_entry( cache_ent )) {
 				/* No session attached anymore... we can delete it */
-				gf_list_rem(dm->cache_entries, i);
+				gf_dm_cache_entry_rem((GF_DownloadManager *) dm, cache_ent);
 				gf_cache_delete_entry(cache_ent);
 			}
 			/* If deleted or not, we don't search further */
@@ -829,6 +1058,116 @@ static void gf_dm_clear_headers(GF_DownloadSession *sess)
 }
 
 
+#define GF_DM_MAX_IDLE_CONNECTIONS	16
+#define GF_DM_IDLE_CONNECTION_TIMEOUT	30000000
+
+static void gf_dm_idle_connection_del(GF_DMIdleConnection *conn)
+{
+#ifdef GPAC_HAS_SSL
+	if (conn->ssl) {
+		SSL_shutdown(conn->ssl);
+		SSL_free(conn->ssl);
+	}
+#endif
+	if (conn->sock) gf_sk_del(conn->sock);
+	gf_free(conn->server_name);
+	gf_free(conn);
+}
+
+/*moves the connection of a session about to be destroyed to the idle pool of the download manager*/
+static void gf_dm_park_connection(GF_DownloadSession *sess)
+{
+	GF_DMIdleConnection *conn;
+	if (!sess->dm || !sess->sock || sess->server_mode || !sess->server_name || sess->th) return;
+	if (!(sess->flags & GF_NETIO_SESSION_PERSISTENT) || sess->connection_close || (sess->proxy_enabled==1)) return;
+	/*only reuse connections with no pending exchange*/
+	if ((sess->status != GF_NETIO_DISCONNECTED) && (sess->status != GF_NETIO_CONNECTED)) return;
+	if (sess->remaining_data_size || (sess->do_requests != http_do_requests)) return;
+
+	GF_SAFEALLOC(conn, GF_DMIdleConnection);
+	if (!conn) return;
+	conn->server_name = gf_strdup(sess->server_name);
+	conn->port = sess->port;
+	conn->use_ssl = (sess->flags & GF_DOWNLOAD_SESSION_USE_SSL) ? GF_TRUE : GF_FALSE;
+	conn->sock = sess->sock;
+	sess->sock = NULL;
+#ifdef GPAC_HAS_SSL
+	conn->ssl = sess->ssl;
+	sess->ssl = NULL;
+	if (conn->ssl) SSL_set_app_data(conn->ssl, NULL);
+#endif
+	conn->park_time = gf_sys_clock_high_res();
+
+	gf_mx_p(sess->dm->cache_mx);
+	if (gf_list_count(sess->dm->idle_connections) >= GF_DM_MAX_IDLE_CONNECTIONS) {
+		GF_DMIdleConnection *oldest = (GF_DMIdleConnection *) gf_list_pop_front(sess->dm->idle_connections);
+		gf_dm_idle_connection_del(oldest);
+	}
+	gf_list_add(sess->dm->idle_connections, conn);
+	gf_mx_v(sess->dm->cache_mx);
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_HTTP, ("[HTTP] Keeping idle connection to %s:%d for reuse\n", conn->server_name, conn->port));
+}
+
+/*attaches an idle connection to the same host to the session if any, returns GF_TRUE if found*/
+static Bool gf_dm_reuse_connection(GF_DownloadSession *sess)
+{
+	u32 i;
+	Bool use_ssl = (sess->flags & GF_DOWNLOAD_SESSION_USE_SSL) ? GF_TRUE : GF_FALSE;
+	u64 now = gf_sys_clock_high_res();
+	GF_DMIdleConnection *found = NULL;
+	if (!sess->dm || !sess->server_name) return GF_FALSE;
+
+	gf_mx_p(sess->dm->cache_mx);
+	for (i=0; i<gf_list_count(sess->dm->idle_connections); i++) {
+		GF_Err e;
+		GF_DMIdleConnection *conn = (GF_DMIdleConnection *) gf_list_get(sess->dm->idle_connections, i);
+		if (now - conn->park_time > GF_DM_IDLE_CONNECTION_TIMEOUT) {
+			gf_list_rem(sess->dm->idle_connections, i);
+			i--;
+			gf_dm_idle_connection_del(conn);
+			continue;
+		}
+		if ((conn->port != sess->port) || (conn->use_ssl != use_ssl) || strcmp(conn->server_name, sess->server_name))
+			continue;
+
+		gf_list_rem(sess->dm->idle_connections, i);
+		i--;
+		/*check the server did not close the connection meanwhile*/
+		e = gf_sk_probe(conn->sock);
+		if (e == GF_IP_NETWORK_EMPTY) {
+			found = conn;
+			break;
+		}
+#ifdef GPAC_HAS_SSL
+		/*TLS connections may have pending session tickets, but also a close_notify alert: peek without blocking
+		to consume non-application records, the connection is alive if no application data nor alert is pending*/
+		if (use_ssl && (e == GF_OK) && conn->ssl && (gf_sk_set_block_mode(conn->sock, GF_TRUE) == GF_OK)) {
+			u8 c;
+			int res = SSL_peek(conn->ssl, &c, 1);
+			Bool alive = ((res <= 0) && (SSL_get_error(conn->ssl, res) == SSL_ERROR_WANT_READ)) ? GF_TRUE : GF_FALSE;
+			gf_sk_set_block_mode(conn->sock, GF_FALSE);
+			if (alive) {
+				found = conn;
+				break;
+			}
+		}
+#endif
+		gf_dm_idle_connection_del(conn);
+	}
+	gf_mx_v(sess->dm->cache_mx);
+	if (!found) return GF_FALSE;
+
+	sess->sock = found->sock;
+#ifdef GPAC_HAS_SSL
+	sess->ssl = found->ssl;
+	if (sess->ssl) SSL_set_app_data(sess->ssl, sess);
+#endif
+	GF_LOG(GF_LOG_INFO, GF_LOG_HTTP, ("[HTTP] Reusing idle connection to %s:%d\n", found->server_name, found->port));
+	gf_free(found->server_name);
+	gf_free(found);
+	return GF_TRUE;
+}
+
 static void gf_dm_disconnect(GF_DownloadSession *sess, Bool force_close)
 {
 	assert( sess );
@@ -883,6 +1222,7 @@ void gf_dm_sess_del(GF_DownloadSession *sess)
 		sess->destroy = GF_TRUE;
 		return;
 	}
+	gf_dm_park_connection(sess);
 	gf_dm_disconnect(sess, GF_TRUE);
 	gf_dm_clear_headers(sess);
 
@@ -1610,10 +1950,10 @@ static void gf_dm_connect(GF_DownloadSession *sess)
 	GF_Err e;
 	u16 proxy_port = 0;
 	const char *proxy;
+	Bool new_sock = GF_FALSE;
 
 	if (!sess->sock) {
-		sess->num_retry = 40;
-		sess->sock = gf_sk_new(GF_SOCK_TYPE_TCP);
+		new_sock = GF_TRUE;
 	}
 
 	/*connect*/
@@ -1654,7 +1994,21 @@ static void gf_dm_connect(GF_DownloadSession *sess)
 		proxy = sess->server_name;
 		proxy_port = sess->port;
 	}
-	GF_LOG(GF_LOG_INFO, GF_LOG_HTTP, ("[HTTP] Connecting to %s:%d\n", proxy, proxy_port));
+
+	if (new_sock) {
+		/*try an idle connection to this host before opening a new one*/
+		if ((sess->proxy_enabled!=1) && gf_dm_reuse_connection(sess)) {
+			sess->connect_time = 0;
+			sess->ssl_setup_time = 0;
+			sess->status = GF_NETIO_CONNECTED;
+			gf_dm_sess_notify_state(sess, GF_NETIO_CONNECTED, GF_OK);
+		} else {
+			sess->num_retry = 40;
+			sess->sock = gf_sk_new(GF_SOCK_TYPE_TCP);
+		}
+	}
+	if (sess->status == GF_NETIO_SETUP)
+		GF_LOG(GF_LOG_INFO, GF_LOG_HTTP, ("[HTTP] Connecting to %s:%d\n", proxy, proxy_port));
 
 	if (sess->status == GF_NETIO_SETUP) {
 		u64 now;
@@ -1710,14 +2064,24 @@ static void gf_dm_connect(GF_DownloadSession *sess)
 			X509 *cert;
 			Bool success;
 
+			SSL_SESSION *ssl_sess;
+
 			sess->ssl = SSL_new(sess->dm->ssl_ctx);
 			SSL_set_fd(sess->ssl, gf_sk_get_handle(sess->sock));
+			SSL_set_app_data(sess->ssl, sess);
+			/*SNI, required by most CDNs*/
+			SSL_set_tlsext_host_name(sess->ssl, sess->server_name);
+			ssl_sess = ssl_get_session(sess);
+			if (ssl_sess) {
+				SSL_set_session(sess->ssl, ssl_sess);
+				SSL_SESSION_free(ssl_sess);
+			}
 			SSL_set_connect_state(sess->ssl);
 			ret = SSL_connect(sess->ssl);
 			if (ret<=0) {
 				GF_LOG(GF_LOG_ERROR, GF_LOG_HTTP, ("[SSL] Cannot connect, error %d\n", ret));
 			} else {
-				GF_LOG(GF_LOG_DEBUG, GF_LOG_HTTP, ("[SSL] connected\n"));
+				GF_LOG(GF_LOG_DEBUG, GF_LOG_HTTP, ("[SSL] connected%s\n", SSL_session_reused(sess->ssl) ? " - session resumed" : ""));
 			}
 
 			cert = SSL_get_peer_certificate(sess->ssl);
@@ -2081,7 +2445,11 @@ GF_DownloadManager *gf_dm_new(GF_FilterSession *fsess)
 		return NULL;
 	}
 	dm->sessions = gf_list_new();
-	dm->cache_entries = gf_list_new();
+	gf_dm_cache_index_resize(dm, GF_DM_CACHE_MIN_BUCKETS);
+	dm->idle_connections = gf_list_new();
+#ifdef GPAC_HAS_SSL
+	dm->tls_sessions = gf_list_new();
+#endif
 	dm->credentials = gf_list_new();
 	dm->skip_proxy_servers = gf_list_new();
 	dm->partial_downloads = gf_list_new();
@@ -2204,6 +2572,12 @@ void gf_dm_del(GF_DownloadManager *dm)
 	}
 	gf_list_del(dm->sessions);
 	dm->sessions = NULL;
+	while (gf_list_count(dm->idle_connections)) {
+		GF_DMIdleConnection *conn = (GF_DMIdleConnection *) gf_list_pop_back(dm->idle_connections);
+		gf_dm_idle_connection_del(conn);
+	}
+	gf_list_del(dm->idle_connections);
+	dm->idle_connections = NULL;
 	assert( dm->skip_proxy_servers );
 	while (gf_list_count(dm->skip_proxy_servers)) {
 		char *serv = (char*)gf_list_get(dm->skip_proxy_servers, 0);
@@ -2220,19 +2594,25 @@ void gf_dm_del(GF_DownloadManager *dm)
 	}
 	gf_list_del( dm->credentials);
 	dm->credentials = NULL;
-	assert( dm->cache_entries );
+	assert( dm->cache_buckets );
 	{
+		u32 i;
 		/* Deletes DownloadedCacheEntry and associated files if required */
 		Bool delete_my_files = gf_dm_needs_to_delete_cache(dm);
-		while (gf_list_count(dm->cache_entries)) {
-			const DownloadedCacheEntry entry = (const DownloadedCacheEntry)gf_list_get( dm->cache_entries, 0);
-			gf_list_rem( dm->cache_entries, 0);
-			if (delete_my_files)
-				gf_cache_entry_set_delete_files_when_deleted(entry);
-			gf_cache_delete_entry(entry);
+		GF_LOG(GF_LOG_INFO, GF_LOG_CACHE, ("[Cache] %d entries - %d hits %d misses\n", dm->nb_cache_entries, dm->cache_hits, dm->cache_misses));
+		for (i=0; i<dm->nb_cache_buckets; i++) {
+			GF_List *bucket = dm->cache_buckets[i];
+			while (gf_list_count(bucket)) {
+				const DownloadedCacheEntry entry = (const DownloadedCacheEntry)gf_list_pop_back(bucket);
+				if (delete_my_files)
+					gf_cache_entry_set_delete_files_when_deleted(entry);
+				gf_cache_delete_entry(entry);
+			}
+			gf_list_del(bucket);
 		}
-		gf_list_del( dm->cache_entries );
-		dm->cache_entries = NULL;
+		gf_free(dm->cache_buckets);
+		dm->cache_buckets = NULL;
+		dm->nb_cache_buckets = dm->nb_cache_entries = 0;
 	}
 
 	gf_list_del( dm->partial_downloads );
@@ -2245,6 +2625,13 @@ void gf_dm_del(GF_DownloadManager *dm)
 	dm->cache_directory = NULL;
 
 #ifdef GPAC_HAS_SSL
+	while (gf_list_count(dm->tls_sessions)) {
+		GF_DMTLSSession *tls = (GF_DMTLSSession *) gf_list_pop_back(dm->tls_sessions);
+		if (tls->ssl_sess) SSL_SESSION_free(tls->ssl_sess);
+		gf_free(tls->server_name);
+		gf_free(tls);
+	}
+	gf_list_del(dm->tls_sessions);
 	if (dm->ssl_ctx) SSL_CTX_free(dm->ssl_ctx);
 #endif
 	/* Stored elsewhere, no need to free */
@@ -2522,6 +2909,7 @@ static GFINLINE void gf_dm_data_received(GF_DownloadSession *sess, u8 *payload,
 			gf_cache_close_write_cache(sess->cache_entry, sess, GF_TRUE);
 			GF_LOG(GF_LOG_DEBUG, GF_LOG_HTTP,
 			       ("[CACHE] url %s saved as %s\n", gf_cache_get_url(sess->cache_entry), gf_cache_get_cache_filename(sess->cache_entry)));
+			gf_dm_cache_entry_done(sess->dm, sess->cache_entry);
 		}
 
 		gf_dm_disconnect(sess, GF_FALSE);
@@ -4338,14 +4726,16 @@ GF_EXPORT
 const DownloadedCacheEntry gf_dm_add_cache_entry(GF_DownloadManager *dm, const char *szURL, u8 *data, u64 size, u64 start_range, u64 end_range,  const char *mime, Bool clone_memory, u32 download_time_ms)
 {
 	u32 i, count;
+	GF_List *bucket;
 	DownloadedCacheEntry the_entry = NULL;
 
 	gf_mx_p(dm->cache_mx );
 	GF_LOG(GF_LOG_INFO, GF_LOG_CACHE, ("[HTTP] Pushing %s to cache\n", szURL));
-	count = gf_list_count(dm->cache_entries);
+	bucket = gf_dm_cache_bucket(dm, szURL);
+	count = gf_list_count(bucket);
 	for (i = 0 ; i < count; i++) {
 		const char * url;
-		DownloadedCacheEntry e = (DownloadedCacheEntry)gf_list_get(dm->cache_entries, i);
+		DownloadedCacheEntry e = (DownloadedCacheEntry)gf_list_get(bucket, i);
 		assert(e);
 		url = gf_cache_get_url(e);
 		assert( url );
@@ -4361,8 +4751,11 @@ const DownloadedCacheEntry gf_dm_add_cache_entry(GF_DownloadManager *dm, const c
 	}
 	if (!the_entry) {
 		the_entry = gf_cache_create_entry(dm, "", szURL, 0, 0, GF_TRUE);
-		if (!the_entry) return NULL;
-		gf_list_add(dm->cache_entries, the_entry);
+		if (!the_entry) {
+			gf_mx_v(dm->cache_mx );
+			return NULL;
+		}
+		gf_dm_cache_entry_add(dm, the_entry);
 	}
 
 	gf_cache_set_mime(the_entry, mime);
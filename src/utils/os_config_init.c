@@ -1136,11 +1136,24 @@ GF_DEF_ARG("full-link", NULL, "throw error if any pid in the filter graph cannot
  GF_DEF_ARG("max-sleep", NULL, "set maximum sleep time slot in milliseconds when regulation is enabled", "50", NULL, GF_ARG_INT, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
 
  GF_DEF_ARG("threads", NULL, "set N extra thread for the session. -1 means use all available cores", NULL, NULL, GF_ARG_INT, GF_ARG_HINT_ADVANCED|GF_ARG_SUBSYS_FILTERS),
+ GF_DEF_ARG("th-cpus", NULL, "pin extra session threads to groups of CPUs, in round-robin. Groups are separated by `:`, each group being a CPU list (e.g. `0-3,8`) or `nodeN` for the CPUs of NUMA node N. `numa` creates one group per NUMA node", NULL, NULL, GF_ARG_STRING, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
+ GF_DEF_ARG("th-bind", NULL, "bind filters to thread groups set by [-th-cpus](), as a comma-separated list of `NAME@N`, NAME being a filter register name, filter name or ID and N the 1-based group index. Packet memory of a filter bound to CPUs of a NUMA node is allocated on that node", NULL, NULL, GF_ARG_STRING, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
  GF_DEF_ARG("no-probe", NULL, "disable data probing on sources and relies on extension (faster load but more error-prone)", NULL, NULL, GF_ARG_BOOL, GF_ARG_HINT_ADVANCED|GF_ARG_SUBSYS_FILTERS),
  GF_DEF_ARG("no-argchk", NULL, "disable tracking of argument usage (all arguments will be considered as used)", NULL, NULL, GF_ARG_BOOL, GF_ARG_HINT_ADVANCED|GF_ARG_SUBSYS_FILTERS),
  GF_DEF_ARG("blacklist", NULL, "blacklist the filters listed in the given string (comma-separated list)", NULL, NULL, GF_ARG_STRING, GF_ARG_HINT_ADVANCED|GF_ARG_SUBSYS_FILTERS),
  GF_DEF_ARG("no-graph-cache", NULL, "disable internal caching of filter graph connections. If disabled, the graph will be recomputed at each link resolution (lower memory usage but slower)", NULL, NULL, GF_ARG_BOOL, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
+ GF_DEF_ARG("graph-cache", NULL, "store the filter graph and resolved filter chains in given file and reuse them in later runs. The file is rebuilt when the filter registry changes (GPAC version, loaded modules, blacklist)", NULL, NULL, GF_ARG_STRING, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
+ GF_DEF_ARG("idx-store", NULL, "set where seek indexes of raw stream reframers (AVC, HEVC, AAC, MP3, AC3) are stored for reuse\n"
+			"- none: indexes are not stored\n"
+			"- cache: indexes are stored in the cache directory\n"
+			"- local: indexes are stored next to the source file, with `.gfidx` extension", "cache", "none|cache|local", GF_ARG_INT, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
  GF_DEF_ARG("no-reservoir", NULL, "disable memory recycling for packets and properties. This uses much less memory but stresses the system memory allocator much more", NULL, NULL, GF_ARG_BOOL, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
+ GF_DEF_ARG("pid-mem", NULL, "set memory budget in bytes for packets queued on each output PID, with optional `K`, `M` or `G` suffix. Once exceeded, the payload of packets is stored in temporary files until consumed (0 means no budget)", "0", NULL, GF_ARG_STRING, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
+ GF_DEF_ARG("sess-mem", NULL, "set memory cap in bytes for all packets queued in the session, with optional `K`, `M` or `G` suffix. Once exceeded, the payload of packets is stored in temporary files until consumed (0 means no cap)", "0", NULL, GF_ARG_STRING, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
+ GF_DEF_ARG("metrics", NULL, "enable live session metrics (PID queue residence time, buffer occupancy, blocking time and task time per filter and thread)", NULL, NULL, GF_ARG_BOOL, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
+ GF_DEF_ARG("metrics-addr", NULL, "enable live session metrics and serve them in OpenMetrics text format at `http://IP:port/metrics`, formatted as `[IP:]port`. If no IP is given, the server only listens on the loopback interface", NULL, NULL, GF_ARG_STRING, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
+ GF_DEF_ARG("trace", NULL, "record task execution and packet flow of the session and write it at exit to the given file as Chrome trace JSON, or as Perfetto protobuf for `.pftrace` extension. On POSIX systems, `SIGUSR1` writes the current trace to the file name suffixed with a dump index", NULL, NULL, GF_ARG_STRING, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
+ GF_DEF_ARG("trace-dur", NULL, "only keep the last given number of seconds in the session trace (0 keeps the whole session)", "0", NULL, GF_ARG_INT, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
 
  GF_DEF_ARG("switch-vres", NULL, "select smallest video resolution larger than scene size, otherwise use current video resolution", NULL, NULL, GF_ARG_BOOL, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_VIDEO),
  GF_DEF_ARG("hwvmem", NULL, "specify (2D rendering only) memory type of main video backbuffer. Depending on the scene type, this may drastically change the playback speed\n"
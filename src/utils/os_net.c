@@ -888,6 +888,12 @@ GF_Err gf_sk_bind(GF_Socket *sock, const char *local_ip, u16 port, const char *p
 //send length bytes of a buffer
 GF_EXPORT
 GF_Err gf_sk_send(GF_Socket *sock, const u8 *buffer, u32 length)
+{
+	return gf_sk_send_ex(sock, buffer, length, NULL);
+}
+
+GF_EXPORT
+GF_Err gf_sk_send_ex(GF_Socket *sock, const u8 *buffer, u32 length, u32 *written)
 {
 	u32 count;
 	s32 res;
@@ -898,6 +904,7 @@ GF_Err gf_sk_send(GF_Socket *sock, const u8 *buffer, u32 length)
 	fd_set Group;
 #endif
 
+	if (written) *written = 0;
 	//the socket must be bound or connected
 	if (!sock || !sock->socket)
 		return GF_BAD_PARAM;
@@ -967,6 +974,7 @@ GF_Err gf_sk_send(GF_Socket *sock, const u8 *buffer, u32 length)
 			}
 		}
 		count += res;
+		if (written) *written = count;
 	}
 	return GF_OK;
 }
@@ -23,6 +23,11 @@
  *
  */
 
+//for CPU affinity
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #ifndef GPAC_DISABLE_CORE_TOOLS
 
 #ifdef GPAC_CONFIG_ANDROID
@@ -401,6 +406,49 @@ void gf_th_set_priority(GF_Thread *t, s32 priority)
 #endif
 }
 
+GF_EXPORT
+GF_Err gf_th_set_cpu_affinity(GF_Thread *t, const u32 *cpus, u32 nb_cpus)
+{
+	if (!cpus || !nb_cpus) return GF_BAD_PARAM;
+
+#if defined(WIN32) && !defined(_WIN32_WCE)
+	{
+	u32 i;
+	DWORD_PTR mask = 0;
+	for (i=0; i<nb_cpus; i++) {
+		if (cpus[i] < 8*sizeof(DWORD_PTR))
+			mask |= ((DWORD_PTR)1) << cpus[i];
+	}
+	if (!mask) return GF_BAD_PARAM;
+	if (!SetThreadAffinityMask(t ? t->threadH : GetCurrentThread(), mask)) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_MUTEX, ("[Thread] Couldn't set CPU affinity, error %d\n", GetLastError() ));
+		return GF_IO_ERR;
+	}
+	return GF_OK;
+	}
+#elif defined(__linux__) && !defined(GPAC_CONFIG_ANDROID)
+	{
+	u32 i;
+	int res;
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (i=0; i<nb_cpus; i++) {
+		if (cpus[i] < CPU_SETSIZE)
+			CPU_SET(cpus[i], &set);
+	}
+	if (!CPU_COUNT(&set)) return GF_BAD_PARAM;
+	res = pthread_setaffinity_np(t ? t->threadH : pthread_self(), sizeof(cpu_set_t), &set);
+	if (res) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_MUTEX, ("[Thread] Couldn't set CPU affinity: %s\n", strerror(res) ));
+		return GF_IO_ERR;
+	}
+	return GF_OK;
+	}
+#else
+	return GF_NOT_SUPPORTED;
+#endif
+}
+
 GF_EXPORT
 u32 gf_th_status(GF_Thread *t)
 {
@@ -870,4 +918,141 @@ Bool gf_sema_wait_for(GF_Semaphore *sm, u32 TimeOut)
 #endif
 }
 
+
+/*********************************************************************
+						Worker Pool
+**********************************************************************/
+typedef struct
+{
+	GF_WorkerPool *pool;
+	GF_Thread *th;
+	u32 idx;
+} GF_PoolWorker;
+
+struct __tag_worker_pool
+{
+	GF_PoolWorker *workers;
+	u32 nb_workers;
+	GF_Semaphore *job_start, *job_done;
+	Bool exit;
+
+	//current job
+	gf_worker_task task;
+	void *udta;
+	u32 nb_tasks, next_task;
+};
+
+static void gf_worker_pool_run_tasks(GF_WorkerPool *pool, u32 worker_idx)
+{
+	while (1) {
+		u32 idx = (u32) safe_int_inc(&pool->next_task) - 1;
+		if (idx >= pool->nb_tasks) break;
+		pool->task(pool->udta, worker_idx, idx);
+	}
+}
+
+static u32 gf_worker_pool_thread_run(void *par)
+{
+	GF_PoolWorker *worker = (GF_PoolWorker *) par;
+	GF_WorkerPool *pool = worker->pool;
+
+	while (1) {
+		gf_sema_wait(pool->job_start);
+		if (pool->exit) break;
+		gf_worker_pool_run_tasks(pool, worker->idx);
+		gf_sema_notify(pool->job_done, 1);
+	}
+	return 0;
+}
+
+GF_EXPORT
+GF_WorkerPool *gf_worker_pool_new(s32 nb_threads, const char *name)
+{
+	u32 i;
+	GF_WorkerPool *pool;
+	GF_SAFEALLOC(pool, GF_WorkerPool);
+	if (!pool) return NULL;
+
+	if (nb_threads<0) {
+		//gf_opts_get_int gives 0 for an unset option, which would disable the pool
+		const char *opt = gf_opts_get_key("core", "threads");
+		nb_threads = opt ? atoi(opt) : -1;
+		if (nb_threads<0) {
+			GF_SystemRTInfo rti;
+			nb_threads = 0;
+			if (gf_sys_get_rti(0, &rti, 0) && (rti.nb_cores>1))
+				nb_threads = rti.nb_cores-1;
+		}
+	}
+	if (!nb_threads) return pool;
+
+	pool->job_start = gf_sema_new(nb_threads, 0);
+	pool->job_done = gf_sema_new(nb_threads, 0);
+	pool->workers = gf_malloc(sizeof(GF_PoolWorker) * nb_threads);
+	if (!pool->job_start || !pool->job_done || !pool->workers) {
+		gf_worker_pool_del(pool);
+		return NULL;
+	}
+	memset(pool->workers, 0, sizeof(GF_PoolWorker) * nb_threads);
+
+	for (i=0; i<(u32) nb_threads; i++) {
+		GF_PoolWorker *worker = &pool->workers[i];
+		worker->pool = pool;
+		worker->idx = i+1;
+		worker->th = gf_th_new(name);
+		if (!worker->th) break;
+		if (gf_th_run(worker->th, gf_worker_pool_thread_run, worker) != GF_OK) {
+			gf_th_del(worker->th);
+			worker->th = NULL;
+			break;
+		}
+		pool->nb_workers++;
+	}
+	GF_LOG(GF_LOG_INFO, GF_LOG_CORE, ("[%s] Using %d threads\n", name ? name : "WorkerPool", pool->nb_workers+1));
+	return pool;
+}
+
+GF_EXPORT
+void gf_worker_pool_del(GF_WorkerPool *pool)
+{
+	u32 i;
+	if (!pool) return;
+	if (pool->nb_workers) {
+		pool->exit = GF_TRUE;
+		gf_sema_notify(pool->job_start, pool->nb_workers);
+	}
+	for (i=0; i<pool->nb_workers; i++) {
+		gf_th_stop(pool->workers[i].th);
+		gf_th_del(pool->workers[i].th);
+	}
+	if (pool->workers) gf_free(pool->workers);
+	if (pool->job_start) gf_sema_del(pool->job_start);
+	if (pool->job_done) gf_sema_del(pool->job_done);
+	gf_free(pool);
+}
+
+GF_EXPORT
+u32 gf_worker_pool_get_thread_count(GF_WorkerPool *pool)
+{
+	return pool ? pool->nb_workers : 0;
+}
+
+GF_EXPORT
+void gf_worker_pool_run(GF_WorkerPool *pool, u32 nb_tasks, gf_worker_task task, void *udta)
+{
+	u32 i, nb_workers;
+	pool->task = task;
+	pool->udta = udta;
+	pool->nb_tasks = nb_tasks;
+	pool->next_task = 0;
+
+	//tasks are shared between the pool threads and the calling thread, only wake up the threads that can get a task
+	nb_workers = MIN(pool->nb_workers, nb_tasks ? nb_tasks-1 : 0);
+	if (nb_workers)
+		gf_sema_notify(pool->job_start, nb_workers);
+	gf_worker_pool_run_tasks(pool, 0);
+	for (i=0; i<nb_workers; i++)
+		gf_sema_wait(pool->job_done);
+}
+
 #endif
@@ -1615,6 +1615,13 @@ struct _tag_dom_parser
 
 	void (*OnProgress)(void *cbck, u64 done, u64 tot);
 	void *cbk;
+
+	gf_xml_dom_node_filter on_filter;
+	void *filter_cbk;
+	//depth in subtree of filtered element, 0 if not in filtered element
+	u32 filter_depth;
+	//last node for which a child was filtered
+	GF_XMLNode *filter_parent;
 };
 
 
@@ -1655,6 +1662,18 @@ static void on_dom_node_start(void *cbk, const char *name, const char *ns, const
 		par->parser->suspended = GF_TRUE;
 		return;
 	}
+	if (par->filter_depth) {
+		par->filter_depth++;
+		return;
+	}
+	if (par->on_filter) {
+		GF_XMLNode *parent = (GF_XMLNode *)gf_list_last(par->stack);
+		if (par->on_filter(par->filter_cbk, parent, name, ns, attributes, nb_attributes)) {
+			par->filter_depth = 1;
+			par->filter_parent = parent;
+			return;
+		}
+	}
 
 	GF_SAFEALLOC(node, GF_XMLNode);
 	if (!node) {
@@ -1688,7 +1707,12 @@ static void on_dom_node_start(void *cbk, const char *name, const char *ns, const
 static void on_dom_node_end(void *cbk, const char *name, const char *ns)
 {
 	GF_DOMParser *par = (GF_DOMParser *)cbk;
-	GF_XMLNode *last = (GF_XMLNode *)gf_list_last(par->stack);
+	GF_XMLNode *last;
+	if (par->filter_depth) {
+		par->filter_depth--;
+		return;
+	}
+	last = (GF_XMLNode *)gf_list_last(par->stack);
 	gf_list_rem_last(par->stack);
 
 	if (!last || (strlen(last->name)!=strlen(name)) || strcmp(last->name, name) || (!ns && last->ns) || (ns && !last->ns) || (ns && strcmp(last->ns, ns) ) ) {
@@ -1717,9 +1741,16 @@ static void on_dom_text_content(void *cbk, const char *content, Bool is_cdata)
 	GF_DOMParser *par = (GF_DOMParser *)cbk;
 	GF_XMLNode *node;
 	GF_XMLNode *last = (GF_XMLNode *)gf_list_last(par->stack);
-	if (!last) return;
+	if (!last || par->filter_depth) return;
 	assert(last->content);
 
+	//don't keep blank text between filtered elements
+	if (par->filter_parent == last) {
+		const char *c = content;
+		while (c[0] && strchr(" \n\r\t", c[0])) c++;
+		if (!c[0]) return;
+	}
+
 	GF_SAFEALLOC(node, GF_XMLNode);
 	if (!node) {
 		GF_LOG(GF_LOG_ERROR, GF_LOG_PARSER, ("[SAX] Failed to allocate XML node"));
@@ -1749,6 +1780,8 @@ static void gf_xml_dom_reset(GF_DOMParser *dom, Bool full_reset)
 		dom->parser = NULL;
 	}
 
+	dom->filter_depth = 0;
+	dom->filter_parent = NULL;
 	if (dom->stack) {
 		while (gf_list_count(dom->stack)) {
 			GF_XMLNode *n = (GF_XMLNode *)gf_list_last(dom->stack);
@@ -1792,6 +1825,14 @@ GF_XMLNode *gf_xml_dom_detach_root(GF_DOMParser *parser)
 }
 #endif
 
+GF_EXPORT
+void gf_xml_dom_set_node_filter(GF_DOMParser *parser, gf_xml_dom_node_filter on_filter, void *cbk)
+{
+	if (!parser) return;
+	parser->on_filter = on_filter;
+	parser->filter_cbk = cbk;
+}
+
 static void dom_on_progress(void *cbck, u64 done, u64 tot)
 {
 	GF_DOMParser *dom = (GF_DOMParser *)cbck;